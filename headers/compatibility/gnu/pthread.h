@@ -12,12 +12,19 @@
 #ifdef _GNU_SOURCE
 
 
+#include <sched.h>
+
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 
 extern int pthread_getattr_np(pthread_t thread, pthread_attr_t* attr);
+extern int pthread_getaffinity_np(pthread_t thread, size_t cpuSetSize,
+	cpu_set_t* mask);
+extern int pthread_setaffinity_np(pthread_t thread, size_t cpuSetSize,
+	const cpu_set_t* mask);
 
 
 #ifdef __cplusplus
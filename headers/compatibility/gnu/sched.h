@@ -0,0 +1,96 @@
+/*
+ * Copyright 2026 Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _GNU_SCHED_H_
+#define _GNU_SCHED_H_
+
+
+#include_next <sched.h>
+
+
+#ifdef _GNU_SOURCE
+
+
+#include <sys/types.h>
+
+
+#define CPU_SETSIZE	1024
+
+typedef struct {
+	__haiku_uint32	__bits[CPU_SETSIZE / 32];
+} cpu_set_t;
+
+
+#define CPU_ZERO(set)			__cpu_zero(set)
+#define CPU_SET(cpu, set)		__cpu_set(cpu, set)
+#define CPU_CLR(cpu, set)		__cpu_clr(cpu, set)
+#define CPU_ISSET(cpu, set)		__cpu_isset(cpu, set)
+#define CPU_COUNT(set)			__cpu_count(set)
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+extern int sched_getaffinity(pid_t thread, size_t cpuSetSize,
+	cpu_set_t* mask);
+extern int sched_setaffinity(pid_t thread, size_t cpuSetSize,
+	const cpu_set_t* mask);
+
+
+static __inline void
+__cpu_zero(cpu_set_t* set)
+{
+	int i;
+	for (i = 0; i < CPU_SETSIZE / 32; i++)
+		set->__bits[i] = 0;
+}
+
+
+static __inline void
+__cpu_set(int cpu, cpu_set_t* set)
+{
+	if (cpu >= 0 && cpu < CPU_SETSIZE)
+		set->__bits[cpu / 32] |= 1u << (cpu % 32);
+}
+
+
+static __inline void
+__cpu_clr(int cpu, cpu_set_t* set)
+{
+	if (cpu >= 0 && cpu < CPU_SETSIZE)
+		set->__bits[cpu / 32] &= ~(1u << (cpu % 32));
+}
+
+
+static __inline int
+__cpu_isset(int cpu, const cpu_set_t* set)
+{
+	if (cpu < 0 || cpu >= CPU_SETSIZE)
+		return 0;
+	return (set->__bits[cpu / 32] & (1u << (cpu % 32))) != 0;
+}
+
+
+static __inline int
+__cpu_count(const cpu_set_t* set)
+{
+	int count = 0;
+	int i;
+	for (i = 0; i < CPU_SETSIZE; i++)
+		count += __cpu_isset(i, set);
+	return count;
+}
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
+
+
+#endif	/* _GNU_SCHED_H_ */
@@ -172,6 +172,7 @@ public:
 									bool isFixedSize = true, int32 count = 1);
 
 			status_t			Append(const BMessage& message);
+			status_t			Reserve(int32 fieldCount, size_t dataSize);
 
 	// Removing data
 			status_t			RemoveData(const char* name, int32 index = 0);
@@ -531,6 +532,11 @@ private:
 
 			status_t			_ValidateMessage();
 
+			status_t			_AllocateBody();
+			void				_FreeBody();
+			status_t			_ResizeFields(uint32 capacity);
+			status_t			_ResizeDataBuffer(size_t capacity);
+
 			void				_UpdateOffsets(uint32 offset, int32 change);
 			status_t			_ResizeData(uint32 offset, int32 change);
 
@@ -43,5 +43,12 @@ struct translator_info {
 	char			MIME[251];
 };
 
+struct translation_signature {
+	int32		offset;				// of the pattern within the data
+	int32		length;				// of the pattern
+	const char*	pattern;
+	const char*	mask;				// ANDed with the data, may be NULL
+};
+
 
 #endif	// _TRANSLATION_DEFS_H
@@ -45,10 +45,13 @@ protected:
 		// Release() function instead of being deleted directly by
 		// the user
 
+public:
+	// uses the slot of the first reserved virtual
+	virtual const translation_signature* InputSignatures(int32* _count) const;
+
 private:
 	friend class BTranslatorRoster::Private;
 
-	virtual status_t			_Reserved_Translator_0(int32, void*);
 	virtual status_t			_Reserved_Translator_1(int32, void*);
 	virtual status_t			_Reserved_Translator_2(int32, void*);
 	virtual status_t			_Reserved_Translator_3(int32, void*);
@@ -23,6 +23,8 @@ extern int32 translatorVersion;
 
 extern translation_format inputFormats[];	// optional
 extern	translation_format outputFormats[];	// optional
+extern translation_signature inputSignatures[];
+	// optional, terminated by an entry with a length of 0
 
 
 extern "C" {
@@ -76,6 +76,8 @@ struct TranslatorBitmap {
 	// actual data follows
 };
 
+#define B_TRANSLATOR_BITMAP_SIGNATURE	{ 0, 4, "bits", NULL }
+
 
 // Sound format (always in big endian)
 struct TranslatorSound {
@@ -16,8 +16,13 @@
 
 
 #define MESSAGE_BODY_HASH_TABLE_SIZE	5
+#define MIN_DATA_PREALLOCATION			256
 #define MAX_DATA_PREALLOCATION			B_PAGE_SIZE * 10
-#define MAX_FIELD_PREALLOCATION			50
+#define MIN_FIELD_PREALLOCATION			8
+#define MAX_FIELD_PREALLOCATION			256
+
+#define MESSAGE_POOL_ENABLED			1
+	// recycle message headers and bodies of the minimum size per thread
 
 
 static const int32 kPortMessageCode = 'pjpp';
@@ -373,6 +373,9 @@ enum {
 	// Internal messages
 	AS_COLOR_MAP_UPDATED,
 
+	// debugging helper
+	AS_DUMP_FONT_CACHE,
+
 	AS_LAST_CODE
 };
 
@@ -31,4 +31,9 @@ const uint32 kGetAddOnInfos = 'GAIn';
 const uint32 kEnableAddOn = 'EnaA';
 const uint32 kDisableAddOn = 'DisA';
 
+// Replies with a "status" message per volume, holding "volume", "catch up
+// active", "catch up runs", "catch up runs done", "catch up backlog" and
+// "catch up runs per second". A run is one entry passed to one analyser.
+const uint32 kGetCatchUpStatus = 'GCuS';
+
 #endif // INDEX_SERVER_PRIVATE_H
@@ -96,6 +96,23 @@ int32 _user_get_scheduler_mode(void);
 
 #ifdef __cplusplus
 }
+
+
+/*!	Restricts the CPUs the given thread may run on. An empty mask, or one
+	that contains all CPUs, removes the restriction.
+	The thread may be running or may be in the ready-to-run queue. If it is
+	running on a CPU it may no longer use, that CPU is told to reschedule;
+	for the current CPU, the caller needs to call
+	scheduler_reschedule_if_necessary().
+	The caller must hold the thread's lock. Interrupts must be enabled.
+*/
+void scheduler_set_thread_cpu_mask(Thread* thread, const CPUSet& mask);
+
+/*!	Returns the CPUs the given thread may run on. If it is not restricted,
+	all CPUs are set.
+*/
+void scheduler_get_thread_cpu_mask(Thread* thread, CPUSet& mask);
+
 #endif
 
 
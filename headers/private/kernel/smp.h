@@ -56,6 +56,7 @@ public:
 	inline	bool		GetBit(int32 cpu) const;
 
 	inline	bool		IsEmpty() const;
+	inline	bool		Matches(const CPUSet& mask) const;
 
 private:
 	static	const int	kArraySize = ROUNDUP(SMP_MAX_CPUS, 32) / 32;
@@ -169,6 +170,20 @@ CPUSet::IsEmpty() const
 }
 
 
+/*!	Returns whether the sets have at least one CPU in common.
+*/
+inline bool
+CPUSet::Matches(const CPUSet& mask) const
+{
+	for (int i = 0; i < kArraySize; i++) {
+		if ((fBitmap[i] & mask.fBitmap[i]) != 0)
+			return true;
+	}
+
+	return false;
+}
+
+
 // Unless spinlock debug features are enabled, try to inline
 // {acquire,release}_spinlock().
 #if !DEBUG_SPINLOCKS && !B_DEBUG_SPINLOCK_CONTENTION
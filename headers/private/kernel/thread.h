@@ -141,6 +141,9 @@ void thread_unblock(Thread* thread, status_t status);
 
 // used in syscalls.c
 status_t _user_set_thread_priority(thread_id thread, int32 newPriority);
+status_t _user_set_thread_affinity(thread_id thread, const void *mask,
+			size_t size);
+status_t _user_get_thread_affinity(thread_id thread, void *mask, size_t size);
 status_t _user_rename_thread(thread_id thread, const char *name);
 status_t _user_suspend_thread(thread_id thread);
 status_t _user_resume_thread(thread_id thread);
@@ -0,0 +1,36 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _PACKAGE__PRIVATE__SOLVER_REPOSITORY_CACHE_KEY_H_
+#define _PACKAGE__PRIVATE__SOLVER_REPOSITORY_CACHE_KEY_H_
+
+
+#include <String.h>
+
+
+namespace BPackageKit {
+
+
+class BSolverRepository;
+
+
+namespace BPrivate {
+
+
+/*!	Identifies the repository cache file the packages of a solver
+	repository were read from, so that solvers can keep their converted
+	form around. The key is empty if the packages didn't come from a
+	repository cache, or have been changed since.
+*/
+BString	get_solver_repository_cache_key(const BSolverRepository* repository);
+void	set_solver_repository_cache_key(const BSolverRepository* repository,
+			const BString& key);
+
+
+}	// namespace BPrivate
+
+}	// namespace BPackageKit
+
+
+#endif	// _PACKAGE__PRIVATE__SOLVER_REPOSITORY_CACHE_KEY_H_
@@ -59,7 +59,8 @@ private:
 									size_t expectedStringLength,
 									char leadingChar);
 
-	static bool					IsValidNumber(BString& number);
+	static bool					IsValidNumber(const char* number,
+									int32 length);
 	static bool					ParseNumber(JsonParseContext& jsonParseContext);
 };
 
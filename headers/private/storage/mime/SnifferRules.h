@@ -7,6 +7,7 @@
 
 
 #include <SupportDefs.h>
+#include <sniffer/Matcher.h>
 
 #include <list>
 #include <string>
@@ -53,18 +54,21 @@ public:
 	};		
 private:
 	status_t BuildRuleList();
+	status_t CompileRules();
 	status_t GuessMimeType(BFile* file, const void *buffer, int32 length,
 		BString *type);
 	ssize_t MaxBytesNeeded();
 	status_t ProcessType(const char *type, ssize_t *bytesNeeded);
 
 	std::list<sniffer_rule> fRuleList;
+	Sniffer::Matcher fMatcher;
 
 private:
 	DatabaseLocation*	fDatabaseLocation;
 	MimeSniffer*		fMimeSniffer;
 	ssize_t				fMaxBytesNeeded;
 	bool				fHaveDoneFullBuild;
+	bool				fHaveCompiledRules;
 };
 
 } // namespace Mime
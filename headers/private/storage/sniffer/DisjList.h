@@ -9,6 +9,7 @@
 #ifndef _SNIFFER_DISJ_LIST_H
 #define _SNIFFER_DISJ_LIST_H
 
+#include <SupportDefs.h>
 #include <sys/types.h>
 
 class BPositionIO;
@@ -18,6 +19,8 @@ namespace Storage {
 namespace Sniffer {
 
 //! Abstract class defining methods acting on a list of ORed patterns
+class Matcher;
+
 class DisjList {
 public:
 	DisjList();
@@ -25,6 +28,7 @@ public:
 
 	virtual bool Sniff(BPositionIO *data) const = 0;
 	virtual ssize_t BytesNeeded() const = 0;
+	virtual void AddTo(Matcher *matcher, uint32 disjunction) const = 0;
 	
 	void SetCaseInsensitive(bool how);
 	bool IsCaseInsensitive();
@@ -0,0 +1,83 @@
+//----------------------------------------------------------------------
+//  This software is part of the Haiku distribution and is covered
+//  by the MIT License.
+//---------------------------------------------------------------------
+/*!
+	\file sniffer/Matcher.h
+	MIME sniffer multi-rule matcher declarations
+*/
+#ifndef _SNIFFER_MATCHER_H
+#define _SNIFFER_MATCHER_H
+
+#include <SupportDefs.h>
+
+#include <string>
+#include <vector>
+
+namespace BPrivate {
+namespace Storage {
+namespace Sniffer {
+
+class Pattern;
+class Range;
+class RPattern;
+class Rule;
+
+/*! \brief A set of rules compiled into a single structure that can be
+	evaluated against a data buffer in one pass.
+
+	Every pattern of every rule is indexed by one of its unmasked bytes (its
+	"anchor"). Matching walks the buffer once, and at each position only the
+	patterns anchored by the byte found there are verified.
+*/
+class Matcher {
+public:
+	Matcher();
+	~Matcher();
+
+	status_t SetTo(const std::vector<const Rule*> &rules);
+	void Unset();
+
+	int32 CountRules() const;
+	void Match(const void *buffer, size_t length,
+		std::vector<bool> &matches) const;
+
+	void AddPattern(uint32 disjunction, const Range &range,
+		const Pattern *pattern, bool caseInsensitive);
+	void AddRPattern(uint32 disjunction, const RPattern *rpattern,
+		bool caseInsensitive);
+
+private:
+	struct pattern_entry {
+		int32		start;			// first allowed starting offset
+		int32		end;			// last allowed starting offset
+		uint32		anchor;			// index of the anchor byte in string
+		uint32		disjunction;
+		std::string	string;
+		std::string	alternate;		// case swapped string, or a copy of string
+		std::string	mask;
+	};
+
+	struct rule_entry {
+		uint32		first_disjunction;
+		uint32		disjunction_count;
+		bool		valid;
+	};
+
+	static uint32 _ChooseAnchor(const std::string &string,
+		const std::string &mask);
+	static bool _Verify(const pattern_entry &entry, const uint8 *data);
+
+	std::vector<pattern_entry> fPatterns;
+	std::vector<uint32> fAnchorTable[256];
+	std::vector<uint32> fUnanchored;
+	std::vector<rule_entry> fRules;
+	uint32 fDisjunctionCount;
+	size_t fScanLength;
+};
+
+};	// namespace Sniffer
+};	// namespace Storage
+};	// namespace BPrivate
+
+#endif	// _SNIFFER_MATCHER_H
@@ -37,6 +37,8 @@ public:
 	
 	status_t SetTo(const std::string &string, const std::string &mask);
 private:
+	friend class Matcher;
+
 	bool Sniff(off_t start, off_t size, BPositionIO *data, bool caseInsensitive) const;
 	
 	void SetStatus(status_t status, const char *msg = NULL);
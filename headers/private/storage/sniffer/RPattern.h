@@ -32,6 +32,8 @@ public:
 	bool Sniff(BPositionIO *data, bool caseInsensitive) const;
 	ssize_t BytesNeeded() const;
 private:
+	friend class Matcher;
+
 	Range fRange;
 	Pattern *fPattern;
 };
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _BLOCK_COMPRESSION_H_
+#define _BLOCK_COMPRESSION_H_
+
+
+#include <CompressionAlgorithm.h>
+#include <OS.h>
+
+
+enum {
+	B_BLOCK_COMPRESSION_DEFAULT_BLOCK_SIZE	= 1024 * 1024,
+};
+
+
+class BBlockCompressingOutputStream : public BDataIO {
+public:
+								BBlockCompressingOutputStream(BDataIO* output,
+									BCompressionAlgorithm* algorithm,
+									const BCompressionParameters* parameters
+										= NULL);
+	virtual						~BBlockCompressingOutputStream();
+
+			status_t			Init(size_t blockSize
+										= B_BLOCK_COMPRESSION_DEFAULT_BLOCK_SIZE,
+									int32 threadCount = 0);
+
+	virtual	ssize_t				Write(const void* buffer, size_t size);
+	virtual	status_t			Flush();
+
+			status_t			Finish();
+
+private:
+			struct Block;
+			struct IndexEntry;
+
+private:
+	static	status_t			_WorkerEntry(void* data);
+			void				_Worker();
+			void				_CompressBlock(Block& block);
+			status_t			_SubmitBlock();
+			status_t			_WriteNextBlock();
+			status_t			_WriteAllBlocks();
+			void				_StopWorkers();
+
+private:
+			BDataIO*			fOutput;
+			BCompressionAlgorithm* fAlgorithm;
+			const BCompressionParameters* fParameters;
+			size_t				fBlockSize;
+			Block*				fBlocks;
+			int32				fBlockCount;
+			thread_id*			fThreads;
+			int32				fThreadCount;
+			sem_id				fWorkSemaphore;
+			int64				fNextBlock;
+			int64				fNextCompressedBlock;
+			int64				fNextWrittenBlock;
+			IndexEntry*			fIndex;
+			int64				fIndexCapacity;
+			uint64				fOutputOffset;
+			status_t			fError;
+			bool				fTerminating;
+			bool				fFinished;
+};
+
+
+class BBlockDecompressingInputStream : public BPositionIO {
+public:
+								BBlockDecompressingInputStream(
+									BPositionIO* input,
+									BCompressionAlgorithm* algorithm,
+									const BDecompressionParameters* parameters
+										= NULL);
+	virtual						~BBlockDecompressingInputStream();
+
+			status_t			Init();
+
+	virtual	ssize_t				ReadAt(off_t position, void* buffer,
+									size_t size);
+	virtual	ssize_t				WriteAt(off_t position, const void* buffer,
+									size_t size);
+
+	virtual	off_t				Seek(off_t position, uint32 seekMode);
+	virtual	off_t				Position() const;
+
+	virtual	status_t			SetSize(off_t size);
+	virtual	status_t			GetSize(off_t* size) const;
+
+			int64				CountBlocks() const	{ return fBlockCount; }
+
+private:
+			struct Block;
+
+private:
+			int64				_BlockAt(off_t position) const;
+			status_t			_LoadBlock(int64 index);
+
+private:
+			BPositionIO*		fInput;
+			BCompressionAlgorithm* fAlgorithm;
+			const BDecompressionParameters* fParameters;
+			Block*				fBlocks;
+			int64				fBlockCount;
+			size_t				fBlockSize;
+			off_t				fSize;
+			off_t				fPosition;
+			uint8*				fBuffer;
+			uint8*				fCompressedBuffer;
+			int64				fBufferedBlock;
+};
+
+
+#endif	// _BLOCK_COMPRESSION_H_
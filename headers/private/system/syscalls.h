@@ -159,6 +159,10 @@ extern status_t		_kern_resume_thread(thread_id thread);
 extern status_t		_kern_rename_thread(thread_id thread, const char *newName);
 extern status_t		_kern_set_thread_priority(thread_id thread,
 						int32 newPriority);
+extern status_t		_kern_set_thread_affinity(thread_id thread,
+						const void *mask, size_t size);
+extern status_t		_kern_get_thread_affinity(thread_id thread, void *mask,
+						size_t size);
 extern status_t		_kern_kill_thread(thread_id thread);
 extern void			_kern_exit_thread(status_t returnValue);
 extern status_t		_kern_cancel_thread(thread_id threadID,
@@ -21,6 +21,7 @@ struct system_profiler_parameters {
 	// sampling
 	bigtime_t	interval;				// interval at which to take samples
 	uint32		stack_depth;			// maximum stack depth to sample
+										// (also used for wait events)
 };
 
 
@@ -31,7 +32,8 @@ enum {
 	B_SYSTEM_PROFILER_IMAGE_EVENTS			= 0x04,
 	B_SYSTEM_PROFILER_SAMPLING_EVENTS		= 0x08,
 	B_SYSTEM_PROFILER_SCHEDULING_EVENTS		= 0x10,
-	B_SYSTEM_PROFILER_IO_SCHEDULING_EVENTS	= 0x20
+	B_SYSTEM_PROFILER_IO_SCHEDULING_EVENTS	= 0x20,
+	B_SYSTEM_PROFILER_WAIT_EVENTS			= 0x40
 };
 
 
@@ -71,7 +73,10 @@ enum {
 	B_SYSTEM_PROFILER_IO_REQUEST_SCHEDULED,
 	B_SYSTEM_PROFILER_IO_REQUEST_FINISHED,
 	B_SYSTEM_PROFILER_IO_OPERATION_STARTED,
-	B_SYSTEM_PROFILER_IO_OPERATION_FINISHED
+	B_SYSTEM_PROFILER_IO_OPERATION_FINISHED,
+
+	// off-CPU profiling
+	B_SYSTEM_PROFILER_THREAD_WAITING
 };
 
 
@@ -229,5 +234,16 @@ struct system_profiler_io_operation_finished {
 	size_t		transferred;
 };
 
+// B_SYSTEM_PROFILER_THREAD_WAITING
+// Sent when a thread starts waiting. The wait ends with the next
+// B_SYSTEM_PROFILER_THREAD_ENQUEUED_IN_RUN_QUEUE event for the thread.
+struct system_profiler_thread_waiting {
+	nanotime_t	time;
+	thread_id	thread;
+	uint16		wait_object_type;
+	addr_t		wait_object;
+	addr_t		samples[0];		// the stack of the thread
+};
+
 
 #endif	/* _SYSTEM_SYSTEM_PROFILER_DEFS_H */
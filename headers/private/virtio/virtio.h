@@ -34,6 +34,9 @@
 #define VIRTIO_FEATURE_BAD_FEATURE 			(1 << 30)
 
 #define VIRTIO_VIRTQUEUES_MAX_COUNT	8
+// descriptors in the indirect table of a request, if
+// VIRTIO_FEATURE_RING_INDIRECT_DESC is used
+#define VIRTIO_INDIRECT_DESCRIPTORS_MAX_COUNT	128
 
 #define VIRTIO_CONFIG_STATUS_RESET	0x00
 #define VIRTIO_CONFIG_STATUS_ACK	0x01
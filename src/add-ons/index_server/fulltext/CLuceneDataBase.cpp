@@ -9,8 +9,11 @@
 
 #include "CLuceneDataBase.h"
 
+#include <Autolock.h>
 #include <Directory.h>
 #include <File.h>
+#include <Locker.h>
+#include <String.h>
 #include <TranslatorRoster.h>
 
 
@@ -29,6 +32,11 @@ using namespace lucene::util;
 
 const uint8 kCluceneTries = 10;
 
+// Lucene allows only one writer per index, but the catch up runs several
+// analysers, each with its own data base, on the same index at once.
+static BLocker sIndexLock("clucene index");
+static int32 sTempFileCount = 0;
+
 
 wchar_t* to_wchar(const char *str)
 {
@@ -52,13 +60,15 @@ CLuceneWriteDataBase::CLuceneWriteDataBase(const BPath& databasePath)
 	printf("CLuceneWriteDataBase fDataBasePath %s\n", fDataBasePath.Path());
 	create_directory(fDataBasePath.Path(), 0755);
 
-	fTempPath.Append("temp_file");
+	BString name;
+	name.SetToFormat("temp_file_%" B_PRId32, atomic_add(&sTempFileCount, 1));
+	fTempPath.Append(name);
 }
 
 
 CLuceneWriteDataBase::~CLuceneWriteDataBase()
 {
-	// TODO: delete fTempPath file
+	BEntry(fTempPath.Path()).Remove();
 }
 
 
@@ -88,7 +98,7 @@ status_t
 CLuceneWriteDataBase::RemoveDocument(const entry_ref& ref)
 {
 	// check if already in the queue
-	for (unsigned int i = 0; i < fAddQueue.size(); i++) {
+	for (unsigned int i = 0; i < fDeleteQueue.size(); i++) {
 		if (fDeleteQueue.at(i) == ref)
 			return B_OK;
 	}
@@ -104,6 +114,8 @@ CLuceneWriteDataBase::Commit()
 		return B_OK;
 	STRACE("Commit\n");
 
+	BAutolock _(sIndexLock);
+
 	_RemoveDocuments(fAddQueue);
 	_RemoveDocuments(fDeleteQueue);
 	fDeleteQueue.clear();
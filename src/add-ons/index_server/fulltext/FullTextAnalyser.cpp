@@ -27,6 +27,11 @@
 #endif
 
 
+//! Every commit opens the index for reading and writing, so documents are
+//! collected into batches.
+const uint32 kMaxUncommitted = 1000;
+
+
 FullTextAnalyser::FullTextAnalyser(BString name, const BVolume& volume)
 	:
 	FileAnalyser(name, volume),
@@ -73,7 +78,7 @@ FullTextAnalyser::AnalyseEntry(const entry_ref& ref)
 	fWriteDataBase->AddDocument(ref);
 
 	fNUncommited++;
-	if (fNUncommited > 100)
+	if (fNUncommited >= kMaxUncommitted)
 		LastEntry();
 }
 
@@ -716,6 +716,24 @@ extern struct nvme_qpair * nvme_ioqp_get(struct nvme_ctrlr *ctrlr,
 					 enum nvme_qprio qprio,
 					 unsigned int qd);
 
+/**
+ * @brief Get an I/O queue pair with its own interrupt vector
+ *
+ * @param ctrlr	Controller handle
+ * @param qprio I/O queue pair priority for weighted round robin arbitration
+ * @param qd 	I/O queue pair maximum submission queue depth
+ * @param iv	MSI-X vector the completion queue should raise
+ *
+ * Same as nvme_ioqp_get(), but completions of the queue pair raise the
+ * interrupt vector @iv instead of vector 0.
+ *
+ * @return An I/O queue pair handle on success and NULL in case of failure.
+ */
+extern struct nvme_qpair * nvme_ioqp_get_iv(struct nvme_ctrlr *ctrlr,
+					    enum nvme_qprio qprio,
+					    unsigned int qd,
+					    unsigned int iv);
+
 /**
  * @brief Release an I/O queue pair
  *
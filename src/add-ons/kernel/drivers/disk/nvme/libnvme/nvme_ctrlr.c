@@ -1401,6 +1401,17 @@ out:
  */
 struct nvme_qpair *nvme_ioqp_get(struct nvme_ctrlr *ctrlr,
 				 enum nvme_qprio qprio, unsigned int qd)
+{
+	return nvme_ioqp_get_iv(ctrlr, qprio, qd, 0);
+}
+
+/*
+ * Get an unused I/O queue pair, whose completions raise
+ * the interrupt vector iv.
+ */
+struct nvme_qpair *nvme_ioqp_get_iv(struct nvme_ctrlr *ctrlr,
+				    enum nvme_qprio qprio, unsigned int qd,
+				    unsigned int iv)
 {
 	struct nvme_qpair *qpair = NULL;
 	union nvme_cc_register cc;
@@ -1457,6 +1468,8 @@ struct nvme_qpair *nvme_ioqp_get(struct nvme_ctrlr *ctrlr,
 		goto out;
 	}
 
+	qpair->iv = iv;
+
 	/*
 	 * At this point, qpair contains a preallocated submission
 	 * and completion queue and a unique queue ID, but it is not
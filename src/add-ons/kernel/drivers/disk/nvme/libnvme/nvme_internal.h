@@ -389,6 +389,11 @@ struct nvme_qpair {
 
 	uint8_t				qprio;
 
+	/*
+	 * Interrupt vector raised by the completion queue.
+	 */
+	uint16_t			iv;
+
 	struct nvme_ctrlr		*ctrlr;
 
 	/* List entry for nvme_ctrlr::free_io_qpairs and active_io_qpairs */
@@ -13,7 +13,10 @@
 #include <algorithm>
 #include <condition_variable.h>
 #include <AutoDeleter.h>
+#include <DPC.h>
+#include <int.h>
 #include <kernel.h>
+#include <smp.h>
 #include <util/AutoLock.h>
 
 #include <fs/devfs.h>
@@ -71,13 +74,45 @@ static const uint8 kDriveIcon[] = {
 #define NVME_DISK_DEVICE_MODULE_NAME 	"drivers/disk/nvme_disk/device_v1"
 #define NVME_DISK_DEVICE_ID_GENERATOR	"nvme_disk/device_id"
 
-#define NVME_MAX_QPAIRS					(8)
+#define NVME_MAX_QPAIRS					(16)
 
 
 static device_manager_info* sDeviceManager;
 static pci_x86_module_info* sPCIx86Module;
 
-typedef struct {
+
+struct nvme_io_batch;
+struct nvme_io_command;
+
+
+/*!	Every CPU submits its I/O to a qpair of its own, as far as there are
+	enough of them. With MSI-X, the completions of a qpair raise a vector of
+	its own, too, which is handled by that same CPU. Completions are
+	processed in the qpair's DPC thread.
+*/
+struct qpair_info : DPCCallback {
+	virtual	void			DoDPC(DPCQueue* queue);
+
+	struct nvme_qpair*		qpair;
+	uint8					vector;
+	int32					dpc_scheduled;
+	DPCQueue				dpc_queue;
+	ConditionVariable		interrupt;
+		// notified after completions have been processed
+
+	spinlock				finished_lock;
+	nvme_io_batch*			finished_batches;
+		// completed while the qpair was locked, notified after polling
+
+	mutex					deferred_lock;
+	nvme_io_command*		deferred_commands;
+	nvme_io_command**		deferred_tail;
+		// could not be submitted as the qpair was full, resubmitted after
+		// polling
+};
+
+
+typedef struct nvme_disk_driver_info {
 	device_node*			node;
 	pci_info				info;
 
@@ -89,20 +124,17 @@ typedef struct {
 	uint32					max_io_blocks;
 	status_t				media_status;
 
-	struct qpair_info {
-		struct nvme_qpair*	qpair;
-	}						qpairs[NVME_MAX_QPAIRS];
+	qpair_info				qpairs[NVME_MAX_QPAIRS];
 	uint32					qpair_count;
-	uint32					next_qpair;
 
 	DMAResource				dma_resource;
 	sem_id					dma_buffers_sem;
 
 	rw_lock					rounded_write_lock;
 
-	ConditionVariable		interrupt;
+	uint8					irq;
+	uint8					msix_count;
 } nvme_disk_driver_info;
-typedef nvme_disk_driver_info::qpair_info qpair_info;
 
 
 typedef struct {
@@ -168,6 +200,7 @@ nvme_disk_set_capacity(nvme_disk_driver_info* info, uint64 capacity,
 
 
 static int32 nvme_interrupt_handler(void* _info);
+static int32 nvme_qpair_interrupt_handler(void* _qpinfo);
 
 
 static status_t
@@ -239,14 +272,92 @@ nvme_disk_init_device(void* _info, void** _cookie)
 	TRACE("capacity: %" B_PRIu64 ", block_size %" B_PRIu32 "\n",
 		info->capacity, info->block_size);
 
+	// set up interrupts
+	if (get_module(B_PCI_X86_MODULE_NAME, (module_info**)&sPCIx86Module)
+			!= B_OK) {
+		sPCIx86Module = NULL;
+	}
+
+	uint16 command = pci->read_pci_config(pcidev, PCI_command, 2);
+	command &= ~(PCI_command_int_disable);
+	pci->write_pci_config(pcidev, PCI_command, 2, command);
+
+	// Ideally, we get a qpair and an MSI-X vector for every CPU, plus the
+	// vector 0 for the admin queue.
+	uint32 qpairCount = min_c((uint32)cstat.io_qpairs, NVME_MAX_QPAIRS);
+	qpairCount = min_c(qpairCount, (uint32)smp_get_num_cpus());
+
+	info->irq = info->info.u.h0.interrupt_line;
+	info->msix_count = 0;
+	if (sPCIx86Module != NULL) {
+		uint8 msixCount = sPCIx86Module->get_msix_count(info->info.bus,
+			info->info.device, info->info.function);
+		if (msixCount > 0) {
+			uint8 vectorCount = min_c(qpairCount + 1, (uint32)msixCount);
+			uint8 msixVector = 0;
+			if (sPCIx86Module->configure_msix(info->info.bus, info->info.device,
+					info->info.function, vectorCount, &msixVector) == B_OK
+				&& sPCIx86Module->enable_msix(info->info.bus, info->info.device,
+					info->info.function) == B_OK) {
+				TRACE_ALWAYS("using MSI-X with %u vectors\n", vectorCount);
+				info->irq = msixVector;
+				info->msix_count = vectorCount;
+			}
+		} else if (sPCIx86Module->get_msi_count(info->info.bus,
+				info->info.device, info->info.function) >= 1) {
+			uint8 msiVector = 0;
+			if (sPCIx86Module->configure_msi(info->info.bus, info->info.device,
+					info->info.function, 1, &msiVector) == B_OK
+				&& sPCIx86Module->enable_msi(info->info.bus, info->info.device,
+					info->info.function) == B_OK) {
+				TRACE_ALWAYS("using message signaled interrupts\n");
+				info->irq = msiVector;
+			}
+		}
+	}
+
+	if (info->irq == 0 || info->irq == 0xFF) {
+		TRACE_ERROR("device PCI:%d:%d:%d was assigned an invalid IRQ\n",
+			info->info.bus, info->info.device, info->info.function);
+		nvme_ctrlr_close(info->ctrlr);
+		return B_ERROR;
+	}
+
+	// If there are vectors for the qpairs, every qpair gets one of its own,
+	// otherwise they share the first one with the admin queue.
+	if (info->msix_count > 1)
+		qpairCount = min_c(qpairCount, (uint32)info->msix_count - 1);
+
 	// allocate qpairs
-	info->qpair_count = info->next_qpair = 0;
-	for (uint32 i = 0; i < NVME_MAX_QPAIRS && i < cstat.io_qpairs; i++) {
-		info->qpairs[i].qpair = nvme_ioqp_get(info->ctrlr,
-			(enum nvme_qprio)0, 0);
-		if (info->qpairs[i].qpair == NULL)
+	info->qpair_count = 0;
+	for (uint32 i = 0; i < qpairCount; i++) {
+		qpair_info* qpinfo = &info->qpairs[i];
+
+		uint32 vectorIndex = info->msix_count > 1 ? i + 1 : 0;
+
+		qpinfo->qpair = nvme_ioqp_get_iv(info->ctrlr, (enum nvme_qprio)0, 0,
+			vectorIndex);
+		if (qpinfo->qpair == NULL)
 			break;
 
+		qpinfo->vector = info->irq + vectorIndex;
+		qpinfo->dpc_scheduled = 0;
+		qpinfo->interrupt.Init(qpinfo, "nvme qpair");
+		B_INITIALIZE_SPINLOCK(&qpinfo->finished_lock);
+		qpinfo->finished_batches = NULL;
+		mutex_init(&qpinfo->deferred_lock, "nvme deferred commands");
+		qpinfo->deferred_commands = NULL;
+		qpinfo->deferred_tail = &qpinfo->deferred_commands;
+
+		char name[B_OS_NAME_LENGTH];
+		snprintf(name, sizeof(name), "nvme qpair %" B_PRIu32, i);
+		if (qpinfo->dpc_queue.Init(name, B_URGENT_DISPLAY_PRIORITY, 0)
+				!= B_OK) {
+			mutex_destroy(&qpinfo->deferred_lock);
+			nvme_ioqp_release(qpinfo->qpair);
+			break;
+		}
+
 		info->qpair_count++;
 	}
 	if (info->qpair_count == 0) {
@@ -284,48 +395,22 @@ nvme_disk_init_device(void* _info, void** _cookie)
 	// set up rounded-write lock
 	rw_lock_init(&info->rounded_write_lock, "nvme rounded writes");
 
-	// set up interrupt
-	if (get_module(B_PCI_X86_MODULE_NAME, (module_info**)&sPCIx86Module)
-			!= B_OK) {
-		sPCIx86Module = NULL;
-	}
+	// The first vector serves the admin queue, and all qpairs that don't
+	// have a vector of their own.
+	install_io_interrupt_handler(info->irq, nvme_interrupt_handler,
+		(void*)info, B_NO_HANDLED_INFO);
 
-	uint16 command = pci->read_pci_config(pcidev, PCI_command, 2);
-	command &= ~(PCI_command_int_disable);
-	pci->write_pci_config(pcidev, PCI_command, 2, command);
+	for (uint32 i = 0; i < info->qpair_count; i++) {
+		qpair_info* qpinfo = &info->qpairs[i];
+		if (qpinfo->vector == info->irq)
+			continue;
 
-	uint8 irq = info->info.u.h0.interrupt_line;
-	if (sPCIx86Module != NULL) {
-		if (sPCIx86Module->get_msix_count(info->info.bus, info->info.device,
-				info->info.function)) {
-			uint8 msixVector = 0;
-			if (sPCIx86Module->configure_msix(info->info.bus, info->info.device,
-					info->info.function, 1, &msixVector) == B_OK
-				&& sPCIx86Module->enable_msix(info->info.bus, info->info.device,
-					info->info.function) == B_OK) {
-				TRACE_ALWAYS("using MSI-X\n");
-				irq = msixVector;
-			}
-		} else if (sPCIx86Module->get_msi_count(info->info.bus,
-				info->info.device, info->info.function) >= 1) {
-			uint8 msiVector = 0;
-			if (sPCIx86Module->configure_msi(info->info.bus, info->info.device,
-					info->info.function, 1, &msiVector) == B_OK
-				&& sPCIx86Module->enable_msi(info->info.bus, info->info.device,
-					info->info.function) == B_OK) {
-				TRACE_ALWAYS("using message signaled interrupts\n");
-				irq = msiVector;
-			}
-		}
-	}
+		install_io_interrupt_handler(qpinfo->vector,
+			nvme_qpair_interrupt_handler, (void*)qpinfo, 0);
 
-	if (irq == 0 || irq == 0xFF) {
-		TRACE_ERROR("device PCI:%d:%d:%d was assigned an invalid IRQ\n",
-			info->info.bus, info->info.device, info->info.function);
-		return B_ERROR;
+		// let the CPU that submits to this qpair handle its completions
+		assign_io_interrupt_to_cpu(qpinfo->vector, i);
 	}
-	info->interrupt.Init(NULL, NULL);
-	install_io_interrupt_handler(irq, nvme_interrupt_handler, (void*)info, B_NO_HANDLED_INFO);
 
 	if (info->ctrlr->feature_supported[NVME_FEAT_INTERRUPT_COALESCING]) {
 		uint32 microseconds = 16, threshold = 32;
@@ -344,8 +429,19 @@ nvme_disk_uninit_device(void* _cookie)
 	CALLED();
 	nvme_disk_driver_info* info = (nvme_disk_driver_info*)_cookie;
 
-	remove_io_interrupt_handler(info->info.u.h0.interrupt_line,
-		nvme_interrupt_handler, (void*)info);
+	remove_io_interrupt_handler(info->irq, nvme_interrupt_handler,
+		(void*)info);
+
+	for (uint32 i = 0; i < info->qpair_count; i++) {
+		qpair_info* qpinfo = &info->qpairs[i];
+		if (qpinfo->vector != info->irq) {
+			remove_io_interrupt_handler(qpinfo->vector,
+				nvme_qpair_interrupt_handler, (void*)qpinfo);
+		}
+
+		qpinfo->dpc_queue.Close(false);
+		mutex_destroy(&qpinfo->deferred_lock);
+	}
 
 	rw_lock_destroy(&info->rounded_write_lock);
 
@@ -399,20 +495,127 @@ nvme_disk_free(void* cookie)
 // #pragma mark - I/O
 
 
+struct nvme_io_request {
+	status_t status;
+
+	bool write;
+
+	off_t lba_start;
+	size_t lba_count;
+
+	physical_entry* iovecs;
+	int32 iovec_count;
+
+	int32 iovec_i;
+	uint32 iovec_offset;
+};
+
+
+struct nvme_io_command : nvme_io_request {
+	nvme_io_batch* batch;
+	nvme_io_command* next;
+		// in the qpair's deferred commands
+	int32 done;
+};
+
+
+/*!	A direct I/O request, split into commands that are processed by the
+	controller at the same time. The request is notified once the last of
+	them has completed.
+*/
+struct nvme_io_batch {
+	nvme_io_batch* next;
+
+	nvme_disk_driver_info* info;
+	qpair_info* qpinfo;
+	io_request* request;
+
+	physical_entry* vtophys;
+	off_t rounded_pos;
+	phys_size_t rounded_len;
+
+	int32 pending;
+		// commands in flight, plus one for the submitter
+	int32 command_count;
+	nvme_io_command* commands;
+};
+
+
+static void
+schedule_qpair_dpc(qpair_info* qpinfo)
+{
+	if (atomic_get_and_set(&qpinfo->dpc_scheduled, 1) == 0)
+		qpinfo->dpc_queue.Add(qpinfo);
+}
+
+
 static int32
 nvme_interrupt_handler(void* _info)
 {
 	nvme_disk_driver_info* info = (nvme_disk_driver_info*)_info;
-	info->interrupt.NotifyAll();
-	return 0;
+
+	// The qpairs can't be polled from here, as libnvme locks them using
+	// mutexes.
+	for (uint32 i = 0; i < info->qpair_count; i++) {
+		if (info->qpairs[i].vector == info->irq)
+			schedule_qpair_dpc(&info->qpairs[i]);
+	}
+	return B_INVOKE_SCHEDULER;
+}
+
+
+static int32
+nvme_qpair_interrupt_handler(void* _qpinfo)
+{
+	schedule_qpair_dpc((qpair_info*)_qpinfo);
+	return B_INVOKE_SCHEDULER;
 }
 
 
 static qpair_info*
 get_qpair(nvme_disk_driver_info* info)
 {
-	return &info->qpairs[atomic_add((int32*)&info->next_qpair, 1)
-		% info->qpair_count];
+	return &info->qpairs[smp_get_current_cpu() % info->qpair_count];
+}
+
+
+static void finish_io_batch(nvme_io_batch* batch);
+static void resubmit_deferred_commands(qpair_info* qpinfo);
+
+
+/*!	Processes the completions of the qpair, resubmits the commands that
+	had to wait for them, and notifies the batches that were completed.
+	This cannot happen in the completion callbacks themselves, as libnvme
+	calls them with the qpair locked, and notifying an I/O request may well
+	issue new I/O.
+*/
+static void
+poll_qpair(qpair_info* qpinfo)
+{
+	nvme_qpair_poll(qpinfo->qpair, 0);
+
+	resubmit_deferred_commands(qpinfo);
+
+	InterruptsSpinLocker locker(qpinfo->finished_lock);
+	nvme_io_batch* batch = qpinfo->finished_batches;
+	qpinfo->finished_batches = NULL;
+	locker.Unlock();
+
+	while (batch != NULL) {
+		nvme_io_batch* next = batch->next;
+		finish_io_batch(batch);
+		batch = next;
+	}
+
+	qpinfo->interrupt.NotifyAll();
+}
+
+
+void
+qpair_info::DoDPC(DPCQueue* queue)
+{
+	atomic_set(&dpc_scheduled, 0);
+	poll_qpair(this);
 }
 
 
@@ -424,54 +627,39 @@ io_finished_callback(status_t* status, const struct nvme_cpl* cpl)
 
 
 static void
-await_status(nvme_disk_driver_info* info, struct nvme_qpair* qpair, status_t& status)
+await_status(qpair_info* qpinfo, status_t& status)
 {
 	CALLED();
 
 	ConditionVariableEntry entry;
 	int timeouts = 0;
 	while (status == EINPROGRESS) {
-		info->interrupt.Add(&entry);
+		qpinfo->interrupt.Add(&entry);
 
-		nvme_qpair_poll(qpair, 0);
+		poll_qpair(qpinfo);
 
 		if (status != EINPROGRESS)
 			return;
 
 		if (entry.Wait(B_RELATIVE_TIMEOUT, 5 * 1000 * 1000) != B_OK) {
-			// This should never happen, as we are woken up on every interrupt
-			// no matter the qpair or transfer within; so if it does occur,
-			// that probably means the controller stalled or something.
+			// This should never happen, as we are woken up after every
+			// interrupt of the qpair; so if it does occur, that probably
+			// means the controller stalled or something.
 
 			TRACE_ERROR("timed out waiting for interrupt!\n");
 			if (timeouts++ >= 3) {
-				nvme_qpair_fail(qpair);
+				nvme_qpair_fail(qpinfo->qpair);
+				poll_qpair(qpinfo);
 				status = B_TIMED_OUT;
 				return;
 			}
 		}
 
-		nvme_qpair_poll(qpair, 0);
+		poll_qpair(qpinfo);
 	}
 }
 
 
-struct nvme_io_request {
-	status_t status;
-
-	bool write;
-
-	off_t lba_start;
-	size_t lba_count;
-
-	physical_entry* iovecs;
-	int32 iovec_count;
-
-	int32 iovec_i;
-	uint32 iovec_offset;
-};
-
-
 void ior_reset_sgl(nvme_io_request* request, uint32_t offset)
 {
 	TRACE("IOR Reset: %" B_PRIu32 "\n", offset);
@@ -531,7 +719,7 @@ do_nvme_io_request(nvme_disk_driver_info* info, nvme_io_request* request)
 		return ret;
 	}
 
-	await_status(info, qpinfo->qpair, request->status);
+	await_status(qpinfo, request->status);
 
 	if (request->status != B_OK) {
 		TRACE_ERROR("%s at LBA %" B_PRIdOFF " of %" B_PRIuSIZE
@@ -544,6 +732,173 @@ do_nvme_io_request(nvme_disk_driver_info* info, nvme_io_request* request)
 }
 
 
+static void
+finish_io_batch(nvme_io_batch* batch)
+{
+	nvme_disk_driver_info* info = batch->info;
+	io_request* request = batch->request;
+
+	// The request has been transferred up to the first command that failed.
+	status_t status = B_OK;
+	generic_size_t transferred = batch->rounded_len;
+	for (int32 i = 0; i < batch->command_count; i++) {
+		nvme_io_command* command = &batch->commands[i];
+		if (command->status == B_OK)
+			continue;
+
+		TRACE_ERROR("%s at LBA %" B_PRIdOFF " of %" B_PRIuSIZE
+			" blocks failed!\n", command->write ? "write" : "read",
+			command->lba_start, command->lba_count);
+
+		status = command->status;
+		transferred = command->lba_start * info->block_size
+			- batch->rounded_pos;
+		break;
+	}
+
+	if (request->IsWrite())
+		rw_lock_read_unlock(&info->rounded_write_lock);
+
+	free(batch->vtophys);
+	free(batch);
+
+	request->SetTransferredBytes(status != B_OK, transferred);
+	request->SetStatusAndNotify(status);
+}
+
+
+static void
+io_command_done(nvme_io_command* command, status_t status)
+{
+	// libnvme may report an error after it already called the callback
+	if (atomic_get_and_set(&command->done, 1) != 0)
+		return;
+
+	command->status = status;
+
+	nvme_io_batch* batch = command->batch;
+	if (atomic_add(&batch->pending, -1) != 1)
+		return;
+
+	// The submitter is done with the batch already, and we are called with
+	// the qpair locked; leave the notification to poll_qpair().
+	qpair_info* qpinfo = batch->qpinfo;
+	InterruptsSpinLocker locker(qpinfo->finished_lock);
+	batch->next = qpinfo->finished_batches;
+	qpinfo->finished_batches = batch;
+}
+
+
+static void
+io_command_finished_callback(nvme_io_command* command,
+	const struct nvme_cpl* cpl)
+{
+	io_command_done(command, nvme_cpl_is_error(cpl) ? B_IO_ERROR : B_OK);
+}
+
+
+static int
+queue_io_command(nvme_disk_driver_info* info, qpair_info* qpinfo,
+	nvme_io_command* command)
+{
+	if (command->write) {
+		return nvme_ns_writev(info->ns, qpinfo->qpair, command->lba_start,
+			command->lba_count, (nvme_cmd_cb)io_command_finished_callback,
+			command, 0, (nvme_req_reset_sgl_cb)ior_reset_sgl,
+			(nvme_req_next_sge_cb)ior_next_sge);
+	}
+
+	return nvme_ns_readv(info->ns, qpinfo->qpair, command->lba_start,
+		command->lba_count, (nvme_cmd_cb)io_command_finished_callback,
+		command, 0, (nvme_req_reset_sgl_cb)ior_reset_sgl,
+		(nvme_req_next_sge_cb)ior_next_sge);
+}
+
+
+/*!	Submits the command, or defers it if the qpair is out of requests.
+	Waiting for some of them to complete is not an option, as we may be
+	called from the qpair's DPC when a finished request issues new I/O;
+	poll_qpair() resubmits the command instead. As the qpair was full,
+	there are commands in flight whose completion will trigger that.
+*/
+static status_t
+submit_io_command(nvme_disk_driver_info* info, qpair_info* qpinfo,
+	nvme_io_command* command)
+{
+	MutexLocker locker(qpinfo->deferred_lock);
+
+	// keep the order, if there are deferred commands already
+	if (qpinfo->deferred_commands == NULL) {
+		int ret = queue_io_command(info, qpinfo, command);
+		if (ret == 0)
+			return B_OK;
+
+		if (ret != ENOMEM) {
+			TRACE_ERROR("attempt to queue %s I/O at LBA %" B_PRIdOFF " of %"
+				B_PRIuSIZE " blocks failed!\n", command->write ? "write" : "read",
+				command->lba_start, command->lba_count);
+			return ret;
+		}
+	}
+
+	command->next = NULL;
+	*qpinfo->deferred_tail = command;
+	qpinfo->deferred_tail = &command->next;
+	return B_OK;
+}
+
+
+static void
+resubmit_deferred_commands(qpair_info* qpinfo)
+{
+	MutexLocker locker(qpinfo->deferred_lock);
+
+	while (nvme_io_command* command = qpinfo->deferred_commands) {
+		int ret = queue_io_command(command->batch->info, qpinfo, command);
+		if (ret == ENOMEM)
+			break;
+
+		qpinfo->deferred_commands = command->next;
+		if (qpinfo->deferred_commands == NULL)
+			qpinfo->deferred_tail = &qpinfo->deferred_commands;
+
+		if (ret != 0) {
+			TRACE_ERROR("attempt to resubmit %s I/O at LBA %" B_PRIdOFF " of %"
+				B_PRIuSIZE " blocks failed!\n", command->write ? "write" : "read",
+				command->lba_start, command->lba_count);
+			io_command_done(command, ret);
+		}
+	}
+}
+
+
+/*!	Returns how many of the \a count vecs fit into a single command, and
+	the number of blocks they span in \a _blocks.
+*/
+static int32
+get_command_vecs(const physical_entry* vecs, int32 count, size_t blockSize,
+	uint32 maxBlocks, size_t* _blocks)
+{
+	count = min_c(count, NVME_MAX_SGL_DESCRIPTORS / 2);
+
+	size_t blocks = 0;
+	for (int32 i = 0; i < count; i++) {
+		size_t newBlocks = blocks + vecs[i].size / blockSize;
+		if (blocks > 0 && newBlocks > maxBlocks) {
+			// We already have a nonzero length, and adding this vec would
+			// make us go over (or we already are over.) Stop adding.
+			count = i;
+			break;
+		}
+
+		blocks = newBlocks;
+	}
+
+	*_blocks = blocks;
+	return count;
+}
+
+
 static status_t
 nvme_disk_bounced_io(nvme_disk_handle* handle, io_request* request)
 {
@@ -730,14 +1085,6 @@ nvme_disk_io(void* cookie, io_request* request)
 		return nvme_disk_bounced_io(handle, request);
 	}
 
-	nvme_request.lba_start = rounded_pos / block_size;
-	nvme_request.lba_count = rounded_len / block_size;
-
-	// No bouncing was required.
-	ReadLocker readLocker;
-	if (nvme_request.write)
-		readLocker.SetTo(handle->info->rounded_write_lock, false);
-
 	// Error check before actually doing I/O.
 	if (status != B_OK) {
 		TRACE_ERROR("I/O failed early: %s\n", strerror(status));
@@ -745,42 +1092,74 @@ nvme_disk_io(void* cookie, io_request* request)
 		return status;
 	}
 
+	// No bouncing was required, so split the request into commands that
+	// are all submitted at once.
 	const uint32 max_io_blocks = handle->info->max_io_blocks;
+	int32 commandCount = 0;
+	for (int32 i = 0; i < nvme_request.iovec_count; commandCount++) {
+		size_t blocks;
+		i += get_command_vecs(nvme_request.iovecs + i,
+			nvme_request.iovec_count - i, block_size, max_io_blocks, &blocks);
+	}
+
+	nvme_io_batch* batch = (nvme_io_batch*)malloc(sizeof(nvme_io_batch)
+		+ sizeof(nvme_io_command) * commandCount);
+	if (batch == NULL) {
+		request->SetStatusAndNotify(B_NO_MEMORY);
+		return B_NO_MEMORY;
+	}
+
+	batch->info = handle->info;
+	batch->qpinfo = get_qpair(handle->info);
+	batch->request = request;
+	batch->vtophys = (physical_entry*)vtophysDeleter.Detach();
+	batch->rounded_pos = rounded_pos;
+	batch->rounded_len = rounded_len;
+	batch->pending = commandCount + 1;
+	batch->command_count = commandCount;
+	batch->commands = (nvme_io_command*)(batch + 1);
+
+	physical_entry* vecs = nvme_request.iovecs;
 	int32 remaining = nvme_request.iovec_count;
-	while (remaining > 0) {
-		nvme_request.iovec_count = min_c(remaining,
-			NVME_MAX_SGL_DESCRIPTORS / 2);
-
-		nvme_request.lba_count = 0;
-		for (int i = 0; i < nvme_request.iovec_count; i++) {
-			int32 new_lba_count = nvme_request.lba_count
-				+ (nvme_request.iovecs[i].size / block_size);
-			if (nvme_request.lba_count > 0 && new_lba_count > max_io_blocks) {
-				// We already have a nonzero length, and adding this vec would
-				// make us go over (or we already are over.) Stop adding.
-				nvme_request.iovec_count = i;
-				break;
-			}
+	off_t lba = rounded_pos / block_size;
+	for (int32 i = 0; i < commandCount; i++) {
+		nvme_io_command* command = &batch->commands[i];
+		memset(command, 0, sizeof(nvme_io_command));
+
+		size_t blocks;
+		int32 vecCount = get_command_vecs(vecs, remaining, block_size,
+			max_io_blocks, &blocks);
+
+		command->status = EINPROGRESS;
+		command->write = nvme_request.write;
+		command->lba_start = lba;
+		command->lba_count = blocks;
+		command->iovecs = vecs;
+		command->iovec_count = vecCount;
+		command->batch = batch;
+
+		vecs += vecCount;
+		remaining -= vecCount;
+		lba += blocks;
+	}
 
-			nvme_request.lba_count = new_lba_count;
-		}
+	// Unlocked by finish_io_batch().
+	if (nvme_request.write)
+		rw_lock_read_lock(&handle->info->rounded_write_lock);
 
-		status = do_nvme_io_request(handle->info, &nvme_request);
+	for (int32 i = 0; i < commandCount; i++) {
+		nvme_io_command* command = &batch->commands[i];
+		if (status == B_OK)
+			status = submit_io_command(handle->info, batch->qpinfo, command);
 		if (status != B_OK)
-			break;
-
-		nvme_request.iovecs += nvme_request.iovec_count;
-		remaining -= nvme_request.iovec_count;
-		nvme_request.lba_start += nvme_request.lba_count;
+			io_command_done(command, status);
 	}
 
-	if (status != B_OK)
-		TRACE_ERROR("I/O failed: %s\n", strerror(status));
+	if (atomic_add(&batch->pending, -1) == 1)
+		finish_io_batch(batch);
 
-	request->SetTransferredBytes(status != B_OK,
-		(nvme_request.lba_start * block_size) - rounded_pos);
-	request->SetStatusAndNotify(status);
-	return status;
+	// The request is notified asynchronously.
+	return B_OK;
 }
 
 
@@ -802,6 +1181,8 @@ nvme_disk_read(void* cookie, off_t pos, void* buffer, size_t* length)
 		return status;
 
 	status = nvme_disk_io(handle, &request);
+	if (status == B_OK)
+		status = request.Wait();
 	*length = request.TransferredBytes();
 	return status;
 }
@@ -825,6 +1206,8 @@ nvme_disk_write(void* cookie, off_t pos, const void* buffer, size_t* length)
 		return status;
 
 	status = nvme_disk_io(handle, &request);
+	if (status == B_OK)
+		status = request.Wait();
 	*length = request.TransferredBytes();
 	return status;
 }
@@ -841,7 +1224,7 @@ nvme_disk_flush(nvme_disk_driver_info* info)
 	if (ret != 0)
 		return ret;
 
-	await_status(info, qpinfo->qpair, status);
+	await_status(qpinfo, status);
 	return status;
 }
 
@@ -985,7 +1368,7 @@ nvme_disk_uninit_driver(void* _cookie)
 	CALLED();
 
 	nvme_disk_driver_info* info = (nvme_disk_driver_info*)_cookie;
-	free(info);
+	delete info;
 }
 
 
@@ -41,6 +41,9 @@
 #define VIRTIO_BLK_F_SCSI	0x0080	/* Supports scsi command passthru */
 #define VIRTIO_BLK_F_FLUSH	0x0200	/* Cache flush command support */
 #define VIRTIO_BLK_F_TOPOLOGY	0x0400	/* Topology information is available */
+#define VIRTIO_BLK_F_MQ		0x1000	/* Supports multiple queues */
+#define VIRTIO_BLK_F_DISCARD	0x2000	/* Supports the discard command */
+#define VIRTIO_BLK_F_WRITE_ZEROES	0x4000	/* Supports write zeroes */
 
 #define VIRTIO_BLK_ID_BYTES	20	/* ID string length */
 
@@ -60,6 +63,32 @@ struct virtio_blk_config {
 
 	/* block size of device (if VIRTIO_BLK_F_BLK_SIZE) */
 	uint32_t blk_size;
+
+	/* the next fields are only available, if the features are supported */
+
+	/* topology of the device (if VIRTIO_BLK_F_TOPOLOGY) */
+	struct virtio_blk_topology {
+		uint8_t physical_block_exp;
+		uint8_t alignment_offset;
+		uint16_t min_io_size;
+		uint32_t opt_io_size;
+	} topology;
+
+	uint8_t writeback;
+	uint8_t unused0;
+	/* number of queues (if VIRTIO_BLK_F_MQ) */
+	uint16_t num_queues;
+
+	/* discard limits (if VIRTIO_BLK_F_DISCARD) */
+	uint32_t max_discard_sectors;
+	uint32_t max_discard_seg;
+	uint32_t discard_sector_alignment;
+
+	/* write zeroes limits (if VIRTIO_BLK_F_WRITE_ZEROES) */
+	uint32_t max_write_zeroes_sectors;
+	uint32_t max_write_zeroes_seg;
+	uint8_t write_zeroes_may_unmap;
+	uint8_t unused1[3];
 } _PACKED;
 
 /*
@@ -86,6 +115,12 @@ struct virtio_blk_config {
 /* Get device ID command */
 #define VIRTIO_BLK_T_GET_ID	8
 
+/* Discard command */
+#define VIRTIO_BLK_T_DISCARD	11
+
+/* Write zeroes command */
+#define VIRTIO_BLK_T_WRITE_ZEROES	13
+
 /* Barrier before this op. */
 #define VIRTIO_BLK_T_BARRIER	0x80000000
 
@@ -102,6 +137,19 @@ struct virtio_blk_outhdr {
 	uint64_t sector;
 };
 
+/* The data of the discard and write zeroes commands. */
+struct virtio_blk_discard_write_zeroes {
+	/* First sector (ie. 512 byte offset) */
+	uint64_t sector;
+	/* Number of sectors */
+	uint32_t num_sectors;
+	/* VIRTIO_BLK_WRITE_ZEROES_FLAG_* */
+	uint32_t flags;
+};
+
+/* The device may deallocate the blocks instead of writing zeroes. */
+#define VIRTIO_BLK_WRITE_ZEROES_FLAG_UNMAP	0x1
+
 struct virtio_scsi_inhdr {
 	uint32_t errors;
 	uint32_t data_len;
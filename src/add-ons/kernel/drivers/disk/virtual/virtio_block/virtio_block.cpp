@@ -10,7 +10,8 @@
 
 
 class DMAResource;
-class IOScheduler;
+class IOSchedulerMultiQueue;
+struct virtio_block_queue;
 
 
 static const uint8 kDriveIcon[] = {
@@ -49,8 +50,9 @@ typedef struct {
 	device_node*			node;
 	::virtio_device			virtio_device;
 	virtio_device_interface*	virtio;
-	::virtio_queue			virtio_queue;
-	IOScheduler*			io_scheduler;
+	virtio_block_queue*		queues;
+	uint32					queue_count;
+	IOSchedulerMultiQueue*	io_scheduler;
 	DMAResource*			dma_resource;
 
 	struct virtio_blk_config	config;
@@ -59,8 +61,6 @@ typedef struct {
 	uint64					capacity;
 	uint32					block_size;
 	status_t				media_status;
-
-	sem_id 	sem_cb;
 } virtio_block_driver_info;
 
 
@@ -69,15 +69,21 @@ typedef struct {
 } virtio_block_handle;
 
 
+#include <stddef.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
+#include <AutoDeleter.h>
+#include <condition_variable.h>
 #include <fs/devfs.h>
+#include <smp.h>
+#include <util/AutoLock.h>
+#include <util/fs_trim_support.h>
 
 #include "dma_resources.h"
 #include "IORequest.h"
-#include "IOSchedulerSimple.h"
+#include "IOSchedulerMultiQueue.h"
 
 
 //#define TRACE_VIRTIO_BLOCK
@@ -90,6 +96,45 @@ typedef struct {
 #define CALLED() 			TRACE("CALLED %s\n", __PRETTY_FUNCTION__)
 
 
+/*!	The part of a request the device reads and writes; the data of
+	the request is passed in between the header and the status.
+*/
+struct virtio_block_request_header {
+	struct virtio_blk_outhdr	header;
+	struct virtio_blk_discard_write_zeroes	segment;
+	uint8						status;
+};
+
+
+struct virtio_block_request {
+	virtio_block_request*		next;
+	virtio_block_request_header*	header;
+	phys_addr_t					physical_address;
+
+	IOOperation*				operation;
+		// NULL for commands issued by the driver itself
+	status_t					status;
+};
+
+
+/*!	Every CPU has a virtqueue of its own, as far as the device offers
+	enough of them. The ring, and the list of unused requests are protected
+	by the spinlock, as they are accessed in interrupt context, too.
+*/
+struct virtio_block_queue {
+	virtio_block_driver_info*	info;
+	::virtio_queue				virtio_queue;
+
+	spinlock					lock;
+	virtio_block_request*		requests;
+	virtio_block_request*		free_requests;
+	area_id						headers_area;
+
+	ConditionVariable			event;
+		// notified whenever requests have been completed
+};
+
+
 static device_manager_info* sDeviceManager;
 
 
@@ -119,6 +164,12 @@ get_feature_name(uint32 feature)
 			return "flush command";
 		case VIRTIO_BLK_F_TOPOLOGY:
 			return "topology";
+		case VIRTIO_BLK_F_MQ:
+			return "multiple queues";
+		case VIRTIO_BLK_F_DISCARD:
+			return "discard command";
+		case VIRTIO_BLK_F_WRITE_ZEROES:
+			return "write zeroes command";
 	}
 	return NULL;
 }
@@ -160,13 +211,26 @@ log2(uint32 x)
 }
 
 
+/*!	Older devices don't have the fields beyond the block size. */
+static size_t
+get_config_size(virtio_block_driver_info* info)
+{
+	if ((info->features & (VIRTIO_BLK_F_TOPOLOGY | VIRTIO_BLK_F_MQ
+			| VIRTIO_BLK_F_DISCARD | VIRTIO_BLK_F_WRITE_ZEROES)) != 0) {
+		return sizeof(struct virtio_blk_config);
+	}
+
+	return offsetof(struct virtio_blk_config, topology);
+}
+
+
 static void
 virtio_block_config_callback(void* driverCookie)
 {
 	virtio_block_driver_info* info = (virtio_block_driver_info*)driverCookie;
 
 	status_t status = info->virtio->read_device_config(info->virtio_device, 0,
-		&info->config, sizeof(struct virtio_blk_config));
+		&info->config, get_config_size(info));
 	if (status != B_OK)
 		return;
 
@@ -183,75 +247,317 @@ virtio_block_config_callback(void* driverCookie)
 }
 
 
+static status_t
+get_request_status(virtio_block_request* request)
+{
+	switch (request->header->status) {
+		case VIRTIO_BLK_S_OK:
+			return B_OK;
+		case VIRTIO_BLK_S_UNSUPP:
+			return ENOTSUP;
+		default:
+			return EIO;
+	}
+}
+
+
 static void
 virtio_block_callback(void* driverCookie, void* cookie)
 {
-	virtio_block_driver_info* info = (virtio_block_driver_info*)cookie;
+	virtio_block_queue* queue = (virtio_block_queue*)cookie;
+	virtio_block_driver_info* info = queue->info;
 
 	// consume all queued elements
-	while (info->virtio->queue_dequeue(info->virtio_queue, NULL, NULL))
-		;
+	while (true) {
+		InterruptsSpinLocker locker(queue->lock);
+
+		virtio_block_request* request;
+		if (!info->virtio->queue_dequeue(queue->virtio_queue,
+				(void**)&request, NULL)) {
+			break;
+		}
+
+		status_t status = get_request_status(request);
+		IOOperation* operation = request->operation;
+		if (operation == NULL) {
+			// the issuer waits for it, and returns it to the queue
+			request->status = status;
+			continue;
+		}
 
-	release_sem_etc(info->sem_cb, 1, B_DO_NOT_RESCHEDULE);
+		request->next = queue->free_requests;
+		queue->free_requests = request;
+		locker.Unlock();
+
+		info->io_scheduler->OperationCompleted(operation, status,
+			status == B_OK ? operation->Length() : 0);
+	}
+
+	queue->event.NotifyAll();
 }
 
 
-static status_t
-do_io(void* cookie, IOOperation* operation)
+static virtio_block_request*
+get_request(virtio_block_queue* queue)
 {
-	virtio_block_driver_info* info = (virtio_block_driver_info*)cookie;
+	while (true) {
+		ConditionVariableEntry entry;
+		queue->event.Add(&entry);
+
+		InterruptsSpinLocker locker(queue->lock);
+		virtio_block_request* request = queue->free_requests;
+		if (request != NULL) {
+			queue->free_requests = request->next;
+			return request;
+		}
+		locker.Unlock();
 
-	size_t bytesTransferred = 0;
-	status_t status = B_OK;
+		entry.Wait();
+	}
+}
 
-	physical_entry entries[operation->VecCount() + 2];
 
-	void *buffer = malloc(sizeof(struct virtio_blk_outhdr) + sizeof(uint8));
-	struct virtio_blk_outhdr *header = (struct virtio_blk_outhdr*)buffer;
-	header->type = operation->IsWrite() ? VIRTIO_BLK_T_OUT : VIRTIO_BLK_T_IN;
-	header->sector = operation->Offset() / 512;
-	header->ioprio = 1;
+static void
+put_request(virtio_block_queue* queue, virtio_block_request* request)
+{
+	InterruptsSpinLocker locker(queue->lock);
+	request->next = queue->free_requests;
+	queue->free_requests = request;
+	locker.Unlock();
+
+	queue->event.NotifyAll();
+}
+
+
+/*!	Passes the request to the device. If the ring is full, this waits
+	until other requests of the queue have been completed.
+*/
+static status_t
+queue_request(virtio_block_queue* queue, virtio_block_request* request,
+	const physical_entry* entries, size_t readCount, size_t writtenCount)
+{
+	virtio_block_driver_info* info = queue->info;
+
+	while (true) {
+		ConditionVariableEntry entry;
+		queue->event.Add(&entry);
+
+		InterruptsSpinLocker locker(queue->lock);
+		status_t status = info->virtio->queue_request_v(queue->virtio_queue,
+			entries, readCount, writtenCount, request);
+		if (status != B_BUSY
+			|| info->virtio->queue_is_empty(queue->virtio_queue)) {
+			return status;
+		}
+		locker.Unlock();
+
+		entry.Wait();
+	}
+}
 
-	uint8* ack = (uint8*)buffer + sizeof(struct virtio_blk_outhdr);
-	*ack = 0xff;
 
-	get_memory_map(buffer, sizeof(struct virtio_blk_outhdr) + sizeof(uint8),
-		&entries[0], 1);
-	entries[operation->VecCount() + 1].address = entries[0].address
-		+ sizeof(struct virtio_blk_outhdr);
-	entries[operation->VecCount() + 1].size = sizeof(uint8);
+static void
+do_io(void* cookie, IOOperation* operation, uint32 queueIndex)
+{
+	virtio_block_driver_info* info = (virtio_block_driver_info*)cookie;
+	virtio_block_queue* queue = &info->queues[queueIndex];
+
+	virtio_block_request* request = get_request(queue);
+	request->operation = operation;
+
+	virtio_block_request_header* header = request->header;
+	header->header.type = operation->IsWrite()
+		? VIRTIO_BLK_T_OUT : VIRTIO_BLK_T_IN;
+	header->header.sector = operation->Offset() / 512;
+	header->header.ioprio = 1;
+	header->status = 0xff;
+
+	uint32 vecCount = operation->VecCount();
+	physical_entry entries[vecCount + 2];
+	entries[0].address = request->physical_address
+		+ offsetof(virtio_block_request_header, header);
 	entries[0].size = sizeof(struct virtio_blk_outhdr);
+	memcpy(entries + 1, operation->Vecs(), vecCount * sizeof(physical_entry));
+	entries[vecCount + 1].address = request->physical_address
+		+ offsetof(virtio_block_request_header, status);
+	entries[vecCount + 1].size = sizeof(uint8);
+
+	status_t status = queue_request(queue, request, entries,
+		1 + (operation->IsWrite() ? vecCount : 0),
+		1 + (operation->IsWrite() ? 0 : vecCount));
+	if (status != B_OK) {
+		ERROR("could not queue request: %s\n", strerror(status));
+		put_request(queue, request);
+		info->io_scheduler->OperationCompleted(operation, status, 0);
+	}
+}
 
-	memcpy(entries + 1, operation->Vecs(), operation->VecCount()
-		* sizeof(physical_entry));
 
-	info->virtio->queue_request_v(info->virtio_queue, entries,
-		1 + (operation->IsWrite() ? operation->VecCount() : 0 ),
-		1 + (operation->IsWrite() ? 0 : operation->VecCount()),
-		info);
+static status_t
+virtio_block_queue_operation(void* cookie, io_operation* operation,
+	uint32 queueIndex)
+{
+	do_io(cookie, operation, queueIndex);
+	return B_OK;
+}
 
-	acquire_sem(info->sem_cb);
 
-	switch (*ack) {
-		case VIRTIO_BLK_S_OK:
-			status = B_OK;
-			bytesTransferred = operation->Length();
-			break;
-		case VIRTIO_BLK_S_UNSUPP:
-			status = ENOTSUP;
-			break;
-		default:
-			status = EIO;
+/*!	Issues a discard or write zeroes command, and waits for its completion. */
+static status_t
+do_command(virtio_block_driver_info* info, uint32 type, uint64 sector,
+	uint32 sectorCount, uint32 flags)
+{
+	virtio_block_queue* queue
+		= &info->queues[smp_get_current_cpu() % info->queue_count];
+
+	virtio_block_request* request = get_request(queue);
+	request->operation = NULL;
+	request->status = EINPROGRESS;
+
+	virtio_block_request_header* header = request->header;
+	header->header.type = type;
+	header->header.sector = 0;
+	header->header.ioprio = 1;
+	header->segment.sector = sector;
+	header->segment.num_sectors = sectorCount;
+	header->segment.flags = flags;
+	header->status = 0xff;
+
+	physical_entry entries[3];
+	entries[0].address = request->physical_address
+		+ offsetof(virtio_block_request_header, header);
+	entries[0].size = sizeof(struct virtio_blk_outhdr);
+	entries[1].address = request->physical_address
+		+ offsetof(virtio_block_request_header, segment);
+	entries[1].size = sizeof(struct virtio_blk_discard_write_zeroes);
+	entries[2].address = request->physical_address
+		+ offsetof(virtio_block_request_header, status);
+	entries[2].size = sizeof(uint8);
+
+	status_t status = queue_request(queue, request, entries, 2, 1);
+	while (status == B_OK) {
+		ConditionVariableEntry entry;
+		queue->event.Add(&entry);
+
+		InterruptsSpinLocker locker(queue->lock);
+		if (request->status != EINPROGRESS) {
+			status = request->status;
 			break;
+		}
+		locker.Unlock();
+
+		entry.Wait();
+	}
+
+	put_request(queue, request);
+	return status;
+}
+
+
+static status_t
+virtio_block_trim(virtio_block_driver_info* info, fs_trim_data* trimData)
+{
+	if ((info->features & VIRTIO_BLK_F_RO) != 0)
+		return B_READ_ONLY_DEVICE;
+
+	// Prefer discarding the blocks; writing zeroes is fine too, as long as
+	// the device may deallocate them instead.
+	uint32 type;
+	uint32 maxSectors;
+	uint32 flags = 0;
+	if ((info->features & VIRTIO_BLK_F_DISCARD) != 0) {
+		type = VIRTIO_BLK_T_DISCARD;
+		maxSectors = info->config.max_discard_sectors;
+	} else if ((info->features & VIRTIO_BLK_F_WRITE_ZEROES) != 0
+		&& info->config.write_zeroes_may_unmap != 0) {
+		type = VIRTIO_BLK_T_WRITE_ZEROES;
+		maxSectors = info->config.max_write_zeroes_sectors;
+		flags = VIRTIO_BLK_WRITE_ZEROES_FLAG_UNMAP;
+	} else
+		return B_UNSUPPORTED;
+
+	// Commands must cover whole blocks
+	const uint32 sectorsPerBlock = info->block_size / 512;
+	maxSectors -= maxSectors % sectorsPerBlock;
+	if (maxSectors == 0)
+		return B_UNSUPPORTED;
+
+	const uint64 deviceSize = info->capacity * info->block_size;
+	uint64 trimmedSize = 0;
+	status_t status = B_OK;
+	for (uint32 i = 0; i < trimData->range_count && status == B_OK; i++) {
+		uint64 offset = ROUNDUP(trimData->ranges[i].offset, info->block_size);
+		uint64 end = trimData->ranges[i].offset + trimData->ranges[i].size;
+		if (end > deviceSize || end < trimData->ranges[i].offset)
+			end = deviceSize;
+		end = ROUNDDOWN(end, info->block_size);
+
+		while (offset < end) {
+			uint32 sectorCount = min_c((end - offset) / 512,
+				(uint64)maxSectors);
+
+			status = do_command(info, type, offset / 512, sectorCount, flags);
+			if (status != B_OK)
+				break;
+
+			offset += (uint64)sectorCount * 512;
+			trimmedSize += (uint64)sectorCount * 512;
+		}
 	}
-	free(buffer);
 
-	info->io_scheduler->OperationCompleted(operation, status,
-		bytesTransferred);
+	trimData->trimmed_size = trimmedSize;
 	return status;
 }
 
 
+static status_t
+init_queue(virtio_block_driver_info* info, virtio_block_queue* queue,
+	::virtio_queue virtioQueue)
+{
+	queue->info = info;
+	queue->virtio_queue = virtioQueue;
+	B_INITIALIZE_SPINLOCK(&queue->lock);
+	queue->event.Init(queue, "virtio block queue");
+
+	// With indirect descriptors, every request needs just one descriptor
+	// of the ring, otherwise at least three.
+	uint32 requestCount = info->virtio->queue_size(virtioQueue);
+	if ((info->features & VIRTIO_FEATURE_RING_INDIRECT_DESC) == 0)
+		requestCount = max_c(requestCount / 3, 1);
+
+	queue->requests = new(std::nothrow) virtio_block_request[requestCount];
+	if (queue->requests == NULL)
+		return B_NO_MEMORY;
+
+	size_t size = ROUNDUP(requestCount * sizeof(virtio_block_request_header),
+		B_PAGE_SIZE);
+	virtio_block_request_header* headers;
+	queue->headers_area = create_area("virtio block requests",
+		(void**)&headers, B_ANY_KERNEL_ADDRESS, size, B_CONTIGUOUS,
+		B_KERNEL_READ_AREA | B_KERNEL_WRITE_AREA);
+	if (queue->headers_area < 0)
+		return queue->headers_area;
+
+	physical_entry entry;
+	status_t status = get_memory_map(headers, B_PAGE_SIZE, &entry, 1);
+	if (status != B_OK)
+		return status;
+
+	queue->free_requests = NULL;
+	for (uint32 i = 0; i < requestCount; i++) {
+		virtio_block_request* request = &queue->requests[i];
+		request->header = &headers[i];
+		request->physical_address = entry.address
+			+ i * sizeof(virtio_block_request_header);
+		request->operation = NULL;
+		request->next = queue->free_requests;
+		queue->free_requests = request;
+	}
+
+	return B_OK;
+}
+
+
 //	#pragma mark - device module API
 
 
@@ -270,15 +576,50 @@ virtio_block_init_device(void* _info, void** _cookie)
 		VIRTIO_BLK_F_BARRIER | VIRTIO_BLK_F_SIZE_MAX
 			| VIRTIO_BLK_F_SEG_MAX | VIRTIO_BLK_F_GEOMETRY
 			| VIRTIO_BLK_F_RO | VIRTIO_BLK_F_BLK_SIZE
-			| VIRTIO_BLK_F_FLUSH | VIRTIO_FEATURE_RING_INDIRECT_DESC,
+			| VIRTIO_BLK_F_FLUSH | VIRTIO_BLK_F_MQ | VIRTIO_BLK_F_DISCARD
+			| VIRTIO_BLK_F_WRITE_ZEROES | VIRTIO_FEATURE_RING_INDIRECT_DESC,
 		&info->features, &get_feature_name);
 
 	status_t status = info->virtio->read_device_config(
-		info->virtio_device, 0, &info->config,
-		sizeof(struct virtio_blk_config));
+		info->virtio_device, 0, &info->config, get_config_size(info));
 	if (status != B_OK)
 		return status;
 
+	// use a queue per CPU, if possible
+	uint32 queueCount = 1;
+	if ((info->features & VIRTIO_BLK_F_MQ) != 0)
+		queueCount = max_c(info->config.num_queues, 1);
+	queueCount = min_c(queueCount, (uint32)smp_get_num_cpus());
+	queueCount = min_c(queueCount, VIRTIO_VIRTQUEUES_MAX_COUNT);
+
+	::virtio_queue virtioQueues[VIRTIO_VIRTQUEUES_MAX_COUNT];
+	status = info->virtio->alloc_queues(info->virtio_device, queueCount,
+		virtioQueues);
+	if (status != B_OK) {
+		ERROR("queue allocation failed (%s)\n", strerror(status));
+		return status;
+	}
+
+	info->queues = new(std::nothrow) virtio_block_queue[queueCount];
+	if (info->queues == NULL)
+		return B_NO_MEMORY;
+
+	for (uint32 i = 0; i < queueCount; i++) {
+		info->queues[i].requests = NULL;
+		info->queues[i].headers_area = -1;
+	}
+	info->queue_count = queueCount;
+
+	for (uint32 i = 0; i < queueCount; i++) {
+		status = init_queue(info, &info->queues[i], virtioQueues[i]);
+		if (status != B_OK) {
+			ERROR("queue initialization failed (%s)\n", strerror(status));
+			return status;
+		}
+	}
+
+	TRACE("virtio_block: using %" B_PRIu32 " queues\n", queueCount);
+
 	// and get (initial) capacity
 	uint32 block_size = 512;
 	if ((info->features & VIRTIO_BLK_F_BLK_SIZE) != 0)
@@ -290,18 +631,13 @@ virtio_block_init_device(void* _info, void** _cookie)
 	TRACE("virtio_block: capacity: %" B_PRIu64 ", block_size %" B_PRIu32 "\n",
 		info->capacity, info->block_size);
 
-	status = info->virtio->alloc_queues(info->virtio_device, 1,
-		&info->virtio_queue);
-	if (status != B_OK) {
-		ERROR("queue allocation failed (%s)\n", strerror(status));
-		return status;
-	}
 	status = info->virtio->setup_interrupt(info->virtio_device,
 		virtio_block_config_callback, info);
 
-	if (status == B_OK) {
-		status = info->virtio->queue_setup_interrupt(info->virtio_queue,
-			virtio_block_callback, info);
+	for (uint32 i = 0; status == B_OK && i < queueCount; i++) {
+		status = info->virtio->queue_setup_interrupt(
+			info->queues[i].virtio_queue, virtio_block_callback,
+			&info->queues[i]);
 	}
 
 	*_cookie = info;
@@ -315,8 +651,17 @@ virtio_block_uninit_device(void* _cookie)
 	CALLED();
 	virtio_block_driver_info* info = (virtio_block_driver_info*)_cookie;
 
+	info->virtio->free_interrupts(info->virtio_device);
+	info->virtio->free_queues(info->virtio_device);
+
 	delete info->io_scheduler;
 	delete info->dma_resource;
+
+	for (uint32 i = 0; i < info->queue_count; i++) {
+		delete[] info->queues[i].requests;
+		delete_area(info->queues[i].headers_area);
+	}
+	delete[] info->queues;
 }
 
 
@@ -485,6 +830,22 @@ virtio_block_ioctl(void* cookie, uint32 op, void* buffer, size_t length)
 
 		/*case B_FLUSH_DRIVE_CACHE:
 			return synchronize_cache(info);*/
+
+		case B_TRIM_DEVICE:
+		{
+			fs_trim_data* trimData;
+			MemoryDeleter deleter;
+			status_t status = get_trim_data_from_user(buffer, length, deleter,
+				trimData);
+			if (status != B_OK)
+				return status;
+
+			status = virtio_block_trim(info, trimData);
+			if (status != B_OK)
+				return status;
+
+			return copy_trim_data_to_user(buffer, trimData);
+		}
 	}
 
 	return B_DEV_INVALID_IOCTL;
@@ -520,14 +881,27 @@ virtio_block_set_capacity(virtio_block_driver_info* info, uint64 capacity,
 		if ((info->features & VIRTIO_BLK_F_SEG_MAX) != 0)
 			restrictions.max_segment_count = info->config.seg_max;
 
+		// The header and the status need a descriptor each, too
+		uint32 maxSegmentCount = 0;
+		if ((info->features & VIRTIO_FEATURE_RING_INDIRECT_DESC) != 0)
+			maxSegmentCount = VIRTIO_INDIRECT_DESCRIPTORS_MAX_COUNT - 2;
+		else if (info->queue_count > 0) {
+			maxSegmentCount = info->virtio->queue_size(
+				info->queues[0].virtio_queue) - 2;
+		}
+		if (maxSegmentCount > 0 && (restrictions.max_segment_count == 0
+				|| restrictions.max_segment_count > maxSegmentCount)) {
+			restrictions.max_segment_count = maxSegmentCount;
+		}
+
 		// TODO: we need to replace the DMAResource in our IOScheduler
 		status_t status = info->dma_resource->Init(restrictions, blockSize,
 			1024, 32);
 		if (status != B_OK)
 			panic("initializing DMAResource failed: %s", strerror(status));
 
-		info->io_scheduler = new(std::nothrow) IOSchedulerSimple(
-			info->dma_resource);
+		info->io_scheduler = new(std::nothrow) IOSchedulerMultiQueue(
+			info->dma_resource, info->queue_count);
 		if (info->io_scheduler == NULL)
 			panic("allocating IOScheduler failed.");
 
@@ -536,7 +910,8 @@ virtio_block_set_capacity(virtio_block_driver_info* info, uint64 capacity,
 		if (status != B_OK)
 			panic("initializing IOScheduler failed: %s", strerror(status));
 
-		info->io_scheduler->SetCallback(do_io, info);
+		info->io_scheduler->SetQueueCallback(virtio_block_queue_operation,
+			info);
 	}
 
 	info->block_size = blockSize;
@@ -605,13 +980,6 @@ virtio_block_init_driver(device_node *node, void **cookie)
 		return B_NO_MEMORY;
 	}
 
-	info->sem_cb = create_sem(0, "virtio_block_cb");
-	if (info->sem_cb < 0) {
-		delete info->dma_resource;
-		status_t status = info->sem_cb;
-		free(info);
-		return status;
-	}
 	info->node = node;
 
 	*cookie = info;
@@ -624,7 +992,6 @@ virtio_block_uninit_driver(void *_cookie)
 {
 	CALLED();
 	virtio_block_driver_info* info = (virtio_block_driver_info*)_cookie;
-	delete_sem(info->sem_cb);
 	free(info);
 }
 
@@ -404,15 +404,8 @@ CachedNode::SetToWritableHeader(Transaction& transaction)
 
 	InternalSetTo(&transaction, 0LL);
 
-	if (fNode != NULL && !fTree->fInTransaction) {
-		transaction.AddListener(fTree);
-		fTree->fInTransaction = true;
-
-		if (!transaction.GetVolume()->IsInitializing()) {
-			acquire_vnode(transaction.GetVolume()->FSVolume(),
-				fTree->fStream->ID());
-		}
-	}
+	if (fNode != NULL)
+		fTree->_ListenToTransaction(transaction);
 
 	return (bplustree_header*)fNode;
 }
@@ -645,6 +638,7 @@ BPlusTree::SetTo(Transaction& transaction, Inode* stream, int32 nodeSize)
 	// initializes in-memory B+Tree
 
 	fStream = stream;
+	fNameCache.Unset();
 
 	CachedNode cached(this);
 	bplustree_header* header = cached.SetToWritableHeader(transaction);
@@ -838,6 +832,8 @@ BPlusTree::Validate(bool repair, bool& _errorsFound)
 status_t
 BPlusTree::MakeEmpty()
 {
+	fNameCache.Unset();
+
 	// Put all nodes into the free list in order
 	Transaction transaction(fStream->GetVolume(), fStream->BlockNumber());
 
@@ -957,10 +953,30 @@ BPlusTree::TransactionDone(bool success)
 		const bplustree_header* header = cached.SetToHeader();
 		if (header != NULL)
 			memcpy(&fHeader, header, sizeof(bplustree_header));
+
+		// the cache may contain changes that have just been reverted
+		fNameCache.Unset();
 	}
 }
 
 
+/*!	Makes sure the tree learns about the end of \a transaction, so that
+	its header and name cache are reverted, if it fails.
+*/
+void
+BPlusTree::_ListenToTransaction(Transaction& transaction)
+{
+	if (fInTransaction)
+		return;
+
+	transaction.AddListener(this);
+	fInTransaction = true;
+
+	if (!transaction.GetVolume()->IsInitializing())
+		acquire_vnode(transaction.GetVolume()->FSVolume(), fStream->ID());
+}
+
+
 void
 BPlusTree::RemovedFromTransaction()
 {
@@ -1677,6 +1693,21 @@ BPlusTree::_SplitNode(bplustree_node* node, off_t nodeOffset,
 status_t
 BPlusTree::Insert(Transaction& transaction, const uint8* key, uint16 keyLength,
 	off_t value)
+{
+	status_t status = _Insert(transaction, key, keyLength, value);
+	if (status == B_OK && _UsesNameCache()) {
+		// a leaf change alone doesn't register us with the transaction
+		_ListenToTransaction(transaction);
+		fNameCache.Insert(key, keyLength, value);
+	}
+
+	return status;
+}
+
+
+status_t
+BPlusTree::_Insert(Transaction& transaction, const uint8* key,
+	uint16 keyLength, off_t value)
 {
 	if (keyLength < BPLUSTREE_MIN_KEY_LENGTH
 		|| keyLength > BPLUSTREE_MAX_KEY_LENGTH)
@@ -2097,6 +2128,20 @@ BPlusTree::_RemoveKey(bplustree_node* node, uint16 index)
 status_t
 BPlusTree::Remove(Transaction& transaction, const uint8* key, uint16 keyLength,
 	off_t value)
+{
+	status_t status = _Remove(transaction, key, keyLength, value);
+	if (status == B_OK && _UsesNameCache()) {
+		_ListenToTransaction(transaction);
+		fNameCache.Remove(key, keyLength);
+	}
+
+	return status;
+}
+
+
+status_t
+BPlusTree::_Remove(Transaction& transaction, const uint8* key,
+	uint16 keyLength, off_t value)
 {
 	if (keyLength < BPLUSTREE_MIN_KEY_LENGTH
 		|| keyLength > BPLUSTREE_MAX_KEY_LENGTH)
@@ -2247,6 +2292,10 @@ BPlusTree::Replace(Transaction& transaction, const uint8* key, uint16 keyLength,
 				if (writableNode != NULL) {
 					writableNode->Values()[keyIndex]
 						= HOST_ENDIAN_TO_BFS_INT64(value);
+					if (_UsesNameCache()) {
+						_ListenToTransaction(transaction);
+						fNameCache.Insert(key, keyLength, value);
+					}
 				} else
 					status = B_IO_ERROR;
 			}
@@ -2287,6 +2336,12 @@ BPlusTree::Find(const uint8* key, uint16 keyLength, off_t* _value)
 
 #if !_BOOT_MODE
 	ASSERT_READ_LOCKED_INODE(fStream);
+
+	if (_UsesNameCache()) {
+		status_t status = fNameCache.Lookup(this, key, keyLength, _value);
+		if (status != B_NO_INIT)
+			return status;
+	}
 #endif
 
 	off_t nodeOffset = fHeader.RootNode();
@@ -12,6 +12,7 @@
 
 #if !_BOOT_MODE
 #include "Journal.h"
+#include "NameCache.h"
 class Inode;
 #else
 #define Inode BFS::Stream
@@ -311,6 +312,11 @@ private:
 
 			int32				_CompareKeys(const void* key1, int keylength1,
 									const void* key2, int keylength2);
+#if !_BOOT_MODE
+			bool				_UsesNameCache() const;
+			void				_ListenToTransaction(
+									Transaction& transaction);
+#endif
 			status_t			_FindKey(const bplustree_node* node,
 									const uint8* key, uint16 keyLength,
 									uint16* index = NULL, off_t* next = NULL);
@@ -318,6 +324,13 @@ private:
 			status_t			_SeekDown(Stack<node_and_key>& stack,
 									const uint8* key, uint16 keyLength);
 
+			status_t			_Insert(Transaction& transaction,
+									const uint8* key, uint16 keyLength,
+									off_t value);
+			status_t			_Remove(Transaction& transaction,
+									const uint8* key, uint16 keyLength,
+									off_t value);
+
 			status_t			_FindFreeDuplicateFragment(
 									Transaction& transaction,
 									const bplustree_node* node,
@@ -373,6 +386,8 @@ private:
 #if !_BOOT_MODE
 			mutex				fIteratorLock;
 			SinglyLinkedList<TreeIterator> fIterators;
+
+			NameCache			fNameCache;
 #endif
 };
 
@@ -502,6 +517,16 @@ BPlusTree::Insert(Transaction& transaction, double key, off_t value)
 		return B_BAD_TYPE;
 	return Insert(transaction, (uint8*)&key, sizeof(key), value);
 }
+
+
+/*!	Only trees that map unique names to values can be cached; for all
+	other key types, different keys may compare equal.
+*/
+inline bool
+BPlusTree::_UsesNameCache() const
+{
+	return !fAllowDuplicates && fHeader.DataType() == BPLUSTREE_STRING_TYPE;
+}
 #endif // !_BOOT_MODE
 
 
@@ -505,7 +505,8 @@ AllocationGroup::Free(Transaction& transaction, uint16 start, int32 length)
 BlockAllocator::BlockAllocator(Volume* volume)
 	:
 	fVolume(volume),
-	fGroups(NULL)
+	fGroups(NULL),
+	fReservedBlocks(0)
 	//fCheckBitmap(NULL),
 	//fCheckCookie(NULL)
 {
@@ -962,7 +963,7 @@ BlockAllocator::Allocate(Transaction& transaction, Inode* inode,
 
 	// Are there already allocated blocks? (then just try to allocate near the
 	// last one)
-	if (inode->Size() > 0) {
+	if (inode->Node().data.Size() > 0) {
 		const data_stream& data = inode->Node().data;
 		// TODO: we currently don't care for when the data stream
 		// is already grown into the indirect ranges
@@ -1048,6 +1049,34 @@ BlockAllocator::Free(Transaction& transaction, block_run run)
 }
 
 
+/*!	Sets aside \a numBlocks blocks for data that has been written to the file
+	cache, but has not been placed on disk yet (see Inode::WriteAt()). The
+	blocks are not taken from any allocation group, they only no longer count
+	as free space, so that the later allocation is guaranteed to succeed.
+*/
+status_t
+BlockAllocator::Reserve(off_t numBlocks)
+{
+	RecursiveLocker lock(fLock);
+
+	if (numBlocks > fVolume->FreeBlocks())
+		return B_DEVICE_FULL;
+
+	fReservedBlocks += numBlocks;
+	return B_OK;
+}
+
+
+void
+BlockAllocator::Unreserve(off_t numBlocks)
+{
+	RecursiveLocker lock(fLock);
+
+	ASSERT(numBlocks <= fReservedBlocks);
+	fReservedBlocks -= numBlocks;
+}
+
+
 #ifdef DEBUG_FRAGMENTER
 void
 BlockAllocator::Fragment()
@@ -39,6 +39,11 @@ public:
 								uint16 minimum = 1);
 			status_t		Free(Transaction& transaction, block_run run);
 
+			status_t		Reserve(off_t numBlocks);
+			void			Unreserve(off_t numBlocks);
+			off_t			ReservedBlocks() const
+								{ return fReservedBlocks; }
+
 			status_t		AllocateBlocks(Transaction& transaction,
 								int32 group, uint16 start, uint16 numBlocks,
 								uint16 minimum, block_run& run);
@@ -82,6 +87,7 @@ private:
 			int32			fNumGroups;
 			uint32			fBlocksPerGroup;
 			uint32			fNumBlocks;
+			off_t			fReservedBlocks;
 };
 
 #ifdef BFS_DEBUGGER_COMMANDS
@@ -13,6 +13,7 @@
 #include "BlockAllocator.h"
 #include "BPlusTree.h"
 #include "Inode.h"
+#include "TrigramIndex.h"
 #include "Volume.h"
 
 
@@ -728,8 +729,34 @@ CheckVisitor::_AddInodeToIndex(Inode* inode)
 			return B_ERROR;
 
 		status_t status = B_OK;
+		size_t attributeLength;
+
+		if ((index->inode->Mode() & S_TRIGRAM_INDEX) != 0
+			&& TrigramIndex::IsTrigramIndexName(index->name,
+				&attributeLength)) {
+			// trigram indices store the trigrams of the attribute's value
+			char attribute[B_FILE_NAME_LENGTH];
+			strlcpy(attribute, index->name, min_c(attributeLength + 1,
+				sizeof(attribute)));
+
+			uint8 key[B_FILE_NAME_LENGTH];
+			size_t keyLength = 0;
+			if (!strcmp(attribute, "name")) {
+				if (inode->InNameIndex()
+					&& inode->GetName((char*)key, sizeof(key)) == B_OK)
+					keyLength = strlen((char*)key);
+			} else {
+				keyLength = MAX_INDEX_KEY_LENGTH;
+				if (inode->ReadAttribute(attribute, B_ANY_TYPE, 0, key,
+						&keyLength) != B_OK)
+					keyLength = 0;
+			}
 
-		if (!strcmp(index->name, "name")) {
+			if (keyLength > 0) {
+				status = TrigramIndex::UpdateTree(transaction, tree, NULL, 0,
+					key, keyLength, inode->ID());
+			}
+		} else if (!strcmp(index->name, "name")) {
 			if (inode->InNameIndex()) {
 				char name[B_FILE_NAME_LENGTH];
 				if (inode->GetName(name, B_FILE_NAME_LENGTH) != B_OK)
@@ -12,6 +12,8 @@
 #include <file_systems/QueryParserUtils.h>
 
 #include "Debug.h"
+#include "IndexUpdateQueue.h"
+#include "TrigramIndex.h"
 #include "Volume.h"
 #include "Inode.h"
 #include "BPlusTree.h"
@@ -197,6 +199,25 @@ Index::Create(Transaction& transaction, const char* name, uint32 type)
 			return B_BAD_TYPE;
 	}
 
+	size_t attributeLength;
+	if (TrigramIndex::IsTrigramIndexName(name, &attributeLength)) {
+		// A trigram index can only be kept up to date alongside the regular
+		// index of its attribute
+		if (mode != S_STR_INDEX)
+			return B_BAD_TYPE;
+
+		char attribute[B_FILE_NAME_LENGTH];
+		strlcpy(attribute, name, min_c(attributeLength + 1,
+			sizeof(attribute)));
+
+		Index index(fVolume);
+		if (index.SetTo(attribute) != B_OK
+			|| index.Type() != B_STRING_TYPE)
+			return B_ENTRY_NOT_FOUND;
+
+		mode |= S_TRIGRAM_INDEX;
+	}
+
 	// do we need to create the index directory first?
 	if (fVolume->IndicesNode() == NULL) {
 		status_t status = fVolume->CreateIndicesRoot(transaction);
@@ -247,7 +268,51 @@ Index::Update(Transaction& transaction, const char* name, int32 type,
 		newKey, newLength);
 
 	if (((name != fName || strcmp(name, fName)) && SetTo(name) != B_OK)
-		|| fNode == NULL)
+		|| fNode == NULL || (fNode->Mode() & S_TRIGRAM_INDEX) != 0)
+		return B_BAD_INDEX;
+
+	if (type == B_STRING_TYPE && fVolume->HasTrigramIndices()) {
+		TrigramIndex trigrams(fVolume);
+		if (trigrams.SetTo(name) == B_OK) {
+			status_t status = trigrams.Update(transaction, oldKey, oldLength,
+				newKey, newLength, inode->ID());
+			if (status != B_OK)
+				RETURN_ERROR(status);
+		}
+	}
+
+	IndexUpdateQueue* queue = fVolume->IndexUpdates();
+	if (queue != NULL && IndexUpdateQueue::CanDelay(name, type)) {
+		int64 oldValue, newValue;
+		if (oldKey != NULL)
+			memcpy(&oldValue, oldKey, sizeof(int64));
+
+		if (oldKey != NULL && newKey != NULL) {
+			// the tree will be updated when the queue is flushed
+			memcpy(&newValue, newKey, sizeof(int64));
+			return queue->Add(transaction, name, inode->ID(), oldValue,
+				newValue);
+		}
+
+		// the key in the tree might still be an older one
+		if (oldKey != NULL
+			&& queue->Remove(transaction, name, inode->ID(), oldValue))
+			oldKey = (const uint8*)&oldValue;
+	}
+
+	RETURN_ERROR(UpdateTree(transaction, oldKey, oldLength, newKey, newLength,
+		inode->ID()));
+}
+
+
+/*!	Removes \a oldKey from, and inserts \a newKey into the tree of the index
+	this object has been set to, without any further checks.
+*/
+status_t
+Index::UpdateTree(Transaction& transaction, const uint8* oldKey,
+	uint16 oldLength, const uint8* newKey, uint16 newLength, ino_t id)
+{
+	if (fNode == NULL)
 		return B_BAD_INDEX;
 
 	BPlusTree* tree = Node()->Tree();
@@ -262,10 +327,10 @@ Index::Update(Transaction& transaction, const char* name, int32 type,
 
 	if (oldKey != NULL) {
 		status = tree->Remove(transaction, (const uint8*)oldKey, oldLength,
-			inode->ID());
+			id);
 		if (status == B_ENTRY_NOT_FOUND) {
 			// That's not nice, but no reason to let the whole thing fail
-			INFORM(("Could not find value in index \"%s\"!\n", name));
+			INFORM(("Could not find value in index \"%s\"!\n", fName));
 		} else if (status != B_OK)
 			return status;
 	}
@@ -274,7 +339,7 @@ Index::Update(Transaction& transaction, const char* name, int32 type,
 
 	if (newKey != NULL) {
 		status = tree->Insert(transaction, (const uint8*)newKey, newLength,
-			inode->ID());
+			id);
 	}
 
 	RETURN_ERROR(status);
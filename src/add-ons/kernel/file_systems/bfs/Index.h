@@ -33,6 +33,10 @@ public:
 								int32 type, const uint8* oldKey,
 								uint16 oldLength, const uint8* newKey,
 								uint16 newLength, Inode* inode);
+			status_t		UpdateTree(Transaction& transaction,
+								const uint8* oldKey, uint16 oldLength,
+								const uint8* newKey, uint16 newLength,
+								ino_t id);
 
 			status_t		InsertName(Transaction& transaction,
 								const char* name, Inode* inode);
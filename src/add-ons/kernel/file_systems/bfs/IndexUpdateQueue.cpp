@@ -0,0 +1,248 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * This file may be used under the terms of the MIT License.
+ */
+
+
+//! Delayed updates of the size and last_modified indices
+
+
+#include "IndexUpdateQueue.h"
+
+#include "Debug.h"
+#include "Index.h"
+#include "Volume.h"
+
+
+static const char* kIndexNames[] = {"size", "last_modified"};
+static const int32 kIndexCount = sizeof(kIndexNames) / sizeof(kIndexNames[0]);
+
+
+IndexUpdateQueue::IndexUpdateQueue(Volume* volume)
+	:
+	fVolume(volume),
+	fCount(0),
+	fSavedCount(0),
+	fInTransaction(false)
+{
+}
+
+
+IndexUpdateQueue::~IndexUpdateQueue()
+{
+	if (fCount != 0) {
+		FATAL(("%" B_PRId32 " index updates were never applied!\n",
+			fCount));
+	}
+}
+
+
+/*!	Returns whether or not changes to the index \a name of \a type can be
+	delayed.
+*/
+/*static*/ bool
+IndexUpdateQueue::CanDelay(const char* name, int32 type)
+{
+	return type == B_INT64_TYPE && _IndexFor(name) >= 0;
+}
+
+
+/*!	Remembers that the key of inode \a id in the index \a name changed from
+	\a oldKey to \a newKey. If the inode already has an update pending, the
+	two are merged. The tree is updated when \a transaction is done, or
+	right away, if the queue is full.
+*/
+status_t
+IndexUpdateQueue::Add(Transaction& transaction, const char* name, ino_t id,
+	int64 oldKey, int64 newKey)
+{
+	int32 index = _IndexFor(name);
+	if (index < 0)
+		return B_BAD_VALUE;
+
+	_AddListener(transaction);
+
+	int32 slot = _Find(index, id);
+	if (slot >= 0) {
+		index_update& update = fUpdates[slot];
+		update.new_key = newKey;
+
+		// if it's back where it started, there is nothing left to do
+		if (update.new_key == update.old_key)
+			fUpdates[slot] = fUpdates[--fCount];
+		return B_OK;
+	}
+
+	if (fCount == kMaxUpdates) {
+		status_t status = Flush(transaction);
+		if (status != B_OK)
+			return status;
+	}
+
+	index_update& update = fUpdates[fCount++];
+	update.id = id;
+	update.old_key = oldKey;
+	update.new_key = newKey;
+	update.index = index;
+
+	return B_OK;
+}
+
+
+/*!	Drops the pending update of inode \a id in the index \a name, if any.
+	If there was one, \c true is returned, and \a _treeKey is set to the key
+	that is actually in the index tree.
+*/
+bool
+IndexUpdateQueue::Remove(Transaction& transaction, const char* name,
+	ino_t id, int64& _treeKey)
+{
+	int32 slot = _Find(_IndexFor(name), id);
+	if (slot < 0)
+		return false;
+
+	_AddListener(transaction);
+
+	_treeKey = fUpdates[slot].old_key;
+	fUpdates[slot] = fUpdates[--fCount];
+	return true;
+}
+
+
+/*!	Applies all pending updates as part of \a transaction. All keys are
+	removed first, and then inserted again, both in key order, so that
+	neighbouring updates hit the same B+tree nodes.
+	This is called by the Journal before it commits a transaction; if it
+	fails, the transaction is aborted, which also restores the queue.
+*/
+status_t
+IndexUpdateQueue::Flush(Transaction& transaction)
+{
+	if (fCount == 0)
+		return B_OK;
+
+	_AddListener(transaction);
+
+	_Sort(false);
+	status_t status = _Apply(transaction, false);
+	if (status == B_OK) {
+		_Sort(true);
+		status = _Apply(transaction, true);
+	}
+
+	if (status != B_OK)
+		RETURN_ERROR(status);
+
+	fCount = 0;
+	return B_OK;
+}
+
+
+void
+IndexUpdateQueue::TransactionDone(bool success)
+{
+	if (!success) {
+		memcpy(fUpdates, fSavedUpdates, fSavedCount * sizeof(index_update));
+		fCount = fSavedCount;
+	}
+}
+
+
+void
+IndexUpdateQueue::RemovedFromTransaction()
+{
+	fInTransaction = false;
+}
+
+
+/*static*/ int32
+IndexUpdateQueue::_IndexFor(const char* name)
+{
+	for (int32 i = 0; i < kIndexCount; i++) {
+		if (strcmp(name, kIndexNames[i]) == 0)
+			return i;
+	}
+	return -1;
+}
+
+
+int32
+IndexUpdateQueue::_Find(int32 index, ino_t id) const
+{
+	for (int32 i = 0; i < fCount; i++) {
+		if (fUpdates[i].id == id && fUpdates[i].index == index)
+			return i;
+	}
+	return -1;
+}
+
+
+/*!	Sorts the updates by index, and by their old or new key. There are
+	never more than a few hundred of them, so a simple insertion sort does.
+*/
+void
+IndexUpdateQueue::_Sort(bool byNewKey)
+{
+	for (int32 i = 1; i < fCount; i++) {
+		index_update update = fUpdates[i];
+		int64 key = byNewKey ? update.new_key : update.old_key;
+
+		int32 j = i;
+		for (; j > 0; j--) {
+			const index_update& other = fUpdates[j - 1];
+			int64 otherKey = byNewKey ? other.new_key : other.old_key;
+			if (other.index < update.index
+				|| (other.index == update.index && otherKey <= key))
+				break;
+
+			fUpdates[j] = other;
+		}
+		fUpdates[j] = update;
+	}
+}
+
+
+status_t
+IndexUpdateQueue::_Apply(Transaction& transaction, bool insert)
+{
+	Index index(fVolume);
+	int32 current = -1;
+	bool exists = false;
+
+	for (int32 i = 0; i < fCount; i++) {
+		const index_update& update = fUpdates[i];
+		if (update.index != current) {
+			current = update.index;
+			exists = index.SetTo(kIndexNames[current]) == B_OK;
+		}
+		if (!exists) {
+			// the index has been removed in the mean time
+			continue;
+		}
+
+		int64 key = insert ? update.new_key : update.old_key;
+		status_t status = index.UpdateTree(transaction,
+			insert ? NULL : (uint8*)&key, insert ? 0 : sizeof(int64),
+			insert ? (uint8*)&key : NULL, insert ? sizeof(int64) : 0,
+			update.id);
+		if (status != B_OK && status != B_ENTRY_NOT_FOUND)
+			return status;
+	}
+
+	return B_OK;
+}
+
+
+/*!	Makes sure the queue can be restored if \a transaction is aborted. */
+void
+IndexUpdateQueue::_AddListener(Transaction& transaction)
+{
+	if (fInTransaction)
+		return;
+
+	memcpy(fSavedUpdates, fUpdates, fCount * sizeof(index_update));
+	fSavedCount = fCount;
+
+	transaction.AddListener(this);
+	fInTransaction = true;
+}
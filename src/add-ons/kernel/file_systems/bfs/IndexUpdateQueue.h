@@ -0,0 +1,79 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * This file may be used under the terms of the MIT License.
+ */
+#ifndef INDEX_UPDATE_QUEUE_H
+#define INDEX_UPDATE_QUEUE_H
+
+
+#include "system_dependencies.h"
+
+#include "Journal.h"
+
+
+class Volume;
+
+
+/*!	Collects the changes a transaction makes to the "size" and
+	"last_modified" indices, and applies them in bulk, sorted by key, right
+	before the transaction is committed, so that an inode that changes
+	several times within a transaction only causes a single tree update.
+
+	Only the tree updates are delayed; live queries are still notified when
+	the change happens. The updates are always part of the transaction that
+	caused them, so the queue is empty whenever no transaction is running.
+	It is protected by the journal lock, that is, it may only be used from
+	within a transaction.
+*/
+class IndexUpdateQueue : public TransactionListener {
+public:
+								IndexUpdateQueue(Volume* volume);
+	virtual						~IndexUpdateQueue();
+
+	static	bool				CanDelay(const char* name, int32 type);
+
+			status_t			Add(Transaction& transaction,
+									const char* name, ino_t id, int64 oldKey,
+									int64 newKey);
+			bool				Remove(Transaction& transaction,
+									const char* name, ino_t id,
+									int64& _treeKey);
+
+			status_t			Flush(Transaction& transaction);
+
+protected:
+	virtual void				TransactionDone(bool success);
+	virtual void				RemovedFromTransaction();
+
+private:
+			struct index_update {
+				ino_t			id;
+				int64			old_key;
+					// the key that is currently in the tree
+				int64			new_key;
+				int32			index;
+			};
+
+	static	int32				_IndexFor(const char* name);
+			int32				_Find(int32 index, ino_t id) const;
+			void				_Sort(bool byNewKey);
+			status_t			_Apply(Transaction& transaction,
+									bool insert);
+			void				_AddListener(Transaction& transaction);
+
+	static	const int32			kMaxUpdates = 256;
+
+private:
+			Volume*				fVolume;
+			index_update		fUpdates[kMaxUpdates];
+			int32				fCount;
+
+			// the state at the start of the current transaction, so that
+			// it can be restored if a sub transaction is aborted
+			index_update		fSavedUpdates[kMaxUpdates];
+			int32				fSavedCount;
+			bool				fInTransaction;
+};
+
+
+#endif	// INDEX_UPDATE_QUEUE_H
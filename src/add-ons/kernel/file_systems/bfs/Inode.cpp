@@ -134,6 +134,11 @@ private:
 #endif
 
 
+static const off_t kMaxDelayedAllocation = 64 * 1024 * 1024;
+	// the blocks of data written with delayed allocation are reserved, and
+	// placed all at once later on, so the amount per file is limited
+
+
 /*!	A helper class used by Inode::Create() to keep track of the belongings
 	of an inode creation in progress.
 	This class will make sure everything is cleaned up properly.
@@ -344,7 +349,9 @@ Inode::Inode(Volume* volume, ino_t id)
 	fTree(NULL),
 	fAttributes(NULL),
 	fCache(NULL),
-	fMap(NULL)
+	fMap(NULL),
+	fDelayedSize(0),
+	fReservedBlocks(0)
 {
 	PRINT(("Inode::Inode(volume = %p, id = %Ld) @ %p\n", volume, id, this));
 
@@ -377,7 +384,9 @@ Inode::Inode(Volume* volume, Transaction& transaction, ino_t id, mode_t mode,
 	fTree(NULL),
 	fAttributes(NULL),
 	fCache(NULL),
-	fMap(NULL)
+	fMap(NULL),
+	fDelayedSize(0),
+	fReservedBlocks(0)
 {
 	PRINT(("Inode::Inode(volume = %p, transaction = %p, id = %Ld) @ %p\n",
 		volume, &transaction, id, this));
@@ -417,6 +426,9 @@ Inode::~Inode()
 {
 	PRINT(("Inode::~Inode() @ %p\n", this));
 
+	if (fReservedBlocks != 0)
+		fVolume->Allocator().Unreserve(fReservedBlocks);
+
 	file_cache_delete(FileCache());
 	file_map_delete(Map());
 	delete fTree;
@@ -1581,18 +1593,24 @@ Inode::WriteAt(Transaction& transaction, off_t pos, const uint8* buffer,
 	if (pos < 0)
 		return B_BAD_VALUE;
 
+	// With delayed allocation, growing the file only reserves the blocks, and
+	// does not need a transaction.
+	bool delayAllocation = changeSize && _CanDelayAllocation(pos + length);
+	bool ownTransaction = !transaction.IsStarted();
+
 	locker.Unlock();
 
 	// the transaction doesn't have to be started already
-	if (changeSize && !transaction.IsStarted())
+	if (changeSize && !delayAllocation && !transaction.IsStarted())
 		transaction.Start(fVolume, BlockNumber());
 
 	WriteLocker writeLocker(fLock);
 
 	// Work around possible race condition: Someone might have shrunken the file
-	// while we had no lock.
+	// while we had no lock (or grown it too much to delay the allocation).
 	if (!transaction.IsStarted()
-		&& (uint64)pos + (uint64)length > (uint64)Size()) {
+		&& (uint64)pos + (uint64)length > (uint64)Size()
+		&& !_CanDelayAllocation(pos + length)) {
 		writeLocker.Unlock();
 		transaction.Start(fVolume, BlockNumber());
 		writeLocker.Lock();
@@ -1600,7 +1618,16 @@ Inode::WriteAt(Transaction& transaction, off_t pos, const uint8* buffer,
 
 	off_t oldSize = Size();
 
-	if ((uint64)pos + (uint64)length > (uint64)oldSize) {
+	if ((uint64)pos + (uint64)length > (uint64)oldSize
+		&& !transaction.IsStarted()) {
+		// the blocks will be placed when the file is closed, synced, or
+		// its data is written back
+		status_t status = _DelayAllocation(pos + length);
+		if (status != B_OK) {
+			*_length = 0;
+			RETURN_ERROR(status);
+		}
+	} else if ((uint64)pos + (uint64)length > (uint64)oldSize) {
 		// let's grow the data stream to the size needed
 		status_t status = SetFileSize(transaction, pos + length);
 		if (status != B_OK) {
@@ -1624,6 +1651,16 @@ Inode::WriteAt(Transaction& transaction, off_t pos, const uint8* buffer,
 
 	writeLocker.Unlock();
 
+	if (ownTransaction && transaction.IsStarted()
+		&& fVolume->HasDelayedAllocation()) {
+		// The blocks are placed, so the transaction is done. Don't keep the
+		// journal locked while the file cache might wait for the page writer.
+		WriteLockInTransaction(transaction);
+		status_t status = transaction.Done();
+		if (status != B_OK)
+			return status;
+	}
+
 	if (oldSize < pos)
 		FillGapWithZeros(oldSize, pos);
 
@@ -1735,12 +1772,17 @@ Inode::_GrowStream(Transaction& transaction, off_t size)
 			minimum = data->double_indirect.Length();
 	}
 
-	// do we have enough free blocks on the disk?
+	// do we have enough free blocks on the disk? (blocks that have been
+	// reserved for this inode are available to it)
 	off_t blocksNeeded = (bytes + fVolume->BlockSize() - 1)
 		>> fVolume->BlockShift();
-	if (blocksNeeded > fVolume->FreeBlocks())
+	if (blocksNeeded > fVolume->FreeBlocks() + fReservedBlocks)
 		return B_DEVICE_FULL;
 
+	// blocks reserved for other inodes must not be preallocated
+	off_t blocksUnreserved = fVolume->FreeBlocks()
+		- max_c(blocksNeeded - fReservedBlocks, 0);
+
 	off_t blocksRequested = blocksNeeded;
 		// because of preallocations and partial allocations, the number of
 		// blocks we need to allocate may be different from the one we request
@@ -1779,6 +1821,8 @@ Inode::_GrowStream(Transaction& transaction, off_t size)
 		if (roundTo > 1) {
 			// Round to next "roundTo" block count
 			blocksRequested = ((blocksNeeded + roundTo) / roundTo) * roundTo;
+			blocksRequested = min_c(blocksRequested,
+				blocksNeeded + blocksUnreserved);
 		}
 	}
 
@@ -2242,10 +2286,20 @@ Inode::SetFileSize(Transaction& transaction, off_t size)
 	if (size < 0)
 		return B_BAD_VALUE;
 
-	off_t oldSize = Size();
+	if (size == Size())
+		return B_OK;
+
+	// Any data that still waits for its blocks is either cut off, or gets
+	// its blocks right away when the stream grows to the new size.
+	_DropDelayedAllocation();
 
-	if (size == oldSize)
+	off_t oldSize = Size();
+	if (size == oldSize) {
+		// the stream already has this size
+		file_cache_set_size(FileCache(), size);
+		file_map_set_size(Map(), size);
 		return B_OK;
+	}
 
 	T(Resize(this, oldSize, size, false));
 
@@ -2288,8 +2342,8 @@ Inode::NeedsTrimming() const
 	// We never trim preallocated index blocks to make them grow as smooth as
 	// possible. There are only few indices anyway, so this doesn't hurt.
 	// Also, if an inode is already in deleted state, we don't bother trimming
-	// it.
-	if (IsIndex() || IsDeleted()
+	// it. Inodes with delayed allocations first need to place their blocks.
+	if (IsIndex() || IsDeleted() || HasDelayedAllocation()
 		|| (IsSymLink() && (Flags() & INODE_LONG_SYMLINK) == 0))
 		return false;
 
@@ -2315,6 +2369,169 @@ Inode::TrimPreallocation(Transaction& transaction)
 }
 
 
+/*!	Returns the part of the file that is backed by blocks on disk, including
+	any preallocated blocks.
+*/
+off_t
+Inode::StreamRange() const
+{
+	const data_stream& data = Node().data;
+	return max_c(data.MaxDirectRange(),
+		max_c(data.MaxIndirectRange(), data.MaxDoubleIndirectRange()));
+}
+
+
+/*!	Places the blocks for all data that has been written with delayed
+	allocation. Since this usually only happens when the file is closed,
+	synced, or its data is written back, the size of the file is known by
+	now, and the block allocator is asked for all blocks at once, instead of
+	in pieces for every write, which keeps concurrently written files from
+	interleaving on disk.
+	The inode must be write locked.
+*/
+status_t
+Inode::AllocateDelayed(Transaction& transaction)
+{
+	if (!HasDelayedAllocation())
+		return B_OK;
+
+	off_t size = fDelayedSize;
+	off_t oldSize = Node().data.Size();
+	off_t oldRange = StreamRange();
+
+	T(Resize(this, oldSize, size, false));
+
+	// Size() still returns the delayed size until the stream has grown
+	fDelayedSize = 0;
+
+	status_t status = _GrowStream(transaction, size);
+	if (status != B_OK) {
+		_ShrinkStream(transaction, oldSize);
+		fDelayedSize = size;
+		RETURN_ERROR(status);
+	}
+
+	fVolume->Allocator().Unreserve(fReservedBlocks);
+	fReservedBlocks = 0;
+
+	// the file map only knows holes beyond the former end of the stream
+	if (size > oldRange)
+		file_map_invalidate(Map(), oldRange, size - oldRange);
+
+	return WriteBack(transaction);
+}
+
+
+/*!	Starts a transaction on its own, and places the blocks of any data that
+	has been written with delayed allocation.
+	This is called by fsync(), which the VFS also calls when the vnode is
+	about to be freed; the inode is therefore not added to the transaction,
+	as that would require another reference to the vnode.
+	It's also called when the data is written back; since the page writer
+	must not wait for a transaction that might wait for the page writer in
+	turn, \a wait is \c false then, and B_WOULD_BLOCK is returned if another
+	transaction is running.
+	The inode must not be locked by the caller.
+*/
+status_t
+Inode::AllocateDelayed(bool wait)
+{
+	if (!HasDelayedAllocation())
+		return B_OK;
+
+	Transaction transaction;
+	status_t status = wait
+		? transaction.Start(fVolume, BlockNumber())
+		: transaction.TryStart(fVolume, BlockNumber());
+	if (status != B_OK)
+		return status;
+
+	WriteLocker locker(fLock);
+
+	status = AllocateDelayed(transaction);
+	if (status == B_OK)
+		return transaction.Done();
+
+	if (transaction.HasParent()) {
+		// TODO: for now, we don't let sub-transactions fail
+		transaction.Done();
+	}
+	return status;
+}
+
+
+/*!	Returns whether or not placing the blocks for a write that extends the
+	file to \a end can be delayed.
+	The inode must be locked.
+*/
+bool
+Inode::_CanDelayAllocation(off_t end) const
+{
+	// Only regular file contents go through the file cache without being
+	// logged; everything else is needed on disk with the transaction.
+	if (!fVolume->HasDelayedAllocation() || !IsFile() || IsDeleted()
+		|| (Flags() & INODE_LOGGED) != 0)
+		return false;
+
+	return end - StreamRange() <= kMaxDelayedAllocation;
+}
+
+
+/*!	Grows the file to \a size without placing any blocks. Enough blocks to
+	back the new data are reserved, so that the data can always be written
+	back.
+	The inode must be write locked.
+*/
+status_t
+Inode::_DelayAllocation(off_t size)
+{
+	off_t range = StreamRange();
+	off_t reserve = 0;
+	if (size > range) {
+		reserve = (size - range + fVolume->BlockSize() - 1)
+			>> fVolume->BlockShift();
+	}
+
+	if (reserve > fReservedBlocks) {
+		status_t status = fVolume->Allocator().Reserve(
+			reserve - fReservedBlocks);
+		if (status != B_OK)
+			return status;
+
+		fReservedBlocks = reserve;
+	}
+
+	T(Resize(this, Size(), size, false));
+
+	fDelayedSize = size;
+
+	file_cache_set_size(FileCache(), size);
+	file_map_set_size(Map(), size);
+	return B_OK;
+}
+
+
+/*!	Forgets about any data written with delayed allocation, and releases its
+	reserved blocks. The file cache and the file map still need to be updated
+	to the new size by the caller.
+	The inode must be write locked.
+*/
+void
+Inode::_DropDelayedAllocation()
+{
+	if (!HasDelayedAllocation())
+		return;
+
+	off_t range = StreamRange();
+	if (fDelayedSize > range)
+		file_map_invalidate(Map(), range, fDelayedSize - range);
+
+	fVolume->Allocator().Unreserve(fReservedBlocks);
+	fReservedBlocks = 0;
+	fDelayedSize = 0;
+}
+
+
 //!	Frees the file's data stream and removes all attributes
 status_t
 Inode::Free(Transaction& transaction)
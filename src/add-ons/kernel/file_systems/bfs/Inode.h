@@ -91,7 +91,9 @@ public:
 			uint32				Type() const { return fNode.Type(); }
 			int32				Flags() const { return fNode.Flags(); }
 
-			off_t				Size() const { return fNode.data.Size(); }
+			off_t				Size() const
+									{ return fDelayedSize != 0
+										? fDelayedSize : fNode.data.Size(); }
 			off_t				AllocatedSize() const;
 			off_t				LastModified() const
 									{ return fNode.LastModifiedTime(); }
@@ -156,6 +158,12 @@ public:
 			status_t			TrimPreallocation(Transaction& transaction);
 			bool				NeedsTrimming() const;
 
+			bool				HasDelayedAllocation() const
+									{ return fDelayedSize != 0; }
+			off_t				StreamRange() const;
+			status_t			AllocateDelayed(Transaction& transaction);
+			status_t			AllocateDelayed(bool wait = true);
+
 			status_t			Free(Transaction& transaction);
 			status_t			Sync();
 
@@ -253,6 +261,9 @@ private:
 									off_t size);
 			status_t			_ShrinkStream(Transaction& transaction,
 									off_t size);
+			bool				_CanDelayAllocation(off_t end) const;
+			status_t			_DelayAllocation(off_t size);
+			void				_DropDelayedAllocation();
 
 private:
 			rw_lock				fLock;
@@ -264,6 +275,11 @@ private:
 			void*				fMap;
 			bfs_inode			fNode;
 
+			off_t				fDelayedSize;
+			off_t				fReservedBlocks;
+				// size and blocks of data in the file cache that have not
+				// been placed on disk yet
+
 			off_t				fOldSize;
 			off_t				fOldLastModified;
 				// we need those values to ensure we will remove
@@ -12,6 +12,7 @@
 #include "Journal.h"
 
 #include "Debug.h"
+#include "IndexUpdateQueue.h"
 #include "Inode.h"
 
 
@@ -973,6 +974,27 @@ Journal::Lock(Transaction* owner, bool separateSubTransactions)
 	if (status != B_OK)
 		return status;
 
+	return _StartTransaction(owner, separateSubTransactions);
+}
+
+
+/*!	Like Lock(), but fails with B_WOULD_BLOCK instead of waiting when
+	another thread is currently running a transaction.
+*/
+status_t
+Journal::TryLock(Transaction* owner)
+{
+	status_t status = recursive_lock_trylock(&fLock);
+	if (status != B_OK)
+		return status;
+
+	return _StartTransaction(owner, false);
+}
+
+
+status_t
+Journal::_StartTransaction(Transaction* owner, bool separateSubTransactions)
+{
 	if (!fSeparateSubTransactions && recursive_lock_get_recursion(&fLock) > 1) {
 		// we'll just use the current transaction again
 		return B_OK;
@@ -1021,6 +1043,15 @@ Journal::Unlock(Transaction* owner, bool success)
 		// TODO: what about failing transactions that do not unlock?
 		// (they must make the parent fail, too)
 		if (owner != NULL) {
+			IndexUpdateQueue* indexUpdates = fVolume->IndexUpdates();
+			if (success && !owner->HasParent() && indexUpdates != NULL) {
+				// The delayed index updates must be part of the transaction
+				// that caused them; if they fail, the caller aborts it
+				status_t status = indexUpdates->Flush(*owner);
+				if (status != B_OK)
+					return status;
+			}
+
 			status_t status = _TransactionDone(success);
 			if (status != B_OK)
 				return status;
@@ -1183,6 +1214,28 @@ Transaction::Start(Volume* volume, off_t refBlock)
 }
 
 
+/*!	Starts the transaction only if that doesn't have to wait for another
+	one to finish; returns B_WOULD_BLOCK otherwise.
+*/
+status_t
+Transaction::TryStart(Volume* volume, off_t refBlock)
+{
+	// has it already been started?
+	if (fJournal != NULL)
+		return B_OK;
+
+	fJournal = volume->GetJournal(refBlock);
+	if (fJournal == NULL)
+		return B_ERROR;
+
+	status_t status = fJournal->TryLock(this);
+	if (status != B_OK)
+		fJournal = NULL;
+
+	return status;
+}
+
+
 void
 Transaction::AddListener(TransactionListener* listener)
 {
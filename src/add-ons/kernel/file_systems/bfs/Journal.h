@@ -27,6 +27,7 @@ public:
 
 			status_t		Lock(Transaction* owner,
 								bool separateSubTransactions);
+			status_t		TryLock(Transaction* owner);
 			status_t		Unlock(Transaction* owner, bool success);
 
 			status_t		ReplayLog();
@@ -49,6 +50,8 @@ private:
 			bool			_HasSubTransaction() const
 								{ return fHasSubtransaction; }
 
+			status_t		_StartTransaction(Transaction* owner,
+								bool separateSubTransactions);
 			status_t		_FlushLog(bool canWait, bool flushBlocks);
 			uint32			_TransactionSize() const;
 			status_t		_WriteTransactionToLog();
@@ -136,6 +139,7 @@ public:
 	}
 
 	status_t Start(Volume* volume, off_t refBlock);
+	status_t TryStart(Volume* volume, off_t refBlock);
 	bool IsStarted() const { return fJournal != NULL; }
 
 	status_t Done()
@@ -0,0 +1,455 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * This file may be used under the terms of the MIT License.
+ */
+
+
+//! In-memory name hash for large directories
+
+
+#include "NameCache.h"
+
+#ifndef FS_SHELL
+#	include <low_resource_manager.h>
+#endif
+
+#include "BPlusTree.h"
+#include "Debug.h"
+#include "Inode.h"
+
+
+// Only trees of at least this size get a cache; a B+tree node holds a few
+// dozen names, so that's around 4000 entries.
+static const off_t kMinTreeSize = 128 * 1024;
+static const int64 kMaxMemory = 32 * 1024 * 1024;
+	// for all caches together; a cache takes less memory than its tree
+static const bigtime_t kBuildBackoff = 10000000;
+	// after running low on memory, no caches are built for this long
+static const uint32 kInitialTableSize = 1024;
+
+static mutex sLock;
+	// protects the variables below, and the fRegistered flags
+static DoublyLinkedList<NameCache> sCaches;
+static int64 sMemory;
+static bigtime_t sBuildBlockedUntil;
+
+
+NameCache::NameCache()
+	:
+	fTable(NULL),
+	fTableSize(0),
+	fCount(0),
+	fMemory(0),
+	fTooLargeSize(0),
+	fLastUsed(0),
+	fRegistered(false)
+{
+	mutex_init(&fLock, "bfs name cache");
+}
+
+
+NameCache::~NameCache()
+{
+	MutexLocker globalLocker(sLock);
+	if (fRegistered)
+		sCaches.Remove(this);
+	globalLocker.Unlock();
+
+	mutex_lock(&fLock);
+	_Clear();
+	mutex_destroy(&fLock);
+}
+
+
+/*!	Looks up \a key in the cache, building it first if \a tree is large
+	enough. Returns B_NO_INIT if there is no cache, in which case the caller
+	has to search the tree.
+	You need to have the tree's inode read or write locked.
+*/
+status_t
+NameCache::Lookup(BPlusTree* tree, const uint8* key, uint16 keyLength,
+	off_t* _value)
+{
+	MutexLocker locker(fLock);
+
+	if (fTable == NULL) {
+		// don't read the whole tree again, if it didn't fit before
+		off_t treeSize = tree->Stream()->Size();
+		if ((fTooLargeSize != 0 && treeSize >= fTooLargeSize)
+			|| !_CanBuild(treeSize)) {
+			return B_NO_INIT;
+		}
+
+		if (_Build(tree) != B_OK)
+			return B_NO_INIT;
+
+		_Register();
+	}
+
+	fLastUsed = system_time();
+
+	name_entry* entry = _Lookup(key, keyLength, _Hash(key, keyLength));
+	if (entry == NULL)
+		return B_ENTRY_NOT_FOUND;
+
+	if (_value != NULL)
+		*_value = entry->value;
+	return B_OK;
+}
+
+
+/*!	Adds \a key to the cache, or changes its value if it's already there.
+	Does nothing if the cache has not been built, and drops it, if there is
+	no room for the key.
+*/
+void
+NameCache::Insert(const uint8* key, uint16 keyLength, off_t value)
+{
+	MutexLocker locker(fLock);
+
+	if (fTable != NULL && _Insert(key, keyLength, value) != B_OK)
+		_Clear();
+}
+
+
+void
+NameCache::Remove(const uint8* key, uint16 keyLength)
+{
+	MutexLocker locker(fLock);
+
+	if (fTable == NULL)
+		return;
+
+	uint32 hash = _Hash(key, keyLength);
+	name_entry** link = &fTable[hash & (fTableSize - 1)];
+	while (name_entry* entry = *link) {
+		if (entry->hash == hash && entry->length == keyLength
+			&& memcmp(entry->key, key, keyLength) == 0) {
+			*link = entry->next;
+			free(entry);
+			fCount--;
+			_ChangeMemory(-(ssize_t)(sizeof(name_entry) + keyLength));
+			return;
+		}
+		link = &entry->next;
+	}
+}
+
+
+/*!	Drops the cache contents; they will be rebuilt from the tree on the next
+	lookup.
+*/
+void
+NameCache::Unset()
+{
+	MutexLocker locker(fLock);
+	_Clear();
+}
+
+
+/*static*/ status_t
+NameCache::InitGlobal()
+{
+	mutex_init(&sLock, "bfs name caches");
+	sMemory = 0;
+	sBuildBlockedUntil = 0;
+
+#ifndef FS_SHELL
+	register_low_resource_handler(&_LowResourceHandler, NULL,
+		B_KERNEL_RESOURCE_PAGES | B_KERNEL_RESOURCE_MEMORY
+			| B_KERNEL_RESOURCE_ADDRESS_SPACE, 0);
+#endif
+	return B_OK;
+}
+
+
+/*static*/ void
+NameCache::UninitGlobal()
+{
+#ifndef FS_SHELL
+	unregister_low_resource_handler(&_LowResourceHandler, NULL);
+#endif
+	mutex_destroy(&sLock);
+}
+
+
+/*!	Reads all keys from \a tree. Must be called with the cache's lock held.
+*/
+status_t
+NameCache::_Build(BPlusTree* tree)
+{
+	status_t status = _Resize(kInitialTableSize);
+	if (status == B_OK) {
+		TreeIterator iterator(tree);
+
+		uint8 key[BPLUSTREE_MAX_KEY_LENGTH + 1];
+		uint16 keyLength;
+		off_t value;
+		while ((status = iterator.GetNextEntry(key, &keyLength, sizeof(key),
+				&value)) == B_OK) {
+			status = _Insert(key, keyLength, value);
+			if (status != B_OK)
+				break;
+		}
+
+		if (status == B_ENTRY_NOT_FOUND)
+			status = B_OK;
+	}
+
+	if (status != B_OK) {
+		_Clear();
+
+		if (status == B_NO_MEMORY) {
+			MutexLocker globalLocker(sLock);
+			sBuildBlockedUntil = system_time() + kBuildBackoff;
+		} else if (status == B_BUFFER_OVERFLOW)
+			fTooLargeSize = tree->Stream()->Size();
+		return status;
+	}
+
+	fTooLargeSize = 0;
+
+	PRINT(("name cache for inode %" B_PRIdOFF ": %" B_PRIu32 " entries, %"
+		B_PRIuSIZE " bytes\n", tree->Stream()->ID(), fCount, fMemory));
+	return B_OK;
+}
+
+
+NameCache::name_entry*
+NameCache::_Lookup(const uint8* key, uint16 keyLength, uint32 hash) const
+{
+	name_entry* entry = fTable[hash & (fTableSize - 1)];
+	while (entry != NULL) {
+		if (entry->hash == hash && entry->length == keyLength
+			&& memcmp(entry->key, key, keyLength) == 0)
+			return entry;
+
+		entry = entry->next;
+	}
+	return NULL;
+}
+
+
+status_t
+NameCache::_Insert(const uint8* key, uint16 keyLength, off_t value)
+{
+	uint32 hash = _Hash(key, keyLength);
+	name_entry* entry = _Lookup(key, keyLength, hash);
+	if (entry != NULL) {
+		entry->value = value;
+		return B_OK;
+	}
+
+	if (fCount >= fTableSize) {
+		status_t status = _Resize(fTableSize * 2);
+		if (status != B_OK)
+			return status;
+	}
+
+	if (!_Reserve(sizeof(name_entry) + keyLength))
+		return B_BUFFER_OVERFLOW;
+
+	entry = (name_entry*)malloc(sizeof(name_entry) + keyLength);
+	if (entry == NULL)
+		return B_NO_MEMORY;
+
+	entry->value = value;
+	entry->hash = hash;
+	entry->length = keyLength;
+	memcpy(entry->key, key, keyLength);
+
+	name_entry** bucket = &fTable[hash & (fTableSize - 1)];
+	entry->next = *bucket;
+	*bucket = entry;
+
+	fCount++;
+	_ChangeMemory(sizeof(name_entry) + keyLength);
+	return B_OK;
+}
+
+
+status_t
+NameCache::_Resize(uint32 size)
+{
+	// the table only ever grows
+	if (!_Reserve((size - fTableSize) * sizeof(name_entry*)))
+		return B_BUFFER_OVERFLOW;
+
+	name_entry** table = (name_entry**)calloc(size, sizeof(name_entry*));
+	if (table == NULL)
+		return B_NO_MEMORY;
+
+	for (uint32 i = 0; i < fTableSize; i++) {
+		name_entry* entry = fTable[i];
+		while (entry != NULL) {
+			name_entry* next = entry->next;
+			name_entry** bucket = &table[entry->hash & (size - 1)];
+			entry->next = *bucket;
+			*bucket = entry;
+			entry = next;
+		}
+	}
+
+	free(fTable);
+	_ChangeMemory(((ssize_t)size - (ssize_t)fTableSize)
+		* (ssize_t)sizeof(name_entry*));
+
+	fTable = table;
+	fTableSize = size;
+	return B_OK;
+}
+
+
+void
+NameCache::_Clear()
+{
+	for (uint32 i = 0; i < fTableSize; i++) {
+		name_entry* entry = fTable[i];
+		while (entry != NULL) {
+			name_entry* next = entry->next;
+			free(entry);
+			entry = next;
+		}
+	}
+
+	free(fTable);
+	fTable = NULL;
+	fTableSize = 0;
+	fCount = 0;
+	_ChangeMemory(-(ssize_t)fMemory);
+}
+
+
+/*!	Makes room for \a size more bytes under the limit, dropping other caches
+	if needed. Returns \c false, if there is no room even then.
+	Must be called with the cache's lock held.
+*/
+bool
+NameCache::_Reserve(size_t size)
+{
+	MutexLocker globalLocker(sLock);
+	if (sMemory + (int64)size <= kMaxMemory)
+		return true;
+	globalLocker.Unlock();
+
+	_Evict(kMaxMemory - (int64)size, this);
+
+	globalLocker.Lock();
+	return sMemory + (int64)size <= kMaxMemory;
+}
+
+
+/*!	Must be called with the cache's lock held. */
+void
+NameCache::_ChangeMemory(ssize_t change)
+{
+	fMemory += change;
+
+	MutexLocker globalLocker(sLock);
+	sMemory += change;
+}
+
+
+/*!	Makes the cache visible to _Evict(). Must be called with the cache's lock
+	held.
+*/
+void
+NameCache::_Register()
+{
+	MutexLocker globalLocker(sLock);
+	if (!fRegistered) {
+		sCaches.Add(this);
+		fRegistered = true;
+	}
+}
+
+
+/*static*/ uint32
+NameCache::_Hash(const uint8* key, uint16 keyLength)
+{
+	// FNV-1a
+	uint32 hash = 2166136261U;
+	for (uint16 i = 0; i < keyLength; i++)
+		hash = (hash ^ key[i]) * 16777619U;
+
+	return hash;
+}
+
+
+/*static*/ bool
+NameCache::_CanBuild(off_t size)
+{
+	if (size < kMinTreeSize)
+		return false;
+
+	MutexLocker globalLocker(sLock);
+	return system_time() >= sBuildBlockedUntil;
+}
+
+
+/*!	Drops the least recently used caches until no more than \a targetMemory
+	bytes are in use.
+	Since the cache locks are acquired before the global lock everywhere
+	else, caches that are currently locked are skipped. For the same reason,
+	the caller may hold the lock of \a except.
+*/
+/*static*/ void
+NameCache::_Evict(int64 targetMemory, NameCache* except)
+{
+	MutexLocker globalLocker(sLock);
+
+	while (sMemory > targetMemory) {
+		NameCache* oldest = NULL;
+
+		DoublyLinkedList<NameCache>::Iterator iterator = sCaches.GetIterator();
+		while (NameCache* cache = iterator.Next()) {
+			if (cache == except || cache->fMemory == 0
+				|| (oldest != NULL && cache->fLastUsed >= oldest->fLastUsed))
+				continue;
+
+			if (mutex_trylock(&cache->fLock) != B_OK)
+				continue;
+
+			if (oldest != NULL)
+				mutex_unlock(&oldest->fLock);
+			oldest = cache;
+		}
+
+		if (oldest == NULL)
+			break;
+
+		// _Clear() updates the memory counter, and needs the global lock
+		globalLocker.Unlock();
+		oldest->_Clear();
+		mutex_unlock(&oldest->fLock);
+		globalLocker.Lock();
+	}
+}
+
+
+/*static*/ void
+NameCache::_LowResourceHandler(void* /*data*/, uint32 /*resources*/,
+	int32 level)
+{
+#ifndef FS_SHELL
+	switch (level) {
+		case B_NO_LOW_RESOURCE:
+			return;
+		case B_LOW_RESOURCE_NOTE:
+		{
+			MutexLocker globalLocker(sLock);
+			int64 targetMemory = sMemory / 2;
+			globalLocker.Unlock();
+
+			_Evict(targetMemory, NULL);
+			break;
+		}
+		default:
+			_Evict(0, NULL);
+			break;
+	}
+
+	MutexLocker globalLocker(sLock);
+	sBuildBlockedUntil = system_time() + kBuildBackoff;
+#endif
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * This file may be used under the terms of the MIT License.
+ */
+#ifndef NAME_CACHE_H
+#define NAME_CACHE_H
+
+
+#include "system_dependencies.h"
+
+
+class BPlusTree;
+
+
+/*!	An in-memory hash of all keys of a B+tree, so that lookups in very large
+	directories don't have to descend the on-disk tree.
+
+	The cache is either complete or unused; a miss in a complete cache means
+	that the key does not exist in the tree. It is only ever built by
+	lookups, and kept up to date by the B+tree's modifications. Anything that
+	could let the cache diverge from the tree, like running out of memory, or
+	an aborted transaction, just drops it.
+	The memory used by all caches is limited: when a cache grows, the least
+	recently used other caches are dropped to make room, and a cache that
+	can't fit is dropped itself. Memory is also given back when the system
+	runs low on it.
+*/
+class NameCache : public DoublyLinkedListLinkImpl<NameCache> {
+public:
+								NameCache();
+								~NameCache();
+
+			status_t			Lookup(BPlusTree* tree, const uint8* key,
+									uint16 keyLength, off_t* _value);
+
+			void				Insert(const uint8* key, uint16 keyLength,
+									off_t value);
+			void				Remove(const uint8* key, uint16 keyLength);
+			void				Unset();
+
+	static	status_t			InitGlobal();
+	static	void				UninitGlobal();
+
+private:
+			struct name_entry {
+				name_entry*		next;
+				off_t			value;
+				uint32			hash;
+				uint16			length;
+				uint8			key[0];
+			};
+
+			status_t			_Build(BPlusTree* tree);
+			name_entry*			_Lookup(const uint8* key, uint16 keyLength,
+									uint32 hash) const;
+			status_t			_Insert(const uint8* key, uint16 keyLength,
+									off_t value);
+			status_t			_Resize(uint32 size);
+			void				_Clear();
+			bool				_Reserve(size_t size);
+			void				_ChangeMemory(ssize_t change);
+			void				_Register();
+
+	static	uint32				_Hash(const uint8* key, uint16 keyLength);
+	static	bool				_CanBuild(off_t size);
+	static	void				_Evict(int64 targetMemory, NameCache* except);
+	static	void				_LowResourceHandler(void* data,
+									uint32 resources, int32 level);
+
+private:
+			mutex				fLock;
+			name_entry**		fTable;
+			uint32				fTableSize;
+			uint32				fCount;
+			size_t				fMemory;
+			off_t				fTooLargeSize;
+			bigtime_t			fLastUsed;
+			bool				fRegistered;
+};
+
+
+#endif	// NAME_CACHE_H
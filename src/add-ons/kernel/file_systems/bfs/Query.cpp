@@ -23,6 +23,7 @@
 #include "Debug.h"
 #include "Index.h"
 #include "Inode.h"
+#include "TrigramIndex.h"
 #include "Volume.h"
 
 
@@ -150,6 +151,7 @@ private:
 			char*				_CopyString(char* start, char* end);
 	inline	bool				_IsEquationChar(char c) const;
 	inline	bool				_IsOperatorChar(char c) const;
+			status_t			_PrepareTrigramQuery(Volume* volume);
 			status_t			_ConvertValue(type_code type);
 			bool				_CompareTo(const uint8* value, uint16 size);
 			uint8*				_Value() const { return (uint8*)&fValue; }
@@ -165,6 +167,12 @@ private:
 
 			int32				fScore;
 			bool				fHasIndex;
+
+			// candidates from the attribute's trigram index, if it is used
+			bool				fUsesTrigrams;
+			off_t*				fCandidates;
+			int32				fCandidateCount;
+			int32				fCandidateIndex;
 };
 
 
@@ -214,7 +222,11 @@ Equation::Equation(char** _expression)
 	fAttribute(NULL),
 	fString(NULL),
 	fType(0),
-	fIsPattern(false)
+	fIsPattern(false),
+	fUsesTrigrams(false),
+	fCandidates(NULL),
+	fCandidateCount(0),
+	fCandidateIndex(0)
 {
 	char* string = *_expression;
 	char* start = string;
@@ -349,6 +361,7 @@ Equation::~Equation()
 {
 	free(fAttribute);
 	free(fString);
+	free(fCandidates);
 }
 
 
@@ -480,10 +493,19 @@ Equation::Complement()
 
 
 status_t
-Equation::PrepareQuery(Volume* /*volume*/, Index& index,
+Equation::PrepareQuery(Volume* volume, Index& index,
 	TreeIterator** iterator, bool queryNonIndexed)
 {
+	free(fCandidates);
+	fCandidates = NULL;
+	fUsesTrigrams = false;
+
 	status_t status = index.SetTo(fAttribute);
+	if (status == B_OK && (index.Node()->Mode() & S_TRIGRAM_INDEX) != 0) {
+		// trigram indices can't be queried directly
+		index.Unset();
+		status = B_ENTRY_NOT_FOUND;
+	}
 
 	// if we should query attributes without an index, we can just proceed here
 	if (status != B_OK && !queryNonIndexed)
@@ -511,6 +533,16 @@ Equation::PrepareQuery(Volume* /*volume*/, Index& index,
 	if (_ConvertValue(type) < B_OK)
 		return B_BAD_VALUE;
 
+	// A fixed prefix of three or more characters already lets us start at
+	// the right position in the index
+	if (fHasIndex && fIsPattern && fOp == OP_EQUAL
+		&& getFirstPatternSymbol(fString) < 3
+		&& _PrepareTrigramQuery(volume) == B_OK) {
+		// the trigram index gave us the candidates to look at
+		*iterator = NULL;
+		return B_OK;
+	}
+
 	BPlusTree* tree = index.Node()->Tree();
 	if (tree == NULL)
 		return B_ERROR;
@@ -585,11 +617,19 @@ Equation::GetNextMatching(Volume* volume, TreeIterator* iterator,
 		uint16 keyLength;
 		uint16 duplicate;
 		off_t offset;
+		status_t status;
 
-		status_t status = iterator->GetNextEntry(&indexValue, &keyLength,
-			(uint16)sizeof(indexValue), &offset, &duplicate);
-		if (status != B_OK)
-			return status;
+		if (fUsesTrigrams) {
+			if (fCandidateIndex >= fCandidateCount)
+				return B_ENTRY_NOT_FOUND;
+
+			offset = fCandidates[fCandidateIndex++];
+		} else {
+			status = iterator->GetNextEntry(&indexValue, &keyLength,
+				(uint16)sizeof(indexValue), &offset, &duplicate);
+			if (status != B_OK)
+				return status;
+		}
 
 		// only compare against the index entry when this is the correct
 		// index for the equation
@@ -691,15 +731,25 @@ Equation::CalculateScore(Index &index)
 	// And the code could also need some real world testing :-)
 
 	// do we have to operate on a "foreign" index?
-	if (fOp == OP_UNEQUAL || index.SetTo(fAttribute) < B_OK) {
+	if (fOp == OP_UNEQUAL || index.SetTo(fAttribute) < B_OK
+		|| (index.Node()->Mode() & S_TRIGRAM_INDEX) != 0) {
 		fScore = 0;
 		return;
 	}
 
 	// if we have a pattern, how much does it help our search?
-	if (fIsPattern)
+	if (fIsPattern) {
 		fScore = getFirstPatternSymbol(fString) << 3;
-	else {
+
+		// every fixed trigram narrows the search down when there is a
+		// trigram index
+		TrigramIndex trigrams(index.Node()->GetVolume());
+		if (trigrams.SetTo(fAttribute) == B_OK && trigrams.IsComplete()) {
+			int32 trigramCount = TrigramIndex::CountPatternTrigrams(fString);
+			if (trigramCount > 0)
+				fScore = max_c(fScore, (trigramCount + 2) << 3);
+		}
+	} else {
 		// Score by operator
 		if (fOp == OP_EQUAL)
 			// higher than pattern="255 chars+*"
@@ -718,6 +768,35 @@ Equation::CalculateScore(Index &index)
 }
 
 
+/*!	Retrieves the inodes that could match the pattern from the attribute's
+	trigram index, if there is one, and if it can help with this pattern.
+	The candidates still have to be matched against the pattern.
+*/
+status_t
+Equation::_PrepareTrigramQuery(Volume* volume)
+{
+	TrigramIndex trigrams(volume);
+	status_t status = trigrams.SetTo(fAttribute);
+	if (status != B_OK)
+		return status;
+
+	// an index that is still being populated, or out of date would miss
+	// entries; the regular index is used instead
+	if (!trigrams.IsComplete())
+		return B_ENTRY_NOT_FOUND;
+
+	status = trigrams.GetCandidates(fString, &fCandidates,
+		&fCandidateCount);
+	if (status != B_OK)
+		return status;
+
+	fCandidateIndex = 0;
+	fUsesTrigrams = true;
+	fHasIndex = false;
+	return B_OK;
+}
+
+
 status_t
 Equation::_ParseQuotedString(char** _start, char** _end)
 {
@@ -1309,23 +1388,26 @@ Query::GetNextEntry(struct dirent* dirent, size_t size)
 	// If we don't have an equation to use yet/anymore, get a new one
 	// from the stack
 	while (true) {
-		if (fIterator == NULL) {
+		if (fCurrent == NULL) {
 			if (!fStack.Pop(&fCurrent)
 				|| fCurrent == NULL)
 				return B_ENTRY_NOT_FOUND;
 
+			// Equations that use a trigram index don't need an iterator
 			status_t status = fCurrent->PrepareQuery(fVolume, fIndex,
 				&fIterator, fFlags & B_QUERY_NON_INDEXED);
-			if (status == B_ENTRY_NOT_FOUND) {
-				// try next equation
-				continue;
-			}
-
-			if (status != B_OK)
+			if (status != B_OK) {
+				delete fIterator;
+				fIterator = NULL;
+				fCurrent = NULL;
+
+				if (status == B_ENTRY_NOT_FOUND) {
+					// try next equation
+					continue;
+				}
 				return status;
+			}
 		}
-		if (fCurrent == NULL)
-			RETURN_ERROR(B_ERROR);
 
 		status_t status = fCurrent->GetNextMatching(fVolume, fIterator, dirent,
 			size);
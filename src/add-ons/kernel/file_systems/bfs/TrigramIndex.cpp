@@ -0,0 +1,701 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * This file may be used under the terms of the MIT License.
+ */
+
+
+//! Trigram index for substring queries
+
+
+#include "TrigramIndex.h"
+
+#include "BPlusTree.h"
+#include "Debug.h"
+#include "Inode.h"
+#include "Volume.h"
+
+
+static const int32 kTrigramLength = 3;
+static const int32 kMaxQueryTrigrams = 16;
+static const int32 kMaxPostingCount = 32768;
+	// trigrams that occur more often than this don't narrow down a query
+	// enough to be worth reading
+static const int32 kPopulateBatch = 1024;
+	// number of entries added to a new index per transaction
+
+
+static inline uint8
+fold_case(uint8 c)
+{
+	if (c >= 'A' && c <= 'Z')
+		return c - 'A' + 'a';
+	return c;
+}
+
+
+static inline void
+trigram_to_key(uint32 trigram, uint8* key)
+{
+	key[0] = (trigram >> 16) & 0xff;
+	key[1] = (trigram >> 8) & 0xff;
+	key[2] = trigram & 0xff;
+}
+
+
+template<typename Value>
+static void
+sift_down(Value* values, int32 root, int32 end)
+{
+	while (true) {
+		int32 child = root * 2 + 1;
+		if (child >= end)
+			break;
+		if (child + 1 < end && values[child] < values[child + 1])
+			child++;
+		if (!(values[root] < values[child]))
+			break;
+
+		Value temp = values[root];
+		values[root] = values[child];
+		values[child] = temp;
+		root = child;
+	}
+}
+
+
+/*!	Sorts \a values, and removes all duplicates. Returns the number of values
+	left. This is a heap sort, as there is no qsort() in the fs_shell.
+*/
+template<typename Value>
+static int32
+sort_unique(Value* values, int32 count)
+{
+	for (int32 i = count / 2 - 1; i >= 0; i--)
+		sift_down(values, i, count);
+
+	for (int32 end = count - 1; end > 0; end--) {
+		Value temp = values[0];
+		values[0] = values[end];
+		values[end] = temp;
+		sift_down(values, 0, end);
+	}
+
+	int32 unique = 0;
+	for (int32 i = 0; i < count; i++) {
+		if (unique == 0 || values[unique - 1] != values[i])
+			values[unique++] = values[i];
+	}
+	return unique;
+}
+
+
+/*!	Removes all values from the sorted array \a ids that are not in the
+	sorted array \a other, and returns the number of values left.
+*/
+static int32
+intersect(off_t* ids, int32 count, const off_t* other, int32 otherCount)
+{
+	int32 result = 0;
+	int32 j = 0;
+	for (int32 i = 0; i < count; i++) {
+		while (j < otherCount && other[j] < ids[i])
+			j++;
+		if (j == otherCount)
+			break;
+		if (other[j] == ids[i])
+			ids[result++] = ids[i];
+	}
+	return result;
+}
+
+
+//	#pragma mark -
+
+
+TrigramIndex::TrigramIndex(Volume* volume)
+	:
+	fVolume(volume),
+	fIndex(volume)
+{
+	fName[0] = '\0';
+	fAttribute[0] = '\0';
+}
+
+
+TrigramIndex::~TrigramIndex()
+{
+}
+
+
+/*!	Sets the object to the trigram index of \a attribute. Returns
+	B_ENTRY_NOT_FOUND if the attribute doesn't have one.
+*/
+status_t
+TrigramIndex::SetTo(const char* attribute)
+{
+	Unset();
+
+	if (!fVolume->HasTrigramIndices())
+		return B_ENTRY_NOT_FOUND;
+
+	if (strlcpy(fAttribute, attribute, sizeof(fAttribute))
+			>= sizeof(fAttribute)
+		|| strlcpy(fName, attribute, sizeof(fName)) >= sizeof(fName)
+		|| strlcat(fName, TRIGRAM_INDEX_SUFFIX, sizeof(fName))
+			>= sizeof(fName))
+		return B_NAME_TOO_LONG;
+
+	status_t status = fIndex.SetTo(fName);
+	if (status != B_OK)
+		return status;
+
+	if ((Node()->Mode() & S_TRIGRAM_INDEX) == 0
+		|| fIndex.Type() != B_STRING_TYPE) {
+		// just a regular index with an unfortunate name
+		fIndex.Unset();
+		return B_ENTRY_NOT_FOUND;
+	}
+
+	return B_OK;
+}
+
+
+void
+TrigramIndex::Unset()
+{
+	fIndex.Unset();
+	fName[0] = '\0';
+	fAttribute[0] = '\0';
+}
+
+
+/*!	Returns whether or not the index contains the trigrams of all values of
+	the attribute, and can therefore be used for queries.
+*/
+bool
+TrigramIndex::IsComplete() const
+{
+	return Node() != NULL && !fVolume->HasStaleTrigramIndices()
+		&& (Node()->Flags() & INODE_TRIGRAMS_COMPLETE) != 0;
+}
+
+
+/*!	Replaces the trigrams of \a oldKey with those of \a newKey for the inode
+	\a id. Either key may be \c NULL.
+*/
+status_t
+TrigramIndex::Update(Transaction& transaction, const uint8* oldKey,
+	uint16 oldLength, const uint8* newKey, uint16 newLength, ino_t id)
+{
+	if (Node() == NULL)
+		return B_NO_INIT;
+
+	BPlusTree* tree = Node()->Tree();
+	if (tree == NULL)
+		return B_BAD_VALUE;
+
+	return UpdateTree(transaction, tree, oldKey, oldLength, newKey,
+		newLength, id);
+}
+
+
+/*!	Adds the trigrams of all values in the attribute's regular index. This is
+	done in a number of smaller transactions, so that it works for large
+	volumes, too; changes that happen in the mean time are added to the index
+	by Index::Update() as usual. The index is marked complete with the last
+	of these transactions, so if this is interrupted, it will never be used.
+*/
+status_t
+TrigramIndex::Populate()
+{
+	if (Node() == NULL)
+		return B_NO_INIT;
+
+	Index index(fVolume);
+	status_t status = index.SetTo(fAttribute);
+	if (status != B_OK)
+		RETURN_ERROR(status);
+
+	BPlusTree* tree = index.Node()->Tree();
+	if (tree == NULL)
+		RETURN_ERROR(B_BAD_VALUE);
+
+	TreeIterator iterator(tree);
+	bool done = false;
+
+	while (!done) {
+		Transaction transaction(fVolume, Node()->BlockNumber());
+
+		for (int32 count = 0; count < kPopulateBatch
+				&& !transaction.IsTooLarge(); count++) {
+			uint8 key[BPLUSTREE_MAX_KEY_LENGTH + 1];
+			uint16 length;
+			off_t id;
+			status = iterator.GetNextEntry(key, &length, sizeof(key), &id);
+			if (status == B_ENTRY_NOT_FOUND) {
+				done = true;
+				status = B_OK;
+				break;
+			}
+			if (status == B_OK)
+				status = Update(transaction, NULL, 0, key, length, id);
+			if (status != B_OK)
+				RETURN_ERROR(status);
+		}
+
+		if (done)
+			status = _SetComplete(transaction, Node(), true);
+		if (status != B_OK)
+			RETURN_ERROR(status);
+
+		status = transaction.Done();
+		if (status != B_OK)
+			RETURN_ERROR(status);
+	}
+
+	return B_OK;
+}
+
+
+/*!	Removes the index the object is set to, and unsets it. */
+status_t
+TrigramIndex::Remove(Transaction& transaction)
+{
+	if (Node() == NULL)
+		return B_NO_INIT;
+
+	char name[B_FILE_NAME_LENGTH];
+	strlcpy(name, fName, sizeof(name));
+	Unset();
+
+	return fVolume->IndicesNode()->Remove(transaction, name);
+}
+
+
+/*!	Returns the sorted IDs of all inodes that could match \a pattern in
+	\a _ids, which you have to free() when you're done with it.
+	Returns B_BAD_VALUE if the index cannot help with this pattern, because
+	it doesn't contain any fixed three character sequence, or only very
+	common ones.
+*/
+status_t
+TrigramIndex::GetCandidates(const char* pattern, off_t** _ids,
+	int32* _count)
+{
+	if (Node() == NULL)
+		return B_NO_INIT;
+
+	uint32 trigrams[kMaxQueryTrigrams];
+	int32 trigramCount = _GetPatternTrigrams(pattern, trigrams,
+		kMaxQueryTrigrams);
+
+	off_t* ids = NULL;
+	int32 count = 0;
+	bool found = false;
+
+	for (int32 i = 0; i < trigramCount; i++) {
+		off_t* list;
+		int32 listCount;
+		status_t status = _ReadPostingList(trigrams[i], &list, &listCount);
+		if (status == B_BUFFER_OVERFLOW)
+			continue;
+		if (status != B_OK) {
+			free(ids);
+			return status;
+		}
+
+		if (!found) {
+			ids = list;
+			count = listCount;
+			found = true;
+		} else {
+			count = intersect(ids, count, list, listCount);
+			free(list);
+		}
+
+		if (count == 0)
+			break;
+	}
+
+	if (!found)
+		return B_BAD_VALUE;
+
+	*_ids = ids;
+	*_count = count;
+	return B_OK;
+}
+
+
+/*!	Returns whether or not the name of index \a name marks a trigram index,
+	and if so, the length of the attribute name part of it.
+*/
+/*static*/ bool
+TrigramIndex::IsTrigramIndexName(const char* name, size_t* _attributeLength)
+{
+	size_t length = strlen(name);
+	size_t suffixLength = strlen(TRIGRAM_INDEX_SUFFIX);
+	if (length <= suffixLength
+		|| strcmp(name + length - suffixLength, TRIGRAM_INDEX_SUFFIX) != 0)
+		return false;
+
+	if (_attributeLength != NULL)
+		*_attributeLength = length - suffixLength;
+	return true;
+}
+
+
+/*!	Returns whether or not the volume might have trigram indices, so that
+	Index::Update() doesn't need to look for them on every change if there
+	are none. This only looks at the names of the indices.
+*/
+/*static*/ bool
+TrigramIndex::AnyExist(Volume* volume)
+{
+	Inode* indices = volume->IndicesNode();
+	if (indices == NULL)
+		return false;
+
+	BPlusTree* tree = indices->Tree();
+	if (tree == NULL)
+		return false;
+
+	TreeIterator iterator(tree);
+	char name[B_FILE_NAME_LENGTH];
+	uint16 length;
+	off_t id;
+	while (iterator.GetNextEntry(name, &length, sizeof(name), &id) == B_OK) {
+		if (IsTrigramIndexName(name))
+			return true;
+	}
+
+	return false;
+}
+
+
+/*!	Removes the complete mark from all trigram indices of the volume, as they
+	are no longer up to date. They can be removed and created again to make
+	them usable again.
+*/
+/*static*/ status_t
+TrigramIndex::MarkAllIncomplete(Volume* volume)
+{
+	Inode* indices = volume->IndicesNode();
+	if (indices == NULL)
+		return B_OK;
+
+	BPlusTree* tree = indices->Tree();
+	if (tree == NULL)
+		RETURN_ERROR(B_BAD_VALUE);
+
+	Transaction transaction(volume, volume->Indices());
+
+	TreeIterator iterator(tree);
+	char name[B_FILE_NAME_LENGTH];
+	uint16 length;
+	off_t id;
+	status_t status;
+	while ((status = iterator.GetNextEntry(name, &length, sizeof(name), &id))
+			== B_OK) {
+		if (!IsTrigramIndexName(name))
+			continue;
+
+		Vnode vnode(volume, id);
+		Inode* inode;
+		status = vnode.Get(&inode);
+		if (status != B_OK)
+			RETURN_ERROR(status);
+
+		if ((inode->Mode() & S_TRIGRAM_INDEX) != 0
+			&& (inode->Flags() & INODE_TRIGRAMS_COMPLETE) != 0) {
+			INFORM(("bfs: trigram index \"%s\" is out of date, and won't be "
+				"used anymore.\n", name));
+			status = _SetComplete(transaction, inode, false);
+			if (status != B_OK)
+				RETURN_ERROR(status);
+		}
+	}
+	if (status != B_ENTRY_NOT_FOUND)
+		RETURN_ERROR(status);
+
+	return transaction.Done();
+}
+
+
+/*static*/ int32
+TrigramIndex::CountPatternTrigrams(const char* pattern)
+{
+	uint32 trigrams[kMaxQueryTrigrams];
+	return _GetPatternTrigrams(pattern, trigrams, kMaxQueryTrigrams);
+}
+
+
+/*!	Removes the trigrams of \a oldKey that are not part of \a newKey from
+	\a tree, and adds those of \a newKey that weren't in \a oldKey.
+*/
+/*static*/ status_t
+TrigramIndex::UpdateTree(Transaction& transaction, BPlusTree* tree,
+	const uint8* oldKey, uint16 oldLength, const uint8* newKey,
+	uint16 newLength, ino_t id)
+{
+	// keys are at most MAX_INDEX_KEY_LENGTH bytes, and so are their trigrams
+	uint32* oldTrigrams = (uint32*)malloc(2 * MAX_INDEX_KEY_LENGTH
+		* sizeof(uint32));
+	if (oldTrigrams == NULL)
+		RETURN_ERROR(B_NO_MEMORY);
+	MemoryDeleter trigramsDeleter(oldTrigrams);
+	uint32* newTrigrams = oldTrigrams + MAX_INDEX_KEY_LENGTH;
+
+	int32 oldCount = oldKey != NULL
+		? _GetTrigrams(oldKey, oldLength, oldTrigrams) : 0;
+	int32 newCount = newKey != NULL
+		? _GetTrigrams(newKey, newLength, newTrigrams) : 0;
+	if (oldCount == 0 && newCount == 0)
+		return B_OK;
+
+	tree->Stream()->WriteLockInTransaction(transaction);
+
+	// both lists are sorted, so we can just walk through them in parallel
+	int32 oldIndex = 0;
+	int32 newIndex = 0;
+	while (oldIndex < oldCount || newIndex < newCount) {
+		uint8 key[kTrigramLength];
+		status_t status;
+
+		if (newIndex == newCount || (oldIndex < oldCount
+				&& oldTrigrams[oldIndex] < newTrigrams[newIndex])) {
+			trigram_to_key(oldTrigrams[oldIndex++], key);
+			status = tree->Remove(transaction, key, kTrigramLength, id);
+			if (status == B_ENTRY_NOT_FOUND)
+				status = B_OK;
+		} else if (oldIndex == oldCount
+			|| newTrigrams[newIndex] < oldTrigrams[oldIndex]) {
+			trigram_to_key(newTrigrams[newIndex++], key);
+			status = tree->Insert(transaction, key, kTrigramLength, id);
+		} else {
+			// part of both keys
+			oldIndex++;
+			newIndex++;
+			continue;
+		}
+
+		if (status != B_OK)
+			RETURN_ERROR(status);
+	}
+
+	return B_OK;
+}
+
+
+/*static*/ status_t
+TrigramIndex::_SetComplete(Transaction& transaction, Inode* inode,
+	bool complete)
+{
+	inode->WriteLockInTransaction(transaction);
+
+	int32 flag = HOST_ENDIAN_TO_BFS_INT32(INODE_TRIGRAMS_COMPLETE);
+	if (complete)
+		inode->Node().flags |= flag;
+	else
+		inode->Node().flags &= ~flag;
+
+	return inode->WriteBack(transaction);
+}
+
+
+status_t
+TrigramIndex::_ReadPostingList(uint32 trigram, off_t** _ids, int32* _count)
+{
+	BPlusTree* tree = Node()->Tree();
+	if (tree == NULL)
+		return B_BAD_VALUE;
+
+	uint8 key[kTrigramLength];
+	trigram_to_key(trigram, key);
+
+	*_ids = NULL;
+	*_count = 0;
+
+	TreeIterator iterator(tree);
+	status_t status = iterator.Find(key, kTrigramLength);
+	if (status == B_ENTRY_NOT_FOUND)
+		return B_OK;
+	if (status != B_OK)
+		return status;
+
+	off_t* ids = NULL;
+	int32 count = 0;
+	int32 size = 0;
+
+	while (true) {
+		uint8 foundKey[BPLUSTREE_MAX_KEY_LENGTH + 1];
+		uint16 length;
+		off_t id;
+		status = iterator.GetNextEntry(foundKey, &length, sizeof(foundKey),
+			&id);
+		if (status == B_ENTRY_NOT_FOUND)
+			break;
+		if (status != B_OK) {
+			free(ids);
+			return status;
+		}
+
+		if (length != kTrigramLength
+			|| memcmp(foundKey, key, kTrigramLength) != 0)
+			break;
+
+		if (count == size) {
+			if (size == kMaxPostingCount) {
+				free(ids);
+				return B_BUFFER_OVERFLOW;
+			}
+
+			size = size == 0 ? 64 : size * 2;
+			off_t* newIDs = (off_t*)realloc(ids, size * sizeof(off_t));
+			if (newIDs == NULL) {
+				free(ids);
+				return B_NO_MEMORY;
+			}
+			ids = newIDs;
+		}
+
+		ids[count++] = id;
+	}
+
+	*_ids = ids;
+	*_count = sort_unique(ids, count);
+	return B_OK;
+}
+
+
+/*!	Fills \a trigrams with the sorted trigrams of \a key, and returns their
+	number. \a trigrams must have room for \a length entries.
+*/
+/*static*/ int32
+TrigramIndex::_GetTrigrams(const uint8* key, uint16 length,
+	uint32* trigrams)
+{
+	// the key may or may not include the terminating null byte
+	for (uint16 i = 0; i < length; i++) {
+		if (key[i] == '\0') {
+			length = i;
+			break;
+		}
+	}
+
+	int32 count = 0;
+	for (int32 i = 0; i + kTrigramLength <= length; i++) {
+		trigrams[count++] = (fold_case(key[i]) << 16)
+			| (fold_case(key[i + 1]) << 8) | fold_case(key[i + 2]);
+	}
+
+	return sort_unique(trigrams, count);
+}
+
+
+/*!	Collects the distinct trigrams of all runs of fixed characters in
+	\a pattern. Sets that only contain the upper and lower case variant of
+	the same letter, like "[Hh]", count as fixed characters.
+*/
+/*static*/ int32
+TrigramIndex::_GetPatternTrigrams(const char* pattern, uint32* trigrams,
+	int32 maxCount)
+{
+	int32 count = 0;
+	int32 runLength = 0;
+	uint32 trigram = 0;
+
+	while (pattern[0] != '\0' && count < maxCount) {
+		int32 c;
+		switch (pattern[0]) {
+			case '*':
+			case '?':
+				pattern++;
+				c = -1;
+				break;
+
+			case '[':
+				pattern++;
+				c = _ParseSet(&pattern);
+				break;
+
+			case '\\':
+				if (pattern[1] == '\0') {
+					pattern++;
+					c = -1;
+					break;
+				}
+				pattern++;
+				// supposed to fall through
+			default:
+				c = fold_case((uint8)pattern[0]);
+				pattern++;
+				break;
+		}
+
+		if (c < 0) {
+			runLength = 0;
+			continue;
+		}
+
+		trigram = ((trigram << 8) | c) & 0xffffff;
+		if (++runLength < kTrigramLength)
+			continue;
+
+		bool known = false;
+		for (int32 i = 0; i < count; i++) {
+			if (trigrams[i] == trigram) {
+				known = true;
+				break;
+			}
+		}
+		if (!known)
+			trigrams[count++] = trigram;
+	}
+
+	return count;
+}
+
+
+/*!	Parses the set \a _pattern points to (right after the opening bracket),
+	and moves it past the set. Returns the case folded character if the set
+	matches just one character, ignoring case, or -1 if not.
+*/
+/*static*/ int32
+TrigramIndex::_ParseSet(const char** _pattern)
+{
+	const char* pattern = *_pattern;
+	int32 folded = -1;
+	bool usable = true;
+
+	if (pattern[0] == '^' || pattern[0] == '!') {
+		usable = false;
+		pattern++;
+	}
+
+	while (pattern[0] != '\0' && pattern[0] != ']') {
+		if (pattern[0] == '\\' && pattern[1] != '\0')
+			pattern++;
+
+		uint8 c = (uint8)pattern[0];
+		pattern++;
+
+		if (pattern[0] == '-' && pattern[1] != ']' && pattern[1] != '\0') {
+			// a range
+			usable = false;
+		}
+
+		if (c >= 0x80) {
+			// part of a multi-byte character
+			usable = false;
+		} else if (folded < 0)
+			folded = fold_case(c);
+		else if (fold_case(c) != folded)
+			usable = false;
+	}
+
+	if (pattern[0] == ']')
+		pattern++;
+
+	*_pattern = pattern;
+	return usable ? folded : -1;
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * This file may be used under the terms of the MIT License.
+ */
+#ifndef TRIGRAM_INDEX_H
+#define TRIGRAM_INDEX_H
+
+
+#include "system_dependencies.h"
+
+#include "Index.h"
+
+
+class BPlusTree;
+class Inode;
+class Transaction;
+class Volume;
+
+
+#define TRIGRAM_INDEX_SUFFIX	":trigram"
+
+
+/*!	A trigram index accompanies the regular index of a string attribute. It
+	is named after the attribute with TRIGRAM_INDEX_SUFFIX appended, and maps
+	every three byte sequence that occurs in one of the attribute's values to
+	the inodes with that value. ASCII letters are folded to lower case.
+
+	This lets queries with patterns that don't start with a fixed prefix,
+	like the case insensitive ones ("*[Hh][Oo][Ww]*") Tracker issues, only
+	look at the inodes that contain all of the pattern's trigrams, instead of
+	matching every single inode. The index only ever narrows down the
+	candidates; they are still checked against the full query.
+
+	Queries only use an index that is complete: it is marked as such once
+	all existing values have been added, and that mark is removed again if
+	the volume has been changed by a driver that doesn't know about trigram
+	indices.
+*/
+class TrigramIndex {
+public:
+								TrigramIndex(Volume* volume);
+								~TrigramIndex();
+
+			status_t			SetTo(const char* attribute);
+			void				Unset();
+
+			Inode*				Node() const { return fIndex.Node(); }
+			bool				IsComplete() const;
+
+			status_t			Update(Transaction& transaction,
+									const uint8* oldKey, uint16 oldLength,
+									const uint8* newKey, uint16 newLength,
+									ino_t id);
+			status_t			Populate();
+			status_t			Remove(Transaction& transaction);
+
+			status_t			GetCandidates(const char* pattern,
+									off_t** _ids, int32* _count);
+
+	static	bool				IsTrigramIndexName(const char* name,
+									size_t* _attributeLength = NULL);
+	static	bool				AnyExist(Volume* volume);
+	static	status_t			MarkAllIncomplete(Volume* volume);
+	static	int32				CountPatternTrigrams(const char* pattern);
+	static	status_t			UpdateTree(Transaction& transaction,
+									BPlusTree* tree, const uint8* oldKey,
+									uint16 oldLength, const uint8* newKey,
+									uint16 newLength, ino_t id);
+
+private:
+								TrigramIndex(const TrigramIndex& other);
+								TrigramIndex& operator=(
+									const TrigramIndex& other);
+									// no implementation
+
+	static	status_t			_SetComplete(Transaction& transaction,
+									Inode* inode, bool complete);
+			status_t			_ReadPostingList(uint32 trigram,
+									off_t** _ids, int32* _count);
+
+	static	int32				_GetTrigrams(const uint8* key, uint16 length,
+									uint32* trigrams);
+	static	int32				_GetPatternTrigrams(const char* pattern,
+									uint32* trigrams, int32 maxCount);
+	static	int32				_ParseSet(const char** _pattern);
+
+private:
+			Volume*				fVolume;
+			Index				fIndex;
+			char				fName[B_FILE_NAME_LENGTH];
+			char				fAttribute[B_FILE_NAME_LENGTH];
+};
+
+
+#endif	// TRIGRAM_INDEX_H
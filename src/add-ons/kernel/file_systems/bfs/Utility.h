@@ -20,7 +20,11 @@ enum inode_type {
 						| S_LONG_LONG_INDEX | S_ULONG_LONG_INDEX
 						| S_FLOAT_INDEX | S_DOUBLE_INDEX),
 
-	S_EXTENDED_TYPES = (S_ATTR_DIR | S_ATTR | S_INDEX_DIR)
+	S_EXTENDED_TYPES = (S_ATTR_DIR | S_ATTR | S_INDEX_DIR),
+
+	S_TRIGRAM_INDEX	= 010000000000
+		// BFS specific: a string index that holds the trigrams of the
+		// attribute values, see TrigramIndex
 };
 
 
@@ -11,9 +11,11 @@
 #include "CheckVisitor.h"
 #include "Debug.h"
 #include "file_systems/DeviceOpener.h"
+#include "IndexUpdateQueue.h"
 #include "Inode.h"
 #include "Journal.h"
 #include "Query.h"
+#include "TrigramIndex.h"
 #include "Volume.h"
 
 
@@ -126,7 +128,8 @@ Volume::Volume(fs_volume* volume)
 	fDirtyCachedBlocks(0),
 	fFlags(0),
 	fCheckingThread(-1),
-	fCheckVisitor(NULL)
+	fCheckVisitor(NULL),
+	fIndexUpdates(NULL)
 {
 	mutex_init(&fLock, "bfs volume");
 	mutex_init(&fQueryLock, "bfs queries");
@@ -135,6 +138,7 @@ Volume::Volume(fs_volume* volume)
 
 Volume::~Volume()
 {
+	delete fIndexUpdates;
 	mutex_destroy(&fQueryLock);
 	mutex_destroy(&fLock);
 }
@@ -192,6 +196,12 @@ Volume::Mount(const char* deviceName, uint32 flags)
 		return B_BAD_VALUE;
 	}
 
+	// Other drivers move the log, but don't keep the trigram indices, nor
+	// their copy of its end up to date. This has to be checked before the
+	// log is replayed.
+	if (fSuperBlock.TrigramLogEnd() != fSuperBlock.LogEnd())
+		fFlags |= VOLUME_STALE_TRIGRAM_INDICES;
+
 	// initialize short hands to the superblock (to save byte swapping)
 	fBlockSize = fSuperBlock.BlockSize();
 	fBlockShift = fSuperBlock.BlockShift();
@@ -268,6 +278,14 @@ Volume::Mount(const char* deviceName, uint32 flags)
 				}
 			} else {
 				// we don't use the vnode layer to access the indices node
+				SetHasTrigramIndices(TrigramIndex::AnyExist(this));
+
+				// If another driver changed the volume, the trigram indices
+				// can't be used until they are rebuilt
+				if (HasStaleTrigramIndices() && (!HasTrigramIndices()
+						|| (!IsReadOnly()
+							&& TrigramIndex::MarkAllIncomplete(this) == B_OK)))
+					fFlags &= ~VOLUME_STALE_TRIGRAM_INDICES;
 			}
 		} else {
 			FATAL(("could not create root node: publish_vnode() failed!\n"));
@@ -296,6 +314,11 @@ Volume::Unmount()
 
 	fBlockAllocator.Uninitialize();
 
+	// Every transaction applies its own index updates, so the queue is
+	// already empty
+	delete fIndexUpdates;
+	fIndexUpdates = NULL;
+
 	// This will also flush the log & all blocks to disk
 	delete fJournal;
 	fJournal = NULL;
@@ -316,6 +339,30 @@ Volume::Sync()
 }
 
 
+/*!	Enables or disables delaying the updates of the size and last_modified
+	indices, see IndexUpdateQueue.
+	Must not be called while the volume is in use.
+*/
+status_t
+Volume::SetDelayedIndexUpdates(bool enabled)
+{
+	if (enabled == (fIndexUpdates != NULL))
+		return B_OK;
+
+	if (!enabled) {
+		delete fIndexUpdates;
+		fIndexUpdates = NULL;
+		return B_OK;
+	}
+
+	fIndexUpdates = new(std::nothrow) IndexUpdateQueue(this);
+	if (fIndexUpdates == NULL)
+		return B_NO_MEMORY;
+
+	return B_OK;
+}
+
+
 status_t
 Volume::ValidateBlockRun(block_run run)
 {
@@ -398,6 +445,9 @@ Volume::AllocateForInode(Transaction& transaction, const Inode* parent,
 status_t
 Volume::WriteSuperBlock()
 {
+	if (!HasStaleTrigramIndices())
+		fSuperBlock.trigram_log_end = fSuperBlock.log_end;
+
 	if (write_pos(fDevice, 512, &fSuperBlock, sizeof(disk_super_block))
 			!= sizeof(disk_super_block))
 		return B_IO_ERROR;
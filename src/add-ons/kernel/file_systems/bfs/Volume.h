@@ -13,13 +13,17 @@
 
 
 class CheckVisitor;
+class IndexUpdateQueue;
 class Journal;
 class Inode;
 class Query;
 
 
 enum volume_flags {
-	VOLUME_READ_ONLY	= 0x0001
+	VOLUME_READ_ONLY			= 0x0001,
+	VOLUME_DELAYED_ALLOCATION	= 0x0002,
+	VOLUME_HAS_TRIGRAM_INDICES	= 0x0004,
+	VOLUME_STALE_TRIGRAM_INDICES = 0x0008
 };
 
 enum volume_initialize_flags {
@@ -44,6 +48,13 @@ public:
 			bool			IsValidSuperBlock() const;
 			bool			IsValidInodeBlock(off_t block) const;
 			bool			IsReadOnly() const;
+			bool			HasDelayedAllocation() const;
+			void			SetDelayedAllocation(bool enabled);
+			bool			HasTrigramIndices() const;
+			void			SetHasTrigramIndices(bool hasIndices);
+			bool			HasStaleTrigramIndices() const;
+			status_t		SetDelayedIndexUpdates(bool enabled);
+			IndexUpdateQueue* IndexUpdates() const { return fIndexUpdates; }
 			void			Panic();
 			mutex&			Lock();
 
@@ -65,7 +76,8 @@ public:
 			off_t			UsedBlocks() const
 								{ return fSuperBlock.UsedBlocks(); }
 			off_t			FreeBlocks() const
-								{ return NumBlocks() - UsedBlocks(); }
+								{ return NumBlocks() - UsedBlocks()
+									- fBlockAllocator.ReservedBlocks(); }
 			off_t			NumBitmapBlocks() const
 								{ return (NumBlocks() + fBlockSize * 8 - 1)
 									/ (fBlockSize * 8); }
@@ -182,6 +194,7 @@ protected:
 			::CheckVisitor*	fCheckVisitor;
 
 			InodeList		fRemovedInodes;
+			IndexUpdateQueue* fIndexUpdates;
 };
 
 
@@ -194,6 +207,47 @@ Volume::IsReadOnly() const
 }
 
 
+inline bool
+Volume::HasDelayedAllocation() const
+{
+	return (fFlags & VOLUME_DELAYED_ALLOCATION) != 0;
+}
+
+
+inline void
+Volume::SetDelayedAllocation(bool enabled)
+{
+	if (enabled)
+		fFlags |= VOLUME_DELAYED_ALLOCATION;
+	else
+		fFlags &= ~VOLUME_DELAYED_ALLOCATION;
+}
+
+
+inline bool
+Volume::HasTrigramIndices() const
+{
+	return (fFlags & VOLUME_HAS_TRIGRAM_INDICES) != 0;
+}
+
+
+inline void
+Volume::SetHasTrigramIndices(bool hasIndices)
+{
+	if (hasIndices)
+		fFlags |= VOLUME_HAS_TRIGRAM_INDICES;
+	else
+		fFlags &= ~VOLUME_HAS_TRIGRAM_INDICES;
+}
+
+
+inline bool
+Volume::HasStaleTrigramIndices() const
+{
+	return (fFlags & VOLUME_STALE_TRIGRAM_INDICES) != 0;
+}
+
+
 inline mutex&
 Volume::Lock()
 {
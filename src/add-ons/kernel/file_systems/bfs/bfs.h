@@ -76,7 +76,10 @@ struct disk_super_block {
 	int32		magic3;
 	inode_addr	root_dir;
 	inode_addr	indices;
-	int32		_reserved[8];
+	int64		trigram_log_end;
+		// the log_end the trigram indices were last known to be complete
+		// for; other drivers don't update them, nor this field
+	int32		_reserved[6];
 	int32		pad_to_block[87];
 		// this also contains parts of the boot block
 
@@ -97,6 +100,8 @@ struct disk_super_block {
 	int32 Flags() const { return BFS_ENDIAN_TO_HOST_INT32(flags); }
 	off_t LogStart() const { return BFS_ENDIAN_TO_HOST_INT64(log_start); }
 	off_t LogEnd() const { return BFS_ENDIAN_TO_HOST_INT64(log_end); }
+	off_t TrigramLogEnd() const
+		{ return BFS_ENDIAN_TO_HOST_INT64(trigram_log_end); }
 
 	// implemented in Volume.cpp:
 	bool IsValid() const;
@@ -258,6 +263,7 @@ enum inode_flags {
 	INODE_DELETED			= 0x00000010,
 	INODE_NOT_READY			= 0x00000020,	// used during Inode construction
 	INODE_LONG_SYMLINK		= 0x00000040,	// symlink in data stream
+	INODE_TRIGRAMS_COMPLETE	= 0x00000080,	// trigram index can be queried
 
 	INODE_PERMANENT_FLAGS	= 0x0000ffff,
 
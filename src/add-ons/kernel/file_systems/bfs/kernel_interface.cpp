@@ -16,6 +16,7 @@
 #include "BPlusTree.h"
 #include "Query.h"
 #include "ResizeVisitor.h"
+#include "TrigramIndex.h"
 #include "bfs_control.h"
 #include "bfs_disk_system.h"
 
@@ -94,6 +95,44 @@ fill_stat_buffer(Inode* inode, struct stat& stat)
 }
 
 
+/*!	Returns whether or not the file data up to \a end can be written back.
+	Data written with delayed allocation doesn't have any blocks before the
+	file is closed, synced, written back, or has grown enough (see
+	Inode::WriteAt()).
+	The inode must be read locked.
+*/
+static bool
+can_write_back(Inode* inode, off_t end)
+{
+	return !inode->HasDelayedAllocation()
+		|| min_c(end, inode->Size()) <= inode->StreamRange();
+}
+
+
+/*!	Places the blocks of data written with delayed allocation, if the file
+	data up to \a end cannot be written back otherwise.
+	This doesn't wait for another transaction to finish, as that one might
+	wait for the pages that are about to be written; B_BUSY is returned in
+	this case, and the pages just stay modified, and are written later.
+	The inode must not be locked.
+*/
+static status_t
+prepare_write_back(Inode* inode, off_t end)
+{
+	{
+		InodeReadLocker locker(inode);
+		if (can_write_back(inode, end))
+			return B_OK;
+	}
+
+	status_t status = inode->AllocateDelayed(false);
+	if (status == B_WOULD_BLOCK)
+		return B_BUSY;
+
+	return status;
+}
+
+
 //!	bfs_io() callback hook
 static status_t
 iterative_io_get_vecs_hook(void* cookie, io_request* request, off_t offset,
@@ -178,7 +217,21 @@ bfs_mount(fs_volume* _volume, const char* device, uint32 flags,
 	if (volume == NULL)
 		return B_NO_MEMORY;
 
-	status_t status = volume->Mount(device, flags);
+	status_t status = B_OK;
+	if (args != NULL) {
+		void* handle = parse_driver_settings_string(args);
+		if (handle != NULL) {
+			volume->SetDelayedAllocation(get_driver_boolean_parameter(handle,
+				"delalloc", false, true));
+			status = volume->SetDelayedIndexUpdates(
+				get_driver_boolean_parameter(handle, "delayed_index", false,
+					true));
+			delete_driver_settings(handle);
+		}
+	}
+
+	if (status == B_OK)
+		status = volume->Mount(device, flags);
 	if (status != B_OK) {
 		delete volume;
 		RETURN_ERROR(status);
@@ -460,12 +513,20 @@ bfs_write_pages(fs_volume* _volume, fs_vnode* _node, void* _cookie,
 	if (inode->FileCache() == NULL)
 		RETURN_ERROR(B_BAD_VALUE);
 
+	status_t status = prepare_write_back(inode, pos + *_numBytes);
+	if (status != B_OK)
+		return status;
+
 	InodeReadLocker _(inode);
 
+	if (!can_write_back(inode, pos + *_numBytes)) {
+		// the file has grown again in the mean time
+		return B_BUSY;
+	}
+
 	uint32 vecIndex = 0;
 	size_t vecOffset = 0;
 	size_t bytesLeft = *_numBytes;
-	status_t status;
 
 	while (true) {
 		file_io_vec fileVecs[8];
@@ -512,9 +573,30 @@ bfs_io(fs_volume* _volume, fs_vnode* _node, void* _cookie, io_request* request)
 		RETURN_ERROR(B_BAD_VALUE);
 	}
 
+#ifndef FS_SHELL
+	// (the fs_shell only uses the read_pages()/write_pages() hooks)
+	off_t end = io_request_offset(request) + io_request_length(request);
+	if (io_request_is_write(request)) {
+		status_t status = prepare_write_back(inode, end);
+		if (status != B_OK) {
+			notify_io_request(request, status);
+			return status;
+		}
+	}
+#endif
+
 	// We lock the node here and will unlock it in the "finished" hook.
 	rw_lock_read_lock(&inode->Lock());
 
+#ifndef FS_SHELL
+	if (io_request_is_write(request) && !can_write_back(inode, end)) {
+		// the file has grown again in the mean time
+		rw_lock_read_unlock(&inode->Lock());
+		notify_io_request(request, B_BUSY);
+		return B_BUSY;
+	}
+#endif
+
 	return do_iterative_fd_io(volume->Device(), request,
 		iterative_io_get_vecs_hook, iterative_io_finished_hook, inode);
 }
@@ -535,6 +617,16 @@ bfs_get_file_map(fs_volume* _volume, fs_vnode* _node, off_t offset, size_t size,
 	//FUNCTION_START(("offset = %Ld, size = %lu\n", offset, size));
 
 	while (true) {
+		if (inode->HasDelayedAllocation() && offset >= inode->StreamRange()) {
+			// the rest of the file has no blocks yet, and only exists in the
+			// file cache; it is mapped as a hole until the blocks are placed
+			vecs[index].offset = -1;
+			vecs[index].length = round_up(inode->Size() - offset,
+				volume->BlockSize());
+			*_count = index + 1;
+			return B_OK;
+		}
+
 		status_t status = inode->FindBlockRun(offset, run, fileOffset);
 		if (status != B_OK)
 			return status;
@@ -838,6 +930,12 @@ bfs_fsync(fs_volume* _volume, fs_vnode* _node)
 	FUNCTION();
 
 	Inode* inode = (Inode*)_node->private_node;
+
+	// data written with delayed allocation needs its blocks first
+	status_t status = inode->AllocateDelayed();
+	if (status != B_OK)
+		RETURN_ERROR(status);
+
 	return inode->Sync();
 }
 
@@ -1491,7 +1589,7 @@ bfs_free_cookie(fs_volume* _volume, fs_vnode* _node, void* _cookie)
 
 		if ((cookie->open_mode & O_RWMASK) != 0
 			&& !inode->IsDeleted()
-			&& (needsTrimming
+			&& (needsTrimming || inode->HasDelayedAllocation()
 				|| inode->OldLastModified() != inode->LastModified()
 				|| (inode->InSizeIndex()
 					// TODO: this can prevent the size update notification
@@ -1512,6 +1610,23 @@ bfs_free_cookie(fs_volume* _volume, fs_vnode* _node, void* _cookie)
 		bool changedSize = false, changedTime = false;
 		Index index(volume);
 
+		// now that the file is closed, its final size is likely known, and
+		// it's a good time to place any delayed blocks
+		if (inode->HasDelayedAllocation()) {
+			status = inode->AllocateDelayed(transaction);
+			if (status != B_OK) {
+				FATAL(("Could not allocate delayed blocks: inode %" B_PRIdINO
+					", transaction %d: %s!\n", inode->ID(),
+					(int)transaction.ID(), strerror(status)));
+
+				// the blocks are still reserved, they will be placed when
+				// the file is synced, at the latest when its vnode is
+				// released
+				status = B_OK;
+			}
+			needsTrimming = inode->NeedsTrimming();
+		}
+
 		if (needsTrimming) {
 			status = inode->TrimPreallocation(transaction);
 			if (status < B_OK) {
@@ -2185,6 +2300,32 @@ bfs_create_index(fs_volume* _volume, const char* name, uint32 type,
 	if (status == B_OK)
 		status = transaction.Done();
 
+	size_t attributeLength;
+	if (status == B_OK
+		&& TrigramIndex::IsTrigramIndexName(name, &attributeLength)) {
+		index.Unset();
+
+		// Changes have to go into the index right away, but queries won't
+		// use it before Populate() marked it complete
+		volume->SetHasTrigramIndices(true);
+
+		// fill in the values that already exist
+		char attribute[B_FILE_NAME_LENGTH];
+		strlcpy(attribute, name, min_c(attributeLength + 1,
+			sizeof(attribute)));
+
+		TrigramIndex trigrams(volume);
+		status = trigrams.SetTo(attribute);
+		if (status == B_OK)
+			status = trigrams.Populate();
+		if (status != B_OK && trigrams.Node() != NULL) {
+			// an incomplete index would make queries miss entries
+			Transaction removeTransaction(volume, volume->Indices());
+			if (trigrams.Remove(removeTransaction) == B_OK)
+				removeTransaction.Done();
+		}
+	}
+
 	RETURN_ERROR(status);
 }
 
@@ -2210,6 +2351,12 @@ bfs_remove_index(fs_volume* _volume, const char* name)
 	Transaction transaction(volume, volume->Indices());
 
 	status_t status = indices->Remove(transaction, name);
+	if (status == B_OK && !TrigramIndex::IsTrigramIndexName(name)) {
+		// the trigram index can't be kept up to date without this one
+		TrigramIndex trigrams(volume);
+		if (trigrams.SetTo(name) == B_OK)
+			status = trigrams.Remove(transaction);
+	}
 	if (status == B_OK)
 		status = transaction.Done();
 
@@ -2434,14 +2581,21 @@ bfs_std_ops(int32 op, ...)
 {
 	switch (op) {
 		case B_MODULE_INIT:
+		{
+			status_t status = NameCache::InitGlobal();
+			if (status != B_OK)
+				return status;
+
 #ifdef BFS_DEBUGGER_COMMANDS
 			add_debugger_commands();
 #endif
 			return B_OK;
+		}
 		case B_MODULE_UNINIT:
 #ifdef BFS_DEBUGGER_COMMANDS
 			remove_debugger_commands();
 #endif
+			NameCache::UninitGlobal();
 			return B_OK;
 
 		default:
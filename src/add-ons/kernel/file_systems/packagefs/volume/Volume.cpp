@@ -24,6 +24,7 @@
 #include <AutoDeleter.h>
 #include <PackagesDirectoryDefs.h>
 
+#include <smp.h>
 #include <vfs.h>
 
 #include "AttributeIndex.h"
@@ -61,6 +62,12 @@ const size_t kMaxActivationRequestSize = 10 * 1024 * 1024;
 // sanity limit for activation file size
 const size_t kMaxActivationFileSize = 10 * 1024 * 1024;
 
+// maximum number of threads loading the initial packages
+static const int32 kMaxInitialPackageLoaderThreads = 8;
+
+// loading or adding a package taking longer is always reported at mount time
+static const bigtime_t kSlowPackageTime = 50000;
+
 static const char* const kAdministrativeDirectoryName
 	= PACKAGES_DIRECTORY_ADMIN_DIRECTORY;
 static const char* const kActivationFileName
@@ -70,6 +77,19 @@ static const char* const kActivationFilePath
 		PACKAGES_DIRECTORY_ACTIVATION_FILE;
 
 
+static void
+report_package_time(const char* name, const char* phase, bigtime_t time)
+{
+	if (time >= kSlowPackageTime) {
+		INFORM("Package \"%s\": %s took %" B_PRIdBIGTIME " ms\n", name, phase,
+			time / 1000);
+	} else {
+		PRINT("Package \"%s\": %s took %" B_PRIdBIGTIME " us\n", name, phase,
+			time);
+	}
+}
+
+
 // #pragma mark - ShineThroughDirectory
 
 
@@ -159,6 +179,157 @@ private:
 };
 
 
+// #pragma mark - InitialPackageLoader
+
+
+/*!	Loads the packages the volume is mounted with. Reading the package headers
+	and TOCs doesn't touch the volume, so a few threads do that in parallel;
+	the packages are added to the volume in their original order afterwards.
+*/
+struct Volume::InitialPackageLoader {
+public:
+	InitialPackageLoader(Volume* volume, PackagesDirectory* packagesDirectory)
+		:
+		fVolume(volume),
+		fPackagesDirectory(packagesDirectory),
+		fEntries(NULL),
+		fCount(0),
+		fCapacity(0),
+		fNextEntry(0),
+		fThreadCount(0)
+	{
+	}
+
+	~InitialPackageLoader()
+	{
+		for (int32 i = 0; i < fCount; i++) {
+			if (fEntries[i].package != NULL)
+				fEntries[i].package->ReleaseReference();
+		}
+		free(fEntries);
+	}
+
+	status_t AddPackage(const char* name)
+	{
+		if (strlen(name) >= B_FILE_NAME_LENGTH)
+			RETURN_ERROR(B_NAME_TOO_LONG);
+
+		if (fCount == fCapacity) {
+			int32 capacity = fCapacity > 0 ? fCapacity * 2 : 64;
+			Entry* entries = (Entry*)realloc(fEntries,
+				capacity * sizeof(Entry));
+			if (entries == NULL)
+				RETURN_ERROR(B_NO_MEMORY);
+			fEntries = entries;
+			fCapacity = capacity;
+		}
+
+		Entry& entry = fEntries[fCount++];
+		strlcpy(entry.name, name, sizeof(entry.name));
+		entry.package = NULL;
+		entry.error = B_NO_INIT;
+		entry.loadTime = 0;
+		return B_OK;
+	}
+
+	void Load()
+	{
+		int32 threadCount = min_c(min_c(smp_get_num_cpus(),
+			kMaxInitialPackageLoaderThreads), fCount);
+
+		thread_id threads[kMaxInitialPackageLoaderThreads];
+		int32 spawnedCount = 0;
+		for (int32 i = 1; i < threadCount; i++) {
+			thread_id thread = spawn_kernel_thread(&_LoaderThreadEntry,
+				"packagefs package loader", B_NORMAL_PRIORITY, this);
+			if (thread < 0)
+				break;
+
+			threads[spawnedCount++] = thread;
+			resume_thread(thread);
+		}
+
+		// the current thread does its share as well
+		_Load();
+
+		for (int32 i = 0; i < spawnedCount; i++)
+			wait_for_thread(threads[i], NULL);
+
+		fThreadCount = spawnedCount + 1;
+	}
+
+	int32 CountPackages() const
+	{
+		return fCount;
+	}
+
+	int32 ThreadCount() const
+	{
+		return fThreadCount;
+	}
+
+	const char* NameAt(int32 index) const
+	{
+		return fEntries[index].name;
+	}
+
+	status_t ErrorAt(int32 index) const
+	{
+		return fEntries[index].error;
+	}
+
+	Package* PackageAt(int32 index) const
+	{
+		return fEntries[index].package;
+	}
+
+	bigtime_t LoadTimeAt(int32 index) const
+	{
+		return fEntries[index].loadTime;
+	}
+
+private:
+	struct Entry {
+		char		name[B_FILE_NAME_LENGTH];
+		Package*	package;
+		status_t	error;
+		bigtime_t	loadTime;
+	};
+
+	static status_t _LoaderThreadEntry(void* data)
+	{
+		((InitialPackageLoader*)data)->_Load();
+		return B_OK;
+	}
+
+	void _Load()
+	{
+		for (;;) {
+			int32 index = atomic_add(&fNextEntry, 1);
+			if (index >= fCount)
+				return;
+
+			Entry& entry = fEntries[index];
+			bigtime_t startTime = system_time();
+			entry.error = fVolume->_LoadPackage(fPackagesDirectory, entry.name,
+				entry.package);
+			entry.loadTime = system_time() - startTime;
+			if (entry.error != B_OK)
+				entry.package = NULL;
+		}
+	}
+
+private:
+	Volume*				fVolume;
+	PackagesDirectory*	fPackagesDirectory;
+	Entry*				fEntries;
+	int32				fCount;
+	int32				fCapacity;
+	int32				fNextEntry;
+	int32				fThreadCount;
+};
+
+
 // #pragma mark - Volume
 
 
@@ -790,8 +961,10 @@ Volume::_AddInitialPackages()
 	// add the packages to the node tree
 	VolumeWriteLocker systemVolumeLocker(_SystemVolumeIfNotSelf());
 	VolumeWriteLocker volumeLocker(this);
+	bigtime_t startTime = system_time();
 	for (PackageFileNameHashTable::Iterator it = fPackages.GetIterator();
 		Package* package = it.Next();) {
+		bigtime_t packageStartTime = system_time();
 		error = _AddPackageContent(package, false);
 		if (error != B_OK) {
 			for (it.Rewind(); Package* activePackage = it.Next();) {
@@ -801,8 +974,14 @@ Volume::_AddInitialPackages()
 			}
 			RETURN_ERROR(error);
 		}
+		report_package_time(package->FileName(), "adding content",
+			system_time() - packageStartTime);
 	}
 
+	INFORM("Added content of %" B_PRId32 " packages in %" B_PRIdBIGTIME
+		" ms\n", (int32)fPackages.CountElements(),
+		(system_time() - startTime) / 1000);
+
 	return B_OK;
 }
 
@@ -855,7 +1034,8 @@ Volume::_AddInitialPackagesFromActivationFile(
 	// null-terminate to simplify parsing
 	fileContent[st.st_size] = '\0';
 
-	// parse the file and add the respective packages
+	// parse the file and load the respective packages
+	InitialPackageLoader loader(this, packagesDirectory);
 	const char* packageName = fileContent;
 	char* const fileContentEnd = fileContent + st.st_size;
 	while (packageName < fileContentEnd) {
@@ -875,15 +1055,14 @@ Volume::_AddInitialPackagesFromActivationFile(
 			RETURN_ERROR(B_BAD_DATA);
 		}
 
-		status_t error = _LoadAndAddInitialPackage(packagesDirectory,
-			packageName);
+		status_t error = loader.AddPackage(packageName);
 		if (error != B_OK)
 			RETURN_ERROR(error);
 
 		packageName = packageNameEnd + 1;
 	}
 
-	return B_OK;
+	return _LoadAndAddInitialPackages(loader, true);
 }
 
 
@@ -905,6 +1084,7 @@ Volume::_AddInitialPackagesFromDirectory()
 	}
 	CObjectDeleter<DIR, int> dirCloser(dir, closedir);
 
+	InitialPackageLoader loader(this, fPackagesDirectory);
 	while (dirent* entry = readdir(dir)) {
 		// skip "." and ".."
 		if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
@@ -917,28 +1097,48 @@ Volume::_AddInitialPackagesFromDirectory()
 			continue;
 		}
 
-		_LoadAndAddInitialPackage(fPackagesDirectory, entry->d_name);
+		status_t error = loader.AddPackage(entry->d_name);
+		if (error != B_OK)
+			RETURN_ERROR(error);
 	}
 
-	return B_OK;
+	return _LoadAndAddInitialPackages(loader, false);
 }
 
 
+/*!	Loads the packages of the given loader, and adds them to the volume.
+	If \a stopOnError is \c true, a package failing to load fails the whole
+	operation, otherwise the package is just skipped.
+*/
 status_t
-Volume::_LoadAndAddInitialPackage(PackagesDirectory* packagesDirectory,
-	const char* name)
+Volume::_LoadAndAddInitialPackages(InitialPackageLoader& loader,
+	bool stopOnError)
 {
-	Package* package;
-	status_t error = _LoadPackage(packagesDirectory, name, package);
-	if (error != B_OK) {
-		ERROR("Failed to load package \"%s\": %s\n", name, strerror(error));
-		RETURN_ERROR(error);
-	}
-	BReference<Package> packageReference(package, true);
+	bigtime_t startTime = system_time();
+	loader.Load();
+	bigtime_t loadTime = system_time() - startTime;
 
 	VolumeWriteLocker systemVolumeLocker(_SystemVolumeIfNotSelf());
 	VolumeWriteLocker volumeLocker(this);
-	_AddPackage(package);
+
+	int32 count = loader.CountPackages();
+	for (int32 i = 0; i < count; i++) {
+		const char* name = loader.NameAt(i);
+		status_t error = loader.ErrorAt(i);
+		if (error != B_OK) {
+			ERROR("Failed to load package \"%s\": %s\n", name,
+				strerror(error));
+			if (stopOnError)
+				RETURN_ERROR(error);
+			continue;
+		}
+
+		_AddPackage(loader.PackageAt(i));
+		report_package_time(name, "loading", loader.LoadTimeAt(i));
+	}
+
+	INFORM("Loaded %" B_PRId32 " packages in %" B_PRIdBIGTIME " ms using %"
+		B_PRId32 " threads\n", count, loadTime / 1000, loader.ThreadCount());
 
 	return B_OK;
 }
@@ -1918,12 +1918,12 @@ AudioMixer::UpdateParameterWeb()
 		B_TRANSLATE("Resampling algorithm"), B_INPUT_MUX);
 	dp->AddItem(0, B_TRANSLATE("Drop/repeat samples"));
 	dp->AddItem(2, B_TRANSLATE("Linear interpolation"));
+	dp->AddItem(3, B_TRANSLATE("Windowed sinc filtering"));
 
 	// Note: The following code is outcommented on purpose
 	// and is about to be modified at a later point
 	/*
 	dp->AddItem(1, B_TRANSLATE("Drop/repeat samples (template based)"));
-	dp->AddItem(3, B_TRANSLATE("17th order filtering"));
 	*/
 	group->MakeDiscreteParameter(PARAM_ETC(80), B_MEDIA_RAW_AUDIO,
 		B_TRANSLATE("Refuse output format changes"), B_ENABLE);
@@ -13,6 +13,7 @@
 #include <MediaDefs.h>
 
 #include "MixerDebug.h"
+#include "MixerKernels.h"
 
 
 /*! Resampling class doing linear interpolation.
@@ -32,6 +33,11 @@ kernel(Resampler* object, const void *_src, int32 srcSampleOffset,
 
 	if (srcSampleCount == destSampleCount) {
 		// optimized case for no resampling
+		if (convert_samples<inType, outType>(src, srcSampleOffset, dest,
+				destSampleOffset, count, gain)) {
+			return;
+		}
+
 		while (count--) {
 			float tmp = *(const inType*)src * gain + offset;
 			if (tmp < min) tmp = min;
@@ -24,10 +24,12 @@
 #include "AudioMixer.h"
 #include "Interpolate.h"
 #include "MixerInput.h"
+#include "MixerKernels.h"
 #include "MixerOutput.h"
 #include "MixerUtils.h"
 #include "Resampler.h"
 #include "RtList.h"
+#include "SincResampler.h"
 
 
 #define DOUBLE_RATE_MIXING 	0
@@ -45,6 +47,10 @@
 	The mixer buffer uses either the same frame rate and same count of frames as
 	the output buffer, or the double frame rate and frame count.
 
+	The mixer buffer, and the input ring buffers, are planar: each channel is
+	stored in its own contiguous block of frames, so that the inner loops can
+	use the vector kernels of MixerKernels.h.
+
 	All mixer input ring buffers must be an exact multiple of the mixer buffer
 	size, so that we do not get any buffer wrap around during reading from the
 	input buffers.
@@ -55,8 +61,7 @@
 
 
 struct chan_info {
-	const char 	*base;
-	uint32		sample_offset;
+	const float	*base;
 	float		gain;
 };
 
@@ -410,10 +415,15 @@ MixerCore::_UpdateResamplers(const media_multi_audio_format& format)
 				fResampler[i] = new Interpolate(
 					media_raw_audio_format::B_AUDIO_FLOAT, format.format);
 				break;
+			case 3:
+				fResampler[i] = new SincResampler(
+					media_raw_audio_format::B_AUDIO_FLOAT, format.format);
+				break;
 			default:
 				fResampler[i] = new Resampler(
 					media_raw_audio_format::B_AUDIO_FLOAT, format.format);
 		}
+		fResampler[i]->SetFrameRates(fMixBufferFrameRate, format.frame_rate);
 	}
 }
 
@@ -599,17 +609,15 @@ MixerCore::_MixThread()
 			for (int channel = 0; channel < count; channel++) {
 				int type;
 				const float* base;
-				uint32 sampleOffset;
 				float gain;
 				if (!input->GetMixerChannelInfo(channel, currentFramePos,
-						fEventTime, &base, &sampleOffset, &type, &gain)) {
+						fEventTime, &base, &type, &gain)) {
 					continue;
 				}
 				if (type < 0 || type >= MAX_CHANNEL_TYPES)
 					continue;
 				chan_info* info = inputChanInfos[type].Create();
-				info->base = (const char*)base;
-				info->sample_offset = sampleOffset;
+				info->base = base;
 				info->gain = gain;
 			}
 		}
@@ -628,38 +636,26 @@ MixerCore::_MixThread()
 					chan_info* info = inputChanInfos[type].ItemAt(j);
 					chan_info* newInfo = mixChanInfos[channel].Create();
 					newInfo->base = info->base;
-					newInfo->sample_offset = info->sample_offset;
 					newInfo->gain = info->gain * gain;
 				}
 			}
 		}
 
+		const mixer_kernels& kernels = get_mixer_kernels();
 		memset(fMixBuffer, 0,
 			fMixBufferChannelCount * fMixBufferFrameCount * sizeof(float));
 		for (int channel = 0; channel < fMixBufferChannelCount; channel++) {
 			PRINT(5, "_MixThread: channel %d has %d sources\n", channel,
 				mixChanInfos[channel].CountItems());
 
+			float* dest = &fMixBuffer[channel * fMixBufferFrameCount];
 			int count = mixChanInfos[channel].CountItems();
 			for (int i = 0; i < count; i++) {
 				chan_info* info = mixChanInfos[channel].ItemAt(i);
-				PRINT(5, "_MixThread:   base %p, sample-offset %2d, gain %.3f\n",
-					info->base, info->sample_offset, info->gain);
-				// This looks slightly ugly, but the current GCC will generate
-				// the fastest code this way.
-				// fMixBufferFrameCount is always > 0.
-				uint32 dstSampleOffset
-					= fMixBufferChannelCount * sizeof(float);
-				uint32 srcSampleOffset = info->sample_offset;
-				register char* dst = (char*)&fMixBuffer[channel];
-				register char* src = (char*)info->base;
-				register float gain = info->gain;
-				register int j = fMixBufferFrameCount;
-				do {
-					*(float*)dst += *(const float*)src * gain;
-					dst += dstSampleOffset;
-					src += srcSampleOffset;
-				 } while (--j);
+				PRINT(5, "_MixThread:   base %p, gain %.3f\n", info->base,
+					info->gain);
+				kernels.mix_add(dest, info->base, fMixBufferFrameCount,
+					info->gain);
 			}
 		}
 
@@ -672,8 +668,7 @@ MixerCore::_MixThread()
 			// copy data from mix buffer into output buffer
 			for (int i = 0; i < fMixBufferChannelCount; i++) {
 				fResampler[i]->Resample(
-					reinterpret_cast<char*>(fMixBuffer) + i * sizeof(float),
-					fMixBufferChannelCount * sizeof(float),
+					&fMixBuffer[i * fMixBufferFrameCount], sizeof(float),
 					fMixBufferFrameCount,
 					reinterpret_cast<char*>(buffer->Data())
 						+ (i * bytes_per_sample(
@@ -18,6 +18,7 @@
 #include "MixerInput.h"
 #include "MixerUtils.h"
 #include "Resampler.h"
+#include "SincResampler.h"
 
 
 MixerInput::MixerInput(MixerCore* core, const media_input& input,
@@ -257,7 +258,7 @@ MixerInput::BufferReceived(BBuffer* buffer)
 		fLastDataFrameWritten = out_frames2 - 1;
 
 		// convert offset from frames into bytes
-		offset *= sizeof(float) * fInputChannelCount;
+		offset *= sizeof(float);
 
 		for (int i = 0; i < fInputChannelCount; i++) {
 			fResampler[i]->Resample(
@@ -265,7 +266,7 @@ MixerInput::BufferReceived(BBuffer* buffer)
 					+ i * bytes_per_sample(fInput.format.u.raw_audio),
 				bytes_per_frame(fInput.format.u.raw_audio), in_frames1,
 				reinterpret_cast<char*>(fInputChannelInfo[i].buffer_base)
-					+ offset, fInputChannelCount * sizeof(float), out_frames1,
+					+ offset, sizeof(float), out_frames1,
 				fInputChannelInfo[i].gain);
 
 			fResampler[i]->Resample(
@@ -274,7 +275,7 @@ MixerInput::BufferReceived(BBuffer* buffer)
 					+ in_frames1 * bytes_per_frame(fInput.format.u.raw_audio),
 				bytes_per_frame(fInput.format.u.raw_audio), in_frames2,
 				reinterpret_cast<char*>(fInputChannelInfo[i].buffer_base),
-				fInputChannelCount * sizeof(float), out_frames2,
+				sizeof(float), out_frames2,
 				fInputChannelInfo[i].gain);
 
 		}
@@ -293,15 +294,15 @@ MixerInput::BufferReceived(BBuffer* buffer)
 
 		fLastDataFrameWritten = offset + out_frames - 1;
 		// convert offset from frames into bytes
-		offset *= sizeof(float) * fInputChannelCount;
+		offset *= sizeof(float);
 		for (int i = 0; i < fInputChannelCount; i++) {
 			fResampler[i]->Resample(
 				reinterpret_cast<char*>(data)
 					+ i * bytes_per_sample(fInput.format.u.raw_audio),
 				bytes_per_frame(fInput.format.u.raw_audio), in_frames,
 				reinterpret_cast<char*>(fInputChannelInfo[i].buffer_base)
-					+ offset, fInputChannelCount * sizeof(float),
-				out_frames, fInputChannelInfo[i].gain);
+					+ offset, sizeof(float), out_frames,
+				fInputChannelInfo[i].gain);
 		}
 	}
 	fLastDataAvailableTime = start + buffer_duration;
@@ -325,11 +326,20 @@ MixerInput::UpdateResamplingAlgorithm()
 					fInput.format.u.raw_audio.format,
 					media_raw_audio_format::B_AUDIO_FLOAT);
 				break;
+			case 3:
+				fResampler[i] = new SincResampler(
+					fInput.format.u.raw_audio.format,
+					media_raw_audio_format::B_AUDIO_FLOAT);
+				break;
 			default:
 				fResampler[i] = new Resampler(
 					fInput.format.u.raw_audio.format,
 					media_raw_audio_format::B_AUDIO_FLOAT);
 		}
+		if (fMixBufferFrameRate != 0) {
+			fResampler[i]->SetFrameRates(fInput.format.u.raw_audio.frame_rate,
+				fMixBufferFrameRate);
+		}
 	}
 }
 
@@ -557,8 +567,8 @@ MixerInput::_UpdateInputChannelDestinations()
 			if (fInputChannelInfo[j].destination_mask
 					& ChannelTypeToChannelMask(
 						fMixerChannelInfo[i].destination_type)) {
-				fMixerChannelInfo[i].buffer_base = fMixBuffer ? &fMixBuffer[j]
-					: 0;
+				fMixerChannelInfo[i].buffer_base = fMixBuffer
+					? &fMixBuffer[j * fMixBufferFrameCount] : 0;
 				break;
 			}
 		}
@@ -676,6 +686,13 @@ MixerInput::SetMixBufferFormat(int32 framerate, int32 frames)
 	fMixBufferFrameRate = framerate;
 	fDebugMixBufferFrames = frames;
 
+	if (framerate != 0) {
+		for (int i = 0; i < fInputChannelCount; i++) {
+			fResampler[i]->SetFrameRates(fInput.format.u.raw_audio.frame_rate,
+				framerate);
+		}
+	}
+
 	// frames and/or framerate can be 0 (if no output is connected)
 	if (framerate == 0 || frames == 0) {
 		if (fMixBuffer != NULL) {
@@ -726,8 +743,11 @@ MixerInput::SetMixBufferFormat(int32 framerate, int32 frames)
 
 	memset(fMixBuffer, 0, size);
 
-	for (int i = 0; i < fInputChannelCount; i++)
-		fInputChannelInfo[i].buffer_base = &fMixBuffer[i];
+	// every channel gets its own contiguous part of the buffer
+	for (int i = 0; i < fInputChannelCount; i++) {
+		fInputChannelInfo[i].buffer_base
+			= &fMixBuffer[i * fMixBufferFrameCount];
+	}
 
 	_UpdateInputChannelDestinationMask();
 	_UpdateInputChannelDestinations();
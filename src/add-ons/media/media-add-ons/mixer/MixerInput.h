@@ -65,8 +65,7 @@ public:
 	// only for use by MixerCore
 			bool				GetMixerChannelInfo(int mixerChannel,
 									int64 framepos, bigtime_t time,
-									const float** _buffer,
-									uint32* _sampleOffset, int* _type,
+									const float** _buffer, int* _type,
 									float* _gain);
 
 protected:
@@ -124,8 +123,7 @@ MixerInput::GetMixerChannelCount()
 
 inline bool
 MixerInput::GetMixerChannelInfo(int mixerChannel, int64 framepos,
-	bigtime_t time, const float** buffer, uint32* sampleOffset, int* type,
-	float* gain)
+	bigtime_t time, const float** buffer, int* type, float* gain)
 {
 	// this function should not be called if we don't have a mix buffer!
 	ASSERT(fMixBuffer != NULL);
@@ -158,10 +156,7 @@ MixerInput::GetMixerChannelInfo(int mixerChannel, int64 framepos,
 		PRINT(3, "GetMixerChannelInfo: frames %ld to %ld\n", offset,
 			offset + fDebugMixBufferFrames - 1);
 	}
-	*buffer = reinterpret_cast<float*>(reinterpret_cast<char*>(
-		fMixerChannelInfo[mixerChannel].buffer_base)
-		+ (offset * sizeof(float) * fInputChannelCount));
-	*sampleOffset = sizeof(float) * fInputChannelCount;
+	*buffer = fMixerChannelInfo[mixerChannel].buffer_base + offset;
 	*type = fMixerChannelInfo[mixerChannel].destination_type;
 	*gain = fMixerChannelInfo[mixerChannel].destination_gain;
 	return true;
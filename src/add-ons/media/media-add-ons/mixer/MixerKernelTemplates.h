@@ -0,0 +1,227 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _MIXER_KERNEL_TEMPLATES_H
+#define _MIXER_KERNEL_TEMPLATES_H
+
+
+#include <stdint.h>
+
+#include "MixerKernels.h"
+
+
+/*	The kernels below are instantiated once per vector extension, and once
+	with ScalarVector for the generic versions. A Vector class provides:
+		Type			the vector type
+		kCount			the number of floats in a vector
+		Load()			loads a vector from any address
+		Store()			stores a vector to any address
+		Broadcast()		creates a vector with all elements set to a value
+		Add(), Mul(), Min(), Max()
+						the element wise operations
+		Sum()			adds up the elements of a vector
+		FromInt32()		loads and converts a vector of int32 values
+		ToInt32()		converts (truncating) and stores a vector as int32
+						values
+*/
+
+
+namespace {
+
+
+struct ScalarVector {
+	typedef float Type;
+	static const int32 kCount = 1;
+
+	static inline Type Load(const float* address) { return *address; }
+	static inline void Store(float* address, Type value) { *address = value; }
+	static inline Type Broadcast(float value) { return value; }
+	static inline Type Add(Type a, Type b) { return a + b; }
+	static inline Type Mul(Type a, Type b) { return a * b; }
+	static inline Type Min(Type a, Type b) { return a < b ? a : b; }
+	static inline Type Max(Type a, Type b) { return a > b ? a : b; }
+	static inline float Sum(Type value) { return value; }
+	static inline Type FromInt32(const int32* address) { return *address; }
+	static inline void ToInt32(int32* address, Type value)
+		{ *address = (int32)value; }
+};
+
+
+// The range the samples are clamped to, as in Resampler
+template<typename sampleType>
+struct SampleLimits {
+};
+
+template<>
+struct SampleLimits<float> {
+	static inline float Min() { return -1.0f; }
+	static inline float Max() { return 1.0f; }
+};
+
+template<>
+struct SampleLimits<int32> {
+	static inline float Min() { return (float)INT32_MIN; }
+	static inline float Max() { return 2147483520.0f; }
+		// INT32_MAX is rounded up to 2^31 as a float, which would overflow
+		// to INT32_MIN when converted
+};
+
+template<>
+struct SampleLimits<int16> {
+	static inline float Min() { return (float)INT16_MIN; }
+	static inline float Max() { return (float)INT16_MAX; }
+};
+
+
+// Moves a vector of samples from and to interleaved data
+template<typename Vector, typename sampleType>
+struct Interleaved {
+	static inline typename Vector::Type Gather(const char*& source,
+		int32 sampleOffset)
+	{
+		int32 values[Vector::kCount];
+		for (int32 i = 0; i < Vector::kCount; i++) {
+			values[i] = *(const sampleType*)source;
+			source += sampleOffset;
+		}
+		return Vector::FromInt32(values);
+	}
+
+	static inline void Scatter(typename Vector::Type value, char*& dest,
+		int32 sampleOffset)
+	{
+		int32 values[Vector::kCount];
+		Vector::ToInt32(values, value);
+		for (int32 i = 0; i < Vector::kCount; i++) {
+			*(sampleType*)dest = (sampleType)values[i];
+			dest += sampleOffset;
+		}
+	}
+};
+
+template<typename Vector>
+struct Interleaved<Vector, float> {
+	static inline typename Vector::Type Gather(const char*& source,
+		int32 sampleOffset)
+	{
+		float values[Vector::kCount];
+		for (int32 i = 0; i < Vector::kCount; i++) {
+			values[i] = *(const float*)source;
+			source += sampleOffset;
+		}
+		return Vector::Load(values);
+	}
+
+	static inline void Scatter(typename Vector::Type value, char*& dest,
+		int32 sampleOffset)
+	{
+		float values[Vector::kCount];
+		Vector::Store(values, value);
+		for (int32 i = 0; i < Vector::kCount; i++) {
+			*(float*)dest = values[i];
+			dest += sampleOffset;
+		}
+	}
+};
+
+
+template<typename Vector>
+static void
+mix_add(float* dest, const float* source, int32 count, float gain)
+{
+	const typename Vector::Type factor = Vector::Broadcast(gain);
+
+	int32 i = 0;
+	for (; i + Vector::kCount <= count; i += Vector::kCount) {
+		Vector::Store(dest + i, Vector::Add(Vector::Load(dest + i),
+			Vector::Mul(Vector::Load(source + i), factor)));
+	}
+	for (; i < count; i++)
+		dest[i] += source[i] * gain;
+}
+
+
+template<typename Vector>
+static float
+dot_product(const float* a, const float* b, int32 count)
+{
+	typename Vector::Type sum = Vector::Broadcast(0.0f);
+
+	int32 i = 0;
+	for (; i + Vector::kCount <= count; i += Vector::kCount) {
+		sum = Vector::Add(sum,
+			Vector::Mul(Vector::Load(a + i), Vector::Load(b + i)));
+	}
+
+	float result = Vector::Sum(sum);
+	for (; i < count; i++)
+		result += a[i] * b[i];
+	return result;
+}
+
+
+template<typename Vector, typename outType>
+static void
+float_to(const float* source, void* _dest, int32 destSampleOffset,
+	int32 count, float gain)
+{
+	typedef SampleLimits<outType> Limits;
+	char* dest = (char*)_dest;
+	const typename Vector::Type factor = Vector::Broadcast(gain);
+	const typename Vector::Type low = Vector::Broadcast(Limits::Min());
+	const typename Vector::Type high = Vector::Broadcast(Limits::Max());
+
+	int32 i = 0;
+	for (; i + Vector::kCount <= count; i += Vector::kCount) {
+		typename Vector::Type value = Vector::Mul(Vector::Load(source + i),
+			factor);
+		value = Vector::Min(Vector::Max(value, low), high);
+		Interleaved<Vector, outType>::Scatter(value, dest, destSampleOffset);
+	}
+	for (; i < count; i++) {
+		float value = source[i] * gain;
+		if (value < Limits::Min())
+			value = Limits::Min();
+		if (value > Limits::Max())
+			value = Limits::Max();
+		*(outType*)dest = (outType)value;
+		dest += destSampleOffset;
+	}
+}
+
+
+template<typename Vector, typename inType>
+static void
+float_from(const void* _source, int32 sourceSampleOffset, float* dest,
+	int32 count, float gain)
+{
+	typedef SampleLimits<float> Limits;
+	const char* source = (const char*)_source;
+	const typename Vector::Type factor = Vector::Broadcast(gain);
+	const typename Vector::Type low = Vector::Broadcast(Limits::Min());
+	const typename Vector::Type high = Vector::Broadcast(Limits::Max());
+
+	int32 i = 0;
+	for (; i + Vector::kCount <= count; i += Vector::kCount) {
+		typename Vector::Type value = Vector::Mul(
+			Interleaved<Vector, inType>::Gather(source, sourceSampleOffset),
+			factor);
+		Vector::Store(dest + i, Vector::Min(Vector::Max(value, low), high));
+	}
+	for (; i < count; i++) {
+		float value = *(const inType*)source * gain;
+		if (value < Limits::Min())
+			value = Limits::Min();
+		if (value > Limits::Max())
+			value = Limits::Max();
+		dest[i] = value;
+		source += sourceSampleOffset;
+	}
+}
+
+
+}	// namespace
+
+
+#endif	// _MIXER_KERNEL_TEMPLATES_H
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	The generic versions of the mixer kernels, and the selection of the
+	fastest ones the CPU supports. On x86_64, SSE2 is always available; the
+	AVX versions are chosen once, on first use, if both the CPU and the
+	kernel support them.
+*/
+
+
+#include "MixerKernels.h"
+
+#ifdef __x86_64__
+#	include <cpuid.h>
+#endif
+
+#include "MixerKernelTemplates.h"
+
+
+const mixer_kernels gMixerKernelsGeneric = {
+	"generic",
+	&mix_add<ScalarVector>,
+	&dot_product<ScalarVector>,
+	&float_to<ScalarVector, float>,
+	&float_to<ScalarVector, int32>,
+	&float_to<ScalarVector, int16>,
+	&float_from<ScalarVector, float>,
+	&float_from<ScalarVector, int32>,
+	&float_from<ScalarVector, int16>
+};
+
+
+static const mixer_kernels* sMixerKernels = NULL;
+
+
+#ifdef __x86_64__
+
+
+static bool
+has_avx()
+{
+	unsigned int eax, ebx, ecx, edx;
+	__cpuid(1, eax, ebx, ecx, edx);
+	if ((ecx & bit_OSXSAVE) == 0 || (ecx & bit_AVX) == 0)
+		return false;
+
+	// the kernel must save the upper halves of the YMM registers as well
+	unsigned int xcr0Low, xcr0High;
+	__asm__ __volatile__("xgetbv" : "=a" (xcr0Low), "=d" (xcr0High) : "c" (0));
+	return (xcr0Low & 0x6) == 0x6;
+}
+
+
+#endif	// __x86_64__
+
+
+static const mixer_kernels*
+select_mixer_kernels()
+{
+	// Threads racing here all come to the same result, so there is no need
+	// for any locking.
+	const mixer_kernels* kernels = &gMixerKernelsGeneric;
+#ifdef __x86_64__
+	kernels = has_avx() ? &gMixerKernelsAVX : &gMixerKernelsSSE2;
+#endif
+
+	sMixerKernels = kernels;
+	return kernels;
+}
+
+
+const mixer_kernels&
+get_mixer_kernels()
+{
+	const mixer_kernels* kernels = sMixerKernels;
+	if (kernels == NULL)
+		kernels = select_mixer_kernels();
+	return *kernels;
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _MIXER_KERNELS_H
+#define _MIXER_KERNELS_H
+
+
+#include <SupportDefs.h>
+
+
+/*!	The inner loops of the mixer. They work on planar float data, that is
+	one contiguous array per channel, and convert from and to the interleaved
+	data of the inputs and the output. As in Resampler, the sample offsets
+	are the distance in bytes between two samples of the same channel.
+
+	The conversions multiply by gain, and clamp the result to the range of
+	the destination format.
+*/
+struct mixer_kernels {
+	const char*	name;
+
+	// dest[i] += source[i] * gain
+	void		(*mix_add)(float* dest, const float* source, int32 count,
+					float gain);
+	float		(*dot_product)(const float* a, const float* b, int32 count);
+
+	// planar to interleaved
+	void		(*float_to_float)(const float* source, void* dest,
+					int32 destSampleOffset, int32 count, float gain);
+	void		(*float_to_int32)(const float* source, void* dest,
+					int32 destSampleOffset, int32 count, float gain);
+	void		(*float_to_int16)(const float* source, void* dest,
+					int32 destSampleOffset, int32 count, float gain);
+
+	// interleaved to planar
+	void		(*float_from_float)(const void* source,
+					int32 sourceSampleOffset, float* dest, int32 count,
+					float gain);
+	void		(*float_from_int32)(const void* source,
+					int32 sourceSampleOffset, float* dest, int32 count,
+					float gain);
+	void		(*float_from_int16)(const void* source,
+					int32 sourceSampleOffset, float* dest, int32 count,
+					float gain);
+};
+
+
+extern const mixer_kernels gMixerKernelsGeneric;
+#ifdef __x86_64__
+extern const mixer_kernels gMixerKernelsSSE2;
+extern const mixer_kernels gMixerKernelsAVX;
+#endif
+
+
+const mixer_kernels& get_mixer_kernels();
+
+
+/*!	Converts \a count samples without resampling, if there is a kernel for
+	the formats and the layout. Either the source or the destination needs
+	to be planar float data. Returns \c false if the caller has to do the
+	conversion itself.
+*/
+template<typename inType, typename outType>
+static inline bool
+convert_samples(const char* source, int32 sourceSampleOffset, char* dest,
+	int32 destSampleOffset, int32 count, float gain)
+{
+	return false;
+}
+
+
+template<>
+inline bool
+convert_samples<float, float>(const char* source, int32 sourceSampleOffset,
+	char* dest, int32 destSampleOffset, int32 count, float gain)
+{
+	if (sourceSampleOffset == sizeof(float)) {
+		get_mixer_kernels().float_to_float((const float*)source, dest,
+			destSampleOffset, count, gain);
+		return true;
+	}
+	if (destSampleOffset == sizeof(float)) {
+		get_mixer_kernels().float_from_float(source, sourceSampleOffset,
+			(float*)dest, count, gain);
+		return true;
+	}
+	return false;
+}
+
+
+template<>
+inline bool
+convert_samples<float, int32>(const char* source, int32 sourceSampleOffset,
+	char* dest, int32 destSampleOffset, int32 count, float gain)
+{
+	if (sourceSampleOffset != sizeof(float))
+		return false;
+
+	get_mixer_kernels().float_to_int32((const float*)source, dest,
+		destSampleOffset, count, gain);
+	return true;
+}
+
+
+template<>
+inline bool
+convert_samples<float, int16>(const char* source, int32 sourceSampleOffset,
+	char* dest, int32 destSampleOffset, int32 count, float gain)
+{
+	if (sourceSampleOffset != sizeof(float))
+		return false;
+
+	get_mixer_kernels().float_to_int16((const float*)source, dest,
+		destSampleOffset, count, gain);
+	return true;
+}
+
+
+template<>
+inline bool
+convert_samples<int32, float>(const char* source, int32 sourceSampleOffset,
+	char* dest, int32 destSampleOffset, int32 count, float gain)
+{
+	if (destSampleOffset != sizeof(float))
+		return false;
+
+	get_mixer_kernels().float_from_int32(source, sourceSampleOffset,
+		(float*)dest, count, gain);
+	return true;
+}
+
+
+template<>
+inline bool
+convert_samples<int16, float>(const char* source, int32 sourceSampleOffset,
+	char* dest, int32 destSampleOffset, int32 count, float gain)
+{
+	if (destSampleOffset != sizeof(float))
+		return false;
+
+	get_mixer_kernels().float_from_int16(source, sourceSampleOffset,
+		(float*)dest, count, gain);
+	return true;
+}
+
+
+#endif	// _MIXER_KERNELS_H
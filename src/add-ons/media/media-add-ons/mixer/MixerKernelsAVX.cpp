@@ -0,0 +1,66 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "MixerKernels.h"
+
+#include <immintrin.h>
+
+#include "MixerKernelTemplates.h"
+
+
+namespace {
+
+
+struct AVXVector {
+	typedef __m256 Type;
+	static const int32 kCount = 8;
+
+	static inline Type Load(const float* address)
+		{ return _mm256_loadu_ps(address); }
+	static inline void Store(float* address, Type value)
+		{ _mm256_storeu_ps(address, value); }
+	static inline Type Broadcast(float value) { return _mm256_set1_ps(value); }
+	static inline Type Add(Type a, Type b) { return _mm256_add_ps(a, b); }
+	static inline Type Mul(Type a, Type b) { return _mm256_mul_ps(a, b); }
+	static inline Type Min(Type a, Type b) { return _mm256_min_ps(a, b); }
+	static inline Type Max(Type a, Type b) { return _mm256_max_ps(a, b); }
+
+	static inline float Sum(Type value)
+	{
+		__m128 sum = _mm_add_ps(_mm256_castps256_ps128(value),
+			_mm256_extractf128_ps(value, 1));
+		sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+		sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+		return _mm_cvtss_f32(sum);
+	}
+
+	static inline Type FromInt32(const int32* address)
+	{
+		return _mm256_cvtepi32_ps(
+			_mm256_loadu_si256((const __m256i*)address));
+	}
+
+	static inline void ToInt32(int32* address, Type value)
+	{
+		_mm256_storeu_si256((__m256i*)address, _mm256_cvttps_epi32(value));
+	}
+};
+
+
+}	// namespace
+
+
+const mixer_kernels gMixerKernelsAVX = {
+	"AVX",
+	&mix_add<AVXVector>,
+	&dot_product<AVXVector>,
+	&float_to<AVXVector, float>,
+	&float_to<AVXVector, int32>,
+	&float_to<AVXVector, int16>,
+	&float_from<AVXVector, float>,
+	&float_from<AVXVector, int32>,
+	&float_from<AVXVector, int16>
+};
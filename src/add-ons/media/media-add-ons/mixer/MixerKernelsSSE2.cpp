@@ -0,0 +1,63 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "MixerKernels.h"
+
+#include <emmintrin.h>
+
+#include "MixerKernelTemplates.h"
+
+
+namespace {
+
+
+struct SSE2Vector {
+	typedef __m128 Type;
+	static const int32 kCount = 4;
+
+	static inline Type Load(const float* address)
+		{ return _mm_loadu_ps(address); }
+	static inline void Store(float* address, Type value)
+		{ _mm_storeu_ps(address, value); }
+	static inline Type Broadcast(float value) { return _mm_set1_ps(value); }
+	static inline Type Add(Type a, Type b) { return _mm_add_ps(a, b); }
+	static inline Type Mul(Type a, Type b) { return _mm_mul_ps(a, b); }
+	static inline Type Min(Type a, Type b) { return _mm_min_ps(a, b); }
+	static inline Type Max(Type a, Type b) { return _mm_max_ps(a, b); }
+
+	static inline float Sum(Type value)
+	{
+		value = _mm_add_ps(value, _mm_movehl_ps(value, value));
+		value = _mm_add_ss(value, _mm_shuffle_ps(value, value, 1));
+		return _mm_cvtss_f32(value);
+	}
+
+	static inline Type FromInt32(const int32* address)
+	{
+		return _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)address));
+	}
+
+	static inline void ToInt32(int32* address, Type value)
+	{
+		_mm_storeu_si128((__m128i*)address, _mm_cvttps_epi32(value));
+	}
+};
+
+
+}	// namespace
+
+
+const mixer_kernels gMixerKernelsSSE2 = {
+	"SSE2",
+	&mix_add<SSE2Vector>,
+	&dot_product<SSE2Vector>,
+	&float_to<SSE2Vector, float>,
+	&float_to<SSE2Vector, int32>,
+	&float_to<SSE2Vector, int16>,
+	&float_from<SSE2Vector, float>,
+	&float_from<SSE2Vector, int32>,
+	&float_from<SSE2Vector, int16>
+};
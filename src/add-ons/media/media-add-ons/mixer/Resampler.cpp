@@ -9,6 +9,7 @@
 #include <MediaDefs.h>
 
 #include "MixerDebug.h"
+#include "MixerKernels.h"
 
 
 /*!	A simple resampling class for the audio mixer.
@@ -32,6 +33,11 @@ kernel(Resampler* object, const void *_src, int32 srcSampleOffset,
 
 	if (srcSampleCount == destSampleCount) {
 		// optimized case for no resampling
+		if (convert_samples<inType, outType>(src, srcSampleOffset, dest,
+				destSampleOffset, count, gain)) {
+			return;
+		}
+
 		while (count--) {
 			float tmp = *(const inType*)src * gain + offset;
 			if (tmp < min) tmp = min;
@@ -128,3 +134,17 @@ Resampler::Resampler()
 }
 
 
+Resampler::~Resampler()
+{
+}
+
+
+/*!	Lets the resampler prepare for the given frame rates. It is called
+	whenever the format changes, never from the realtime thread.
+*/
+void
+Resampler::SetFrameRates(float sourceRate, float destRate)
+{
+}
+
+
@@ -13,9 +13,13 @@ class Resampler {
 public:
 								Resampler(uint32 sourceFormat,
 									uint32 destFormat);
+	virtual						~Resampler();
 
 			status_t			InitCheck() const;
 
+	virtual	void				SetFrameRates(float sourceRate,
+									float destRate);
+
 			void				Resample(const void* src, int32 srcSampleOffset,
 									int32 srcSampleCount, void* dest,
 									int32 destSampleOffset,
@@ -0,0 +1,303 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "SincResampler.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <new>
+
+#include <MediaDefs.h>
+
+#include "MixerDebug.h"
+#include "MixerKernels.h"
+
+
+/*!	Resampling class using a polyphase windowed sinc filter.
+
+	Each output sample is computed from kTaps source samples, weighted by a
+	sinc function that is cut off by a Kaiser window. The weights for
+	kPhases positions between two source samples are computed in advance,
+	and interpolated linearly for the positions in between. When
+	downsampling, the cutoff frequency of the filter is lowered to the new
+	Nyquist frequency, so the table depends on the ratio of the frame
+	rates. It is computed when they are set, outside of the realtime path.
+
+	The filter delays the signal by kTaps / 2 source samples; the last
+	kTaps - 1 source samples are kept in front of the next buffer. All
+	memory is allocated up front; longer buffers are filtered in several
+	steps.
+*/
+
+
+static const int32 kTaps = 32;
+static const int32 kPhases = 64;
+static const double kKaiserBeta = 8.0;
+static const double kPassband = 0.95;
+	// of the cutoff frequency, leaving room for the transition band
+
+// The cutoff frequency is quantized to this many steps.
+static const int32 kCutoffSteps = 256;
+
+// source samples that are filtered in one step
+static const int32 kBufferSamples = 4096;
+
+
+static double
+bessel_i0(double x)
+{
+	double sum = 1.0;
+	double term = 1.0;
+	for (int32 k = 1; k < 50; k++) {
+		double factor = x / (2.0 * k);
+		term *= factor * factor;
+		sum += term;
+		if (term < sum * 1e-12)
+			break;
+	}
+	return sum;
+}
+
+
+template<typename inType, typename outType, int gnum, int gden, int offset,
+	int32 min, int32 max> static void
+kernel(Resampler* object, const void *_src, int32 srcSampleOffset,
+	int32 srcSampleCount, void *_dest, int32 destSampleOffset,
+	int32 destSampleCount, float _gain)
+{
+	SincResampler* resampler = (SincResampler*)object;
+	const char* src = (const char*)_src;
+	char* dest = (char*)_dest;
+	int32 count = destSampleCount;
+	float gain = _gain * gnum / gden;
+
+	if (!resampler->IsValid()) {
+		ERROR("SincResampler: out of memory\n");
+		return;
+	}
+
+	if (srcSampleCount == destSampleCount) {
+		// optimized case for no resampling
+		if (!convert_samples<inType, outType>(src, srcSampleOffset, dest,
+				destSampleOffset, count, gain)) {
+			while (count--) {
+				float tmp = *(const inType*)src * gain + offset;
+				if (tmp < min) tmp = min;
+				if (tmp > max) tmp = max;
+				*(outType *)dest = (outType)tmp;
+				src += srcSampleOffset;
+				dest += destSampleOffset;
+			}
+		}
+
+		// keep the history up to date, in case the next buffer is resampled
+		int32 keep = min_c(srcSampleCount, kTaps - 1);
+		float* history = resampler->Buffer();
+		memmove(history, history + keep, sizeof(float) * (kTaps - 1 - keep));
+		src = (const char*)_src + (srcSampleCount - keep) * srcSampleOffset;
+		for (int32 i = kTaps - 1 - keep; i < kTaps - 1; i++) {
+			history[i] = *(const inType*)src;
+			src += srcSampleOffset;
+		}
+		return;
+	}
+
+	// The filter is normalized, so gain and offset can be applied to its
+	// result.
+	float* buffer = resampler->Buffer() + kTaps - 1;
+	double delta = double(srcSampleCount) / double(destSampleCount);
+	int32 i = 0;
+	for (int32 base = 0; base < srcSampleCount;) {
+		// convert the source samples, and append them to the ones we kept
+		int32 sourceCount = min_c(srcSampleCount - base, kBufferSamples);
+		for (int32 j = 0; j < sourceCount; j++) {
+			buffer[j] = *(const inType*)src;
+			src += srcSampleOffset;
+		}
+
+		for (; i < destSampleCount; i++) {
+			double position = i * delta;
+			int32 index = (int32)position;
+			if (index >= base + sourceCount)
+				break;
+
+			float tmp = resampler->Filter(index - base, position - index)
+				* gain + offset;
+			if (tmp < min) tmp = min;
+			if (tmp > max) tmp = max;
+			*(outType *)dest = (outType)tmp;
+			dest += destSampleOffset;
+		}
+
+		resampler->KeepHistory(sourceCount);
+		base += sourceCount;
+	}
+}
+
+
+SincResampler::SincResampler(uint32 src_format, uint32 dst_format)
+	:
+	Resampler(),
+	fKernels(get_mixer_kernels()),
+	fTable(new(std::nothrow) float[(kPhases + 1) * kTaps]),
+	fTableCutoff(-1),
+	fBuffer(new(std::nothrow) float[kTaps - 1 + kBufferSamples])
+{
+	if (fBuffer != NULL)
+		memset(fBuffer, 0, sizeof(float) * (kTaps - 1));
+
+	// until the frame rates are known, expect them to be the same
+	_ComputeTable(kCutoffSteps);
+
+	if (dst_format == media_raw_audio_format::B_AUDIO_FLOAT) {
+		switch (src_format) {
+			case media_raw_audio_format::B_AUDIO_FLOAT:
+				fFunc = &kernel<float, float, 1, 1, 0, -1, 1>;
+				return;
+			case media_raw_audio_format::B_AUDIO_INT:
+				fFunc = &kernel<int32, float, 1, INT32_MAX, 0, -1, 1>;
+				return;
+			case media_raw_audio_format::B_AUDIO_SHORT:
+				fFunc = &kernel<int16, float, 1, INT16_MAX, 0, -1, 1>;
+				return;
+			case media_raw_audio_format::B_AUDIO_CHAR:
+				fFunc = &kernel<int8, float, 1, INT8_MAX, 0, -1, 1>;
+				return;
+			case media_raw_audio_format::B_AUDIO_UCHAR:
+				fFunc = &kernel<uint8, float, 2, UINT8_MAX, -128, -1, 1>;
+				return;
+			default:
+				ERROR("Resampler::Resampler: unknown source format 0x%x\n",
+					src_format);
+				return;
+		}
+	}
+
+	if (src_format == media_raw_audio_format::B_AUDIO_FLOAT) {
+		switch (dst_format) {
+			// float=>float already handled above
+			case media_raw_audio_format::B_AUDIO_INT:
+				fFunc = &kernel<float, int32, INT32_MAX, 1, 0,
+					INT32_MIN, INT32_MAX>;
+				return;
+			case media_raw_audio_format::B_AUDIO_SHORT:
+				fFunc = &kernel<float, int16, INT16_MAX, 1, 0,
+					INT16_MIN, INT16_MAX>;
+				return;
+			case media_raw_audio_format::B_AUDIO_CHAR:
+				fFunc = &kernel<float, int8, INT8_MAX, 1, 0,
+					INT8_MIN, INT8_MAX>;
+				return;
+			case media_raw_audio_format::B_AUDIO_UCHAR:
+				fFunc = &kernel<float, uint8, UINT8_MAX, 2, 1,
+					0, UINT8_MAX>;
+				return;
+			default:
+				ERROR("Resampler::Resampler: unknown destination format 0x%x\n",
+					dst_format);
+				return;
+		}
+	}
+
+	ERROR("Resampler::Resampler: source or destination format must be "
+		"B_AUDIO_FLOAT\n");
+}
+
+
+SincResampler::~SincResampler()
+{
+	delete[] fTable;
+	delete[] fBuffer;
+}
+
+
+/*!	Computes the filter table for the given frame rates. This must not be
+	called while the resampler is in use.
+*/
+void
+SincResampler::SetFrameRates(float sourceRate, float destRate)
+{
+	int32 cutoff = kCutoffSteps;
+	if (sourceRate > destRate && sourceRate > 0)
+		cutoff = (int32)(kCutoffSteps * destRate / sourceRate);
+
+	_ComputeTable(cutoff);
+}
+
+
+void
+SincResampler::_ComputeTable(int32 cutoff)
+{
+	if (fTable == NULL || cutoff == fTableCutoff)
+		return;
+
+	TRACE("SincResampler: computing filter for cutoff %ld/%ld\n", cutoff,
+		kCutoffSteps);
+
+	double frequency = kPassband * cutoff / kCutoffSteps;
+	double windowScale = 1.0 / bessel_i0(kKaiserBeta);
+
+	for (int32 phase = 0; phase <= kPhases; phase++) {
+		float* weights = fTable + phase * kTaps;
+		double fraction = double(phase) / kPhases;
+		double sum = 0.0;
+
+		for (int32 tap = 0; tap < kTaps; tap++) {
+			// the distance of the source sample to the output position
+			double x = tap - (kTaps / 2 - 1) - fraction;
+
+			double sinc = frequency;
+			if (x != 0.0)
+				sinc = sin(M_PI * frequency * x) / (M_PI * x);
+
+			double w = x / (kTaps / 2);
+			double window = 0.0;
+			if (w * w < 1.0)
+				window = bessel_i0(kKaiserBeta * sqrt(1.0 - w * w)) * windowScale;
+
+			weights[tap] = sinc * window;
+			sum += weights[tap];
+		}
+
+		// normalize, so that the filter does not change the volume
+		for (int32 tap = 0; tap < kTaps; tap++)
+			weights[tap] /= sum;
+	}
+
+	fTableCutoff = cutoff;
+}
+
+
+/*!	Returns the filtered sample at \a fraction behind the source sample at
+	\a position, delayed by kTaps / 2 samples.
+*/
+float
+SincResampler::Filter(int32 position, float fraction) const
+{
+	float phase = fraction * kPhases;
+	int32 index = (int32)phase;
+	float weight = phase - index;
+
+	const float* samples = fBuffer + position;
+	const float* weights = fTable + index * kTaps;
+
+	float value = fKernels.dot_product(samples, weights, kTaps);
+	if (weight == 0.0f)
+		return value;
+
+	float next = fKernels.dot_product(samples, weights + kTaps, kTaps);
+	return value + (next - value) * weight;
+}
+
+
+/*!	Moves the last source samples in front of the next buffer.
+*/
+void
+SincResampler::KeepHistory(int32 sourceCount)
+{
+	memmove(fBuffer, fBuffer + sourceCount, sizeof(float) * (kTaps - 1));
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _SINC_RESAMPLER_H
+#define _SINC_RESAMPLER_H
+
+
+#include "Resampler.h"
+
+
+struct mixer_kernels;
+
+
+class SincResampler : public Resampler {
+public:
+								SincResampler(uint32 sourceFormat,
+									uint32 destFormat);
+	virtual						~SincResampler();
+
+	virtual	void				SetFrameRates(float sourceRate,
+									float destRate);
+
+			bool				IsValid() const
+									{ return fTable != NULL && fBuffer != NULL; }
+			float				Filter(int32 position, float fraction) const;
+			void				KeepHistory(int32 sourceCount);
+
+			float*				Buffer() const { return fBuffer; }
+
+private:
+			void				_ComputeTable(int32 cutoff);
+
+private:
+			const mixer_kernels& fKernels;
+			float*				fTable;
+			int32				fTableCutoff;
+			float*				fBuffer;
+};
+
+
+#endif	// _SINC_RESAMPLER_H
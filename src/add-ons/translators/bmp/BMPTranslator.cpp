@@ -78,9 +78,16 @@ static const TranSetting sDefaultSettings[] = {
 	{B_TRANSLATOR_EXT_DATA_ONLY, TRAN_SETTING_BOOL, false}
 };
 
+// The data this translator identifies starts with one of these
+static const translation_signature sInputSignatures[] = {
+	{ 0, 2, "BM", NULL },
+	B_TRANSLATOR_BITMAP_SIGNATURE
+};
+
 const uint32 kNumInputFormats = sizeof(sInputFormats) / sizeof(translation_format);
 const uint32 kNumOutputFormats = sizeof(sOutputFormats) / sizeof(translation_format);
 const uint32 kNumDefaultSettings = sizeof(sDefaultSettings) / sizeof(TranSetting);
+const uint32 kNumInputSignatures = sizeof(sInputSignatures) / sizeof(translation_signature);
 
 
 // ---------------------------------------------------------------
@@ -138,6 +145,7 @@ BMPTranslator::BMPTranslator()
 		sDefaultSettings, kNumDefaultSettings,
 		B_TRANSLATOR_BITMAP, B_BMP_FORMAT)
 {
+	SetInputSignatures(sInputSignatures, kNumInputSignatures);
 }
 
 // ---------------------------------------------------------------
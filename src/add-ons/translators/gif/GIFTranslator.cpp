@@ -106,12 +106,21 @@ static const TranSetting sDefaultSettings[] = {
 	{ GIF_SETTING_TRANSPARENT_BLUE, TRAN_SETTING_INT32, 255 }
 };
 
+// The data this translator identifies starts with one of these
+static const translation_signature sInputSignatures[] = {
+	{ 0, 6, "GIF87a", NULL },
+	{ 0, 6, "GIF89a", NULL },
+	B_TRANSLATOR_BITMAP_SIGNATURE
+};
+
 const uint32 kNumInputFormats = sizeof(sInputFormats)
 	/ sizeof(translation_format);
 const uint32 kNumOutputFormats = sizeof(sOutputFormats)
 	/ sizeof(translation_format);
 const uint32 kNumDefaultSettings = sizeof(sDefaultSettings)
 	/ sizeof(TranSetting);
+const uint32 kNumInputSignatures = sizeof(sInputSignatures)
+	/ sizeof(translation_signature);
 
 
 /*!	Look at first few bytes in stream to determine type - throw it back
@@ -325,6 +334,7 @@ GIFTranslator::GIFTranslator()
 	sDefaultSettings, kNumDefaultSettings,
 	B_TRANSLATOR_BITMAP, B_GIF_FORMAT)
 {
+	SetInputSignatures(sInputSignatures, kNumInputSignatures);
 }
 
 
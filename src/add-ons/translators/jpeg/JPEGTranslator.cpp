@@ -105,9 +105,16 @@ static const TranSetting sDefaultSettings[] = {
 	{JPEG_SET_SHOWREADWARNING, TRAN_SETTING_BOOL, true}
 };
 
+// The data this translator identifies starts with one of these
+static const translation_signature sInputSignatures[] = {
+	{ 0, 3, "\xff\xd8\xff", NULL },
+	B_TRANSLATOR_BITMAP_SIGNATURE
+};
+
 const uint32 kNumInputFormats = sizeof(sInputFormats) / sizeof(translation_format);
 const uint32 kNumOutputFormats = sizeof(sOutputFormats) / sizeof(translation_format);
 const uint32 kNumDefaultSettings = sizeof(sDefaultSettings) / sizeof(TranSetting);
+const uint32 kNumInputSignatures = sizeof(sInputSignatures) / sizeof(translation_signature);
 
 
 namespace conversion {
@@ -1309,7 +1316,9 @@ JPEGTranslator::JPEGTranslator()
 		SETTINGS_FILE,
 		sDefaultSettings, kNumDefaultSettings,
 		B_TRANSLATOR_BITMAP, JPEG_FORMAT)
-{}
+{
+	SetInputSignatures(sInputSignatures, kNumInputSignatures);
+}
 
 
 BTranslator*
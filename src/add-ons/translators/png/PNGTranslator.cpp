@@ -102,9 +102,16 @@ static const TranSetting sDefaultSettings[] = {
 		// interlacing is off by default
 };
 
+// The data this translator identifies starts with one of these
+static const translation_signature sInputSignatures[] = {
+	{ 0, 8, "\x89PNG\r\n\x1a\n", NULL },
+	B_TRANSLATOR_BITMAP_SIGNATURE
+};
+
 const uint32 kNumInputFormats = sizeof(sInputFormats) / sizeof(translation_format);
 const uint32 kNumOutputFormats = sizeof(sOutputFormats) / sizeof(translation_format);
 const uint32 kNumDefaultSettings = sizeof(sDefaultSettings) / sizeof(TranSetting);
+const uint32 kNumInputSignatures = sizeof(sInputSignatures) / sizeof(translation_signature);
 
 
 // ---------------------------------------------------------------
@@ -202,6 +209,7 @@ PNGTranslator::PNGTranslator()
 		sDefaultSettings, kNumDefaultSettings,
 		B_TRANSLATOR_BITMAP, B_PNG_FORMAT)
 {
+	SetInputSignatures(sInputSignatures, kNumInputSignatures);
 }
 
 // ---------------------------------------------------------------
@@ -85,6 +85,8 @@ BaseTranslator::BaseTranslator(const char *name, const char *info,
 	fInputCount = (fInputFormats) ? inCount : 0;
 	fOutputFormats = outFormats;
 	fOutputCount = (fOutputFormats) ? outCount : 0;
+	fInputSignatures = NULL;
+	fInputSignatureCount = 0;
 	fTranGroup = tranGroup;
 	fTranType = tranType;
 }
@@ -228,6 +230,65 @@ BaseTranslator::OutputFormats(int32 *out_count) const
 }
 
 
+// ---------------------------------------------------------------
+// InputSignatures
+//
+// Returns the signatures set with SetInputSignatures(), one of
+// which is found at the start of all data this translator can
+// identify.
+//
+// Preconditions:
+//
+// Parameters:	out_count,	The number of signatures is
+//							returned here.
+//
+// Postconditions:
+//
+// Returns: the array of signatures, or NULL if there are none
+// ---------------------------------------------------------------
+const translation_signature *
+BaseTranslator::InputSignatures(int32 *out_count) const
+{
+	if (fInputSignatures == NULL)
+		return BTranslator::InputSignatures(out_count);
+
+	if (out_count) {
+		*out_count = fInputSignatureCount;
+		return fInputSignatures;
+	} else
+		return NULL;
+}
+
+
+// ---------------------------------------------------------------
+// SetInputSignatures
+//
+// Sets the signatures returned by InputSignatures(). As this
+// class identifies B_TRANSLATOR_BITMAP data for the derived
+// class, the signatures must include
+// B_TRANSLATOR_BITMAP_SIGNATURE.
+//
+// Preconditions:
+//
+// Parameters:	signatures,	The array of signatures, it must
+//							stay valid for the lifetime of
+//							the translator
+//
+//				count,		The number of signatures
+//
+// Postconditions:
+//
+// Returns:
+// ---------------------------------------------------------------
+void
+BaseTranslator::SetInputSignatures(const translation_signature *signatures,
+	int32 count)
+{
+	fInputSignatures = signatures;
+	fInputSignatureCount = signatures != NULL ? count : 0;
+}
+
+
 // ---------------------------------------------------------------
 // identify_bits_header
 //
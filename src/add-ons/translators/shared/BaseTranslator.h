@@ -70,6 +70,11 @@ public:
 		// returns the output formats and the count of output formats
 		// that this translator supports
 
+	virtual const translation_signature *InputSignatures(int32 *out_count)
+		const;
+		// returns the signatures of the data this translator can
+		// identify, if they have been set
+
 	virtual status_t Identify(BPositionIO *inSource,
 		const translation_format *inFormat, BMessage *ioExtension,
 		translator_info *outInfo, uint32 outType);
@@ -109,6 +114,11 @@ public:
 
 
 protected:
+	void SetInputSignatures(const translation_signature *signatures,
+		int32 count);
+		// restricts the data the roster asks this translator to identify;
+		// the signatures must include B_TRANSLATOR_BITMAP_SIGNATURE
+
 	status_t BitsCheck(BPositionIO *inSource, BMessage *ioExtension,
 		uint32 &outType);
 
@@ -141,6 +151,8 @@ private:
 	int32 fInputCount;
 	const translation_format *fOutputFormats;
 	int32 fOutputCount;
+	const translation_signature *fInputSignatures;
+	int32 fInputSignatureCount;
 	uint32 fTranGroup;
 	uint32 fTranType;
 };
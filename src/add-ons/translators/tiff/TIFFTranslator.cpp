@@ -82,9 +82,19 @@ static const TranSetting sDefaultSettings[] = {
 		// Compression is LZW by default
 };
 
+// The data this translator identifies starts with one of these
+static const translation_signature sInputSignatures[] = {
+	{ 0, 4, "II*\0", NULL },
+	{ 0, 4, "MM\0*", NULL },
+	{ 0, 4, "II+\0", NULL },
+	{ 0, 4, "MM\0+", NULL },
+	B_TRANSLATOR_BITMAP_SIGNATURE
+};
+
 const uint32 kNumInputFormats = sizeof(sInputFormats) / sizeof(translation_format);
 const uint32 kNumOutputFormats = sizeof(sOutputFormats) / sizeof(translation_format);
 const uint32 kNumDefaultSettings = sizeof(sDefaultSettings) / sizeof(TranSetting);
+const uint32 kNumInputSignatures = sizeof(sInputSignatures) / sizeof(translation_signature);
 
 
 // ---------------------------------------------------------------
@@ -612,6 +622,8 @@ TIFFTranslator::TIFFTranslator()
 		sDefaultSettings, kNumDefaultSettings,
 		B_TRANSLATOR_BITMAP, B_TIFF_FORMAT)
 {
+	SetInputSignatures(sInputSignatures, kNumInputSignatures);
+
 	// TODO: for now!
 	TIFFSetErrorHandler(NULL);
 }
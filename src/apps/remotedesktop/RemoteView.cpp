@@ -6,8 +6,10 @@
  *		Michael Lotz <mmlr@mlotz.ch>
  */
 
+#include "BatchCompression.h"
 #include "NetReceiver.h"
 #include "NetSender.h"
+#include "RemoteBitmapCache.h"
 #include "RemoteMessage.h"
 #include "RemoteView.h"
 #include "StreamingRingBuffer.h"
@@ -24,6 +26,7 @@
 
 #include <new>
 #include <stdio.h>
+#include <stdlib.h>
 
 
 static const uint8 kCursorData[] = { 16 /* size, 16x16 */,
@@ -39,6 +42,10 @@ static const uint8 kCursorData[] = { 16 /* size, 16x16 */,
 };
 
 
+static const uint32 kBitmapCacheMemory = 32 * 1024 * 1024;
+static const uint32 kBitmapCacheSlots = 4096;
+
+
 #define TRACE(x...)				/*printf("RemoteView: " x)*/
 #define TRACE_ALWAYS(x...)		printf("RemoteView: " x)
 #define TRACE_ERROR(x...)		printf("RemoteView: " x)
@@ -69,7 +76,9 @@ RemoteView::RemoteView(BRect frame, const char *remoteHost, uint16 remotePort)
 	fOffscreen(NULL),
 	fViewCursor(kCursorData),
 	fCursorBitmap(NULL),
-	fCursorVisible(false)
+	fCursorVisible(false),
+	fCachedBitmaps(NULL),
+	fCachedBitmapCount(0)
 {
 	fReceiveBuffer = new(std::nothrow) StreamingRingBuffer(16 * 1024);
 	if (fReceiveBuffer == NULL) {
@@ -114,7 +123,8 @@ RemoteView::RemoteView(BRect frame, const char *remoteHost, uint16 remotePort)
 		return;
 	}
 
-	fReceiver = new(std::nothrow) NetReceiver(fEndpoint, fReceiveBuffer);
+	fReceiver = new(std::nothrow) NetReceiver(fEndpoint, fReceiveBuffer,
+		NULL, NULL, true);
 	if (fReceiver == NULL) {
 		fInitStatus = B_NO_MEMORY;
 		TRACE_ERROR("no memory available\n");
@@ -173,6 +183,8 @@ RemoteView::~RemoteView()
 
 	int32 result;
 	wait_for_thread(fDrawThread, &result);
+
+	_SetupBitmapCache(0);
 }
 
 
@@ -442,7 +454,14 @@ RemoteView::_DrawThread()
 	// cursor
 	BPoint cursorHotSpot(0, 0);
 
+	uint32 features = RP_FEATURE_BITMAP_CACHE;
+	if (fReceiver->IsDecompressing() && BatchCompressor::IsSupported())
+		features |= RP_FEATURE_COMPRESSION;
+
 	reply.Start(RP_INIT_CONNECTION);
+	reply.Add(features);
+	reply.Add(kBitmapCacheMemory);
+	reply.Add(kBitmapCacheSlots);
 	reply.Flush();
 
 	while (!fStopThread) {
@@ -468,6 +487,21 @@ RemoteView::_DrawThread()
 		switch (code) {
 			case RP_INIT_CONNECTION:
 			{
+				// servers that don't know about the features don't send any
+				uint32 serverFeatures = 0;
+				uint32 cacheMemory = 0;
+				uint32 cacheSlots = 0;
+				if (message.DataLeft() > 0) {
+					message.Read(serverFeatures);
+					message.Read(cacheMemory);
+					message.Read(cacheSlots);
+				}
+
+				if ((serverFeatures & RP_FEATURE_BITMAP_CACHE) == 0
+					|| _SetupBitmapCache(cacheSlots) != B_OK) {
+					_SetupBitmapCache(0);
+				}
+
 				BRect bounds = fOffscreenBitmap->Bounds();
 				reply.Start(RP_UPDATE_DISPLAY_MODE);
 				reply.Add(bounds.IntegerWidth() + 1);
@@ -803,6 +837,57 @@ RemoteView::_DrawThread()
 				break;
 			}
 
+			case RP_DRAW_CACHED_BITMAP:
+			{
+				BBitmap *bitmap;
+				BRect bitmapRect, viewRect;
+				uint32 options;
+				bool cached;
+
+				message.Read(bitmapRect);
+				message.Read(viewRect);
+				message.Read(options);
+				if (_ReadCachedBitmap(message, &bitmap, cached) != B_OK)
+					continue;
+
+				offscreen->DrawBitmap(bitmap, bitmapRect, viewRect, options);
+				invalidRegion.Include(viewRect);
+				if (!cached)
+					delete bitmap;
+				break;
+			}
+
+			case RP_DRAW_CACHED_BITMAP_RECTS:
+			{
+				color_space colorSpace;
+				int32 rectCount;
+				uint32 flags, options;
+
+				message.Read(options);
+				message.Read(colorSpace);
+				message.Read(flags);
+				message.Read(rectCount);
+				for (int32 i = 0; i < rectCount; i++) {
+					BBitmap *bitmap;
+					BRect viewRect;
+					bool cached;
+
+					message.Read(viewRect);
+					if (_ReadCachedBitmap(message, &bitmap, cached, true,
+							colorSpace, flags) != B_OK) {
+						break;
+					}
+
+					offscreen->DrawBitmap(bitmap, bitmap->Bounds(), viewRect,
+						options);
+					invalidRegion.Include(viewRect);
+					if (!cached)
+						delete bitmap;
+				}
+
+				break;
+			}
+
 			case RP_STROKE_ARC:
 			case RP_FILL_ARC:
 			case RP_FILL_ARC_GRADIENT:
@@ -1329,3 +1414,77 @@ RemoteView::_BuildInvalidateRect(BPoint *points, int32 pointCount)
 
 	return bounds;
 }
+
+
+status_t
+RemoteView::_SetupBitmapCache(uint32 slotCount)
+{
+	for (uint32 i = 0; i < fCachedBitmapCount; i++)
+		delete fCachedBitmaps[i];
+
+	free(fCachedBitmaps);
+	fCachedBitmaps = NULL;
+	fCachedBitmapCount = 0;
+
+	if (slotCount == 0)
+		return B_OK;
+
+	fCachedBitmaps = (BBitmap **)calloc(slotCount, sizeof(BBitmap *));
+	if (fCachedBitmaps == NULL)
+		return B_NO_MEMORY;
+
+	fCachedBitmapCount = slotCount;
+	return B_OK;
+}
+
+
+/*!	Reads a bitmap sent through the bitmap cache. The server decides about
+	the slots, so this only has to drop the evicted bitmaps and store or look
+	up the one in the message. If \a _cached is set, the bitmap is owned by
+	the cache and must not be deleted.
+*/
+status_t
+RemoteView::_ReadCachedBitmap(RemoteMessage &message, BBitmap **_bitmap,
+	bool &_cached, bool minimal, color_space colorSpace, uint32 flags)
+{
+	int32 evictedCount;
+	if (message.Read(evictedCount) != B_OK)
+		return B_ERROR;
+
+	for (int32 i = 0; i < evictedCount; i++) {
+		uint32 evicted;
+		if (message.Read(evicted) != B_OK || evicted >= fCachedBitmapCount)
+			return B_BAD_DATA;
+
+		delete fCachedBitmaps[evicted];
+		fCachedBitmaps[evicted] = NULL;
+	}
+
+	uint32 slot;
+	bool store;
+	message.Read(slot);
+	if (message.Read(store) != B_OK)
+		return B_ERROR;
+
+	if (slot != kRemoteBitmapNotCached && slot >= fCachedBitmapCount)
+		return B_BAD_DATA;
+
+	_cached = slot != kRemoteBitmapNotCached;
+	if (_cached && !store) {
+		*_bitmap = fCachedBitmaps[slot];
+		return *_bitmap != NULL ? B_OK : B_BAD_DATA;
+	}
+
+	BBitmap *bitmap;
+	status_t result = message.ReadBitmap(&bitmap, minimal, colorSpace, flags);
+	if (result != B_OK)
+		return result;
+
+	if (_cached) {
+		delete fCachedBitmaps[slot];
+		fCachedBitmaps[slot] = bitmap;
+	}
+
+	*_bitmap = bitmap;
+	return B_OK;
+}
@@ -16,6 +16,7 @@
 class BBitmap;
 class NetReceiver;
 class NetSender;
+class RemoteMessage;
 class StreamingRingBuffer;
 
 struct engine_state;
@@ -61,6 +62,13 @@ static	int32						_DrawEntry(void *data);
 		BRect						_BuildInvalidateRect(BPoint *points,
 										int32 pointCount);
 
+		status_t					_SetupBitmapCache(uint32 slotCount);
+		status_t					_ReadCachedBitmap(RemoteMessage &message,
+										BBitmap **_bitmap, bool &_cached,
+										bool minimal = false,
+										color_space colorSpace = B_RGB32,
+										uint32 flags = 0);
+
 		status_t					fInitStatus;
 		bool						fIsConnected;
 
@@ -82,6 +90,9 @@ static	int32						_DrawEntry(void *data);
 		bool						fCursorVisible;
 
 		BObjectList<engine_state>	fStates;
+
+		BBitmap **					fCachedBitmaps;
+		uint32						fCachedBitmapCount;
 };
 
 #endif // REMOTE_VIEW_H
@@ -0,0 +1,172 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "FoldedProfileResult.h"
+
+#if __GNUC__ > 2
+#include <cxxabi.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <new>
+
+#include "Options.h"
+#include "ProfiledEntity.h"
+
+
+FoldedProfileResult::FoldedProfileResult()
+{
+}
+
+
+FoldedProfileResult::~FoldedProfileResult()
+{
+}
+
+
+void
+FoldedProfileResult::AddSamples(ImageProfileResultContainer* container,
+	addr_t* samples, int32 sampleCount)
+{
+	try {
+		std::string stack;
+		_GetStack(container, samples, sampleCount, stack);
+		fStacks[stack]++;
+	} catch (std::bad_alloc&) {
+	}
+}
+
+
+void
+FoldedProfileResult::AddWaitSamples(ImageProfileResultContainer* container,
+	addr_t* samples, int32 sampleCount, const char* waitObject,
+	bigtime_t waitTime)
+{
+	if (waitTime <= 0)
+		return;
+
+	try {
+		std::string stack;
+		_GetStack(container, samples, sampleCount, stack);
+
+		// the wait object is the innermost frame
+		std::string frame = "[";
+		frame += waitObject;
+		frame += "]";
+		_AppendFrame(stack, frame.c_str());
+
+		fStacks[stack] += waitTime;
+	} catch (std::bad_alloc&) {
+	}
+}
+
+
+void
+FoldedProfileResult::AddDroppedTicks(int32 dropped)
+{
+	// there's no way to attribute them to a stack
+}
+
+
+void
+FoldedProfileResult::PrintResults(ImageProfileResultContainer* container)
+{
+	// The entity is the outermost frame, so that the results of several
+	// threads can simply be concatenated.
+	char entity[B_OS_NAME_LENGTH + 32];
+	snprintf(entity, sizeof(entity), "%s %" B_PRId32, fEntity->EntityName(),
+		fEntity->EntityID());
+	for (char* c = entity; *c != '\0'; c++) {
+		if (*c == ';')
+			*c = ':';
+	}
+
+	for (StackMap::const_iterator it = fStacks.begin(); it != fStacks.end();
+			++it) {
+		fprintf(gOptions.output, "%s%s %" B_PRId64 "\n", entity,
+			it->first.c_str(), it->second);
+	}
+}
+
+
+status_t
+FoldedProfileResult::GetImageProfileResult(SharedImage* image, image_id id,
+	ImageProfileResult*& _imageResult)
+{
+	ImageProfileResult* result
+		= new(std::nothrow) ImageProfileResult(image, id);
+	if (result == NULL)
+		return B_NO_MEMORY;
+
+	_imageResult = result;
+	return B_OK;
+}
+
+
+/*!	Returns the frames of the given stack, each one preceded by a separator.
+*/
+void
+FoldedProfileResult::_GetStack(ImageProfileResultContainer* container,
+	addr_t* samples, int32 sampleCount, std::string& _stack)
+{
+	// the samples start with the innermost frame
+	for (int32 i = sampleCount - 1; i >= 0; i--) {
+		addr_t loadDelta;
+		ImageProfileResult* image = container->FindImage(samples[i],
+			loadDelta);
+		if (image == NULL) {
+			_AppendFrame(_stack, "[unknown]");
+			continue;
+		}
+
+		SharedImage* sharedImage = image->GetImage();
+		int32 symbol = sharedImage->FindSymbol(samples[i] - loadDelta);
+		if (symbol < 0) {
+			std::string frame = "[";
+			frame += sharedImage->Name();
+			frame += "]";
+			_AppendFrame(_stack, frame.c_str());
+			continue;
+		}
+
+		_AppendFrame(_stack,
+			_SymbolName(sharedImage->Symbols()[symbol]).c_str());
+	}
+}
+
+
+const std::string&
+FoldedProfileResult::_SymbolName(const Symbol* symbol)
+{
+	SymbolNameMap::iterator it = fSymbolNames.find(symbol);
+	if (it != fSymbolNames.end())
+		return it->second;
+
+	std::string& name = fSymbolNames[symbol];
+#if __GNUC__ > 2
+	int status;
+	char* demangled = __cxxabiv1::__cxa_demangle(symbol->Name(), NULL, NULL,
+		&status);
+	if (demangled != NULL) {
+		name = demangled;
+		free(demangled);
+		return name;
+	}
+#endif
+	name = symbol->Name();
+	return name;
+}
+
+
+/*static*/ void
+FoldedProfileResult::_AppendFrame(std::string& stack, const char* name)
+{
+	// semicolons separate the frames, so they must not appear in a name
+	stack += ';';
+	for (const char* c = name; *c != '\0'; c++)
+		stack += *c == ';' ? ':' : *c;
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef FOLDED_PROFILE_RESULT_H
+#define FOLDED_PROFILE_RESULT_H
+
+
+#include <map>
+#include <string>
+
+#include "ProfileResult.h"
+
+
+/*!	Collects the complete stacks and prints them in the "folded" format used
+	by flame graph tools: one line per distinct stack, with the functions
+	from the outermost to the innermost one separated by semicolons, followed
+	by the number of ticks, respectively the microseconds waited, spent in
+	that stack.
+*/
+class FoldedProfileResult : public ProfileResult {
+public:
+								FoldedProfileResult();
+	virtual						~FoldedProfileResult();
+
+	virtual	void				AddSamples(
+									ImageProfileResultContainer* container,
+									addr_t* samples, int32 sampleCount);
+	virtual	void				AddWaitSamples(
+									ImageProfileResultContainer* container,
+									addr_t* samples, int32 sampleCount,
+									const char* waitObject,
+									bigtime_t waitTime);
+	virtual	void				AddDroppedTicks(int32 dropped);
+	virtual	void				PrintResults(
+									ImageProfileResultContainer* container);
+
+	virtual status_t			GetImageProfileResult(SharedImage* image,
+									image_id id,
+									ImageProfileResult*& _imageResult);
+
+private:
+			typedef std::map<std::string, int64> StackMap;
+			typedef std::map<const Symbol*, std::string> SymbolNameMap;
+
+private:
+			void				_GetStack(
+									ImageProfileResultContainer* container,
+									addr_t* samples, int32 sampleCount,
+									std::string& _stack);
+			const std::string&	_SymbolName(const Symbol* symbol);
+	static	void				_AppendFrame(std::string& stack,
+									const char* name);
+
+private:
+			StackMap			fStacks;
+			SymbolNameMap		fSymbolNames;
+};
+
+
+#endif	// FOLDED_PROFILE_RESULT_H
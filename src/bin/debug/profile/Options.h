@@ -24,7 +24,9 @@ struct Options {
 		profile_teams(true),
 		profile_threads(true),
 		analyze_full_stack(false),
-		summary_result(false)
+		summary_result(false),
+		folded_result(false),
+		profile_waits(false)
 	{
 	}
 
@@ -39,6 +41,8 @@ struct Options {
 	bool		profile_threads;
 	bool		analyze_full_stack;
 	bool		summary_result;
+	bool		folded_result;
+	bool		profile_waits;
 };
 
 
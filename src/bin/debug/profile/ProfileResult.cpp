@@ -78,3 +78,15 @@ ProfileResult::SetInterval(bigtime_t interval)
 {
 	fInterval = interval;
 }
+
+
+/*!	Adds the stack of a thread that waited \a waitTime microseconds on
+	\a waitObject. Only results that are meaningful for off-CPU profiling
+	need to implement this.
+*/
+void
+ProfileResult::AddWaitSamples(ImageProfileResultContainer* container,
+	addr_t* samples, int32 sampleCount, const char* waitObject,
+	bigtime_t waitTime)
+{
+}
@@ -75,6 +75,11 @@ public:
 									ImageProfileResultContainer* container,
 									addr_t* samples,
 									int32 sampleCount) = 0;
+	virtual	void				AddWaitSamples(
+									ImageProfileResultContainer* container,
+									addr_t* samples, int32 sampleCount,
+									const char* waitObject,
+									bigtime_t waitTime);
 	virtual	void				AddDroppedTicks(int32 dropped) = 0;
 	virtual	void				PrintResults(
 									ImageProfileResultContainer* container) = 0;
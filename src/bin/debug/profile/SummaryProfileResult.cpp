@@ -75,6 +75,16 @@ SummaryProfileResult::AddSamples(ImageProfileResultContainer* container,
 }
 
 
+void
+SummaryProfileResult::AddWaitSamples(ImageProfileResultContainer* container,
+	addr_t* samples, int32 sampleCount, const char* waitObject,
+	bigtime_t waitTime)
+{
+	fResult->AddWaitSamples(container, samples, sampleCount, waitObject,
+		waitTime);
+}
+
+
 void
 SummaryProfileResult::AddDroppedTicks(int32 dropped)
 {
@@ -66,6 +66,11 @@ public:
 	virtual	void				AddSamples(
 									ImageProfileResultContainer* container,
 									addr_t* samples, int32 sampleCount);
+	virtual	void				AddWaitSamples(
+									ImageProfileResultContainer* container,
+									addr_t* samples, int32 sampleCount,
+									const char* waitObject,
+									bigtime_t waitTime);
 	virtual	void				AddDroppedTicks(int32 dropped);
 	virtual	void				PrintResults(
 									ImageProfileResultContainer* container);
@@ -6,6 +6,8 @@
 
 #include "Thread.h"
 
+#include <string.h>
+
 #include <algorithm>
 #include <new>
 
@@ -49,7 +51,12 @@ Thread::Thread(thread_id threadID, const char* name, Team* team)
 	fSampleArea(-1),
 	fSamples(NULL),
 	fProfileResult(NULL),
-	fLazyImages(true)
+	fLazyImages(true),
+	fWaitStartTime(-1),
+	fWaitObjectType(0),
+	fWaitObject(0),
+	fWaitSamples(NULL),
+	fWaitSampleCount(0)
 {
 	fTeam->AcquireReference();
 }
@@ -63,6 +70,8 @@ Thread::~Thread()
 	if (fProfileResult != NULL)
 		fProfileResult->ReleaseReference();
 
+	delete[] fWaitSamples;
+
 	while (ThreadImage* image = fImages.RemoveHead())
 		delete image;
 	while (ThreadImage* image = fOldImages.RemoveHead())
@@ -227,6 +236,37 @@ Thread::AddSamples(addr_t* samples, int32 sampleCount)
 }
 
 
+void
+Thread::StartWaiting(nanotime_t time, uint32 waitObjectType,
+	addr_t waitObject, const addr_t* samples, int32 sampleCount)
+{
+	if (fWaitSamples == NULL) {
+		fWaitSamples = new(std::nothrow) addr_t[gOptions.stack_depth];
+		if (fWaitSamples == NULL)
+			return;
+	}
+	sampleCount = std::min(sampleCount, gOptions.stack_depth);
+
+	fWaitStartTime = time;
+	fWaitObjectType = waitObjectType;
+	fWaitObject = waitObject;
+	memcpy(fWaitSamples, samples, sampleCount * sizeof(addr_t));
+	fWaitSampleCount = sampleCount;
+}
+
+
+void
+Thread::StopWaiting(nanotime_t time, const char* waitObject)
+{
+	if (!IsWaiting())
+		return;
+
+	fProfileResult->AddWaitSamples(this, fWaitSamples, fWaitSampleCount,
+		waitObject, (time - fWaitStartTime) / 1000);
+	fWaitStartTime = -1;
+}
+
+
 void
 Thread::PrintResults()
 {
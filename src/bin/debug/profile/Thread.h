@@ -66,6 +66,16 @@ public:
 									int32 stackDepth, bool variableStackDepth,
 									int32 event);
 			void				AddSamples(addr_t* samples, int32 sampleCount);
+
+			void				StartWaiting(nanotime_t time,
+									uint32 waitObjectType, addr_t waitObject,
+									const addr_t* samples, int32 sampleCount);
+			void				StopWaiting(nanotime_t time,
+									const char* waitObject);
+	inline	bool				IsWaiting() const;
+	inline	uint32				WaitObjectType() const;
+	inline	addr_t				WaitObject() const;
+
 			void				PrintResults();
 
 private:
@@ -92,6 +102,12 @@ private:
 			ImageList			fNewImages;
 			ImageList			fOldImages;
 			bool				fLazyImages;
+
+			nanotime_t			fWaitStartTime;
+			uint32				fWaitObjectType;
+			addr_t				fWaitObject;
+			addr_t*				fWaitSamples;
+			int32				fWaitSampleCount;
 };
 
 
@@ -123,6 +139,27 @@ Thread::GetTeam() const
 }
 
 
+bool
+Thread::IsWaiting() const
+{
+	return fWaitStartTime >= 0;
+}
+
+
+uint32
+Thread::WaitObjectType() const
+{
+	return fWaitObjectType;
+}
+
+
+addr_t
+Thread::WaitObject() const
+{
+	return fWaitObject;
+}
+
+
 ProfileResult*
 Thread::GetProfileResult() const
 {
@@ -25,6 +25,7 @@
 
 #include <syscalls.h>
 #include <system_profiler_defs.h>
+#include <thread_defs.h>
 
 #include <AutoDeleter.h>
 #include <debug_support.h>
@@ -36,6 +37,7 @@
 #include "BasicProfileResult.h"
 #include "CallgrindProfileResult.h"
 #include "debug_utils.h"
+#include "FoldedProfileResult.h"
 #include "Image.h"
 #include "Options.h"
 #include "SummaryProfileResult.h"
@@ -74,6 +76,10 @@ static const char* kUsage =
 	"                   for every encountered function will be incremented.\n"
 	"                   This increases the default for the caller stack depth\n"
 	"                   (\"-s\") to 64.\n"
+	"  -F, --folded   - Print the complete stacks in the folded format used by\n"
+	"                   flame graph tools, one line per stack with the number\n"
+	"                   of ticks spent in it. This increases the default for\n"
+	"                   the caller stack depth (\"-s\") to 64.\n"
 	"  -h, --help     - Print this usage info.\n"
 	"  -i <interval>  - Use a tick interval of <interval> microseconds.\n"
 	"                   Default is 1000 (1 ms). On a fast machine, a shorter\n"
@@ -92,6 +98,11 @@ static const char* kUsage =
 	"                   produce a combined output at the end.\n"
 	"  -v <directory> - Create valgrind/callgrind output. <directory> is the\n"
 	"                   directory where to put the output files.\n"
+	"  -w, --wait     - Profile where threads wait instead of where they run.\n"
+	"                   The stack of a thread is recorded whenever it blocks,\n"
+	"                   and the time until it is woken up is added to that\n"
+	"                   stack and the object it waited on. Implies \"-a\" and\n"
+	"                   \"-F\", the numbers are microseconds.\n"
 ;
 
 
@@ -284,6 +295,51 @@ public:
 			fSummaryProfileResult->PrintSummaryResults();
 	}
 
+	void AddWaitObject(system_profiler_wait_object_info* info)
+	{
+		try {
+			fWaitObjects[WaitObjectKey(info->type, info->object)] = info->name;
+		} catch (std::bad_alloc&) {
+		}
+	}
+
+	BString WaitObjectName(uint32 type, addr_t object) const
+	{
+		BString name;
+		switch (type) {
+			case THREAD_BLOCK_TYPE_SEMAPHORE:
+				name = "semaphore";
+				break;
+			case THREAD_BLOCK_TYPE_CONDITION_VARIABLE:
+				name = "condition variable";
+				break;
+			case THREAD_BLOCK_TYPE_SNOOZE:
+				return "snooze";
+			case THREAD_BLOCK_TYPE_SIGNAL:
+				return "signal";
+			case THREAD_BLOCK_TYPE_MUTEX:
+				name = "mutex";
+				break;
+			case THREAD_BLOCK_TYPE_RW_LOCK:
+				name = "rw lock";
+				break;
+			case THREAD_BLOCK_TYPE_USER:
+				return "user";
+			default:
+				name = "other";
+				break;
+		}
+
+		WaitObjectMap::const_iterator it
+			= fWaitObjects.find(WaitObjectKey(type, object));
+		if (it != fWaitObjects.end() && !it->second.empty())
+			name << ": " << it->second.c_str();
+		else if (type == THREAD_BLOCK_TYPE_SEMAPHORE)
+			name << " " << (sem_id)object;
+
+		return name;
+	}
+
 private:
 	virtual int32 EntityID() const
 	{
@@ -411,7 +467,9 @@ private:
 	{
 		ProfileResult* profileResult;
 
-		if (gOptions.callgrind_directory != NULL)
+		if (gOptions.folded_result)
+			profileResult = new(std::nothrow) FoldedProfileResult;
+		else if (gOptions.callgrind_directory != NULL)
 			profileResult = new(std::nothrow) CallgrindProfileResult;
 		else if (gOptions.analyze_full_stack)
 			profileResult = new(std::nothrow) InclusiveProfileResult;
@@ -488,11 +546,14 @@ private:
 
 private:
 	typedef std::map<std::string, SharedImage*> ImageMap;
+	typedef std::pair<uint32, addr_t> WaitObjectKey;
+	typedef std::map<WaitObjectKey, std::string> WaitObjectMap;
 
 private:
 	BObjectList<Team>				fTeams;
 	BObjectList<Thread>				fThreads;
 	ImageMap						fImages;
+	WaitObjectMap					fWaitObjects;
 	Team*							fKernelTeam;
 	port_id							fDebuggerPort;
 	SummaryProfileResult*			fSummaryProfileResult;
@@ -628,6 +689,44 @@ process_event_buffer(ThreadManager& threadManager, uint8* buffer,
 				break;
 			}
 
+			case B_SYSTEM_PROFILER_WAIT_OBJECT_INFO:
+			{
+				system_profiler_wait_object_info* event
+					= (system_profiler_wait_object_info*)buffer;
+
+				threadManager.AddWaitObject(event);
+				break;
+			}
+
+			case B_SYSTEM_PROFILER_THREAD_WAITING:
+			{
+				system_profiler_thread_waiting* event
+					= (system_profiler_thread_waiting*)buffer;
+
+				Thread* thread = threadManager.FindThread(event->thread);
+				if (thread != NULL) {
+					thread->StartWaiting(event->time, event->wait_object_type,
+						event->wait_object, event->samples,
+						(addr_t*)(buffer + header->size) - event->samples);
+				}
+				break;
+			}
+
+			case B_SYSTEM_PROFILER_THREAD_ENQUEUED_IN_RUN_QUEUE:
+			{
+				system_profiler_thread_enqueued_in_run_queue* event
+					= (system_profiler_thread_enqueued_in_run_queue*)buffer;
+
+				// If the thread was waiting, the wait is over now.
+				Thread* thread = threadManager.FindThread(event->thread);
+				if (thread != NULL && thread->IsWaiting()) {
+					BString waitObject = threadManager.WaitObjectName(
+						thread->WaitObjectType(), thread->WaitObject());
+					thread->StopWaiting(event->time, waitObject.String());
+				}
+				break;
+			}
+
 			case B_SYSTEM_PROFILER_BUFFER_END:
 			{
 				// Marks the end of the ring buffer -- we need to ignore the
@@ -707,7 +806,9 @@ profile_all(const char* const* programArgs, int programArgCount)
 	profilerParameters.buffer_area = area;
 	profilerParameters.flags = B_SYSTEM_PROFILER_TEAM_EVENTS
 		| B_SYSTEM_PROFILER_THREAD_EVENTS | B_SYSTEM_PROFILER_IMAGE_EVENTS
-		| B_SYSTEM_PROFILER_SAMPLING_EVENTS;
+		| (gOptions.profile_waits
+			? B_SYSTEM_PROFILER_WAIT_EVENTS : B_SYSTEM_PROFILER_SAMPLING_EVENTS);
+	profilerParameters.locking_lookup_size = 64 * 1024;
 	profilerParameters.interval = gOptions.interval;
 	profilerParameters.stack_depth = gOptions.stack_depth;
 
@@ -1009,13 +1110,15 @@ main(int argc, const char* const* argv)
 	while (true) {
 		static struct option sLongOptions[] = {
 			{ "all", no_argument, 0, 'a' },
+			{ "folded", no_argument, 0, 'F' },
 			{ "help", no_argument, 0, 'h' },
 			{ "recorded", no_argument, 0, 'r' },
+			{ "wait", no_argument, 0, 'w' },
 			{ 0, 0, 0, 0 }
 		};
 
 		opterr = 0; // don't print errors
-		int c = getopt_long(argc, (char**)argv, "+acCfhi:klo:rs:Sv:",
+		int c = getopt_long(argc, (char**)argv, "+acCfFhi:klo:rs:Sv:w",
 			sLongOptions, NULL);
 		if (c == -1)
 			break;
@@ -1034,6 +1137,10 @@ main(int argc, const char* const* argv)
 				gOptions.stack_depth = 64;
 				gOptions.analyze_full_stack = true;
 				break;
+			case 'F':
+				gOptions.folded_result = true;
+				gOptions.stack_depth = 64;
+				break;
 			case 'h':
 				print_usage_and_exit(false);
 				break;
@@ -1063,6 +1170,12 @@ main(int argc, const char* const* argv)
 				gOptions.analyze_full_stack = true;
 				gOptions.stack_depth = 64;
 				break;
+			case 'w':
+				gOptions.profile_waits = true;
+				gOptions.profile_all = true;
+				gOptions.folded_result = true;
+				gOptions.stack_depth = 64;
+				break;
 			default:
 				print_usage_and_exit(true);
 				break;
@@ -30,6 +30,7 @@ static struct option const kLongOptions[] = {
 	{"volume", required_argument, 0, 'd'},
 	{"type", required_argument, 0, 't'},
 	{"copy-from", required_argument, 0, 'f'},
+	{"trigram", no_argument, 0, 'g'},
 	{"verbose", no_argument, 0, 'v'},
 	{"help", no_argument, 0, 'h'},
 	{NULL}
@@ -38,6 +39,9 @@ static struct option const kLongOptions[] = {
 extern const char *__progname;
 static const char *kProgramName = __progname;
 
+// BFS keeps the trigrams of an attribute in an index of this name
+static const char *kTrigramIndexSuffix = ":trigram";
+
 
 static void
 copy_indexes(dev_t from, dev_t to, bool verbose)
@@ -88,6 +92,9 @@ usage(int status)
 		"\t\t\t\"llong\", \"string\", \"float\", or \"double\".\n"
 		"\t\t\tDefaults to \"string\".\n"
 		"      --copy-from\tpath to volume to copy the indexes from.\n"
+		"  -g, --trigram\t\talso create a trigram index for the string attribute,\n"
+		"\t\t\tso that queries for substrings, and case insensitive\n"
+		"\t\t\tqueries can use an index, too.\n"
 		"  -v, --verbose\t\tprint information about the index being created\n",
 		kProgramName);
 
@@ -102,10 +109,11 @@ main(int argc, char **argv)
 	int indexType = B_STRING_TYPE;
 	char *indexName = NULL;
 	bool verbose = false;
+	bool trigram = false;
 	dev_t device = -1, copyFromDevice = -1;
 
 	int c;
-	while ((c = getopt_long(argc, argv, "d:ht:v", kLongOptions, NULL)) != -1) {
+	while ((c = getopt_long(argc, argv, "d:ght:v", kLongOptions, NULL)) != -1) {
 		switch (c) {
 			case 0:
 				break;
@@ -125,6 +133,9 @@ main(int argc, char **argv)
 					return -1;
 				}
 				break;
+			case 'g':
+				trigram = true;
+				break;
 			case 'h':
 				usage(0);
 				break;
@@ -185,8 +196,35 @@ main(int argc, char **argv)
 			indexName, indexTypeName, path.Path());
 	}
 
-	if (fs_create_index(device, indexName, indexType, 0) != 0)
+	if (trigram && indexType != B_STRING_TYPE) {
+		fprintf(stderr, "%s: Trigram indexes are only available for strings.\n",
+			kProgramName);
+		return 1;
+	}
+
+	if (fs_create_index(device, indexName, indexType, 0) != 0
+		&& (!trigram || errno != B_FILE_EXISTS)) {
 		fprintf(stderr, "%s: Could not create index: %s\n", kProgramName, strerror(errno));
+		return 0;
+	}
+
+	if (trigram) {
+		// the index that goes along with the one above
+		char trigramName[B_FILE_NAME_LENGTH];
+		if (snprintf(trigramName, sizeof(trigramName), "%s%s", indexName,
+				kTrigramIndexSuffix) >= (int)sizeof(trigramName)) {
+			fprintf(stderr, "%s: Index name is too long.\n", kProgramName);
+			return 1;
+		}
+
+		if (verbose)
+			printf("Creating trigram index \"%s\".\n", trigramName);
+
+		if (fs_create_index(device, trigramName, B_STRING_TYPE, 0) != 0) {
+			fprintf(stderr, "%s: Could not create trigram index: %s\n",
+				kProgramName, strerror(errno));
+		}
+	}
 
 	return 0;
 }
@@ -14,6 +14,8 @@
 
 #include <OS.h>
 
+#include <syscalls.h>
+
 
 enum {
 	Team = 0,
@@ -43,6 +45,51 @@ const char* sStates[] = {"run", "rdy", "msg", "zzz", "sus", "wait"};
 
 static void printTeamThreads(team_info* teamInfo, bool printSemaphoreInfo);
 static void printTeamInfo(team_info* teamInfo, bool printHeader);
+static void formatAffinity(thread_id thread, int32 cpuCount, char* buffer,
+	size_t size);
+
+
+/*!	Writes the CPUs the thread may run on as a list of ranges, or "all" if it
+	is not restricted.
+*/
+static void
+formatAffinity(thread_id thread, int32 cpuCount, char* buffer, size_t size)
+{
+	uint32 mask[32];
+	size_t length = 0;
+	int32 i;
+
+	if (_kern_get_thread_affinity(thread, mask, sizeof(mask)) != B_OK) {
+		strlcpy(buffer, "-", size);
+		return;
+	}
+
+#define CPU_IN_MASK(cpu) ((mask[(cpu) / 32] & (1u << ((cpu) % 32))) != 0)
+	for (i = 0; i < cpuCount && CPU_IN_MASK(i); i++)
+		;
+	if (i == cpuCount) {
+		strlcpy(buffer, "all", size);
+		return;
+	}
+
+	buffer[0] = '\0';
+	for (i = 0; i < cpuCount && length < size; i++) {
+		int32 last = i;
+		if (!CPU_IN_MASK(i))
+			continue;
+		while (last + 1 < cpuCount && CPU_IN_MASK(last + 1))
+			last++;
+
+		length += snprintf(buffer + length, size - length, "%s%" B_PRId32,
+			length > 0 ? "," : "", i);
+		if (last > i && length < size) {
+			length += snprintf(buffer + length, size - length, "-%" B_PRId32,
+				last);
+		}
+		i = last;
+	}
+#undef CPU_IN_MASK
+}
 
 
 static void
@@ -89,6 +136,10 @@ printTeamThreads(team_info* teamInfo, bool printSemaphoreInfo)
 	int32 threadCookie = 0;
 	sem_info semaphoreInfo;
 	thread_info threadInfo;
+	system_info systemInfo;
+	char affinity[16];
+
+	get_system_info(&systemInfo);
 
 	// Print all info about its threads too
 	while (get_next_thread_info(teamInfo->team, &threadCookie, &threadInfo)
@@ -100,10 +151,13 @@ printTeamThreads(team_info* teamInfo, bool printSemaphoreInfo)
 		else
 			threadState = sStates[threadInfo.state - 1];
 
+		formatAffinity(threadInfo.thread, systemInfo.cpu_count, affinity,
+			sizeof(affinity));
+
 		printf("%-37s %5" B_PRId32 " %8s %4" B_PRId32 " %8" B_PRIu64 " %8"
-			B_PRId64 " ", threadInfo.name, threadInfo.thread, threadState,
+			B_PRId64 " %-8s ", threadInfo.name, threadInfo.thread, threadState,
 			threadInfo.priority, (threadInfo.user_time / 1000),
-			(threadInfo.kernel_time / 1000));
+			(threadInfo.kernel_time / 1000), affinity);
 
 		if (printSemaphoreInfo) {
 			if (threadInfo.state == B_THREAD_WAITING && threadInfo.sem != -1) {
@@ -196,11 +250,11 @@ main(int argc, char** argv)
 			printTeamInfo(&teamInfo, printHeader);
 			printHeader = false;
 			if (printThreads) {
-				printf("\n%-37s %5s %8s %4s %8s %8s\n", "Thread", "Id", \
-					"State", "Prio", "UTime", "KTime");
+				printf("\n%-37s %5s %8s %4s %8s %8s %-8s\n", "Thread", "Id", \
+					"State", "Prio", "UTime", "KTime", "CPUs");
 				printTeamThreads(&teamInfo, printSemaphoreInfo);
 				printf("----------------------------------------------" \
-					"-----------------------------\n");
+					"--------------------------------------\n");
 				printHeader = true;
 			}
 		}
@@ -215,8 +269,8 @@ main(int argc, char** argv)
 			if (strstr(p, string_to_match) == NULL)
 				continue;
 			printTeamInfo(&teamInfo, true);
-			printf("\n%-37s %5s %8s %4s %8s %8s\n", "Thread", "Id", "State", \
-				"Prio", "UTime", "KTime");
+			printf("\n%-37s %5s %8s %4s %8s %8s %-8s\n", "Thread", "Id", \
+				"State", "Prio", "UTime", "KTime", "CPUs");
 			printTeamThreads(&teamInfo, printSemaphoreInfo);
 		}
 	}
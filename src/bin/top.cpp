@@ -20,6 +20,8 @@
 
 #include <list>
 
+#include <syscalls.h>
+
 #include "termcap.h"
 
 static const char IDLE_NAME[] = "idle thread ";
@@ -98,6 +100,36 @@ init_term()
 }
 
 
+/*
+ * Describe the cpus a thread may run on: "all", or the first ones of them
+ */
+static void
+cpu_affinity(thread_id thid, char *buffer, size_t size)
+{
+	uint32 mask[32];
+	if (_kern_get_thread_affinity(thid, mask, sizeof(mask)) != B_OK) {
+		strlcpy(buffer, "-", size);
+		return;
+	}
+
+	int allowed = 0;
+	size_t length = 0;
+	buffer[0] = '\0';
+	for (int i = 0; i < cpus; i++) {
+		if ((mask[i / 32] & (1u << (i % 32))) == 0)
+			continue;
+		allowed++;
+		if (length < size) {
+			length += snprintf(buffer + length, size - length, "%s%d",
+				length > 0 ? "," : "", i);
+		}
+	}
+
+	if (allowed == cpus)
+		strlcpy(buffer, "all", size);
+}
+
+
 /*
  * Calculate the cpu percentage used by a given thread
  * Remember: for multiple CPUs, multiply the interval by # cpus
@@ -187,8 +219,8 @@ compare(
 	 */
 	times.sort();
 
-	printf("%6s %7s %7s %7s %4s %16s %-16s \n", "THID", "TOTAL", "USER", "KERNEL",
-		"%CPU", "TEAM NAME", "THREAD NAME");
+	printf("%6s %7s %7s %7s %4s %-7s %16s %-16s \n", "THID", "TOTAL", "USER",
+		"KERNEL", "%CPU", "CPUS", "TEAM NAME", "THREAD NAME");
 	linecount = 1;
 	idletime = 0;
 	gtotal = 0;
@@ -216,8 +248,8 @@ compare(
 
 		if (columns <= 80)
 			t.name[16] = 0;
-		else if (columns - 64 < sizeof(t.name))
-			t.name[columns - 64] = 0;
+		else if (columns - 72 < sizeof(t.name))
+			t.name[columns - 72] = 0;
 
 		total = it->total_time();
 		if (ignore) {
@@ -228,13 +260,16 @@ compare(
 			utotal += it->user_time;
 		}
 		if (!ignore && (!refresh || (linecount < (rows - 1)))) {
+			char affinity[8];
+			cpu_affinity(it->thid, affinity, sizeof(affinity));
 
-			printf("%6" B_PRId32 " %7.2f %7.2f %7.2f %4.1f %16s %s \n",
+			printf("%6" B_PRId32 " %7.2f %7.2f %7.2f %4.1f %-7s %16s %s \n",
 				it->thid,
 				total / 1000.0,
 				(double)(it->user_time / 1000),
 				(double)(it->kernel_time / 1000),
 				cpu_perc(total, uinterval),
+				affinity,
 				tm.args,
 				t.name);
 			linecount++;
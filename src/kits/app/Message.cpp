@@ -30,6 +30,7 @@
 #include <Rect.h>
 #include <String.h>
 #include <StringList.h>
+#include <TLS.h>
 
 #include <assert.h>
 #include <ctype.h>
@@ -84,6 +85,165 @@ port_id BMessage::sReplyPorts[sNumReplyPorts];
 int32 BMessage::sReplyPortInUse[sNumReplyPorts];
 
 
+// #pragma mark - message pool
+
+
+/*!	Headers, field lists and data buffers of the minimum size are recycled
+	through a small pool per thread, as most messages are short lived and
+	never grow beyond that. Pooled blocks are ordinary malloc() blocks, so
+	blocks may be freed by a different thread than the one that allocated
+	them, and the pool may be used or not at any time.
+*/
+
+enum {
+	kMessagePoolHeaders = 0,
+	kMessagePoolFields,
+	kMessagePoolData,
+
+	kMessagePoolTypeCount
+};
+
+static const size_t kMessagePoolBlockSizes[kMessagePoolTypeCount] = {
+	sizeof(BMessage::message_header),
+	MIN_FIELD_PREALLOCATION * sizeof(BMessage::field_header),
+	MIN_DATA_PREALLOCATION
+};
+
+
+#if MESSAGE_POOL_ENABLED
+
+static const int32 kMaxPooledBlocks = 32;
+
+struct pooled_block {
+	pooled_block*	next;
+};
+
+struct message_pool {
+	pooled_block*	blocks[kMessagePoolTypeCount];
+	int32			counts[kMessagePoolTypeCount];
+};
+
+static int32 sMessagePoolSlot = -1;
+
+
+static void
+message_pool_delete(void* _pool)
+{
+	message_pool* pool = (message_pool*)_pool;
+	tls_set(sMessagePoolSlot, NULL);
+
+	for (int32 type = 0; type < kMessagePoolTypeCount; type++) {
+		pooled_block* block = pool->blocks[type];
+		while (block != NULL) {
+			pooled_block* next = block->next;
+			free(block);
+			block = next;
+		}
+	}
+
+	free(pool);
+}
+
+
+static message_pool*
+message_pool_get(bool create)
+{
+	if (sMessagePoolSlot < 0)
+		return NULL;
+
+	message_pool* pool = (message_pool*)tls_get(sMessagePoolSlot);
+	if (pool != NULL || !create)
+		return pool;
+
+	pool = (message_pool*)calloc(1, sizeof(message_pool));
+	if (pool == NULL)
+		return NULL;
+
+	if (on_exit_thread(&message_pool_delete, pool) != B_OK) {
+		free(pool);
+		return NULL;
+	}
+
+	tls_set(sMessagePoolSlot, pool);
+	return pool;
+}
+
+#endif	// MESSAGE_POOL_ENABLED
+
+
+static void*
+message_pool_allocate(int32 type)
+{
+#if MESSAGE_POOL_ENABLED
+	message_pool* pool = message_pool_get(true);
+	if (pool != NULL && pool->blocks[type] != NULL) {
+		pooled_block* block = pool->blocks[type];
+		pool->blocks[type] = block->next;
+		pool->counts[type]--;
+		return block;
+	}
+#endif
+
+	return malloc(kMessagePoolBlockSizes[type]);
+}
+
+
+/*!	Frees \a block, which is \a size bytes large. Blocks of the size of the
+	given pool type are put back into the pool.
+*/
+static void
+message_pool_free(int32 type, void* block, size_t size)
+{
+	if (block == NULL)
+		return;
+
+#if MESSAGE_POOL_ENABLED
+	if (size == kMessagePoolBlockSizes[type]) {
+		// don't create a pool just to free blocks, this might happen while
+		// the thread is exiting
+		message_pool* pool = message_pool_get(false);
+		if (pool != NULL && pool->counts[type] < kMaxPooledBlocks) {
+			pooled_block* pooledBlock = (pooled_block*)block;
+			pooledBlock->next = pool->blocks[type];
+			pool->blocks[type] = pooledBlock;
+			pool->counts[type]++;
+			return;
+		}
+	}
+#endif
+
+	free(block);
+}
+
+
+/*!	Resizes \a block from \a oldSize to \a newSize bytes, keeping its first
+	\a usedSize bytes. Blocks of the size of the given pool type are taken
+	from and put back into the pool, all others are reallocated.
+*/
+static void*
+message_pool_resize(int32 type, void* block, size_t oldSize, size_t newSize,
+	size_t usedSize)
+{
+	size_t poolSize = kMessagePoolBlockSizes[type];
+	if (oldSize != poolSize && newSize != poolSize)
+		return realloc(block, newSize);
+
+	void* newBlock = newSize == poolSize
+		? message_pool_allocate(type) : malloc(newSize);
+	if (newBlock == NULL)
+		return NULL;
+
+	if (usedSize > 0)
+		memcpy(newBlock, block, usedSize);
+
+	message_pool_free(type, block, oldSize);
+	return newBlock;
+}
+
+
+// #pragma mark -
+
+
 template<typename Type>
 static void
 print_to_stream_type(uint8* pointer)
@@ -196,7 +356,7 @@ BMessage::operator=(const BMessage& other)
 
 	_Clear();
 
-	fHeader = (message_header*)malloc(sizeof(message_header));
+	fHeader = (message_header*)message_pool_allocate(kMessagePoolHeaders);
 	if (fHeader == NULL)
 		return *this;
 
@@ -212,34 +372,22 @@ BMessage::operator=(const BMessage& other)
 		| MESSAGE_FLAG_PASS_BY_AREA);
 	// Note, that BeOS R5 seems to keep the reply info.
 
-	if (fHeader->field_count > 0) {
-		size_t fieldsSize = fHeader->field_count * sizeof(field_header);
-		if (other.fFields != NULL)
-			fFields = (field_header*)malloc(fieldsSize);
-
-		if (fFields == NULL) {
-			fHeader->field_count = 0;
-			fHeader->data_size = 0;
-		} else if (other.fFields != NULL)
-			memcpy(fFields, other.fFields, fieldsSize);
-	}
-
-	if (fHeader->data_size > 0) {
-		if (other.fData != NULL)
-			fData = (uint8*)malloc(fHeader->data_size);
-
-		if (fData == NULL) {
-			fHeader->field_count = 0;
-			free(fFields);
-			fFields = NULL;
-		} else if (other.fData != NULL)
+	if ((fHeader->field_count > 0 && other.fFields == NULL)
+		|| (fHeader->data_size > 0 && other.fData == NULL)
+		|| _AllocateBody() != B_OK) {
+		fHeader->field_count = 0;
+		fHeader->data_size = 0;
+	} else {
+		if (fHeader->field_count > 0) {
+			memcpy(fFields, other.fFields,
+				fHeader->field_count * sizeof(field_header));
+		}
+		if (fHeader->data_size > 0)
 			memcpy(fData, other.fData, fHeader->data_size);
 	}
 
 	fHeader->what = what = other.what;
 	fHeader->message_area = -1;
-	fFieldsAvailable = 0;
-	fDataAvailable = 0;
 
 	return *this;
 }
@@ -373,7 +521,7 @@ BMessage::_InitHeader()
 {
 	DEBUG_FUNCTION_ENTER;
 	if (fHeader == NULL) {
-		fHeader = (message_header*)malloc(sizeof(message_header));
+		fHeader = (message_header*)message_pool_allocate(kMessagePoolHeaders);
 		if (fHeader == NULL)
 			return B_NO_MEMORY;
 	}
@@ -412,20 +560,15 @@ BMessage::_Clear()
 		if (fHeader->message_area >= 0)
 			_Dereference();
 
-		free(fHeader);
+		_FreeBody();
+
+		message_pool_free(kMessagePoolHeaders, fHeader,
+			sizeof(message_header));
 		fHeader = NULL;
 	}
 
-	free(fFields);
-	fFields = NULL;
-	free(fData);
-	fData = NULL;
-
 	fArchivingPointer = NULL;
 
-	fFieldsAvailable = 0;
-	fDataAvailable = 0;
-
 	delete fOriginal;
 	fOriginal = NULL;
 
@@ -1216,35 +1359,25 @@ BMessage::_CopyForWrite()
 	if (fHeader == NULL)
 		return B_NO_INIT;
 
-	field_header* newFields = NULL;
-	uint8* newData = NULL;
+	field_header* areaFields = fFields;
+	uint8* areaData = fData;
 
-	if (fHeader->field_count > 0) {
-		size_t fieldsSize = fHeader->field_count * sizeof(field_header);
-		newFields = (field_header*)malloc(fieldsSize);
-		if (newFields == NULL)
-			return B_NO_MEMORY;
-
-		memcpy(newFields, fFields, fieldsSize);
+	status_t result = _AllocateBody();
+	if (result != B_OK) {
+		fFields = areaFields;
+		fData = areaData;
+		return result;
 	}
 
-	if (fHeader->data_size > 0) {
-		newData = (uint8*)malloc(fHeader->data_size);
-		if (newData == NULL) {
-			free(newFields);
-			return B_NO_MEMORY;
-		}
-
-		memcpy(newData, fData, fHeader->data_size);
+	if (fHeader->field_count > 0) {
+		memcpy(fFields, areaFields,
+			fHeader->field_count * sizeof(field_header));
 	}
+	if (fHeader->data_size > 0)
+		memcpy(fData, areaData, fHeader->data_size);
 
-	_Dereference();
-
-	fFieldsAvailable = 0;
-	fDataAvailable = 0;
-
-	fFields = newFields;
-	fData = newData;
+	delete_area(fHeader->message_area);
+	fHeader->message_area = -1;
 	return B_OK;
 }
 
@@ -1310,7 +1443,7 @@ BMessage::Unflatten(BDataIO* stream)
 
 	_Clear();
 
-	fHeader = (message_header*)malloc(sizeof(message_header));
+	fHeader = (message_header*)message_pool_allocate(kMessagePoolHeaders);
 	if (fHeader == NULL)
 		return B_NO_MEMORY;
 
@@ -1336,28 +1469,20 @@ BMessage::Unflatten(BDataIO* stream)
 	} else {
 		fHeader->message_area = -1;
 
+		status_t error = _AllocateBody();
+		if (error != B_OK) {
+			_InitHeader();
+			return error;
+		}
+
 		if (fHeader->field_count > 0) {
 			ssize_t fieldsSize = fHeader->field_count * sizeof(field_header);
-			fFields = (field_header*)malloc(fieldsSize);
-			if (fFields == NULL) {
-				_InitHeader();
-				return B_NO_MEMORY;
-			}
-
 			result = stream->Read(fFields, fieldsSize);
 			if (result != fieldsSize)
 				return result < 0 ? result : B_BAD_VALUE;
 		}
 
 		if (fHeader->data_size > 0) {
-			fData = (uint8*)malloc(fHeader->data_size);
-			if (fData == NULL) {
-				free(fFields);
-				fFields = NULL;
-				_InitHeader();
-				return B_NO_MEMORY;
-			}
-
 			result = stream->Read(fData, fHeader->data_size);
 			if (result != (ssize_t)fHeader->data_size)
 				return result < 0 ? result : B_BAD_VALUE;
@@ -1534,6 +1659,109 @@ BMessage::PopSpecifier()
 }
 
 
+/*!	Allocates the field list and the data buffer for the field count and
+	data size the header specifies, but leaves their contents to the caller.
+	Small bodies are rounded up to the minimum sizes, so that they can be
+	recycled through the message pool.
+	On error, the body is left empty, but the header is kept intact.
+*/
+status_t
+BMessage::_AllocateBody()
+{
+	uint32 fieldCount = fHeader->field_count;
+	uint32 dataSize = fHeader->data_size;
+
+	fHeader->field_count = 0;
+	fHeader->data_size = 0;
+	fFields = NULL;
+	fData = NULL;
+	fFieldsAvailable = 0;
+	fDataAvailable = 0;
+
+	status_t result = B_OK;
+	if (fieldCount > 0) {
+		result = _ResizeFields(max_c(fieldCount,
+			(uint32)MIN_FIELD_PREALLOCATION));
+	}
+	if (result == B_OK && dataSize > 0) {
+		result = _ResizeDataBuffer(max_c(dataSize,
+			(uint32)MIN_DATA_PREALLOCATION));
+	}
+
+	if (result != B_OK)
+		_FreeBody();
+	else {
+		fFieldsAvailable -= fieldCount;
+		fDataAvailable -= dataSize;
+	}
+
+	fHeader->field_count = fieldCount;
+	fHeader->data_size = dataSize;
+	return result;
+}
+
+
+void
+BMessage::_FreeBody()
+{
+	uint32 fieldCapacity = fHeader->field_count + fFieldsAvailable;
+	message_pool_free(kMessagePoolFields, fFields,
+		fieldCapacity * sizeof(field_header));
+	message_pool_free(kMessagePoolData, fData,
+		fHeader->data_size + fDataAvailable);
+
+	fFields = NULL;
+	fData = NULL;
+	fFieldsAvailable = 0;
+	fDataAvailable = 0;
+}
+
+
+/*!	Resizes the field list to room for \a capacity fields, which must not be
+	less than the number of fields in the message.
+*/
+status_t
+BMessage::_ResizeFields(uint32 capacity)
+{
+	uint32 count = fHeader->field_count;
+	uint32 oldCapacity = count + fFieldsAvailable;
+	if (capacity == oldCapacity)
+		return B_OK;
+
+	field_header* newFields = (field_header*)message_pool_resize(
+		kMessagePoolFields, fFields, oldCapacity * sizeof(field_header),
+		capacity * sizeof(field_header), count * sizeof(field_header));
+	if (newFields == NULL)
+		return B_NO_MEMORY;
+
+	fFields = newFields;
+	fFieldsAvailable = capacity - count;
+	return B_OK;
+}
+
+
+/*!	Resizes the data buffer to \a capacity bytes, which must not be less than
+	the size of the data in the message.
+*/
+status_t
+BMessage::_ResizeDataBuffer(size_t capacity)
+{
+	size_t size = fHeader->data_size;
+	size_t oldCapacity = size + fDataAvailable;
+	if (capacity == oldCapacity)
+		return B_OK;
+
+	uint8* newData = (uint8*)message_pool_resize(kMessagePoolData, fData,
+		oldCapacity, capacity, size);
+	if (newData == NULL)
+		return B_NO_MEMORY;
+
+	fData = newData;
+	fDataAvailable = capacity - size;
+	return B_OK;
+}
+
+
 void
 BMessage::_UpdateOffsets(uint32 offset, int32 change)
 {
@@ -1579,19 +1807,19 @@ BMessage::_ResizeData(uint32 offset, int32 change)
 		size_t size = fHeader->data_size * 2;
 		size = min_c(size, fHeader->data_size + MAX_DATA_PREALLOCATION);
 		size = max_c(size, fHeader->data_size + change);
+		size = max_c(size, MIN_DATA_PREALLOCATION);
 
-		uint8* newData = (uint8*)realloc(fData, size);
-		if (size > 0 && newData == NULL)
-			return B_NO_MEMORY;
+		status_t result = _ResizeDataBuffer(size);
+		if (result != B_OK)
+			return result;
 
-		fData = newData;
 		if (offset < fHeader->data_size) {
 			memmove(fData + offset + change, fData + offset,
 				fHeader->data_size - offset);
 		}
 
 		fHeader->data_size += change;
-		fDataAvailable = size - fHeader->data_size;
+		fDataAvailable -= change;
 	} else {
 		ssize_t length = fHeader->data_size - offset + change;
 		if (length > 0)
@@ -1602,17 +1830,9 @@ BMessage::_ResizeData(uint32 offset, int32 change)
 		fDataAvailable -= change;
 
 		if (fDataAvailable > MAX_DATA_PREALLOCATION) {
-			ssize_t available = MAX_DATA_PREALLOCATION / 2;
-			ssize_t size = fHeader->data_size + available;
-			uint8* newData = (uint8*)realloc(fData, size);
-			if (size > 0 && newData == NULL) {
-				// this is strange, but not really fatal
-				_UpdateOffsets(offset, change);
-				return B_OK;
-			}
-
-			fData = newData;
-			fDataAvailable = available;
+			// failing to shrink is strange, but not really fatal
+			_ResizeDataBuffer(fHeader->data_size
+				+ MAX_DATA_PREALLOCATION / 2);
 		}
 	}
 
@@ -1682,16 +1902,13 @@ BMessage::_AddField(const char* name, type_code type, bool isFixedSize,
 		return B_NO_INIT;
 
 	if (fFieldsAvailable <= 0) {
-		uint32 count = fHeader->field_count * 2 + 1;
+		uint32 count = fHeader->field_count * 2;
 		count = min_c(count, fHeader->field_count + MAX_FIELD_PREALLOCATION);
+		count = max_c(count, MIN_FIELD_PREALLOCATION);
 
-		field_header* newFields = (field_header*)realloc(fFields,
-			count * sizeof(field_header));
-		if (count > 0 && newFields == NULL)
-			return B_NO_MEMORY;
-
-		fFields = newFields;
-		fFieldsAvailable = count - fHeader->field_count;
+		status_t result = _ResizeFields(count);
+		if (result != B_OK)
+			return result;
 	}
 
 	uint32 hash = _HashName(name) % fHeader->hash_table_size;
@@ -1758,16 +1975,8 @@ BMessage::_RemoveField(field_header* field)
 	fFieldsAvailable++;
 
 	if (fFieldsAvailable > MAX_FIELD_PREALLOCATION) {
-		ssize_t available = MAX_FIELD_PREALLOCATION / 2;
-		size = (fHeader->field_count + available) * sizeof(field_header);
-		field_header* newFields = (field_header*)realloc(fFields, size);
-		if (size > 0 && newFields == NULL) {
-			// this is strange, but not really fatal
-			return B_OK;
-		}
-
-		fFields = newFields;
-		fFieldsAvailable = available;
+		// failing to shrink is strange, but not really fatal
+		_ResizeFields(fHeader->field_count + MAX_FIELD_PREALLOCATION / 2);
 	}
 
 	return B_OK;
@@ -2052,6 +2261,10 @@ BMessage::_StaticInit()
 	sReplyPortInUse[2] = 0;
 
 	sMsgCache = new BBlockCache(20, sizeof(BMessage), B_OBJECT_CACHE);
+
+#if MESSAGE_POOL_ENABLED
+	sMessagePoolSlot = tls_allocate();
+#endif
 }
 
 
@@ -2782,6 +2995,11 @@ BMessage::AddFlat(const char* name, const BFlattenable* object, int32 count)
 status_t
 BMessage::Append(const BMessage& other)
 {
+	status_t result = Reserve(other.fHeader->field_count,
+		other.fHeader->data_size);
+	if (result != B_OK)
+		return result;
+
 	field_header* field = other.fFields;
 	for (uint32 i = 0; i < other.fHeader->field_count; i++, field++) {
 		const char* name = (const char*)(other.fData + field->offset);
@@ -2808,6 +3026,36 @@ BMessage::Append(const BMessage& other)
 }
 
 
+status_t
+BMessage::Reserve(int32 fieldCount, size_t dataSize)
+{
+	DEBUG_FUNCTION_ENTER;
+	if (fHeader == NULL)
+		return B_NO_INIT;
+
+	if (fieldCount < 0 || dataSize > UINT32_MAX - fHeader->data_size)
+		return B_BAD_VALUE;
+
+	status_t result;
+	if (fHeader->message_area >= 0) {
+		result = _CopyForWrite();
+		if (result != B_OK)
+			return result;
+	}
+
+	if ((uint32)fieldCount > fFieldsAvailable) {
+		result = _ResizeFields(fHeader->field_count + fieldCount);
+		if (result != B_OK)
+			return result;
+	}
+
+	if (dataSize > fDataAvailable)
+		return _ResizeDataBuffer(fHeader->data_size + dataSize);
+
+	return B_OK;
+}
+
+
 status_t
 BMessage::FindAlignment(const char* name, BAlignment* alignment) const
 {
@@ -72,7 +72,9 @@ SymbolTableBasedImage::SymbolTableBasedImage()
 	fSymbolTable(NULL),
 	fStringTable(NULL),
 	fSymbolCount(0),
-	fStringTableSize(0)
+	fStringTableSize(0),
+	fSymbolsSorted(false),
+	fMaxSymbolSize(0)
 {
 }
 
@@ -91,29 +93,35 @@ SymbolTableBasedImage::LookupSymbol(addr_t address, addr_t* _baseAddress,
 	bool exactMatch = false;
 	addr_t deltaFound = ~(addr_t)0;
 
-	for (int32 i = 0; i < fSymbolCount; i++) {
-		const elf_sym* symbol = &fSymbolTable[i];
-
-		if (symbol->st_value == 0
-			|| symbol->st_size >= (size_t)fInfo.text_size + fInfo.data_size) {
-			continue;
-		}
+	if (fSymbolsSorted) {
+		symbolFound = _LookupSortedSymbol(address, exactMatch);
+		if (symbolFound != NULL)
+			symbolName = fStringTable + symbolFound->st_name;
+	} else {
+		for (int32 i = 0; i < fSymbolCount; i++) {
+			const elf_sym* symbol = &fSymbolTable[i];
+
+			if (symbol->st_value == 0 || symbol->st_size
+					>= (size_t)fInfo.text_size + fInfo.data_size) {
+				continue;
+			}
 
-		addr_t symbolAddress = symbol->st_value + fLoadDelta;
-		if (symbolAddress > address)
-			continue;
+			addr_t symbolAddress = symbol->st_value + fLoadDelta;
+			if (symbolAddress > address)
+				continue;
 
-		addr_t symbolDelta = address - symbolAddress;
-		if (symbolDelta >= 0 && symbolDelta < symbol->st_size)
-			exactMatch = true;
+			addr_t symbolDelta = address - symbolAddress;
+			if (symbolDelta >= 0 && symbolDelta < symbol->st_size)
+				exactMatch = true;
 
-		if (exactMatch || symbolDelta < deltaFound) {
-			deltaFound = symbolDelta;
-			symbolFound = symbol;
-			symbolName = fStringTable + symbol->st_name;
+			if (exactMatch || symbolDelta < deltaFound) {
+				deltaFound = symbolDelta;
+				symbolFound = symbol;
+				symbolName = fStringTable + symbol->st_name;
 
-			if (exactMatch)
-				break;
+				if (exactMatch)
+					break;
+			}
 		}
 	}
 
@@ -160,6 +168,54 @@ SymbolTableBasedImage::NextSymbol(int32& iterator, const char** _symbolName,
 }
 
 
+/*!	Like the linear search in LookupSymbol(), but for a symbol table sorted
+	by address: returns the closest symbol at or before \a address whose
+	range contains it, so that labels inside of a function don't hide the
+	function. If there is none, the closest symbol before \a address is
+	returned.
+*/
+const elf_sym*
+SymbolTableBasedImage::_LookupSortedSymbol(addr_t address,
+	bool& _exactMatch) const
+{
+	// binary search the first symbol after the address
+	int32 lower = 0;
+	int32 upper = fSymbolCount;
+	while (lower < upper) {
+		int32 mid = (lower + upper) / 2;
+		if (fSymbolTable[mid].st_value + fLoadDelta <= address)
+			lower = mid + 1;
+		else
+			upper = mid;
+	}
+
+	// Scan back for a symbol containing the address. None can start more
+	// than the largest symbol size before it.
+	const elf_sym* closestSymbol = NULL;
+	for (int32 i = lower - 1; i >= 0; i--) {
+		const elf_sym* symbol = &fSymbolTable[i];
+		if (symbol->st_value == 0
+			|| symbol->st_size >= (size_t)fInfo.text_size + fInfo.data_size) {
+			continue;
+		}
+
+		addr_t symbolDelta = address - (symbol->st_value + fLoadDelta);
+		if (symbolDelta < symbol->st_size) {
+			_exactMatch = true;
+			return symbol;
+		}
+
+		if (closestSymbol == NULL)
+			closestSymbol = symbol;
+		if (symbolDelta >= fMaxSymbolSize)
+			break;
+	}
+
+	_exactMatch = false;
+	return closestSymbol;
+}
+
+
 size_t
 SymbolTableBasedImage::_SymbolNameLen(const char* symbolName) const
 {
@@ -328,8 +384,28 @@ ImageFile::_LoadFile(const char* path, addr_t* _textAddress, size_t* _textSize,
 	status_t error = _FindTableInSection(elfHeader, SHT_SYMTAB);
 	if (error != B_OK)
 		error = _FindTableInSection(elfHeader, SHT_DYNSYM);
+	if (error != B_OK)
+		return error;
 
-	return error;
+	// Use the symbol table sorted by address from the cache, if possible.
+	if (fSymbolCache.Init(path, st) == B_OK
+		|| fSymbolCache.Create(path, st, fSymbolTable, fSymbolCount,
+			fStringTable, fStringTableSize) == B_OK) {
+		fSymbolTable = (elf_sym*)fSymbolCache.Symbols();
+		fSymbolCount = fSymbolCache.CountSymbols();
+		fStringTable = (char*)fSymbolCache.StringTable();
+		fStringTableSize = fSymbolCache.StringTableSize();
+		fSymbolsSorted = true;
+
+		size_t maxSize = *_textSize + *_dataSize;
+		for (int32 i = 0; i < fSymbolCount; i++) {
+			size_t size = fSymbolTable[i].st_size;
+			if (size > fMaxSymbolSize && size < maxSize)
+				fMaxSymbolSize = size;
+		}
+	}
+
+	return B_OK;
 }
 
 
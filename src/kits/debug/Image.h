@@ -14,6 +14,8 @@
 
 #include <util/DoublyLinkedList.h>
 
+#include "SymbolCache.h"
+
 
 struct image_t;
 struct runtime_loader_debug_area;
@@ -74,12 +76,18 @@ public:
 protected:
 			size_t				_SymbolNameLen(const char* symbolName) const;
 
+private:
+			const elf_sym*		_LookupSortedSymbol(addr_t address,
+									bool& _exactMatch) const;
+
 protected:
 			addr_t				fLoadDelta;
 			elf_sym*			fSymbolTable;
 			char*				fStringTable;
 			int32				fSymbolCount;
 			size_t				fStringTableSize;
+			bool				fSymbolsSorted;
+			size_t				fMaxSymbolSize;
 };
 
 
@@ -103,6 +111,7 @@ private:
 			int					fFD;
 			off_t				fFileSize;
 			uint8*				fMappedFile;
+			SymbolCache			fSymbolCache;
 };
 
 
@@ -0,0 +1,389 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include "SymbolCache.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <new>
+
+#include <AutoDeleter.h>
+#include <FindDirectory.h>
+
+
+using namespace BPrivate::Debug;
+
+
+static const uint32 kSymbolCacheMagic = 'dsyc';
+static const uint32 kSymbolCacheVersion = 2;
+static const char* const kSymbolCacheDirectory = "debug_symbols";
+
+// a cache file is marked as used at most once per day, and removed when it
+// hasn't been used for 30 days
+static const time_t kMarkUsedInterval = 24 * 60 * 60;
+static const time_t kMaxUnusedTime = 30 * 24 * 60 * 60;
+
+
+/*!	The header is followed by the path of the image file, padded to a
+	multiple of 8 bytes, the symbols, and their string table.
+*/
+struct symbol_cache_header {
+	int64	modification_time;
+	int64	file_size;
+	uint32	magic;
+	uint32	version;
+	uint32	symbol_count;
+	uint32	string_table_size;
+	uint32	path_size;
+	uint32	reserved;
+};
+
+
+struct SymbolAddressComparator {
+	bool operator()(const elf_sym& a, const elf_sym& b) const
+	{
+		return a.st_value < b.st_value;
+	}
+};
+
+
+static inline size_t
+padded_path_size(size_t pathSize)
+{
+	return (pathSize + 7) & ~(size_t)7;
+}
+
+
+static bool
+header_matches(const symbol_cache_header& header, const struct stat& imageStat)
+{
+	return header.magic == kSymbolCacheMagic
+		&& header.version == kSymbolCacheVersion
+		&& header.modification_time == imageStat.st_mtime
+		&& header.file_size == imageStat.st_size;
+}
+
+
+/*!	The device and node IDs of packaged files change between boots, so the
+	cache files are named after a hash of the image path instead.
+*/
+static uint64
+hash_path(const char* path)
+{
+	// FNV-1a
+	uint64 hash = 0xcbf29ce484222325ULL;
+	for (; *path != '\0'; path++) {
+		hash ^= (uint8)*path;
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+
+static status_t
+write_fully(int fd, const void* buffer, size_t size)
+{
+	ssize_t bytesWritten = write(fd, buffer, size);
+	if (bytesWritten < 0)
+		return errno;
+	return (size_t)bytesWritten == size ? B_OK : B_IO_ERROR;
+}
+
+
+// #pragma mark - SymbolCache
+
+
+SymbolCache::SymbolCache()
+	:
+	fMappedFile((uint8*)MAP_FAILED),
+	fMappedSize(0),
+	fSymbols(NULL),
+	fSymbolCount(0),
+	fStringTable(NULL),
+	fStringTableSize(0)
+{
+}
+
+
+SymbolCache::~SymbolCache()
+{
+	_Unset();
+}
+
+
+/*!	Maps the cached symbol table of the image file at \a imagePath.
+	Fails, if there is none, or if it is out of date.
+*/
+status_t
+SymbolCache::Init(const char* imagePath, const struct stat& imageStat)
+{
+	_Unset();
+
+	char path[B_PATH_NAME_LENGTH];
+	status_t error = _GetPath(imagePath, path, sizeof(path));
+	if (error != B_OK)
+		return error;
+
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return errno;
+	FileDescriptorCloser fdCloser(fd);
+
+	struct stat st;
+	if (fstat(fd, &st) < 0)
+		return errno;
+	if (st.st_size < (off_t)sizeof(symbol_cache_header))
+		return B_BAD_DATA;
+
+	fMappedSize = st.st_size;
+	fMappedFile = (uint8*)mmap(NULL, fMappedSize, PROT_READ, MAP_PRIVATE, fd,
+		0);
+	if (fMappedFile == MAP_FAILED)
+		return errno;
+
+	const symbol_cache_header& header
+		= *(const symbol_cache_header*)fMappedFile;
+	size_t pathSize = strlen(imagePath) + 1;
+	if (!header_matches(header, imageStat)
+		|| header.path_size != pathSize
+		|| sizeof(header) + padded_path_size(pathSize)
+			+ (size_t)header.symbol_count * sizeof(elf_sym)
+			+ header.string_table_size != fMappedSize
+		|| memcmp(fMappedFile + sizeof(header), imagePath, pathSize) != 0) {
+		_Unset();
+		return B_BAD_DATA;
+	}
+
+	fSymbols = (const elf_sym*)(fMappedFile + sizeof(header)
+		+ padded_path_size(pathSize));
+	fSymbolCount = header.symbol_count;
+	fStringTable = (const char*)(fSymbols + fSymbolCount);
+	fStringTableSize = header.string_table_size;
+
+	// the names must not run past the end of the file
+	if (fStringTableSize == 0 || fStringTable[fStringTableSize - 1] != '\0') {
+		_Unset();
+		return B_BAD_DATA;
+	}
+
+	for (int32 i = 0; i < fSymbolCount; i++) {
+		if (fSymbols[i].st_name >= fStringTableSize) {
+			_Unset();
+			return B_BAD_DATA;
+		}
+	}
+
+	// mark the file as used, so that it isn't removed
+	if (time(NULL) - st.st_mtime > kMarkUsedInterval)
+		utimes(path, NULL);
+
+	return B_OK;
+}
+
+
+/*!	Writes the cached symbol table for the image file at \a imagePath, and
+	maps it. Only symbols with an address are kept.
+	The file is written under a temporary name and renamed into place, so
+	that concurrent readers and writers never see a partial file. Since this
+	doesn't happen often, unused cache files are removed at the same time.
+*/
+status_t
+SymbolCache::Create(const char* imagePath, const struct stat& imageStat,
+	const elf_sym* symbols, int32 symbolCount, const char* stringTable,
+	size_t stringTableSize)
+{
+	_Unset();
+
+	// The names may be shared in the image's string table, so their total
+	// size is computed first.
+	size_t namesSize = 1;
+	for (int32 i = 0; i < symbolCount; i++) {
+		const elf_sym& symbol = symbols[i];
+		if (symbol.st_value != 0 && symbol.st_name < stringTableSize) {
+			namesSize += strnlen(stringTable + symbol.st_name,
+				stringTableSize - symbol.st_name) + 1;
+		}
+	}
+
+	// copy the symbols and their names
+	elf_sym* sortedSymbols = new(std::nothrow) elf_sym[symbolCount];
+	char* names = (char*)malloc(namesSize);
+	ArrayDeleter<elf_sym> symbolsDeleter(sortedSymbols);
+	MemoryDeleter namesDeleter(names);
+	if (sortedSymbols == NULL || names == NULL)
+		return B_NO_MEMORY;
+
+	int32 sortedCount = 0;
+	namesSize = 1;
+	names[0] = '\0';
+	for (int32 i = 0; i < symbolCount; i++) {
+		const elf_sym& symbol = symbols[i];
+		if (symbol.st_value == 0 || symbol.st_name >= stringTableSize)
+			continue;
+
+		const char* name = stringTable + symbol.st_name;
+		size_t nameLength = strnlen(name, stringTableSize - symbol.st_name);
+
+		elf_sym& sortedSymbol = sortedSymbols[sortedCount++];
+		sortedSymbol = symbol;
+		sortedSymbol.st_name = namesSize;
+		memcpy(names + namesSize, name, nameLength);
+		names[namesSize + nameLength] = '\0';
+		namesSize += nameLength + 1;
+	}
+
+	std::stable_sort(sortedSymbols, sortedSymbols + sortedCount,
+		SymbolAddressComparator());
+
+	size_t pathSize = strlen(imagePath) + 1;
+
+	symbol_cache_header header;
+	memset(&header, 0, sizeof(header));
+	header.modification_time = imageStat.st_mtime;
+	header.file_size = imageStat.st_size;
+	header.magic = kSymbolCacheMagic;
+	header.version = kSymbolCacheVersion;
+	header.symbol_count = sortedCount;
+	header.string_table_size = namesSize;
+	header.path_size = pathSize;
+
+	// write the file
+	char path[B_PATH_NAME_LENGTH];
+	status_t error = _GetPath(imagePath, path, sizeof(path));
+	if (error != B_OK)
+		return error;
+
+	char tempPath[B_PATH_NAME_LENGTH];
+	snprintf(tempPath, sizeof(tempPath), "%s.%" B_PRId32, path,
+		find_thread(NULL));
+
+	int fd = open(tempPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		return errno;
+
+	static const char kPadding[8] = {};
+	error = write_fully(fd, &header, sizeof(header));
+	if (error == B_OK)
+		error = write_fully(fd, imagePath, pathSize);
+	if (error == B_OK) {
+		error = write_fully(fd, kPadding,
+			padded_path_size(pathSize) - pathSize);
+	}
+	if (error == B_OK) {
+		error = write_fully(fd, sortedSymbols,
+			sortedCount * sizeof(elf_sym));
+	}
+	if (error == B_OK)
+		error = write_fully(fd, names, namesSize);
+	close(fd);
+
+	if (error == B_OK && rename(tempPath, path) < 0)
+		error = errno;
+	if (error != B_OK) {
+		unlink(tempPath);
+		return error;
+	}
+
+	if (_GetDirectory(path, sizeof(path)) == B_OK)
+		_RemoveUnused(path);
+
+	return Init(imagePath, imageStat);
+}
+
+
+void
+SymbolCache::_Unset()
+{
+	if (fMappedFile != MAP_FAILED)
+		munmap(fMappedFile, fMappedSize);
+
+	fMappedFile = (uint8*)MAP_FAILED;
+	fMappedSize = 0;
+	fSymbols = NULL;
+	fSymbolCount = 0;
+	fStringTable = NULL;
+	fStringTableSize = 0;
+}
+
+
+/*static*/ status_t
+SymbolCache::_GetDirectory(char* path, size_t size)
+{
+	status_t error = find_directory(B_USER_CACHE_DIRECTORY, -1, true, path,
+		size);
+	if (error != B_OK)
+		return error;
+
+	if (strlcat(path, "/", size) >= size
+		|| strlcat(path, kSymbolCacheDirectory, size) >= size) {
+		return B_NAME_TOO_LONG;
+	}
+
+	if (mkdir(path, 0755) < 0 && errno != B_FILE_EXISTS)
+		return errno;
+
+	return B_OK;
+}
+
+
+/*static*/ status_t
+SymbolCache::_GetPath(const char* imagePath, char* path, size_t size)
+{
+	status_t error = _GetDirectory(path, size);
+	if (error != B_OK)
+		return error;
+
+	size_t length = strlen(path);
+	if ((size_t)snprintf(path + length, size - length, "/%016" B_PRIx64,
+			hash_path(imagePath)) >= size - length) {
+		return B_NAME_TOO_LONG;
+	}
+
+	return B_OK;
+}
+
+
+/*!	Removes the cache files, and any leftover temporary files, that haven't
+	been used for a while. This includes the line number tables the Debugger
+	stores in the same directory.
+*/
+/*static*/ void
+SymbolCache::_RemoveUnused(const char* directory)
+{
+	DIR* dir = opendir(directory);
+	if (dir == NULL)
+		return;
+
+	time_t now = time(NULL);
+	char path[B_PATH_NAME_LENGTH];
+	while (dirent* entry = readdir(dir)) {
+		if (strcmp(entry->d_name, ".") == 0
+			|| strcmp(entry->d_name, "..") == 0) {
+			continue;
+		}
+
+		struct stat st;
+		if ((size_t)snprintf(path, sizeof(path), "%s/%s", directory,
+				entry->d_name) >= sizeof(path)
+			|| lstat(path, &st) < 0 || !S_ISREG(st.st_mode)) {
+			continue;
+		}
+
+		if (now - st.st_mtime > kMaxUnusedTime)
+			unlink(path);
+	}
+
+	closedir(dir);
+}
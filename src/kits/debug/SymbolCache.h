@@ -0,0 +1,68 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef SYMBOL_CACHE_H
+#define SYMBOL_CACHE_H
+
+
+#include <sys/stat.h>
+
+#include <elf_private.h>
+#include <OS.h>
+
+
+namespace BPrivate {
+namespace Debug {
+
+
+/*!	A copy of the symbol table of an image file, sorted by address, and with
+	a string table containing only the names of the symbols. It is stored in
+	the user's cache directory, keyed by the path of the image file, and
+	checked against its modification time and size, so that all tools using
+	this library share it. Copies that haven't been used for a while are
+	removed.
+*/
+class SymbolCache {
+public:
+								SymbolCache();
+								~SymbolCache();
+
+			status_t			Init(const char* imagePath,
+									const struct stat& imageStat);
+			status_t			Create(const char* imagePath,
+									const struct stat& imageStat,
+									const elf_sym* symbols, int32 symbolCount,
+									const char* stringTable,
+									size_t stringTableSize);
+
+			const elf_sym*		Symbols() const		{ return fSymbols; }
+			int32				CountSymbols() const
+									{ return fSymbolCount; }
+			const char*			StringTable() const	{ return fStringTable; }
+			size_t				StringTableSize() const
+									{ return fStringTableSize; }
+
+private:
+			void				_Unset();
+
+	static	status_t			_GetDirectory(char* path, size_t size);
+	static	status_t			_GetPath(const char* imagePath, char* path,
+									size_t size);
+	static	void				_RemoveUnused(const char* directory);
+
+private:
+			uint8*				fMappedFile;
+			size_t				fMappedSize;
+			const elf_sym*		fSymbols;
+			int32				fSymbolCount;
+			const char*			fStringTable;
+			size_t				fStringTableSize;
+};
+
+
+}	// namespace Debug
+}	// namespace BPrivate
+
+
+#endif	// SYMBOL_CACHE_H
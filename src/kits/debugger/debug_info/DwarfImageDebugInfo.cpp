@@ -44,6 +44,7 @@
 #include "Image.h"
 #include "ImageDebugInfo.h"
 #include "InstructionInfo.h"
+#include "LineNumberTable.h"
 #include "LocatableFile.h"
 #include "Register.h"
 #include "RegisterMap.h"
@@ -342,6 +343,8 @@ DwarfImageDebugInfo::DwarfImageDebugInfo(const ImageInfo& imageInfo,
 	fTypeCache(typeCache),
 	fSourceInfo(sourceInfo),
 	fTypeNameTable(NULL),
+	fTypeNameUnits(20, false),
+	fTypeNamesComplete(false),
 	fFile(file),
 	fTextSegment(NULL),
 	fRelocationDelta(0),
@@ -397,7 +400,13 @@ DwarfImageDebugInfo::Init()
 		fPLTSectionEnd = fPLTSectionStart + section->Size();
 	}
 
-	return _BuildTypeNameTable();
+	// The type names are added when types are first looked up, see
+	// _LoadTypeNames(), so that only the units needed are loaded.
+	fTypeNameTable = new(std::nothrow) TypeNameTable;
+	if (fTypeNameTable == NULL)
+		return B_NO_MEMORY;
+
+	return fTypeNameTable->Init();
 }
 
 
@@ -409,9 +418,15 @@ DwarfImageDebugInfo::GetFunctions(const BObjectList<SymbolInfo>& symbols,
 	TRACE_IMAGES("  %" B_PRId32 " compilation units\n",
 		fFile->CountCompilationUnits());
 
-	status_t error = B_OK;
-	for (int32 i = 0; CompilationUnit* unit = fFile->CompilationUnitAt(i);
-			i++) {
+	// Only the units containing code can define functions. Their source
+	// files are needed for the function list right away, so the units
+	// are loaded here, in parallel.
+	BObjectList<CompilationUnit> units(20, false);
+	status_t error = fFile->GetCodeCompilationUnits(units);
+	if (error != B_OK)
+		return error;
+
+	for (int32 i = 0; CompilationUnit* unit = units.ItemAt(i); i++) {
 		DIECompileUnitBase* unitEntry = unit->UnitEntry();
 //		printf("  %s:\n", unitEntry->Name());
 //		printf("    address ranges:\n");
@@ -468,11 +483,25 @@ status_t
 DwarfImageDebugInfo::GetType(GlobalTypeCache* cache, const BString& name,
 	const TypeLookupConstraints& constraints, Type*& _type)
 {
-	TypeNameEntry* entry = fTypeNameTable->Lookup(name);
-	if (entry == NULL)
-		return B_ENTRY_NOT_FOUND;
+	// Creating a type may look up other types, so the lock is only held to
+	// get the candidates.
+	TypeEntryList types(10, false);
+	{
+		AutoLocker<BLocker> locker(fLock);
 
-	for (int32 i = 0; TypeEntryInfo* info = entry->types.ItemAt(i); i++) {
+		status_t error = _LoadTypeNames(name);
+		if (error != B_OK)
+			return error;
+
+		TypeNameEntry* entry = fTypeNameTable->Lookup(name);
+		if (entry == NULL)
+			return B_ENTRY_NOT_FOUND;
+
+		if (!types.AddList(&entry->types))
+			return B_NO_MEMORY;
+	}
+
+	for (int32 i = 0; TypeEntryInfo* info = types.ItemAt(i); i++) {
 		DIEType* typeEntry = info->type;
 		if (constraints.HasTypeKind()) {
 			if (dwarf_tag_to_type_kind(typeEntry->Tag())
@@ -540,6 +569,12 @@ bool
 DwarfImageDebugInfo::HasType(const BString& name,
 	const TypeLookupConstraints& constraints) const
 {
+	DwarfImageDebugInfo* self = const_cast<DwarfImageDebugInfo*>(this);
+	AutoLocker<BLocker> locker(self->fLock);
+
+	if (self->_LoadTypeNames(name) != B_OK)
+		return false;
+
 	TypeNameEntry* entry = fTypeNameTable->Lookup(name);
 	if (entry == NULL)
 		return false;
@@ -647,7 +682,7 @@ DwarfImageDebugInfo::CreateFrame(Image* image,
 		= cpuState->InstructionPointer() - fRelocationDelta;
 	target_addr_t framePointer;
 	CompilationUnit* unit = function != NULL ? function->GetCompilationUnit()
-			: NULL;
+			: fFile->CompilationUnitForAddress(instructionPointer);
 	error = fFile->UnwindCallFrame(unit, fArchitecture->AddressSize(), entry,
 		instructionPointer, inputInterface, outputInterface, framePointer);
 
@@ -793,10 +828,10 @@ DwarfImageDebugInfo::GetStatement(FunctionDebugInfo* _function,
 	// comparison below
 	int32 fileIndex = _GetSourceFileIndex(unit, file);
 
-	// Get the statement by executing the line number program for the
+	// Get the statement from the decoded line number program of the
 	// compilation unit.
-	LineNumberProgram& program = unit->GetLineNumberProgram();
-	if (!program.IsValid()) {
+	const LineNumberTable* table = fFile->GetLineNumberTable(unit);
+	if (table == NULL) {
 		TRACE_CODE("  -> no line number program\n");
 		return B_BAD_DATA;
 	}
@@ -804,20 +839,28 @@ DwarfImageDebugInfo::GetStatement(FunctionDebugInfo* _function,
 	// adjust address
 	address -= fRelocationDelta;
 
-	LineNumberProgram::State state;
-	program.GetInitialState(state);
+	// only the sequence covering the address has to be looked at
+	const LineNumberTable::Sequence* sequence
+		= table->SequenceForAddress(address);
+	if (sequence == NULL) {
+		TRACE_CODE("  -> no line number program match\n");
+		return B_ENTRY_NOT_FOUND;
+	}
 
+	const LineNumberTable::Row* rows = table->Rows() + sequence->firstRow;
 	target_addr_t statementAddress = 0;
 	int32 statementLine = -1;
 	int32 statementColumn = -1;
-	while (program.GetNextRow(state)) {
+	for (uint32 i = 0; i < sequence->rowCount; i++) {
+		const LineNumberTable::Row& row = rows[i];
+
 		// skip statements of other files
-		if (state.file != fileIndex)
+		if (row.file != fileIndex)
 			continue;
 
 		if (statementAddress != 0
-			&& (state.isStatement || state.isSequenceEnd)) {
-			target_addr_t endAddress = state.address;
+			&& (row.IsStatement() || row.IsSequenceEnd())) {
+			target_addr_t endAddress = row.address;
 			if (address >= statementAddress && address < endAddress) {
 				ContiguousStatement* statement = new(std::nothrow)
 					ContiguousStatement(
@@ -834,11 +877,11 @@ DwarfImageDebugInfo::GetStatement(FunctionDebugInfo* _function,
 			statementAddress = 0;
 		}
 
-		if (state.isStatement) {
-			statementAddress = state.address;
-			statementLine = state.line - 1;
+		if (row.IsStatement()) {
+			statementAddress = row.address;
+			statementLine = row.line - 1;
 			// discard column info until proper support is implemented
-			// statementColumn = std::max(state.column - 1, (int32)0);
+			// statementColumn = std::max(row.column - 1, (int32)0);
 			statementColumn = 0;
 		}
 	}
@@ -878,24 +921,22 @@ DwarfImageDebugInfo::GetStatementAtSourceLocation(FunctionDebugInfo* _function,
 	// comparison below
 	int32 fileIndex = _GetSourceFileIndex(unit, file);
 
-	// Get the statement by executing the line number program for the
+	// Get the statement from the decoded line number program of the
 	// compilation unit.
-	LineNumberProgram& program = unit->GetLineNumberProgram();
-	if (!program.IsValid())
+	const LineNumberTable* table = fFile->GetLineNumberTable(unit);
+	if (table == NULL)
 		return B_BAD_DATA;
 
-	LineNumberProgram::State state;
-	program.GetInitialState(state);
-
 	target_addr_t statementAddress = 0;
 	int32 statementLine = -1;
 	int32 statementColumn = -1;
-	while (program.GetNextRow(state)) {
-		bool isOurFile = state.file == fileIndex;
+	for (int32 i = 0; i < table->CountRows(); i++) {
+		const LineNumberTable::Row& row = table->Rows()[i];
+		bool isOurFile = row.file == fileIndex;
 
 		if (statementAddress != 0
-			&& (!isOurFile || state.isStatement || state.isSequenceEnd)) {
-			target_addr_t endAddress = state.address;
+			&& (!isOurFile || row.IsStatement() || row.IsSequenceEnd())) {
+			target_addr_t endAddress = row.address;
 
 			if (statementAddress < endAddress) {
 				TRACE_LINES2("  statement: %#" B_PRIx64 " - %#" B_PRIx64
@@ -930,11 +971,11 @@ DwarfImageDebugInfo::GetStatementAtSourceLocation(FunctionDebugInfo* _function,
 		if (!isOurFile)
 			continue;
 
-		if (state.isStatement) {
-			statementAddress = state.address;
-			statementLine = state.line - 1;
+		if (row.IsStatement()) {
+			statementAddress = row.address;
+			statementLine = row.line - 1;
 			// discard column info until proper support is implemented
-			// statementColumn = std::max(state.column - 1, (int32)0);
+			// statementColumn = std::max(row.column - 1, (int32)0);
 			statementColumn = 0;
 		}
 	}
@@ -991,14 +1032,19 @@ status_t
 DwarfImageDebugInfo::AddSourceCodeInfo(LocatableFile* file,
 	FileSourceCode* sourceCode)
 {
+	// only units containing code have line information
+	BObjectList<CompilationUnit> units(20, false);
+	status_t error = fFile->GetCodeCompilationUnits(units);
+	if (error != B_OK)
+		return error;
+
 	bool addedAny = false;
-	for (int32 i = 0; CompilationUnit* unit = fFile->CompilationUnitAt(i);
-			i++) {
+	for (int32 i = 0; CompilationUnit* unit = units.ItemAt(i); i++) {
 		int32 fileIndex = _GetSourceFileIndex(unit, file);
 		if (fileIndex < 0)
 			continue;
 
-		status_t error = _AddSourceCodeInfo(unit, sourceCode, fileIndex);
+		error = _AddSourceCodeInfo(unit, sourceCode, fileIndex);
 		if (error == B_NO_MEMORY)
 			return error;
 		addedAny |= error == B_OK;
@@ -1012,28 +1058,26 @@ status_t
 DwarfImageDebugInfo::_AddSourceCodeInfo(CompilationUnit* unit,
 	FileSourceCode* sourceCode, int32 fileIndex)
 {
-	// Get the statements by executing the line number program for the
-	// compilation unit and filtering the rows for our source file.
-	LineNumberProgram& program = unit->GetLineNumberProgram();
-	if (!program.IsValid())
+	// Get the statements from the decoded line number program of the
+	// compilation unit, filtering the rows for our source file.
+	const LineNumberTable* table = fFile->GetLineNumberTable(unit);
+	if (table == NULL)
 		return B_BAD_DATA;
 
-	LineNumberProgram::State state;
-	program.GetInitialState(state);
-
 	target_addr_t statementAddress = 0;
 	int32 statementLine = -1;
 	int32 statementColumn = -1;
-	while (program.GetNextRow(state)) {
+	for (int32 i = 0; i < table->CountRows(); i++) {
+		const LineNumberTable::Row& row = table->Rows()[i];
 		TRACE_LINES2("  %#" B_PRIx64 "  (%" B_PRId32 ", %" B_PRId32 ", %"
-			B_PRId32 ")  %d\n", state.address, state.file, state.line,
-			state.column, state.isStatement);
+			B_PRId32 ")  %d\n", row.address, row.file, row.line,
+			row.column, row.IsStatement());
 
-		bool isOurFile = state.file == fileIndex;
+		bool isOurFile = row.file == fileIndex;
 
 		if (statementAddress != 0
-			&& (!isOurFile || state.isStatement || state.isSequenceEnd)) {
-			target_addr_t endAddress = state.address;
+			&& (!isOurFile || row.IsStatement() || row.IsSequenceEnd())) {
+			target_addr_t endAddress = row.address;
 			if (endAddress > statementAddress) {
 				// add the statement
 				status_t error = sourceCode->AddSourceLocation(
@@ -1054,11 +1098,11 @@ DwarfImageDebugInfo::_AddSourceCodeInfo(CompilationUnit* unit,
 		if (!isOurFile)
 			continue;
 
-		if (state.isStatement) {
-			statementAddress = state.address;
-			statementLine = state.line - 1;
+		if (row.IsStatement()) {
+			statementAddress = row.address;
+			statementLine = row.line - 1;
 			// discard column info until proper support is implemented
-			// statementColumn = std::max(state.column - 1, (int32)0);
+			// statementColumn = std::max(row.column - 1, (int32)0);
 			statementColumn = 0;
 		}
 	}
@@ -1433,40 +1477,84 @@ DwarfImageDebugInfo::_AddFunction(DIESubprogram* subprogramEntry,
 }
 
 
-status_t
-DwarfImageDebugInfo::_BuildTypeNameTable()
+static int
+compare_unit_offsets(const CompilationUnit* a, const CompilationUnit* b)
 {
-	fTypeNameTable = new(std::nothrow) TypeNameTable;
-	if (fTypeNameTable == NULL)
-		return B_NO_MEMORY;
+	if (a->HeaderOffset() < b->HeaderOffset())
+		return -1;
+	return a->HeaderOffset() > b->HeaderOffset() ? 1 : 0;
+}
 
-	status_t error = fTypeNameTable->Init();
-	if (error != B_OK)
-		return error;
 
-	// iterate through all compilation units
-	for (int32 i = 0; CompilationUnit* unit = fFile->CompilationUnitAt(i);
-		i++) {
-		// iterate through all types of the compilation unit
-		for (DebugInfoEntryList::ConstIterator it
-				= unit->UnitEntry()->Types().GetIterator();
-			DIEType* typeEntry = dynamic_cast<DIEType*>(it.Next());) {
+/*!	Makes sure the type name table contains the types called \a name. If the
+	file has a .debug_pubtypes section, only the units it lists for the name
+	are loaded. Otherwise all units are loaded and added on the first call.
+	The caller must hold fLock.
+*/
+status_t
+DwarfImageDebugInfo::_LoadTypeNames(const BString& name)
+{
+	if (fTypeNamesComplete)
+		return B_OK;
+
+	BObjectList<CompilationUnit> units(20, false);
+	if (fFile->HasPublicTypeNames()) {
+		status_t error = fFile->GetCompilationUnitsForTypeName(name, units);
+		if (error != B_OK)
+			return error;
+	} else {
+		status_t error = fFile->LoadCompilationUnits();
+		if (error != B_OK)
+			return error;
 
-			if (_RecursiveAddTypeNames(typeEntry, unit) != B_OK)
+		for (int32 i = 0; CompilationUnit* unit = fFile->CompilationUnitAt(i);
+				i++) {
+			if (!units.AddItem(unit))
 				return B_NO_MEMORY;
 		}
+		fTypeNamesComplete = true;
+	}
 
-		for (DebugInfoEntryList::ConstIterator it
-			= unit->UnitEntry()->OtherChildren().GetIterator();
-			DebugInfoEntry* child = it.Next();) {
-			DIENamespace* namespaceEntry = dynamic_cast<DIENamespace*>(child);
-			if (namespaceEntry == NULL)
-				continue;
+	for (int32 i = 0; CompilationUnit* unit = units.ItemAt(i); i++) {
+		if (fTypeNameUnits.BinarySearch(*unit, &compare_unit_offsets) != NULL)
+			continue;
 
-			if (_RecursiveTraverseNamespaceForTypes(namespaceEntry, unit)
-					!= B_OK) {
-				return B_NO_MEMORY;
-			}
+		status_t error = _AddTypeNames(unit);
+		if (error != B_OK) {
+			fTypeNamesComplete = false;
+			return error;
+		}
+	}
+
+	return B_OK;
+}
+
+
+status_t
+DwarfImageDebugInfo::_AddTypeNames(CompilationUnit* unit)
+{
+	if (!fTypeNameUnits.BinaryInsert(unit, &compare_unit_offsets))
+		return B_NO_MEMORY;
+
+	// iterate through all types of the compilation unit
+	for (DebugInfoEntryList::ConstIterator it
+			= unit->UnitEntry()->Types().GetIterator();
+		DIEType* typeEntry = dynamic_cast<DIEType*>(it.Next());) {
+
+		if (_RecursiveAddTypeNames(typeEntry, unit) != B_OK)
+			return B_NO_MEMORY;
+	}
+
+	for (DebugInfoEntryList::ConstIterator it
+		= unit->UnitEntry()->OtherChildren().GetIterator();
+		DebugInfoEntry* child = it.Next();) {
+		DIENamespace* namespaceEntry = dynamic_cast<DIENamespace*>(child);
+		if (namespaceEntry == NULL)
+			continue;
+
+		if (_RecursiveTraverseNamespaceForTypes(namespaceEntry, unit)
+				!= B_OK) {
+			return B_NO_MEMORY;
 		}
 	}
 
@@ -140,7 +140,8 @@ private:
 									CompilationUnit* unit,
 									BObjectList<FunctionDebugInfo>& functions);
 
-			status_t			_BuildTypeNameTable();
+			status_t			_LoadTypeNames(const BString& name);
+			status_t			_AddTypeNames(CompilationUnit* unit);
 			status_t			_RecursiveAddTypeNames(DIEType* type,
 									CompilationUnit* unit);
 			status_t			_RecursiveTraverseNamespaceForTypes(
@@ -157,6 +158,8 @@ private:
 			GlobalTypeCache*	fTypeCache;
 			TeamFunctionSourceInformation* fSourceInfo;
 			TypeNameTable*		fTypeNameTable;
+			BObjectList<CompilationUnit> fTypeNameUnits;
+			bool				fTypeNamesComplete;
 			DwarfFile*			fFile;
 			ElfSegment*			fTextSegment;
 			target_addr_t		fRelocationDelta;
@@ -37,7 +37,8 @@ CompilationUnit::CompilationUnit(off_t headerOffset, off_t contentOffset,
 	fAddressRanges(NULL),
 	fDirectories(10, true),
 	fFiles(10, true),
-	fLineNumberProgram(addressSize)
+	fLineNumberProgram(addressSize),
+	fLoadState(dwarf_unit_load_state_none)
 {
 }
 
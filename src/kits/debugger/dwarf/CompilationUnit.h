@@ -11,6 +11,7 @@
 
 #include "BaseUnit.h"
 #include "LineNumberProgram.h"
+#include "LineNumberTable.h"
 #include "Types.h"
 
 
@@ -18,6 +19,15 @@ class DIECompileUnitBase;
 class TargetAddressRangeList;
 
 
+enum dwarf_unit_load_state {
+	dwarf_unit_load_state_none = 0,
+		// only the unit header has been read
+	dwarf_unit_load_state_entries,
+		// the entry tree exists, but the attributes aren't set yet
+	dwarf_unit_load_state_complete
+};
+
+
 class CompilationUnit : public BaseUnit {
 public:
 								CompilationUnit(off_t headerOffset,
@@ -29,6 +39,10 @@ public:
 
 	inline	target_addr_t		MaxAddress() const;
 
+			dwarf_unit_load_state LoadState() const	{ return fLoadState; }
+			void				SetLoadState(dwarf_unit_load_state state)
+									{ fLoadState = state; }
+
 			DIECompileUnitBase*	UnitEntry() const	{ return fUnitEntry; }
 			void				SetUnitEntry(DIECompileUnitBase* entry);
 
@@ -41,6 +55,8 @@ public:
 
 			LineNumberProgram&	GetLineNumberProgram()
 									{ return fLineNumberProgram; }
+			LineNumberTable&	GetLineNumberTable()
+									{ return fLineNumberTable; }
 
 			bool				AddDirectory(const char* directory);
 			int32				CountDirectories() const;
@@ -64,6 +80,8 @@ private:
 			DirectoryList		fDirectories;
 			FileList			fFiles;
 			LineNumberProgram	fLineNumberProgram;
+			LineNumberTable		fLineNumberTable;
+			dwarf_unit_load_state fLoadState;
 };
 
 
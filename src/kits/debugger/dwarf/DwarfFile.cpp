@@ -7,12 +7,16 @@
 
 #include "DwarfFile.h"
 
+#include <sys/stat.h>
+
 #include <algorithm>
 #include <new>
 
 #include <AutoDeleter.h>
+#include <AutoLocker.h>
 #include <Entry.h>
 #include <FindDirectory.h>
+#include <OS.h>
 #include <Path.h>
 #include <PathFinder.h>
 
@@ -25,6 +29,8 @@
 #include "DwarfExpressionEvaluator.h"
 #include "DwarfTargetInterface.h"
 #include "ElfFile.h"
+#include "LineNumberTableCache.h"
+#include "StringUtils.h"
 #include "TagNames.h"
 #include "TargetAddressRangeList.h"
 #include "Tracing.h"
@@ -481,6 +487,180 @@ public:
 };
 
 
+// #pragma mark - UnitAddressRange
+
+
+struct DwarfFile::UnitAddressRange {
+public:
+	UnitAddressRange(target_addr_t start, target_addr_t end,
+		CompilationUnit* unit)
+	:
+	start(start),
+	end(end),
+	unit(unit)
+	{
+	}
+
+	static int CompareRanges(const UnitAddressRange* a,
+		const UnitAddressRange* b)
+	{
+		if (a->start < b->start)
+			return -1;
+		else if (a->start > b->start)
+			return 1;
+
+		return 0;
+	}
+
+	inline bool ContainsAddress(target_addr_t address) const
+	{
+		return address >= start && address < end;
+	}
+
+	target_addr_t 		start;
+	target_addr_t 		end;
+	CompilationUnit*	unit;
+};
+
+
+// #pragma mark - PublicTypeEntry
+
+
+/*!	Returns the part of \a name after its last scope operator, ignoring any
+	within template arguments. Compilers don't agree on whether the names in
+	.debug_pubtypes are qualified, so only this part is compared.
+*/
+static const char*
+public_type_base_name(const char* name)
+{
+	const char* baseName = name;
+	int32 depth = 0;
+	for (const char* c = name; *c != '\0'; c++) {
+		if (*c == '<' || *c == '(')
+			depth++;
+		else if ((*c == '>' || *c == ')') && depth > 0)
+			depth--;
+		else if (depth == 0 && c[0] == ':' && c[1] == ':')
+			baseName = ++c + 1;
+	}
+
+	return baseName;
+}
+
+
+static int
+compare_unit_offsets(const CompilationUnit* a, const CompilationUnit* b)
+{
+	if (a->HeaderOffset() < b->HeaderOffset())
+		return -1;
+	return a->HeaderOffset() > b->HeaderOffset() ? 1 : 0;
+}
+
+
+struct DwarfFile::PublicTypeEntry {
+	PublicTypeEntry(const char* name)
+	:
+	name(name),
+	units(4, false),
+	next(NULL)
+	{
+	}
+
+	const char*			name;
+	CompilationUnitList	units;
+	PublicTypeEntry*	next;
+};
+
+
+struct DwarfFile::PublicTypeHashDefinition {
+	typedef const char*		KeyType;
+	typedef	PublicTypeEntry	ValueType;
+
+	size_t HashKey(const char* key) const
+	{
+		return StringUtils::HashValue(key);
+	}
+
+	size_t Hash(PublicTypeEntry* value) const
+	{
+		return HashKey(value->name);
+	}
+
+	bool Compare(const char* key, PublicTypeEntry* value) const
+	{
+		return strcmp(value->name, key) == 0;
+	}
+
+	PublicTypeEntry*& GetLink(PublicTypeEntry* value) const
+	{
+		return value->next;
+	}
+};
+
+
+// #pragma mark - UnitLoader
+
+
+static const int32 kMaxUnitLoaderThreads = 8;
+
+
+/*!	Parses or finishes a list of compilation units. The units are handed out
+	one at a time to all threads running Run(), which stop at the first error.
+*/
+struct DwarfFile::UnitLoader {
+public:
+	UnitLoader(DwarfFile* file, const CompilationUnitList& units, bool finish)
+	:
+	fFile(file),
+	fUnits(units),
+	fFinish(finish),
+	fNextIndex(0),
+	fError(B_OK)
+	{
+	}
+
+	void Run()
+	{
+		while (atomic_get(&fError) == B_OK) {
+			int32 index = atomic_add(&fNextIndex, 1);
+			CompilationUnit* unit = fUnits.ItemAt(index);
+			if (unit == NULL)
+				break;
+
+			status_t error = fFinish
+				? fFile->_FinishUnit(unit)
+				: fFile->_ParseCompilationUnit(unit);
+			if (error != B_OK) {
+				atomic_test_and_set(&fError, error, B_OK);
+				break;
+			}
+
+			unit->SetLoadState(fFinish
+				? dwarf_unit_load_state_complete
+				: dwarf_unit_load_state_entries);
+		}
+	}
+
+	static status_t ThreadEntry(void* data)
+	{
+		((UnitLoader*)data)->Run();
+		return B_OK;
+	}
+
+	status_t Error() const
+	{
+		return fError;
+	}
+
+private:
+	DwarfFile*					fFile;
+	const CompilationUnitList&	fUnits;
+	bool						fFinish;
+	int32						fNextIndex;
+	int32						fError;
+};
+
+
 // #pragma mark - DwarfFile
 
 
@@ -500,11 +680,17 @@ DwarfFile::DwarfFile()
 	fDebugLocationSection(NULL),
 	fDebugPublicTypesSection(NULL),
 	fDebugTypesSection(NULL),
+	fDebugAddressRangesSection(NULL),
 	fCompilationUnits(20, true),
+	fUnitAddressRanges(20, true),
+	fUnitLock("dwarf units"),
+	fParseLock("dwarf unit references"),
+	fPublicTypes(NULL),
+	fLineNumberTableCache(NULL),
+	fLineNumberTableCacheWritten(false),
 	fTypeUnits(),
 	fDebugFrameInfos(100, true),
 	fEHFrameInfos(100, true),
-	fTypesSectionRequired(false),
 	fFinished(false),
 	fItaniumEHFrameFormat(false),
 	fFinishError(B_OK)
@@ -530,6 +716,7 @@ DwarfFile::~DwarfFile()
 		fElfFile->PutSection(fEHFrameSection);
 		debugInfoFile->PutSection(fDebugLocationSection);
 		debugInfoFile->PutSection(fDebugPublicTypesSection);
+		debugInfoFile->PutSection(fDebugAddressRangesSection);
 		delete fElfFile;
 		delete fAlternateElfFile;
 	}
@@ -541,6 +728,10 @@ DwarfFile::~DwarfFile()
 		entry = nextEntry;
 	}
 
+	_DeletePublicTypes();
+
+	delete fLineNumberTableCache;
+
 	free(fName);
 	free(fAlternateName);
 }
@@ -613,27 +804,38 @@ DwarfFile::Load(uint8 addressSize, const BString& externalInfoFilePath)
 
 	fDebugLocationSection = debugInfoFile->GetSection(".debug_loc");
 	fDebugPublicTypesSection = debugInfoFile->GetSection(".debug_pubtypes");
+	fDebugAddressRangesSection = debugInfoFile->GetSection(".debug_aranges");
 
 	if (fDebugInfoSection == NULL) {
 		fFinished = true;
 		return B_OK;
 	}
 
+	error = fUnitLock.InitCheck();
+	if (error != B_OK)
+		return error;
+	error = fParseLock.InitCheck();
+	if (error != B_OK)
+		return error;
+
+	// Only the unit headers are read here, the entries of a compilation unit
+	// are parsed when it is first needed, see LoadCompilationUnits().
 	error = _ParseDebugInfoSection();
 	if (error != B_OK)
 		return error;
 
-	if (fTypesSectionRequired) {
-		fDebugTypesSection = debugInfoFile->GetSection(".debug_types");
-		if (fDebugTypesSection == NULL) {
-			WARNING(".debug_types section required but missing.\n");
-			return B_BAD_DATA;
-		}
+	// Whether the type units are referenced isn't known before the
+	// compilation units are parsed, so they are parsed if present.
+	fDebugTypesSection = debugInfoFile->GetSection(".debug_types");
+	if (fDebugTypesSection != NULL) {
 		error = _ParseTypesSection();
 		if (error != B_OK)
 			return error;
 	}
 
+	if (fDebugAddressRangesSection != NULL)
+		return _ParseAddressRangesSection();
+
 	return B_OK;
 }
 
@@ -654,14 +856,12 @@ DwarfFile::FinishLoading()
 			return fFinishError = error;
 	}
 
-	for (int32 i = 0; CompilationUnit* unit = fCompilationUnits.ItemAt(i);
-			i++) {
-		error = _FinishUnit(unit);
-		if (error != B_OK)
-			return fFinishError = error;
+	if (_ParsePublicTypesInfo() != B_OK) {
+		// An incomplete index would hide types, so none is used at all.
+		_DeletePublicTypes();
 	}
 
-	_ParsePublicTypesInfo();
+	_InitLineNumberTableCache();
 
 	fFinished = true;
 	return B_OK;
@@ -675,10 +875,152 @@ DwarfFile::CountCompilationUnits() const
 }
 
 
+/*!	Loads all compilation units that haven't been loaded yet, see
+	_LoadCompilationUnits().
+*/
+status_t
+DwarfFile::LoadCompilationUnits()
+{
+	AutoLocker<BLocker> locker(fUnitLock);
+	if (fFinishError != B_OK)
+		return fFinishError;
+
+	return _LoadCompilationUnits(fCompilationUnits);
+}
+
+
+/*!	Loads and returns the compilation units that may contain code, which are
+	those covered by .debug_aranges. Without that section all units are
+	returned.
+*/
+status_t
+DwarfFile::GetCodeCompilationUnits(BObjectList<CompilationUnit>& _units)
+{
+	AutoLocker<BLocker> locker(fUnitLock);
+	if (fFinishError != B_OK)
+		return fFinishError;
+
+	if (fDebugAddressRangesSection == NULL) {
+		status_t error = _LoadCompilationUnits(fCompilationUnits);
+		if (error != B_OK)
+			return error;
+
+		_WriteLineNumberTableCache(fCompilationUnits);
+		return _units.AddList(&fCompilationUnits) ? B_OK : B_NO_MEMORY;
+	}
+
+	// The ranges are sorted by address, so the same unit may occur several
+	// times. Order the units like in the file and drop the duplicates.
+	CompilationUnitList units(20, false);
+	for (int32 i = 0; UnitAddressRange* range = fUnitAddressRanges.ItemAt(i);
+			i++) {
+		if (!units.AddItem(range->unit))
+			return B_NO_MEMORY;
+	}
+	units.SortItems(&compare_unit_offsets);
+
+	for (int32 i = 0; CompilationUnit* unit = units.ItemAt(i); i++) {
+		if ((i == 0 || units.ItemAt(i - 1) != unit) && !_units.AddItem(unit))
+			return B_NO_MEMORY;
+	}
+
+	status_t error = _LoadCompilationUnits(_units);
+	if (error != B_OK)
+		return error;
+
+	_WriteLineNumberTableCache(_units);
+	return B_OK;
+}
+
+
+/*!	Returns whether the file has a .debug_pubtypes section. If so,
+	GetCompilationUnitsForTypeName() can be used to find the units defining
+	a type.
+*/
+bool
+DwarfFile::HasPublicTypeNames() const
+{
+	return fPublicTypes != NULL;
+}
+
+
+/*!	Loads and returns the compilation units that .debug_pubtypes lists for
+	a type called \a name. Only the part of the name after its last scope
+	operator is compared, so the units may define other types as well.
+*/
+status_t
+DwarfFile::GetCompilationUnitsForTypeName(const char* name,
+	BObjectList<CompilationUnit>& _units)
+{
+	if (fPublicTypes == NULL)
+		return B_ENTRY_NOT_FOUND;
+
+	PublicTypeEntry* entry = fPublicTypes->Lookup(
+		public_type_base_name(name));
+	if (entry == NULL)
+		return B_OK;
+
+	if (!_units.AddList(&entry->units))
+		return B_NO_MEMORY;
+
+	AutoLocker<BLocker> locker(fUnitLock);
+	if (fFinishError != B_OK)
+		return fFinishError;
+
+	return _LoadCompilationUnits(_units);
+}
+
+
+/*!	Returns the compilation unit at \a index, loading it first if needed.
+	Returns \c NULL if the index is out of range, or the unit could not be
+	loaded.
+*/
 CompilationUnit*
-DwarfFile::CompilationUnitAt(int32 index) const
+DwarfFile::CompilationUnitAt(int32 index)
 {
-	return fCompilationUnits.ItemAt(index);
+	CompilationUnit* unit = fCompilationUnits.ItemAt(index);
+	if (unit == NULL)
+		return NULL;
+
+	AutoLocker<BLocker> locker(fUnitLock);
+	return _LoadCompilationUnit(unit) == B_OK ? unit : NULL;
+}
+
+
+/*!	Returns the compilation unit covering \a address, which must not be
+	relocated, loading only that unit if the file has a .debug_aranges
+	section. Otherwise all units are loaded once to build the index.
+*/
+CompilationUnit*
+DwarfFile::CompilationUnitForAddress(target_addr_t address)
+{
+	AutoLocker<BLocker> locker(fUnitLock);
+
+	if (fDebugAddressRangesSection == NULL && fUnitAddressRanges.IsEmpty()
+		&& !fCompilationUnits.IsEmpty()) {
+		if (LoadCompilationUnits() != B_OK || _BuildUnitAddressRanges() != B_OK)
+			return NULL;
+	}
+
+	// binary search
+	int lower = 0;
+	int upper = fUnitAddressRanges.CountItems() - 1;
+	if (upper < 0)
+		return NULL;
+
+	while (lower < upper) {
+		int mid = (lower + upper + 1) / 2;
+		if (address < fUnitAddressRanges.ItemAt(mid)->start)
+			upper = mid - 1;
+		else
+			lower = mid;
+	}
+
+	UnitAddressRange* range = fUnitAddressRanges.ItemAt(lower);
+	if (!range->ContainsAddress(address))
+		return NULL;
+
+	return _LoadCompilationUnit(range->unit) == B_OK ? range->unit : NULL;
 }
 
 
@@ -706,6 +1048,31 @@ DwarfFile::CompilationUnitForDIE(const DebugInfoEntry* entry) const
 }
 
 
+/*!	Returns the decoded line number table of \a unit, or \c NULL, if it
+	has none. The table is taken from the cache, if that is up to date,
+	otherwise the unit's line number program is decoded.
+*/
+const LineNumberTable*
+DwarfFile::GetLineNumberTable(CompilationUnit* unit)
+{
+	AutoLocker<BLocker> locker(fUnitLock);
+
+	LineNumberTable& table = unit->GetLineNumberTable();
+	if (table.IsValid())
+		return &table;
+
+	if (fLineNumberTableCache != NULL
+		&& fLineNumberTableCache->GetTable(unit->HeaderOffset(), table)) {
+		return &table;
+	}
+
+	if (table.Init(unit->GetLineNumberProgram()) != B_OK)
+		return NULL;
+
+	return &table;
+}
+
+
 TargetAddressRangeList*
 DwarfFile::ResolveRangeList(CompilationUnit* unit, uint64 offset) const
 {
@@ -1025,11 +1392,16 @@ DwarfFile::_ParseDebugInfoSection()
 			return B_NO_MEMORY;
 		}
 
-		// parse the debug info for the unit
-		status_t error = _ParseCompilationUnit(unit);
+		// The abbreviation tables are shared between the units, so they are
+		// looked up here, before the units may get parsed in parallel.
+		AbbreviationTable* abbreviationTable;
+		status_t error = _GetAbbreviationTable(abbrevOffset,
+			abbreviationTable);
 		if (error != B_OK)
 			return error;
 
+		unit->SetAbbreviationTable(abbreviationTable);
+
 		dataReader.SeekAbsolute(unitLengthOffset + unitLength);
 	}
 
@@ -1129,6 +1501,120 @@ DwarfFile::_ParseTypesSection()
 }
 
 
+status_t
+DwarfFile::_ParseAddressRangesSection()
+{
+	DataReader dataReader(fDebugAddressRangesSection->Data(),
+		fDebugAddressRangesSection->Size(), 4);
+	while (dataReader.HasData()) {
+		off_t setOffset = dataReader.Offset();
+		bool dwarf64;
+		uint64 setLength = dataReader.ReadInitialLength(dwarf64);
+
+		off_t setLengthOffset = dataReader.Offset();
+		if (setLengthOffset + setLength
+				> (uint64)fDebugAddressRangesSection->Size()) {
+			WARNING("\"%s\": Invalid address range set length.\n", fName);
+			break;
+		}
+
+		uint16 version = dataReader.Read<uint16>(0);
+		off_t unitOffset = dwarf64
+			? dataReader.Read<uint64>(0)
+			: dataReader.Read<uint32>(0);
+		uint8 addressSize = dataReader.Read<uint8>(0);
+		uint8 segmentSize = dataReader.Read<uint8>(0);
+
+		if (dataReader.HasOverflow()) {
+			WARNING("\"%s\": Unexpected end of data in address range set "
+				"header.\n", fName);
+			break;
+		}
+
+		CompilationUnit* unit = _GetContainingCompilationUnit(unitOffset);
+		if (version != 2 || segmentSize != 0
+			|| (addressSize != 4 && addressSize != 8) || unit == NULL) {
+			WARNING("\"%s\": Ignoring address range set at %" B_PRIdOFF
+				".\n", fName, setOffset);
+			dataReader.SeekAbsolute(setLengthOffset + setLength);
+			continue;
+		}
+		dataReader.SetAddressSize(addressSize);
+
+		// the tuples are aligned to twice the address size
+		off_t tupleSize = 2 * addressSize;
+		off_t tuplesOffset = (dataReader.Offset() - setOffset + tupleSize - 1)
+			/ tupleSize * tupleSize + setOffset;
+		dataReader.SeekAbsolute(tuplesOffset);
+
+		while (dataReader.Offset() < setLengthOffset + (off_t)setLength) {
+			target_addr_t start = dataReader.ReadAddress(0);
+			target_addr_t length = dataReader.ReadAddress(0);
+			if (dataReader.HasOverflow() || (start == 0 && length == 0))
+				break;
+
+			status_t error = _AddUnitAddressRange(unit, start, start + length);
+			if (error != B_OK)
+				return error;
+		}
+
+		dataReader.SeekAbsolute(setLengthOffset + setLength);
+	}
+
+	return B_OK;
+}
+
+
+status_t
+DwarfFile::_AddUnitAddressRange(CompilationUnit* unit, target_addr_t start,
+	target_addr_t end)
+{
+	if (start >= end)
+		return B_OK;
+
+	UnitAddressRange* range = new(std::nothrow) UnitAddressRange(start, end,
+		unit);
+	if (range == NULL
+		|| !fUnitAddressRanges.BinaryInsert(range,
+			UnitAddressRange::CompareRanges)) {
+		delete range;
+		return B_NO_MEMORY;
+	}
+
+	return B_OK;
+}
+
+
+/*!	Builds the address index from the loaded compilation units, for files
+	without a .debug_aranges section.
+*/
+status_t
+DwarfFile::_BuildUnitAddressRanges()
+{
+	for (int32 i = 0; CompilationUnit* unit = fCompilationUnits.ItemAt(i);
+			i++) {
+		status_t error = B_OK;
+		if (TargetAddressRangeList* ranges = unit->AddressRanges()) {
+			for (int32 j = 0; j < ranges->CountRanges(); j++) {
+				TargetAddressRange range = ranges->RangeAt(j);
+				error = _AddUnitAddressRange(unit, range.Start(), range.End());
+				if (error != B_OK)
+					break;
+			}
+		} else {
+			DIECompileUnitBase* unitEntry = unit->UnitEntry();
+			error = _AddUnitAddressRange(unit, unitEntry->LowPC(),
+				unitEntry->HighPC());
+		}
+
+		if (error != B_OK)
+			return error;
+	}
+
+	return B_OK;
+}
+
+
 status_t
 DwarfFile::_ParseFrameSection(ElfSection* section, uint8 addressSize,
 	bool ehFrame, FDEInfoList& infos)
@@ -1242,22 +1728,14 @@ DwarfFile::_ParseFrameSection(ElfSection* section, uint8 addressSize,
 status_t
 DwarfFile::_ParseCompilationUnit(CompilationUnit* unit)
 {
-	AbbreviationTable* abbreviationTable;
-	status_t error = _GetAbbreviationTable(unit->AbbreviationOffset(),
-		abbreviationTable);
-	if (error != B_OK)
-		return error;
-
-	unit->SetAbbreviationTable(abbreviationTable);
-
 	DataReader dataReader(
 		(const uint8*)fDebugInfoSection->Data() + unit->ContentOffset(),
 		unit->ContentSize(), unit->AddressSize());
 
 	DebugInfoEntry* entry;
 	bool endOfEntryList;
-	error = _ParseDebugInfoEntry(dataReader, unit, abbreviationTable, entry,
-		endOfEntryList);
+	status_t error = _ParseDebugInfoEntry(dataReader, unit,
+		unit->GetAbbreviationTable(), entry, endOfEntryList);
 	if (error != B_OK)
 		return error;
 
@@ -1283,6 +1761,130 @@ DwarfFile::_ParseCompilationUnit(CompilationUnit* unit)
 }
 
 
+/*!	Loads \a unit, and all units it refers to, completely.
+	The caller must hold fUnitLock.
+*/
+status_t
+DwarfFile::_LoadCompilationUnit(CompilationUnit* unit)
+{
+	if (unit->LoadState() == dwarf_unit_load_state_complete)
+		return B_OK;
+	if (fFinishError != B_OK)
+		return fFinishError;
+
+	if (unit->LoadState() == dwarf_unit_load_state_none) {
+		status_t error = _ParseCompilationUnit(unit);
+		if (error != B_OK)
+			return fFinishError = error;
+		unit->SetLoadState(dwarf_unit_load_state_entries);
+	}
+
+	// Finishing a unit may parse the entries of the units it refers to,
+	// which then have to be finished as well.
+	bool finishedAny;
+	do {
+		finishedAny = false;
+		for (int32 i = 0; CompilationUnit* other = fCompilationUnits.ItemAt(i);
+				i++) {
+			if (other->LoadState() != dwarf_unit_load_state_entries)
+				continue;
+
+			status_t error = _FinishUnit(other);
+			if (error != B_OK)
+				return fFinishError = error;
+			other->SetLoadState(dwarf_unit_load_state_complete);
+			finishedAny = true;
+		}
+	} while (finishedAny);
+
+	return B_OK;
+}
+
+
+/*!	Loads the given units, and all units they refer to, completely. The
+	entries of the units are parsed first, then their attributes are set, as
+	those may refer to entries in other units. Both steps are spread over as
+	many threads as there are CPUs. The caller must hold fUnitLock.
+*/
+status_t
+DwarfFile::_LoadCompilationUnits(const CompilationUnitList& units)
+{
+	CompilationUnitList pending(20, false);
+	for (int32 i = 0; CompilationUnit* unit = units.ItemAt(i); i++) {
+		if (unit->LoadState() == dwarf_unit_load_state_none
+			&& !pending.AddItem(unit)) {
+			return B_NO_MEMORY;
+		}
+	}
+
+	status_t error = _RunUnitLoader(pending, false);
+	if (error != B_OK)
+		return fFinishError = error;
+
+	// Setting the attributes may parse the entries of units that haven't
+	// been loaded yet, which then have to be finished as well.
+	while (true) {
+		pending.MakeEmpty(false);
+		for (int32 i = 0; CompilationUnit* unit = fCompilationUnits.ItemAt(i);
+				i++) {
+			if (unit->LoadState() == dwarf_unit_load_state_entries
+				&& !pending.AddItem(unit)) {
+				return B_NO_MEMORY;
+			}
+		}
+
+		if (pending.IsEmpty())
+			return B_OK;
+
+		error = _RunUnitLoader(pending, true);
+		if (error != B_OK)
+			return fFinishError = error;
+	}
+}
+
+
+/*!	Parses the entries of the given units, or, if \a finish is \c true,
+	sets their attributes. The caller must hold fUnitLock.
+*/
+status_t
+DwarfFile::_RunUnitLoader(const CompilationUnitList& units, bool finish)
+{
+	int32 count = units.CountItems();
+	if (count == 0)
+		return B_OK;
+
+	int32 threadCount = 1;
+	system_info info;
+	if (get_system_info(&info) == B_OK)
+		threadCount = std::min((int32)info.cpu_count, kMaxUnitLoaderThreads);
+	threadCount = std::max((int32)1, std::min(threadCount, count));
+
+	UnitLoader loader(this, units, finish);
+
+	thread_id threads[kMaxUnitLoaderThreads];
+	int32 spawnedCount = 0;
+	for (int32 i = 1; i < threadCount; i++) {
+		thread_id thread = spawn_thread(&UnitLoader::ThreadEntry,
+			"dwarf unit loader", B_NORMAL_PRIORITY, &loader);
+		if (thread < 0)
+			break;
+
+		threads[spawnedCount++] = thread;
+		resume_thread(thread);
+	}
+
+	// this thread does its share of the work as well
+	loader.Run();
+
+	for (int32 i = 0; i < spawnedCount; i++) {
+		status_t result;
+		wait_for_thread(threads[i], &result);
+	}
+
+	return loader.Error();
+}
+
+
 status_t
 DwarfFile::_ParseTypeUnit(TypeUnit* unit)
 {
@@ -1628,7 +2230,6 @@ DwarfFile::_ParseEntryAttributes(DataReader& dataReader,
 				attributeValue.SetToFlag(true);
 				break;
 			case DW_FORM_ref_sig8:
-				fTypesSectionRequired = true;
 				value = dataReader.Read<uint64>(0);
 				refType = dwarf_reference_type_signature;
 				break;
@@ -1863,6 +2464,55 @@ DwarfFile::_ParseLineInfo(CompilationUnit* unit)
 }
 
 
+/*!	Maps the cached line number tables of the file, if they are up to date.
+	Otherwise they are written once the units containing code have been
+	loaded.
+*/
+void
+DwarfFile::_InitLineNumberTableCache()
+{
+	if (fDebugLineSection == NULL)
+		return;
+
+	const char* path = fAlternateName != NULL ? fAlternateName : fName;
+	struct stat st;
+	if (stat(path, &st) < 0)
+		return;
+
+	fLineNumberTableCache = new(std::nothrow) LineNumberTableCache;
+	if (fLineNumberTableCache != NULL)
+		fLineNumberTableCache->Init(path, st);
+}
+
+
+/*!	Decodes the line number programs of the given units, and writes their
+	tables to the cache, if it isn't up to date. This is only tried once.
+	The caller must hold fUnitLock.
+*/
+void
+DwarfFile::_WriteLineNumberTableCache(const CompilationUnitList& units)
+{
+	if (fLineNumberTableCache == NULL || fLineNumberTableCache->IsValid()
+		|| fLineNumberTableCacheWritten) {
+		return;
+	}
+	fLineNumberTableCacheWritten = true;
+
+	for (int32 i = 0; CompilationUnit* unit = units.ItemAt(i); i++) {
+		LineNumberTable& table = unit->GetLineNumberTable();
+		if (!table.IsValid()
+			&& table.Init(unit->GetLineNumberProgram()) == B_NO_MEMORY) {
+			return;
+		}
+	}
+
+	const char* path = fAlternateName != NULL ? fAlternateName : fName;
+	struct stat st;
+	if (stat(path, &st) == 0)
+		fLineNumberTableCache->Create(path, st, units);
+}
+
+
 status_t
 DwarfFile::_UnwindCallFrame(CompilationUnit* unit, uint8 addressSize,
 	DIESubprogram* subprogramEntry, target_addr_t location,
@@ -2571,6 +3221,14 @@ DwarfFile::_ParsePublicTypesInfo()
 		return B_ENTRY_NOT_FOUND;
 	}
 
+	fPublicTypes = new(std::nothrow) PublicTypeTable;
+	if (fPublicTypes == NULL)
+		return B_NO_MEMORY;
+
+	status_t error = fPublicTypes->Init();
+	if (error != B_OK)
+		return error;
+
 	DataReader dataReader((uint8*)fDebugPublicTypesSection->Data(),
 		fDebugPublicTypesSection->Size(), 4);
 		// address size doesn't matter at this point
@@ -2588,17 +3246,19 @@ DwarfFile::_ParsePublicTypesInfo()
 		if (unitLengthOffset + unitLength
 				> (uint64)fDebugPublicTypesSection->Size()) {
 			WARNING("Invalid public types set unit length.\n");
-			break;
+			return B_BAD_DATA;
 		}
 
 		DataReader unitDataReader(dataReader.Data(), unitLength, 4);
 			// address size doesn't matter
-		_ParsePublicTypesInfo(unitDataReader, dwarf64);
+		error = _ParsePublicTypesInfo(unitDataReader, dwarf64);
+		if (error != B_OK)
+			return error;
 
 		dataReader.SeekAbsolute(unitLengthOffset + unitLength);
 	}
 
-	return B_OK;
+	return fPublicTypes->CountElements() > 0 ? B_OK : B_ENTRY_NOT_FOUND;
 }
 
 
@@ -2611,7 +3271,7 @@ DwarfFile::_ParsePublicTypesInfo(DataReader& dataReader, bool dwarf64)
 		return B_UNSUPPORTED;
 	}
 
-	TRACE_PUBTYPES_ONLY(off_t debugInfoOffset =) dwarf64
+	off_t debugInfoOffset = dwarf64
 		? dataReader.Read<uint64>(0)
 		: (uint64)dataReader.Read<uint32>(0);
 	TRACE_PUBTYPES_ONLY(off_t debugInfoSize =) dwarf64
@@ -2625,6 +3285,10 @@ DwarfFile::_ParsePublicTypesInfo(DataReader& dataReader, bool dwarf64)
 		"info: (%" B_PRIdOFF ", %" B_PRIdOFF ")\n", debugInfoOffset,
 		debugInfoSize);
 
+	CompilationUnit* unit = _GetContainingCompilationUnit(debugInfoOffset);
+	if (unit == NULL)
+		return B_BAD_DATA;
+
 	while (dataReader.BytesRemaining() > 0) {
 		off_t entryOffset = dwarf64
 			? dataReader.Read<uint64>(0)
@@ -2632,15 +3296,66 @@ DwarfFile::_ParsePublicTypesInfo(DataReader& dataReader, bool dwarf64)
 		if (entryOffset == 0)
 			return B_OK;
 
-		TRACE_PUBTYPES_ONLY(const char* name =) dataReader.ReadString();
+		const char* name = dataReader.ReadString();
+		if (dataReader.HasOverflow())
+			return B_BAD_DATA;
 
 		TRACE_PUBTYPES("  \"%s\" -> %" B_PRIdOFF "\n", name, entryOffset);
+
+		status_t error = _AddPublicTypeName(name, unit);
+		if (error != B_OK)
+			return error;
 	}
 
 	return B_OK;
 }
 
 
+status_t
+DwarfFile::_AddPublicTypeName(const char* name, CompilationUnit* unit)
+{
+	// the names point into the section data, which stays loaded
+	const char* baseName = public_type_base_name(name);
+
+	PublicTypeEntry* entry = fPublicTypes->Lookup(baseName);
+	if (entry == NULL) {
+		entry = new(std::nothrow) PublicTypeEntry(baseName);
+		if (entry == NULL)
+			return B_NO_MEMORY;
+
+		status_t error = fPublicTypes->Insert(entry);
+		if (error != B_OK) {
+			delete entry;
+			return error;
+		}
+	}
+
+	// all names of a unit are in the same set
+	if (entry->units.LastItem() == unit)
+		return B_OK;
+
+	return entry->units.AddItem(unit) ? B_OK : B_NO_MEMORY;
+}
+
+
+void
+DwarfFile::_DeletePublicTypes()
+{
+	if (fPublicTypes == NULL)
+		return;
+
+	PublicTypeEntry* entry = fPublicTypes->Clear(true);
+	while (entry != NULL) {
+		PublicTypeEntry* next = entry->next;
+		delete entry;
+		entry = next;
+	}
+
+	delete fPublicTypes;
+	fPublicTypes = NULL;
+}
+
+
 status_t
 DwarfFile::_GetAbbreviationTable(off_t offset, AbbreviationTable*& _table)
 {
@@ -2674,7 +3389,7 @@ DwarfFile::_GetAbbreviationTable(off_t offset, AbbreviationTable*& _table)
 
 DebugInfoEntry*
 DwarfFile::_ResolveReference(BaseUnit* unit, uint64 offset,
-	uint8 refType) const
+	uint8 refType)
 {
 	switch (refType) {
 		case dwarf_reference_type_local:
@@ -2686,6 +3401,20 @@ DwarfFile::_ResolveReference(BaseUnit* unit, uint64 offset,
 			if (unit == NULL)
 				break;
 
+			if (unit->LoadState() == dwarf_unit_load_state_none) {
+				// The referenced unit hasn't been parsed yet. Its
+				// attributes are set by the caller holding fUnitLock, once
+				// the unit referring to it has been finished. That may be
+				// waiting for the loader threads, so the parsing is
+				// serialized by another lock.
+				AutoLocker<BLocker> locker(fParseLock);
+				if (unit->LoadState() == dwarf_unit_load_state_none) {
+					if (_ParseCompilationUnit(unit) != B_OK)
+						break;
+					unit->SetLoadState(dwarf_unit_load_state_entries);
+				}
+			}
+
 			offset -= unit->HeaderOffset();
 			DebugInfoEntry* entry = unit->EntryForOffset(offset);
 			if (entry != NULL)
@@ -7,6 +7,7 @@
 #define DWARF_FILE_H
 
 
+#include <Locker.h>
 #include <ObjectList.h>
 #include <Referenceable.h>
 #include <util/DoublyLinkedList.h>
@@ -25,6 +26,8 @@ class DataReader;
 class DwarfTargetInterface;
 class ElfFile;
 class ElfSection;
+class LineNumberTable;
+class LineNumberTableCache;
 class TargetAddressRangeList;
 class ValueLocation;
 
@@ -48,11 +51,24 @@ public:
 									{ return fDebugFrameSection != NULL
 										|| fEHFrameSection != NULL; }
 
+			status_t			LoadCompilationUnits();
+			status_t			GetCodeCompilationUnits(
+									BObjectList<CompilationUnit>& _units);
+
+			bool				HasPublicTypeNames() const;
+			status_t			GetCompilationUnitsForTypeName(
+									const char* name,
+									BObjectList<CompilationUnit>& _units);
+
 			int32				CountCompilationUnits() const;
-			CompilationUnit*	CompilationUnitAt(int32 index) const;
+			CompilationUnit*	CompilationUnitAt(int32 index);
+			CompilationUnit*	CompilationUnitForAddress(
+									target_addr_t address);
 			CompilationUnit*	CompilationUnitForDIE(
 									const DebugInfoEntry* entry) const;
 
+			const LineNumberTable* GetLineNumberTable(CompilationUnit* unit);
+
 			TargetAddressRangeList* ResolveRangeList(CompilationUnit* unit,
 									uint64 offset) const;
 
@@ -110,19 +126,36 @@ private:
 			struct FDEAugmentation;
 			struct CIEAugmentation;
 			struct FDELookupInfo;
+			struct PublicTypeEntry;
+			struct PublicTypeHashDefinition;
+			struct UnitAddressRange;
+			struct UnitLoader;
 
 			typedef DoublyLinkedList<AbbreviationTable> AbbreviationTableList;
 			typedef BObjectList<CompilationUnit> CompilationUnitList;
 			typedef BOpenHashTable<TypeUnitTableHashDefinition> TypeUnitTable;
 			typedef BObjectList<FDELookupInfo> FDEInfoList;
+			typedef BObjectList<UnitAddressRange> UnitAddressRangeList;
+			typedef BOpenHashTable<PublicTypeHashDefinition> PublicTypeTable;
 
 private:
 			status_t			_ParseDebugInfoSection();
 			status_t			_ParseTypesSection();
+			status_t			_ParseAddressRangesSection();
+			status_t			_AddUnitAddressRange(
+									CompilationUnit* unit,
+									target_addr_t start, target_addr_t end);
+			status_t			_BuildUnitAddressRanges();
 			status_t			_ParseFrameSection(ElfSection* section,
 									uint8 addressSize, bool ehFrame,
 									FDEInfoList& infos);
 			status_t			_ParseCompilationUnit(CompilationUnit* unit);
+			status_t			_LoadCompilationUnit(CompilationUnit* unit);
+			status_t			_LoadCompilationUnits(
+									const CompilationUnitList& units);
+			status_t			_RunUnitLoader(
+									const CompilationUnitList& units,
+									bool finish);
 			status_t			_ParseTypeUnit(TypeUnit* unit);
 			status_t			_ParseDebugInfoEntry(DataReader& dataReader,
 									BaseUnit* unit,
@@ -136,6 +169,9 @@ private:
 									AbbreviationEntry& abbreviationEntry);
 
 			status_t			_ParseLineInfo(CompilationUnit* unit);
+			void				_InitLineNumberTableCache();
+			void				_WriteLineNumberTableCache(
+									const CompilationUnitList& units);
 
 			status_t			_UnwindCallFrame(CompilationUnit* unit,
 									uint8 addressSize,
@@ -162,13 +198,16 @@ private:
 			status_t			_ParsePublicTypesInfo();
 			status_t			_ParsePublicTypesInfo(DataReader& dataReader,
 									bool dwarf64);
+			status_t			_AddPublicTypeName(const char* name,
+									CompilationUnit* unit);
+			void				_DeletePublicTypes();
 
 			status_t			_GetAbbreviationTable(off_t offset,
 									AbbreviationTable*& _table);
 
 			DebugInfoEntry*		_ResolveReference(BaseUnit* unit,
 									uint64 offset,
-									uint8 refType) const;
+									uint8 refType);
 
 			status_t			_GetLocationExpression(CompilationUnit* unit,
 									const LocationDescription* location,
@@ -200,6 +239,7 @@ private:
 
 private:
 			friend struct 		DwarfFile::ExpressionEvaluationContext;
+			friend struct		DwarfFile::UnitLoader;
 
 private:
 			char*				fName;
@@ -216,13 +256,19 @@ private:
 			ElfSection*			fDebugLocationSection;
 			ElfSection*			fDebugPublicTypesSection;
 			ElfSection*			fDebugTypesSection;
+			ElfSection*			fDebugAddressRangesSection;
 			AbbreviationTableList fAbbreviationTables;
 			DebugInfoEntryFactory fDebugInfoFactory;
 			CompilationUnitList	fCompilationUnits;
+			UnitAddressRangeList fUnitAddressRanges;
+			BLocker				fUnitLock;
+			BLocker				fParseLock;
+			PublicTypeTable*	fPublicTypes;
+			LineNumberTableCache* fLineNumberTableCache;
+			bool				fLineNumberTableCacheWritten;
 			TypeUnitTable		fTypeUnits;
 			FDEInfoList			fDebugFrameInfos;
 			FDEInfoList			fEHFrameInfos;
-			bool				fTypesSectionRequired;
 			bool				fFinished;
 			bool				fItaniumEHFrameFormat;
 			status_t			fFinishError;
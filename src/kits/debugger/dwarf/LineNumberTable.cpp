@@ -0,0 +1,165 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include "LineNumberTable.h"
+
+#include <algorithm>
+#include <new>
+
+#include <AutoDeleter.h>
+
+#include "LineNumberProgram.h"
+
+
+struct SequenceAddressComparator {
+	bool operator()(const LineNumberTable::Sequence& a,
+		const LineNumberTable::Sequence& b) const
+	{
+		return a.start < b.start;
+	}
+};
+
+
+LineNumberTable::LineNumberTable()
+	:
+	fRows(NULL),
+	fRowCount(0),
+	fSequences(NULL),
+	fSequenceCount(0),
+	fOwnsArrays(false)
+{
+}
+
+
+LineNumberTable::~LineNumberTable()
+{
+	_Unset();
+}
+
+
+status_t
+LineNumberTable::Init(const LineNumberProgram& program)
+{
+	_Unset();
+
+	if (!program.IsValid())
+		return B_BAD_DATA;
+
+	// count the rows and the sequences first
+	LineNumberProgram::State state;
+	int32 rowCount = 0;
+	int32 sequenceCount = 0;
+	bool inSequence = false;
+	program.GetInitialState(state);
+	while (program.GetNextRow(state)) {
+		rowCount++;
+		inSequence = !state.isSequenceEnd;
+		if (state.isSequenceEnd)
+			sequenceCount++;
+	}
+	if (inSequence)
+		sequenceCount++;
+
+	Row* rows = new(std::nothrow) Row[std::max(rowCount, (int32)1)];
+	Sequence* sequences
+		= new(std::nothrow) Sequence[std::max(sequenceCount, (int32)1)];
+	ArrayDeleter<Row> rowsDeleter(rows);
+	ArrayDeleter<Sequence> sequencesDeleter(sequences);
+	if (rows == NULL || sequences == NULL)
+		return B_NO_MEMORY;
+
+	int32 rowIndex = 0;
+	int32 sequenceIndex = 0;
+	Sequence* sequence = NULL;
+	program.GetInitialState(state);
+	while (rowIndex < rowCount && program.GetNextRow(state)) {
+		Row& row = rows[rowIndex];
+		row.address = state.address;
+		row.file = state.file;
+		row.line = state.line;
+		row.column = state.column;
+		row.flags = (state.isStatement ? LINE_NUMBER_ROW_STATEMENT : 0)
+			| (state.isSequenceEnd ? LINE_NUMBER_ROW_SEQUENCE_END : 0);
+
+		if (sequence == NULL) {
+			sequence = &sequences[sequenceIndex++];
+			sequence->start = state.address;
+			sequence->firstRow = rowIndex;
+		}
+
+		rowIndex++;
+		sequence->end = state.address;
+		sequence->rowCount = rowIndex - sequence->firstRow;
+		if (state.isSequenceEnd)
+			sequence = NULL;
+	}
+
+	std::stable_sort(sequences, sequences + sequenceIndex,
+		SequenceAddressComparator());
+
+	fRows = rowsDeleter.Detach();
+	fRowCount = rowIndex;
+	fSequences = sequencesDeleter.Detach();
+	fSequenceCount = sequenceIndex;
+	fOwnsArrays = true;
+	return B_OK;
+}
+
+
+/*!	Refers to the given arrays, which must stay valid as long as the table
+	is used.
+*/
+void
+LineNumberTable::SetTo(const Row* rows, int32 rowCount,
+	const Sequence* sequences, int32 sequenceCount)
+{
+	_Unset();
+
+	fRows = rows;
+	fRowCount = rowCount;
+	fSequences = sequences;
+	fSequenceCount = sequenceCount;
+}
+
+
+/*!	Returns the sequence covering \a address, which must not be relocated,
+	or \c NULL, if there's none.
+*/
+const LineNumberTable::Sequence*
+LineNumberTable::SequenceForAddress(target_addr_t address) const
+{
+	// binary search for the last sequence starting at or before the address
+	int32 lower = 0;
+	int32 upper = fSequenceCount;
+	while (lower < upper) {
+		int32 mid = (lower + upper) / 2;
+		if (fSequences[mid].start <= address)
+			lower = mid + 1;
+		else
+			upper = mid;
+	}
+
+	if (lower == 0)
+		return NULL;
+
+	const Sequence* sequence = &fSequences[lower - 1];
+	return address < sequence->end ? sequence : NULL;
+}
+
+
+void
+LineNumberTable::_Unset()
+{
+	if (fOwnsArrays) {
+		delete[] fRows;
+		delete[] fSequences;
+	}
+
+	fRows = NULL;
+	fRowCount = 0;
+	fSequences = NULL;
+	fSequenceCount = 0;
+	fOwnsArrays = false;
+}
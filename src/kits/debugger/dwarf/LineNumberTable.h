@@ -0,0 +1,80 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef LINE_NUMBER_TABLE_H
+#define LINE_NUMBER_TABLE_H
+
+
+#include "Types.h"
+
+
+class LineNumberProgram;
+
+
+enum {
+	LINE_NUMBER_ROW_STATEMENT		= 0x01,
+	LINE_NUMBER_ROW_SEQUENCE_END	= 0x02
+};
+
+
+/*!	The rows of a compilation unit's line number program, decoded once. The
+	rows stay in the order of the program, the sequences they form are
+	sorted by address. The table either owns its arrays, or refers to a
+	LineNumberTableCache.
+*/
+class LineNumberTable {
+public:
+			struct Row {
+				target_addr_t	address;
+				int32			file;
+				int32			line;
+				int32			column;
+				uint32			flags;
+
+				bool IsStatement() const
+					{ return (flags & LINE_NUMBER_ROW_STATEMENT) != 0; }
+				bool IsSequenceEnd() const
+					{ return (flags & LINE_NUMBER_ROW_SEQUENCE_END) != 0; }
+			};
+
+			struct Sequence {
+				target_addr_t	start;
+				target_addr_t	end;
+				uint32			firstRow;
+				uint32			rowCount;
+			};
+
+public:
+								LineNumberTable();
+								~LineNumberTable();
+
+			status_t			Init(const LineNumberProgram& program);
+			void				SetTo(const Row* rows, int32 rowCount,
+									const Sequence* sequences,
+									int32 sequenceCount);
+
+			bool				IsValid() const	{ return fRows != NULL; }
+
+			int32				CountRows() const	{ return fRowCount; }
+			const Row*			Rows() const		{ return fRows; }
+
+			int32				CountSequences() const
+									{ return fSequenceCount; }
+			const Sequence*		Sequences() const	{ return fSequences; }
+			const Sequence*		SequenceForAddress(
+									target_addr_t address) const;
+
+private:
+			void				_Unset();
+
+private:
+			const Row*			fRows;
+			int32				fRowCount;
+			const Sequence*		fSequences;
+			int32				fSequenceCount;
+			bool				fOwnsArrays;
+};
+
+
+#endif	// LINE_NUMBER_TABLE_H
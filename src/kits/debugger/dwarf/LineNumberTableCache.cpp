@@ -0,0 +1,373 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include "LineNumberTableCache.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <new>
+
+#include <AutoDeleter.h>
+#include <FindDirectory.h>
+
+#include "CompilationUnit.h"
+
+
+static const uint32 kLineTableCacheMagic = 'dlnc';
+static const uint32 kLineTableCacheVersion = 1;
+static const char* const kCacheDirectory = "debug_symbols";
+	// shared with libdebug's symbol cache, which removes unused files
+
+// a cache file is marked as used at most once per day
+static const time_t kMarkUsedInterval = 24 * 60 * 60;
+
+
+/*!	The header is followed by the path of the file, padded to a multiple of
+	8 bytes, the unit entries sorted by unit offset, the sequences, and the
+	rows. The sequences and rows of a unit are consecutive.
+*/
+struct line_table_cache_header {
+	int64	modification_time;
+	int64	file_size;
+	uint32	magic;
+	uint32	version;
+	uint32	unit_count;
+	uint32	sequence_count;
+	uint32	row_count;
+	uint32	path_size;
+};
+
+
+struct LineNumberTableCache::UnitEntry {
+	uint64	unit_offset;
+	uint32	first_sequence;
+	uint32	sequence_count;
+	uint32	first_row;
+	uint32	row_count;
+};
+
+
+static inline size_t
+padded_path_size(size_t pathSize)
+{
+	return (pathSize + 7) & ~(size_t)7;
+}
+
+
+static uint64
+hash_path(const char* path)
+{
+	// FNV-1a, as used for the symbol cache
+	uint64 hash = 0xcbf29ce484222325ULL;
+	for (; *path != '\0'; path++) {
+		hash ^= (uint8)*path;
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+
+static status_t
+write_fully(int fd, const void* buffer, size_t size)
+{
+	ssize_t bytesWritten = write(fd, buffer, size);
+	if (bytesWritten < 0)
+		return errno;
+	return (size_t)bytesWritten == size ? B_OK : B_IO_ERROR;
+}
+
+
+static int
+compare_unit_offsets(const CompilationUnit* a, const CompilationUnit* b)
+{
+	if (a->HeaderOffset() < b->HeaderOffset())
+		return -1;
+	return a->HeaderOffset() > b->HeaderOffset() ? 1 : 0;
+}
+
+
+// #pragma mark - LineNumberTableCache
+
+
+LineNumberTableCache::LineNumberTableCache()
+	:
+	fMappedFile((uint8*)MAP_FAILED),
+	fMappedSize(0),
+	fUnits(NULL),
+	fUnitCount(0),
+	fSequences(NULL),
+	fRows(NULL)
+{
+}
+
+
+LineNumberTableCache::~LineNumberTableCache()
+{
+	_Unset();
+}
+
+
+/*!	Maps the cached line number tables of the file at \a filePath.
+	Fails, if there are none, or if they are out of date.
+*/
+status_t
+LineNumberTableCache::Init(const char* filePath, const struct stat& fileStat)
+{
+	_Unset();
+
+	char path[B_PATH_NAME_LENGTH];
+	status_t error = _GetPath(filePath, path, sizeof(path));
+	if (error != B_OK)
+		return error;
+
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return errno;
+	FileDescriptorCloser fdCloser(fd);
+
+	struct stat st;
+	if (fstat(fd, &st) < 0)
+		return errno;
+	if (st.st_size < (off_t)sizeof(line_table_cache_header))
+		return B_BAD_DATA;
+
+	fMappedSize = st.st_size;
+	fMappedFile = (uint8*)mmap(NULL, fMappedSize, PROT_READ, MAP_PRIVATE, fd,
+		0);
+	if (fMappedFile == MAP_FAILED)
+		return errno;
+
+	const line_table_cache_header& header
+		= *(const line_table_cache_header*)fMappedFile;
+	size_t pathSize = strlen(filePath) + 1;
+	if (header.magic != kLineTableCacheMagic
+		|| header.version != kLineTableCacheVersion
+		|| header.modification_time != fileStat.st_mtime
+		|| header.file_size != fileStat.st_size
+		|| header.path_size != pathSize
+		|| sizeof(header) + padded_path_size(pathSize)
+			+ (size_t)header.unit_count * sizeof(UnitEntry)
+			+ (size_t)header.sequence_count * sizeof(LineNumberTable::Sequence)
+			+ (size_t)header.row_count * sizeof(LineNumberTable::Row)
+			!= fMappedSize
+		|| memcmp(fMappedFile + sizeof(header), filePath, pathSize) != 0) {
+		_Unset();
+		return B_BAD_DATA;
+	}
+
+	fUnits = (const UnitEntry*)(fMappedFile + sizeof(header)
+		+ padded_path_size(pathSize));
+	fUnitCount = header.unit_count;
+	fSequences = (const LineNumberTable::Sequence*)(fUnits + fUnitCount);
+	fRows = (const LineNumberTable::Row*)(fSequences + header.sequence_count);
+
+	for (int32 i = 0; i < fUnitCount; i++) {
+		const UnitEntry& unit = fUnits[i];
+		if ((uint64)unit.first_sequence + unit.sequence_count
+				> header.sequence_count
+			|| (uint64)unit.first_row + unit.row_count > header.row_count) {
+			_Unset();
+			return B_BAD_DATA;
+		}
+
+		for (uint32 j = 0; j < unit.sequence_count; j++) {
+			const LineNumberTable::Sequence& sequence
+				= fSequences[unit.first_sequence + j];
+			if ((uint64)sequence.firstRow + sequence.rowCount
+					> unit.row_count) {
+				_Unset();
+				return B_BAD_DATA;
+			}
+		}
+	}
+
+	// mark the file as used, so that it isn't removed
+	if (time(NULL) - st.st_mtime > kMarkUsedInterval)
+		utimes(path, NULL);
+
+	return B_OK;
+}
+
+
+/*!	Writes the line number tables of the given units for the file at
+	\a filePath, and maps them. Units without a valid table are left out.
+	The file is written under a temporary name and renamed into place, so
+	that concurrent readers and writers never see a partial file.
+*/
+status_t
+LineNumberTableCache::Create(const char* filePath, const struct stat& fileStat,
+	const BObjectList<CompilationUnit>& _units)
+{
+	_Unset();
+
+	BObjectList<CompilationUnit> units(20, false);
+	uint32 sequenceCount = 0;
+	uint32 rowCount = 0;
+	for (int32 i = 0; CompilationUnit* unit = _units.ItemAt(i); i++) {
+		const LineNumberTable& table = unit->GetLineNumberTable();
+		if (!table.IsValid())
+			continue;
+
+		if (!units.AddItem(unit))
+			return B_NO_MEMORY;
+		sequenceCount += table.CountSequences();
+		rowCount += table.CountRows();
+	}
+	units.SortItems(&compare_unit_offsets);
+
+	int32 unitCount = units.CountItems();
+	UnitEntry* entries = new(std::nothrow) UnitEntry[unitCount + 1];
+	ArrayDeleter<UnitEntry> entriesDeleter(entries);
+	if (entries == NULL)
+		return B_NO_MEMORY;
+
+	uint32 firstSequence = 0;
+	uint32 firstRow = 0;
+	for (int32 i = 0; i < unitCount; i++) {
+		const LineNumberTable& table = units.ItemAt(i)->GetLineNumberTable();
+		UnitEntry& entry = entries[i];
+		entry.unit_offset = units.ItemAt(i)->HeaderOffset();
+		entry.first_sequence = firstSequence;
+		entry.sequence_count = table.CountSequences();
+		entry.first_row = firstRow;
+		entry.row_count = table.CountRows();
+		firstSequence += entry.sequence_count;
+		firstRow += entry.row_count;
+	}
+
+	size_t pathSize = strlen(filePath) + 1;
+
+	line_table_cache_header header;
+	memset(&header, 0, sizeof(header));
+	header.modification_time = fileStat.st_mtime;
+	header.file_size = fileStat.st_size;
+	header.magic = kLineTableCacheMagic;
+	header.version = kLineTableCacheVersion;
+	header.unit_count = unitCount;
+	header.sequence_count = sequenceCount;
+	header.row_count = rowCount;
+	header.path_size = pathSize;
+
+	// write the file
+	char path[B_PATH_NAME_LENGTH];
+	status_t error = _GetPath(filePath, path, sizeof(path));
+	if (error != B_OK)
+		return error;
+
+	char tempPath[B_PATH_NAME_LENGTH];
+	snprintf(tempPath, sizeof(tempPath), "%s.%" B_PRId32, path,
+		find_thread(NULL));
+
+	int fd = open(tempPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		return errno;
+
+	static const char kPadding[8] = {};
+	error = write_fully(fd, &header, sizeof(header));
+	if (error == B_OK)
+		error = write_fully(fd, filePath, pathSize);
+	if (error == B_OK) {
+		error = write_fully(fd, kPadding,
+			padded_path_size(pathSize) - pathSize);
+	}
+	if (error == B_OK)
+		error = write_fully(fd, entries, unitCount * sizeof(UnitEntry));
+	for (int32 i = 0; error == B_OK && i < unitCount; i++) {
+		const LineNumberTable& table = units.ItemAt(i)->GetLineNumberTable();
+		error = write_fully(fd, table.Sequences(),
+			table.CountSequences() * sizeof(LineNumberTable::Sequence));
+	}
+	for (int32 i = 0; error == B_OK && i < unitCount; i++) {
+		const LineNumberTable& table = units.ItemAt(i)->GetLineNumberTable();
+		error = write_fully(fd, table.Rows(),
+			table.CountRows() * sizeof(LineNumberTable::Row));
+	}
+	close(fd);
+
+	if (error == B_OK && rename(tempPath, path) < 0)
+		error = errno;
+	if (error != B_OK) {
+		unlink(tempPath);
+		return error;
+	}
+
+	return Init(filePath, fileStat);
+}
+
+
+/*!	Sets \a _table to refer to the cached table of the unit with the header
+	offset \a unitOffset. The table stays valid as long as the cache does.
+*/
+bool
+LineNumberTableCache::GetTable(off_t unitOffset,
+	LineNumberTable& _table) const
+{
+	// binary search
+	int32 lower = 0;
+	int32 upper = fUnitCount - 1;
+	while (lower <= upper) {
+		int32 mid = (lower + upper) / 2;
+		const UnitEntry& unit = fUnits[mid];
+		if (unit.unit_offset < (uint64)unitOffset) {
+			lower = mid + 1;
+		} else if (unit.unit_offset > (uint64)unitOffset) {
+			upper = mid - 1;
+		} else {
+			_table.SetTo(fRows + unit.first_row, unit.row_count,
+				fSequences + unit.first_sequence, unit.sequence_count);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+void
+LineNumberTableCache::_Unset()
+{
+	if (fMappedFile != MAP_FAILED)
+		munmap(fMappedFile, fMappedSize);
+
+	fMappedFile = (uint8*)MAP_FAILED;
+	fMappedSize = 0;
+	fUnits = NULL;
+	fUnitCount = 0;
+	fSequences = NULL;
+	fRows = NULL;
+}
+
+
+/*static*/ status_t
+LineNumberTableCache::_GetPath(const char* filePath, char* path, size_t size)
+{
+	status_t error = find_directory(B_USER_CACHE_DIRECTORY, -1, true, path,
+		size);
+	if (error != B_OK)
+		return error;
+
+	if (strlcat(path, "/", size) >= size
+		|| strlcat(path, kCacheDirectory, size) >= size) {
+		return B_NAME_TOO_LONG;
+	}
+
+	if (mkdir(path, 0755) < 0 && errno != B_FILE_EXISTS)
+		return errno;
+
+	size_t length = strlen(path);
+	if ((size_t)snprintf(path + length, size - length, "/%016" B_PRIx64
+			".lines", hash_path(filePath)) >= size - length) {
+		return B_NAME_TOO_LONG;
+	}
+
+	return B_OK;
+}
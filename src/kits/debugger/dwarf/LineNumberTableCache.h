@@ -0,0 +1,61 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef LINE_NUMBER_TABLE_CACHE_H
+#define LINE_NUMBER_TABLE_CACHE_H
+
+
+#include <sys/stat.h>
+
+#include <ObjectList.h>
+
+#include "LineNumberTable.h"
+
+
+class CompilationUnit;
+
+
+/*!	The line number tables of all compilation units of a file with debug
+	information. The copy is stored in the same cache directory as the
+	symbol tables libdebug keeps, named after the path of the file, and
+	checked against its modification time and size. It is mapped when it is
+	used, and removed along with the symbol tables when it hasn't been used
+	for a while.
+*/
+class LineNumberTableCache {
+public:
+								LineNumberTableCache();
+								~LineNumberTableCache();
+
+			status_t			Init(const char* filePath,
+									const struct stat& fileStat);
+			status_t			Create(const char* filePath,
+									const struct stat& fileStat,
+									const BObjectList<CompilationUnit>& units);
+
+			bool				IsValid() const
+									{ return fUnits != NULL; }
+			bool				GetTable(off_t unitOffset,
+									LineNumberTable& _table) const;
+
+private:
+			struct UnitEntry;
+
+private:
+			void				_Unset();
+
+	static	status_t			_GetPath(const char* filePath, char* path,
+									size_t size);
+
+private:
+			uint8*				fMappedFile;
+			size_t				fMappedSize;
+			const UnitEntry*	fUnits;
+			int32				fUnitCount;
+			const LineNumberTable::Sequence* fSequences;
+			const LineNumberTable::Row* fRows;
+};
+
+
+#endif	// LINE_NUMBER_TABLE_CACHE_H
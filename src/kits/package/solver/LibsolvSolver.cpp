@@ -10,6 +10,8 @@
 #include "LibsolvSolver.h"
 
 #include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
 #include <sys/utsname.h>
 
 #include <new>
@@ -18,11 +20,19 @@
 #include <solv/poolarch.h>
 #include <solv/repo.h>
 #include <solv/repo_haiku.h>
+#include <solv/repo_solv.h>
+#include <solv/repo_write.h>
 #include <solv/selection.h>
 #include <solv/solverdebug.h>
+#include <solv/solvversion.h>
+
+#include <Directory.h>
+#include <FindDirectory.h>
+#include <Path.h>
 
 #include <package/PackageResolvableExpression.h>
 #include <package/RepositoryCache.h>
+#include <package/SolverRepositoryCacheKey.h>
 #include <package/solver/SolverPackage.h>
 #include <package/solver/SolverPackageSpecifier.h>
 #include <package/solver/SolverPackageSpecifierList.h>
@@ -38,6 +48,57 @@
 // abort()s. Obviously that isn't good behavior for a library.
 
 
+static const char* const kRepositoryCacheDirectory = "package-solver";
+static const char* const kRepositoryCacheSignature = "haiku-solv-cache";
+static const int32 kRepositoryCacheVersion = 2;
+	// increase when the conversion of the packages changes
+
+
+/*!	Converting the packages of large repositories to libsolv's format
+	takes longer than anything else the solver does, so the result is stored
+	in the user's cache directory, and used again as long as the repository
+	cache file it was read from is unchanged.
+*/
+static status_t
+get_repository_cache_path(BSolverRepository* repository, BPath& _path)
+{
+#ifndef HAIKU_TARGET_PLATFORM_HAIKU
+	// don't leave caches behind on the build host
+	return B_NOT_SUPPORTED;
+#endif
+
+	status_t error = find_directory(B_USER_CACHE_DIRECTORY, &_path, true);
+	if (error != B_OK)
+		return error;
+
+	error = _path.Append(kRepositoryCacheDirectory);
+	if (error != B_OK)
+		return error;
+
+	error = create_directory(_path.Path(), 0755);
+	if (error != B_OK)
+		return error;
+
+	BString name(repository->Name());
+	name.ReplaceAll('/', '_');
+	return _path.Append(name << ".solv");
+}
+
+
+/*!	The header identifies the repository cache file, and the code the
+	cache was written with: both libsolv's solv file format and its
+	conversion of the packages may change with its version.
+*/
+static BString
+get_repository_cache_header(BSolverRepository* repository,
+	const BString& cacheKey)
+{
+	return BString(kRepositoryCacheSignature) << " "
+		<< kRepositoryCacheVersion << " libsolv " << solv_version << " "
+		<< repository->CountPackages() << " " << cacheKey << "\n";
+}
+
+
 BSolver*
 BPackageKit::create_solver()
 {
@@ -748,21 +809,27 @@ LibsolvSolver::_AddRepositories()
 		repo->priority = -1 - repository->Priority();
 		repo->appdata = (void*)repositoryInfo;
 
-		int32 packageCount = repository->CountPackages();
-		for (int32 k = 0; k < packageCount; k++) {
-			BSolverPackage* package = repository->PackageAt(k);
-			Id solvableId = repo_add_haiku_package_info(repo, package->Info(),
-				REPO_REUSE_REPODATA | REPO_NO_INTERNALIZE);
-
-			try {
-				fSolvablePackages[solvableId] = package;
-				fPackageSolvables[package] = solvableId;
-			} catch (std::bad_alloc&) {
-				return B_NO_MEMORY;
+		error = _LoadRepositoryCache(repositoryInfo);
+		if (error == B_NO_MEMORY)
+			return error;
+		if (error != B_OK) {
+			int32 packageCount = repository->CountPackages();
+			for (int32 k = 0; k < packageCount; k++) {
+				BSolverPackage* package = repository->PackageAt(k);
+				Id solvableId = repo_add_haiku_package_info(repo,
+					package->Info(), REPO_REUSE_REPODATA | REPO_NO_INTERNALIZE);
+
+				try {
+					fSolvablePackages[solvableId] = package;
+					fPackageSolvables[package] = solvableId;
+				} catch (std::bad_alloc&) {
+					return B_NO_MEMORY;
+				}
 			}
-		}
 
-		repo_internalize(repo);
+			repo_internalize(repo);
+			_WriteRepositoryCache(repositoryInfo);
+		}
 
 		if (repository->IsInstalled()) {
 			fInstalledRepository = repositoryInfo;
@@ -779,6 +846,101 @@ LibsolvSolver::_AddRepositories()
 }
 
 
+/*!	Fills the repository's solv repo from its cache file, if there is a
+	valid one. If this fails for any other reason than \c B_NO_MEMORY, the
+	packages have to be converted instead.
+*/
+status_t
+LibsolvSolver::_LoadRepositoryCache(RepositoryInfo* repositoryInfo)
+{
+	BSolverRepository* repository = repositoryInfo->Repository();
+	BString cacheKey = BPrivate::get_solver_repository_cache_key(repository);
+	if (cacheKey.IsEmpty())
+		return B_ENTRY_NOT_FOUND;
+
+	BPath path;
+	status_t error = get_repository_cache_path(repository, path);
+	if (error != B_OK)
+		return error;
+
+	FILE* file = fopen(path.Path(), "r");
+	if (file == NULL)
+		return errno;
+	CObjectDeleter<FILE, int> fileCloser(file, fclose);
+
+	BString header = get_repository_cache_header(repository, cacheKey);
+	BString fileHeader;
+	char* buffer = fileHeader.LockBuffer(header.Length());
+	if (buffer == NULL)
+		return B_NO_MEMORY;
+	size_t bytesRead = fread(buffer, 1, header.Length(), file);
+	fileHeader.UnlockBuffer(bytesRead);
+	if (fileHeader != header)
+		return B_BAD_DATA;
+
+	Repo* repo = repositoryInfo->SolvRepo();
+	int32 packageCount = repository->CountPackages();
+	if (repo_add_solv(repo, file, 0) != 0 || repo->nsolvables != packageCount) {
+		repo_empty(repo, 1);
+		return B_BAD_DATA;
+	}
+
+	// The solvables must match the repository's packages one by one.
+	for (int32 k = 0; k < packageCount; k++) {
+		Solvable* solvable = pool_id2solvable(fPool, repo->start + k);
+		if (solvable->repo != repo
+			|| repository->PackageAt(k)->Info().Name()
+				!= pool_id2str(fPool, solvable->name)) {
+			repo_empty(repo, 1);
+			return B_BAD_DATA;
+		}
+	}
+
+	for (int32 k = 0; k < packageCount; k++) {
+		BSolverPackage* package = repository->PackageAt(k);
+		try {
+			fSolvablePackages[repo->start + k] = package;
+			fPackageSolvables[package] = repo->start + k;
+		} catch (std::bad_alloc&) {
+			return B_NO_MEMORY;
+		}
+	}
+
+	return B_OK;
+}
+
+
+void
+LibsolvSolver::_WriteRepositoryCache(RepositoryInfo* repositoryInfo)
+{
+	BSolverRepository* repository = repositoryInfo->Repository();
+	BString cacheKey = BPrivate::get_solver_repository_cache_key(repository);
+	if (cacheKey.IsEmpty())
+		return;
+
+	BPath path;
+	if (get_repository_cache_path(repository, path) != B_OK)
+		return;
+
+	// Write to a temporary file first, so that concurrent solvers never see
+	// an incomplete cache.
+	BString tempPath(path.Path());
+	tempPath << "." << getpid();
+
+	FILE* file = fopen(tempPath.String(), "w");
+	if (file == NULL)
+		return;
+
+	BString header = get_repository_cache_header(repository, cacheKey);
+	bool success = fputs(header.String(), file) >= 0
+		&& repo_write(repositoryInfo->SolvRepo(), file) == 0;
+	success = fclose(file) == 0 && success;
+
+	if (!success || rename(tempPath.String(), path.Path()) != 0)
+		unlink(tempPath.String());
+}
+
+
 LibsolvSolver::RepositoryInfo*
 LibsolvSolver::_InstalledRepository() const
 {
@@ -95,6 +95,10 @@ private:
 
 			bool				_HaveRepositoriesChanged() const;
 			status_t			_AddRepositories();
+			status_t			_LoadRepositoryCache(
+									RepositoryInfo* repositoryInfo);
+			void				_WriteRepositoryCache(
+									RepositoryInfo* repositoryInfo);
 			RepositoryInfo*		_InstalledRepository() const;
 			RepositoryInfo*		_GetRepositoryInfo(
 									BSolverRepository* repository) const;
@@ -9,10 +9,20 @@
 
 #include <package/solver/SolverRepository.h>
 
+#include <sys/stat.h>
+
+#include <map>
+#include <new>
+
+#include <Autolock.h>
+#include <Locker.h>
+#include <Path.h>
+
 #include <package/PackageDefs.h>
 #include <package/PackageRoster.h>
 #include <package/RepositoryCache.h>
 #include <package/RepositoryConfig.h>
+#include <package/SolverRepositoryCacheKey.h>
 #include <package/solver/SolverPackage.h>
 
 
@@ -22,6 +32,32 @@ static const int32 kInitialPackageListSize = 40;
 namespace BPackageKit {
 
 
+// The cache keys are kept aside, as BSolverRepository has no room for them.
+typedef std::map<const BSolverRepository*, BString> CacheKeyMap;
+
+static BLocker sCacheKeyLock("solver repository cache keys");
+static CacheKeyMap sCacheKeys;
+
+
+static void
+set_cache_key(const BSolverRepository* repository,
+	const BRepositoryCache& cache)
+{
+	// Not having a key only means that solvers can't cache the repository.
+	struct stat st;
+	BPath path;
+	if (cache.Entry().GetStat(&st) != B_OK
+		|| cache.Entry().GetPath(&path) != B_OK) {
+		return;
+	}
+
+	BString key;
+	key << path.Path() << " " << (int64)st.st_dev << ":" << (int64)st.st_ino
+		<< " " << (int64)st.st_mtime << " " << (int64)st.st_size;
+	BPrivate::set_solver_repository_cache_key(repository, key);
+}
+
+
 BSolverRepository::BSolverRepository()
 	:
 	fName(),
@@ -83,6 +119,7 @@ BSolverRepository::BSolverRepository(const BRepositoryConfig& config)
 
 BSolverRepository::~BSolverRepository()
 {
+	BPrivate::set_solver_repository_cache_key(this, BString());
 }
 
 
@@ -159,6 +196,7 @@ BSolverRepository::SetTo(const BRepositoryConfig& config)
 		}
 	}
 
+	set_cache_key(this, cache);
 	return B_OK;
 }
 
@@ -184,6 +222,7 @@ BSolverRepository::SetTo(const BRepositoryCache& cache)
 		}
 	}
 
+	set_cache_key(this, cache);
 	return B_OK;
 }
 
@@ -196,6 +235,7 @@ BSolverRepository::Unset()
 	fIsInstalled = false;
 	fPackages.MakeEmpty();
 	fChangeCount++;
+	BPrivate::set_solver_repository_cache_key(this, BString());
 }
 
 
@@ -275,6 +315,7 @@ BSolverRepository::AddPackage(const BPackageInfo& info,
 	}
 
 	fChangeCount++;
+	BPrivate::set_solver_repository_cache_key(this, BString());
 
 	if (_package != NULL)
 		*_package = package;
@@ -310,6 +351,7 @@ BSolverRepository::RemovePackage(BSolverPackage* package)
 		return false;
 
 	fChangeCount++;
+	BPrivate::set_solver_repository_cache_key(this, BString());
 	return true;
 }
 
@@ -332,4 +374,37 @@ BSolverRepository::ChangeCount() const
 }
 
 
+// #pragma mark - private
+
+
+BString
+BPrivate::get_solver_repository_cache_key(const BSolverRepository* repository)
+{
+	BAutolock locker(sCacheKeyLock);
+
+	CacheKeyMap::const_iterator it = sCacheKeys.find(repository);
+	return it != sCacheKeys.end() ? it->second : BString();
+}
+
+
+void
+BPrivate::set_solver_repository_cache_key(const BSolverRepository* repository,
+	const BString& key)
+{
+	BAutolock locker(sCacheKeyLock);
+
+	if (key.IsEmpty()) {
+		if (!sCacheKeys.empty())
+			sCacheKeys.erase(repository);
+		return;
+	}
+
+	try {
+		sCacheKeys[repository] = key;
+	} catch (std::bad_alloc&) {
+		// the repository just won't be cached
+	}
+}
+
+
 }	// namespace BPackageKit
@@ -13,6 +13,10 @@
 #include <ctype.h>
 #include <cerrno>
 
+#if defined(__SSE2__)
+#	include <emmintrin.h>
+#endif
+
 #include <AutoDeleter.h>
 #include <DataIO.h>
 #include <UnicodeChar.h>
@@ -26,6 +30,9 @@
 namespace BPrivate {
 
 
+static const size_t kReadBufferSize = 8192;
+
+
 static bool
 b_jsonparse_is_hex(char c)
 {
@@ -47,7 +54,55 @@ b_jsonparse_all_hex(const char* c)
 }
 
 
-/*! This class carries state around the parsing process. */
+static bool
+b_jsonparse_is_number_char(char c)
+{
+	return isdigit(c) || c == '+' || c == '-' || c == 'e' || c == 'E'
+		|| c == '.';
+}
+
+
+/*! Returns the first character in the given range that needs to be looked at
+    when parsing a string; that is a quote, a backslash, or a control
+    character. If there is none, \a end is returned.
+*/
+
+static char*
+b_jsonparse_find_string_special(char* start, char* end)
+{
+#if defined(__SSE2__)
+	const __m128i quote = _mm_set1_epi8('"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+	const __m128i lastControl = _mm_set1_epi8(0x1f);
+
+	while (end - start >= 16) {
+		__m128i data = _mm_loadu_si128(reinterpret_cast<__m128i*>(start));
+		__m128i special = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(data, quote),
+				_mm_cmpeq_epi8(data, backslash)),
+			_mm_cmpeq_epi8(_mm_min_epu8(data, lastControl), data));
+		int mask = _mm_movemask_epi8(special);
+		if (mask != 0)
+			return start + __builtin_ctz(mask);
+
+		start += 16;
+	}
+#endif
+
+	for (; start < end; start++) {
+		uint8 c = static_cast<uint8>(*start);
+		if (c == '"' || c == '\\' || c < 0x20)
+			return start;
+	}
+
+	return end;
+}
+
+
+/*! This class carries state around the parsing process. The input is read
+    ahead into a buffer; strings and numbers that are entirely contained in
+    it are passed to the listener without copying them.
+*/
 
 class JsonParseContext {
 public:
@@ -56,8 +111,8 @@ public:
 		fListener(listener),
 		fData(data),
 		fLineNumber(1), // 1 is the first line
-		fPushbackChar(0),
-		fHasPushbackChar(false)
+		fPosition(fBuffer),
+		fEnd(fBuffer)
 	{
 	}
 
@@ -86,35 +141,82 @@ public:
 	}
 
 
-		// TODO; there is considerable opportunity for performance improvements
-		// here by buffering the input and then feeding it into the parse
-		// algorithm character by character.
-
 	status_t NextChar(char* buffer)
 	{
-
-		if (fHasPushbackChar) {
-			buffer[0] = fPushbackChar;
-			fHasPushbackChar = false;
-			return B_OK;
+		if (fPosition == fEnd) {
+			status_t result = _FillBuffer();
+			if (result != B_OK)
+				return result;
 		}
 
-		return Data()->ReadExactly(buffer, 1);
+		buffer[0] = *fPosition++;
+		return B_OK;
 	}
 
 
 	void PushbackChar(char c)
 	{
-		fPushbackChar = c;
-		fHasPushbackChar = true;
+		// this is only ever done with the character that was just read, so
+		// it is still in the buffer
+		*--fPosition = c;
+	}
+
+
+	/*! The buffered input that has not been consumed yet goes from here to
+	    End(). The parser may modify it in place.
+	*/
+	char* Position() const
+	{
+		return fPosition;
+	}
+
+
+	char* End() const
+	{
+		return fEnd;
+	}
+
+
+	void SetPosition(char* position)
+	{
+		fPosition = position;
+	}
+
+
+	/*! The input is read ahead, so the data may have been read beyond the
+	    end of the parsed value. If the data is positionable, it is moved
+	    back to the first byte that has not been consumed.
+	*/
+	void ReturnUnconsumed()
+	{
+		BPositionIO* positionIO = dynamic_cast<BPositionIO*>(fData);
+		if (positionIO != NULL && fEnd > fPosition)
+			positionIO->Seek(fPosition - fEnd, SEEK_CUR);
+
+		fEnd = fPosition;
+	}
+
+private:
+	status_t _FillBuffer()
+	{
+		ssize_t bytesRead = Data()->Read(fBuffer, kReadBufferSize);
+		if (bytesRead < 0)
+			return bytesRead;
+		if (bytesRead == 0)
+			return B_PARTIAL_READ;
+
+		fPosition = fBuffer;
+		fEnd = fBuffer + bytesRead;
+		return B_OK;
 	}
 
 private:
 	BJsonEventListener*		fListener;
 	BDataIO*				fData;
 	uint32					fLineNumber;
-	char					fPushbackChar;
-	bool					fHasPushbackChar;
+	char*					fPosition;
+	char*					fEnd;
+	char					fBuffer[kReadBufferSize];
 };
 
 
@@ -155,6 +257,11 @@ BJson::Parse(const char* JSON, BMessage& message)
      - array start
      - object end
     Each event is sent to the listener to process as required.
+
+    The data is read ahead in chunks of up to 8 KiB. If \a data is a
+    BPositionIO, its position is moved back to just after the parsed value
+    once parsing ends. Otherwise, any data following the value may have been
+    consumed from the stream, too.
 */
 
 void
@@ -162,6 +269,7 @@ BJson::Parse(BDataIO* data, BJsonEventListener* listener)
 {
 	JsonParseContext context(data, listener);
 	ParseAny(context);
+	context.ReturnUnconsumed();
 	listener->Complete();
 }
 
@@ -574,8 +682,29 @@ BJson::ParseString(JsonParseContext& jsonParseContext,
 {
 	char c;
 	BString stringResult;
+	bool isCopied = false;
 
 	while(true) {
+		// take all the plain characters in the buffer at once
+		char* start = jsonParseContext.Position();
+		char* end = jsonParseContext.End();
+		char* special = b_jsonparse_find_string_special(start, end);
+
+		if (special != end && *special == '"' && !isCopied) {
+				// the whole string is in the buffer, so it can be passed on
+				// from there
+			*special = '\0';
+			jsonParseContext.SetPosition(special + 1);
+			jsonParseContext.Listener()->Handle(BJsonEvent(eventType, start));
+			return true;
+		}
+
+		if (special != start) {
+			stringResult.Append(start, special - start);
+			jsonParseContext.SetPosition(special);
+			isCopied = true;
+		}
+
 		if (!NextChar(jsonParseContext, &c))
     		return false;
 
@@ -594,6 +723,7 @@ BJson::ParseString(JsonParseContext& jsonParseContext,
 					stringResult)) {
 					return false;
 				}
+				isCopied = true;
 				break;
 			}
 
@@ -612,6 +742,7 @@ BJson::ParseString(JsonParseContext& jsonParseContext,
 				}
 
 				stringResult.Append(&c, 1);
+				isCopied = true;
 				break;
 			}
 		}
@@ -671,10 +802,9 @@ BJson::ParseExpectedVerbatimString(JsonParseContext& jsonParseContext,
 */
 
 bool
-BJson::IsValidNumber(BString& number)
+BJson::IsValidNumber(const char* number, int32 len)
 {
 	int32 offset = 0;
-	int32 len = number.Length();
 
 	if (offset < len && number[offset] == '-')
 		offset++;
@@ -723,56 +853,81 @@ BJson::IsValidNumber(BString& number)
     and handles any end-of-file state itself because it is feasible that the
     entire JSON payload is a number and because (unlike other structures, the
     number can take the end-of-file to signify the end of the number.
+
+    If the number ends within the buffered input, it is terminated there
+    temporarily, rather than copied.
 */
 
 bool
 BJson::ParseNumber(JsonParseContext& jsonParseContext)
 {
 	BString value;
+	bool isCopied = false;
 
 	while (true) {
-		char c;
-		status_t result = jsonParseContext.NextChar(&c);
+		char* start = jsonParseContext.Position();
+		char* end = jsonParseContext.End();
+		char* position = start;
 
-		switch (result) {
-			case B_OK:
-			{
-				if (isdigit(c)) {
-					value += c;
-					break;
-				}
+		while (position < end && b_jsonparse_is_number_char(*position))
+			position++;
 
-				if (NULL != strchr("+-eE.", c)) {
-					value += c;
-					break;
-				}
+		jsonParseContext.SetPosition(position);
 
-				jsonParseContext.PushbackChar(c);
-				// intentional fall through
+		if (position < end) {
+			if (isCopied) {
+				value.Append(start, position - start);
+				break;
 			}
-			case B_PARTIAL_READ:
-			{
-				errno = 0;
 
-				if (!IsValidNumber(value)) {
-					jsonParseContext.Listener()->HandleError(B_BAD_DATA,
-						jsonParseContext.LineNumber(), "malformed number");
-					return false;
-				}
+			char terminator = *position;
+			*position = '\0';
 
+			bool isValid = IsValidNumber(start, position - start);
+			if (isValid) {
 				jsonParseContext.Listener()->Handle(BJsonEvent(B_JSON_NUMBER,
-					value.String()));
-
-				return true;
+					start));
 			}
-			default:
-			{
-				jsonParseContext.Listener()->HandleError(result, -1,
-					"io related read error");
+
+			*position = terminator;
+
+			if (!isValid) {
+				jsonParseContext.Listener()->HandleError(B_BAD_DATA,
+					jsonParseContext.LineNumber(), "malformed number");
 				return false;
 			}
+
+			return true;
 		}
+
+		// the number may continue after the buffered input
+		value.Append(start, position - start);
+		isCopied = true;
+
+		char c;
+		status_t result = jsonParseContext.NextChar(&c);
+		if (result == B_PARTIAL_READ)
+			break;
+
+		if (result != B_OK) {
+			jsonParseContext.Listener()->HandleError(result, -1,
+				"io related read error");
+			return false;
+		}
+
+		jsonParseContext.PushbackChar(c);
+	}
+
+	if (!IsValidNumber(value.String(), value.Length())) {
+		jsonParseContext.Listener()->HandleError(B_BAD_DATA,
+			jsonParseContext.LineNumber(), "malformed number");
+		return false;
 	}
+
+	jsonParseContext.Listener()->Handle(BJsonEvent(B_JSON_NUMBER,
+		value.String()));
+
+	return true;
 }
 
 } // namespace BPrivate
@@ -17,6 +17,9 @@
 #include <stdio.h>
 #include <sys/stat.h>
 
+#include <new>
+#include <vector>
+
 #include <Directory.h>
 #include <Entry.h>
 #include <File.h>
@@ -119,7 +122,8 @@ SnifferRules::SnifferRules(DatabaseLocation* databaseLocation,
 	fDatabaseLocation(databaseLocation),
 	fMimeSniffer(mimeSniffer),
 	fMaxBytesNeeded(0),
-	fHaveDoneFullBuild(false)
+	fHaveDoneFullBuild(false),
+	fHaveCompiledRules(false)
 {
 }
 
@@ -268,6 +272,7 @@ SnifferRules::SetSnifferRule(const char *type, const char *rule)
 		}
 		if (i == fRuleList.end())
 			fRuleList.push_back(item);
+		fHaveCompiledRules = false;
 	}
 
 	return err;
@@ -292,6 +297,7 @@ SnifferRules::DeleteSnifferRule(const char *type)
 		   i != fRuleList.end(); i++) {
 		if (i->type == type) {
 			fRuleList.erase(i);
+			fHaveCompiledRules = false;
 			break;
 		}
 	}
@@ -406,6 +412,7 @@ SnifferRules::BuildRuleList()
 		fRuleList.sort();
 		fMaxBytesNeeded = maxBytesNeeded;
 		fHaveDoneFullBuild = true;
+		fHaveCompiledRules = false;
 //		PrintToStream();
 	} else {
 		DBG(OUT("Mime::SnifferRules::BuildRuleList() failed, error code == 0x%"
@@ -424,6 +431,10 @@ SnifferRules::BuildRuleList()
 	"supertype/subtype" form rules are checked before "supertype-only" form
 	rules if their priorities happen to be identical).
 
+	All rules are evaluated against the buffer in a single pass by the
+	compiled Sniffer::Matcher, which is rebuilt whenever the rule list
+	changes. Should compiling fail, the rules are sniffed one by one instead.
+
 	\param file The file to sniff. May be \c NULL. \a buffer is always given.
 	\param buffer Pointer to a data buffer to sniff
 	\param length The length of the data buffer pointed to by \a buffer
@@ -457,11 +468,18 @@ SnifferRules::GuessMimeType(BFile* file, const void *buffer, int32 length,
 	}
 
 	if (!err) {
+		// Evaluate all rules at once, if possible
+		bool compiled = fHaveCompiledRules || CompileRules() == B_OK;
+		std::vector<bool> matches;
+		if (compiled)
+			fMatcher.Match(buffer, length, matches);
+
 		// Run through our rule list, which is sorted in order of
 		// descreasing priority, and see if one of the rules sniffs
 		// out a match
+		int32 index = 0;
 		for (std::list<sniffer_rule>::const_iterator i = fRuleList.begin();
-			   i != fRuleList.end(); i++) {
+			   i != fRuleList.end(); i++, index++) {
 			if (i->rule) {
 				// If an add-on identified the type with a priority at least
 				// as great as the remaining rules, we can stop further
@@ -471,7 +489,8 @@ SnifferRules::GuessMimeType(BFile* file, const void *buffer, int32 length,
 					return B_OK;
 				}
 
-				if (i->rule->Sniff(&data)) {
+				bool match = compiled ? matches[index] : i->rule->Sniff(&data);
+				if (match) {
 					type->SetTo(i->type.c_str());
 					return B_OK;
 				}
@@ -496,6 +515,37 @@ SnifferRules::GuessMimeType(BFile* file, const void *buffer, int32 length,
 	return err;
 }
 
+// CompileRules
+/*! \brief Compiles the current rule list into the matcher used by
+	GuessMimeType().
+
+	The matcher refers to the rules by their position in the list, so it
+	has to be recompiled whenever the list changes.
+*/
+status_t
+SnifferRules::CompileRules()
+{
+	std::vector<const Sniffer::Rule*> rules;
+	try {
+		rules.reserve(fRuleList.size());
+		for (std::list<sniffer_rule>::const_iterator i = fRuleList.begin();
+			   i != fRuleList.end(); i++) {
+			rules.push_back(i->rule);
+		}
+	} catch (std::bad_alloc&) {
+		return B_NO_MEMORY;
+	}
+
+	status_t err = fMatcher.SetTo(rules);
+	if (!err)
+		fHaveCompiledRules = true;
+	else {
+		DBG(OUT("Mime::SnifferRules::CompileRules() failed, error code == 0x%"
+			B_PRIx32 "\n", err));
+	}
+	return err;
+}
+
 // MaxBytesNeeded
 /*! \brief Returns the maxmimum number of bytes needed in a data buffer for
 	all the currently installed rules to be able to perform a complete sniff,
@@ -0,0 +1,281 @@
+//----------------------------------------------------------------------
+//  This software is part of the Haiku distribution and is covered
+//  by the MIT License.
+//---------------------------------------------------------------------
+/*!
+	\file Matcher.cpp
+	MIME sniffer multi-rule matcher implementation
+*/
+
+#include <sniffer/DisjList.h>
+#include <sniffer/Matcher.h>
+#include <sniffer/Pattern.h>
+#include <sniffer/Range.h>
+#include <sniffer/RPattern.h>
+#include <sniffer/Rule.h>
+
+#include <new>
+
+using namespace BPrivate::Storage::Sniffer;
+
+static const uint32 kNoAnchor = 0xffffffff;
+
+
+static inline char
+swap_case(char c)
+{
+	if ('A' <= c && c <= 'Z')
+		return 'a' + (c - 'A');
+	if ('a' <= c && c <= 'z')
+		return 'A' + (c - 'a');
+	return c;
+}
+
+
+/*! \brief Returns true if \a c is a byte that shows up in so many files
+	that it makes for a poor anchor.
+*/
+static inline bool
+is_common_byte(uint8 c)
+{
+	return c == 0x00 || c == 0xff || c == ' ' || c == '\n' || c == '\r'
+		|| c == '\t';
+}
+
+
+Matcher::Matcher()
+	: fDisjunctionCount(0)
+	, fScanLength(0)
+{
+}
+
+Matcher::~Matcher() {
+}
+
+/*! \brief Compiles the given rules into the matcher.
+
+	The rules are referenced by their index in \a rules in the result of
+	Match(). The matcher does not keep any references to the rules, so they
+	may be deleted afterwards.
+*/
+status_t
+Matcher::SetTo(const std::vector<const Rule*> &rules) {
+	Unset();
+
+	try {
+		fRules.reserve(rules.size());
+		for (size_t i = 0; i < rules.size(); i++) {
+			const Rule *rule = rules[i];
+
+			rule_entry entry;
+			entry.first_disjunction = fDisjunctionCount;
+			entry.disjunction_count = 0;
+			entry.valid = rule != NULL && rule->InitCheck() == B_OK;
+
+			if (entry.valid) {
+				std::vector<DisjList*>::const_iterator j;
+				for (j = rule->fConjList->begin(); j != rule->fConjList->end();
+						j++) {
+					// Rule::Sniff() ignores NULL entries, so do we
+					if (*j == NULL)
+						continue;
+					(*j)->AddTo(this, fDisjunctionCount++);
+					entry.disjunction_count++;
+				}
+			}
+
+			fRules.push_back(entry);
+		}
+	} catch (std::bad_alloc&) {
+		Unset();
+		return B_NO_MEMORY;
+	}
+
+	return B_OK;
+}
+
+void
+Matcher::Unset() {
+	fPatterns.clear();
+	for (int i = 0; i < 256; i++)
+		fAnchorTable[i].clear();
+	fUnanchored.clear();
+	fRules.clear();
+	fDisjunctionCount = 0;
+	fScanLength = 0;
+}
+
+int32
+Matcher::CountRules() const {
+	return fRules.size();
+}
+
+/*! \brief Evaluates all compiled rules against the given buffer.
+
+	On return, \a matches contains one element per rule, which is \c true
+	if the rule matched. The result is the same as calling Rule::Sniff()
+	for every rule on a BMemoryIO wrapping \a buffer.
+*/
+void
+Matcher::Match(const void *buffer, size_t length,
+	std::vector<bool> &matches) const
+{
+	const uint8 *data = (const uint8*)buffer;
+	std::vector<bool> satisfied(fDisjunctionCount, false);
+
+	// Walk the buffer once, verifying only the patterns anchored by the
+	// byte at the current position
+	size_t scanLength = length < fScanLength ? length : fScanLength;
+	for (size_t position = 0; position < scanLength; position++) {
+		const std::vector<uint32> &candidates = fAnchorTable[data[position]];
+		for (size_t i = 0; i < candidates.size(); i++) {
+			const pattern_entry &entry = fPatterns[candidates[i]];
+			if (satisfied[entry.disjunction] || position < entry.anchor)
+				continue;
+
+			size_t start = position - entry.anchor;
+			if (start < (size_t)entry.start || start > (size_t)entry.end
+				|| start + entry.string.length() > length) {
+				continue;
+			}
+
+			if (_Verify(entry, data + start))
+				satisfied[entry.disjunction] = true;
+		}
+	}
+
+	// Patterns that are masked everywhere can't be anchored, so they are
+	// tried at every offset of their range
+	for (size_t i = 0; i < fUnanchored.size(); i++) {
+		const pattern_entry &entry = fPatterns[fUnanchored[i]];
+		if (satisfied[entry.disjunction] || entry.string.length() > length)
+			continue;
+
+		size_t end = length - entry.string.length();
+		if ((size_t)entry.end < end)
+			end = entry.end;
+		for (size_t start = entry.start; start <= end; start++) {
+			if (_Verify(entry, data + start)) {
+				satisfied[entry.disjunction] = true;
+				break;
+			}
+		}
+	}
+
+	matches.assign(fRules.size(), false);
+	for (size_t i = 0; i < fRules.size(); i++) {
+		const rule_entry &rule = fRules[i];
+		if (!rule.valid)
+			continue;
+
+		bool result = true;
+		for (uint32 j = 0; j < rule.disjunction_count; j++) {
+			if (!satisfied[rule.first_disjunction + j]) {
+				result = false;
+				break;
+			}
+		}
+		matches[i] = result;
+	}
+}
+
+/*! \brief Adds a pattern to be searched for over the given range as part of
+	the given disjunction.
+
+	Called back by DisjList::AddTo() while compiling.
+*/
+void
+Matcher::AddPattern(uint32 disjunction, const Range &range,
+	const Pattern *pattern, bool caseInsensitive)
+{
+	if (pattern == NULL || range.InitCheck() != B_OK
+		|| pattern->InitCheck() != B_OK) {
+		return;
+	}
+
+	// Negative offsets can never match
+	if (range.End() < 0)
+		return;
+
+	pattern_entry entry;
+	entry.start = range.Start() < 0 ? 0 : range.Start();
+	entry.end = range.End();
+	entry.disjunction = disjunction;
+	entry.string = pattern->fString;
+	entry.mask = pattern->fMask;
+	entry.alternate = pattern->fString;
+	if (caseInsensitive) {
+		for (size_t i = 0; i < entry.alternate.length(); i++)
+			entry.alternate[i] = swap_case(entry.alternate[i]);
+	}
+	entry.anchor = _ChooseAnchor(entry.string, entry.mask);
+
+	uint32 index = fPatterns.size();
+	fPatterns.push_back(entry);
+
+	if (entry.anchor == kNoAnchor) {
+		fUnanchored.push_back(index);
+		return;
+	}
+
+	uint8 anchor = entry.string[entry.anchor];
+	uint8 alternate = entry.alternate[entry.anchor];
+	fAnchorTable[anchor].push_back(index);
+	if (alternate != anchor)
+		fAnchorTable[alternate].push_back(index);
+
+	size_t scanLength = (size_t)entry.end + entry.anchor + 1;
+	if (scanLength > fScanLength)
+		fScanLength = scanLength;
+}
+
+void
+Matcher::AddRPattern(uint32 disjunction, const RPattern *rpattern,
+	bool caseInsensitive)
+{
+	if (rpattern == NULL || rpattern->InitCheck() != B_OK)
+		return;
+
+	AddPattern(disjunction, rpattern->fRange, rpattern->fPattern,
+		caseInsensitive);
+}
+
+/*! \brief Picks the byte of the pattern the matcher indexes it by.
+
+	Only bytes the mask doesn't touch qualify, and among those, bytes that
+	are rare in typical files are preferred, so that as few candidates as
+	possible need to be verified.
+*/
+uint32
+Matcher::_ChooseAnchor(const std::string &string, const std::string &mask)
+{
+	uint32 anchor = kNoAnchor;
+	for (size_t i = 0; i < string.length(); i++) {
+		if ((uint8)mask[i] != 0xff)
+			continue;
+		if (!is_common_byte(string[i]))
+			return i;
+		if (anchor == kNoAnchor)
+			anchor = i;
+	}
+	return anchor;
+}
+
+/*! \brief Compares the pattern of \a entry with the bytes at \a data, the
+	same way Pattern::Sniff() does.
+*/
+bool
+Matcher::_Verify(const pattern_entry &entry, const uint8 *data)
+{
+	const uint8 *string = (const uint8*)entry.string.data();
+	const uint8 *alternate = (const uint8*)entry.alternate.data();
+	const uint8 *mask = (const uint8*)entry.mask.data();
+	size_t length = entry.string.length();
+
+	for (size_t i = 0; i < length; i++) {
+		uint8 byte = data[i] & mask[i];
+		if ((string[i] & mask[i]) != byte && (alternate[i] & mask[i]) != byte)
+			return false;
+	}
+	return true;
+}
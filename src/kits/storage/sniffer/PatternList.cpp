@@ -8,6 +8,7 @@
 */
 
 #include <sniffer/Err.h>
+#include <sniffer/Matcher.h>
 #include <sniffer/Pattern.h>
 #include <sniffer/PatternList.h>
 #include <DataIO.h>
@@ -91,6 +92,18 @@ PatternList::BytesNeeded() const
 	return result;	
 }
 
+//! Adds the list's patterns to the given matcher as the given disjunction.
+void
+PatternList::AddTo(Matcher *matcher, uint32 disjunction) const {
+	if (InitCheck() != B_OK)
+		return;
+	std::vector<Pattern*>::const_iterator i;
+	for (i = fList.begin(); i != fList.end(); i++) {
+		if (*i)
+			matcher->AddPattern(disjunction, fRange, *i, fCaseInsensitive);
+	}
+}
+
 void
 PatternList::Add(Pattern *pattern) {
 	if (pattern)
@@ -8,6 +8,7 @@
 */
 
 #include <sniffer/Err.h>
+#include <sniffer/Matcher.h>
 #include <sniffer/RPattern.h>
 #include <sniffer/RPatternList.h>
 #include <DataIO.h>
@@ -84,6 +85,16 @@ RPatternList::BytesNeeded() const
 	return result;
 }
 	
+//! Adds the list's rpatterns to the given matcher as the given disjunction.
+void
+RPatternList::AddTo(Matcher *matcher, uint32 disjunction) const {
+	std::vector<RPattern*>::const_iterator i;
+	for (i = fList.begin(); i != fList.end(); i++) {
+		if (*i)
+			matcher->AddRPattern(disjunction, *i, fCaseInsensitive);
+	}
+}
+
 void
 RPatternList::Add(RPattern *rpattern) {
 	if (rpattern)
@@ -0,0 +1,718 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	A compressed format made of independently compressed blocks, followed by
+	an index of the blocks, so that the blocks can be compressed in parallel,
+	and any part of the data can be decompressed without reading what comes
+	before it. The blocks are compressed with any BCompressionAlgorithm, which
+	isn't recorded in the stream.
+
+	The layout, all numbers in little endian:
+		header		block_compression_header
+		blocks		the compressed blocks; a block that doesn't get smaller is
+					stored as is, which the index records by a compressed size
+					equal to the uncompressed one
+		index		a block_compression_index_entry per block
+		trailer		block_compression_trailer
+*/
+
+
+#include <BlockCompression.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <new>
+
+#include <ByteOrder.h>
+#include <Errors.h>
+
+
+static const uint32 kBlockCompressionMagic = 'bcmp';
+static const uint16 kBlockCompressionVersion = 1;
+static const int32 kMaxCompressionThreads = 32;
+
+
+struct block_compression_header {
+	uint32	magic;
+	uint16	version;
+	uint16	reserved;
+	uint32	block_size;
+	uint32	reserved2;
+};
+
+
+struct block_compression_index_entry {
+	uint64	offset;
+	uint32	compressed_size;
+	uint32	size;
+};
+
+
+struct block_compression_trailer {
+	uint64	index_offset;
+	uint64	block_count;
+	uint32	reserved;
+	uint32	magic;
+};
+
+
+// #pragma mark - BBlockCompressingOutputStream
+
+
+struct BBlockCompressingOutputStream::Block {
+	uint8*		data;
+	uint8*		compressedData;
+	size_t		size;
+	size_t		compressedSize;
+	status_t	status;
+	sem_id		doneSemaphore;
+};
+
+
+struct BBlockCompressingOutputStream::IndexEntry
+	: block_compression_index_entry {
+};
+
+
+BBlockCompressingOutputStream::BBlockCompressingOutputStream(BDataIO* output,
+	BCompressionAlgorithm* algorithm, const BCompressionParameters* parameters)
+	:
+	fOutput(output),
+	fAlgorithm(algorithm),
+	fParameters(parameters),
+	fBlockSize(0),
+	fBlocks(NULL),
+	fBlockCount(0),
+	fThreads(NULL),
+	fThreadCount(0),
+	fWorkSemaphore(-1),
+	fNextBlock(0),
+	fNextCompressedBlock(0),
+	fNextWrittenBlock(0),
+	fIndex(NULL),
+	fIndexCapacity(0),
+	fOutputOffset(0),
+	fError(B_NO_INIT),
+	fTerminating(false),
+	fFinished(false)
+{
+}
+
+
+BBlockCompressingOutputStream::~BBlockCompressingOutputStream()
+{
+	if (fError == B_OK && !fFinished)
+		Finish();
+
+	_WriteAllBlocks();
+	_StopWorkers();
+
+	for (int32 i = 0; i < fBlockCount; i++) {
+		free(fBlocks[i].data);
+		free(fBlocks[i].compressedData);
+		if (fBlocks[i].doneSemaphore >= 0)
+			delete_sem(fBlocks[i].doneSemaphore);
+	}
+	delete[] fBlocks;
+	delete[] fThreads;
+	free(fIndex);
+}
+
+
+/*!	Writes the stream header and starts \a threadCount worker threads, or as
+	many as there are CPUs, if \c 0. Each block holds \a blockSize bytes of
+	uncompressed data.
+*/
+status_t
+BBlockCompressingOutputStream::Init(size_t blockSize, int32 threadCount)
+{
+	if (fBlocks != NULL)
+		return B_BAD_VALUE;
+	if (fOutput == NULL || fAlgorithm == NULL || blockSize == 0
+		|| (uint64)blockSize > 0xffffffff) {
+		return fError = B_BAD_VALUE;
+	}
+
+	if (threadCount <= 0) {
+		system_info info;
+		threadCount = get_system_info(&info) == B_OK ? info.cpu_count : 1;
+	}
+	threadCount = std::min(threadCount, kMaxCompressionThreads);
+
+	fBlockSize = blockSize;
+
+	// Twice as many blocks as threads, so that the blocks can be filled
+	// while the previous ones are compressed.
+	fBlockCount = threadCount * 2;
+	fBlocks = new(std::nothrow) Block[fBlockCount];
+	fThreads = new(std::nothrow) thread_id[threadCount];
+	if (fBlocks == NULL || fThreads == NULL) {
+		fBlockCount = 0;
+		return fError = B_NO_MEMORY;
+	}
+
+	for (int32 i = 0; i < fBlockCount; i++) {
+		Block& block = fBlocks[i];
+		block.data = NULL;
+		block.compressedData = NULL;
+		block.size = 0;
+		block.compressedSize = 0;
+		block.status = B_OK;
+		block.doneSemaphore = -1;
+	}
+
+	for (int32 i = 0; i < fBlockCount; i++) {
+		Block& block = fBlocks[i];
+		block.data = (uint8*)malloc(fBlockSize);
+		block.compressedData = (uint8*)malloc(fBlockSize);
+		if (block.data == NULL || block.compressedData == NULL)
+			return fError = B_NO_MEMORY;
+
+		block.doneSemaphore = create_sem(0, "block compressed");
+		if (block.doneSemaphore < 0)
+			return fError = block.doneSemaphore;
+	}
+
+	fWorkSemaphore = create_sem(0, "block compression work");
+	if (fWorkSemaphore < 0)
+		return fError = fWorkSemaphore;
+
+	for (int32 i = 0; i < threadCount; i++) {
+		thread_id thread = spawn_thread(&_WorkerEntry, "block compressor",
+			B_NORMAL_PRIORITY, this);
+		if (thread < 0) {
+			_StopWorkers();
+			return fError = thread;
+		}
+
+		fThreads[fThreadCount++] = thread;
+		resume_thread(thread);
+	}
+
+	block_compression_header header;
+	memset(&header, 0, sizeof(header));
+	header.magic = B_HOST_TO_LENDIAN_INT32(kBlockCompressionMagic);
+	header.version = B_HOST_TO_LENDIAN_INT16(kBlockCompressionVersion);
+	header.block_size = B_HOST_TO_LENDIAN_INT32(fBlockSize);
+
+	status_t error = fOutput->WriteExactly(&header, sizeof(header));
+	if (error != B_OK)
+		return fError = error;
+
+	fOutputOffset = sizeof(header);
+	return fError = B_OK;
+}
+
+
+ssize_t
+BBlockCompressingOutputStream::Write(const void* buffer, size_t size)
+{
+	if (fError != B_OK)
+		return fError;
+	if (fFinished)
+		return B_NOT_ALLOWED;
+
+	const uint8* input = (const uint8*)buffer;
+	size_t bytesRemaining = size;
+
+	while (bytesRemaining > 0) {
+		// make sure the block to fill has been written
+		while (fNextBlock - fNextWrittenBlock >= fBlockCount) {
+			status_t error = _WriteNextBlock();
+			if (error != B_OK)
+				return error;
+		}
+
+		Block& block = fBlocks[fNextBlock % fBlockCount];
+		size_t toCopy = std::min(bytesRemaining, fBlockSize - block.size);
+		memcpy(block.data + block.size, input, toCopy);
+		block.size += toCopy;
+		input += toCopy;
+		bytesRemaining -= toCopy;
+
+		if (block.size == fBlockSize) {
+			status_t error = _SubmitBlock();
+			if (error != B_OK)
+				return error;
+		}
+	}
+
+	return size;
+}
+
+
+/*!	Ends the current block early, and writes all blocks. The stream can be
+	continued afterwards.
+*/
+status_t
+BBlockCompressingOutputStream::Flush()
+{
+	if (fError != B_OK)
+		return fError;
+	if (fFinished)
+		return B_OK;
+
+	if (fBlocks[fNextBlock % fBlockCount].size > 0) {
+		status_t error = _SubmitBlock();
+		if (error != B_OK)
+			return error;
+	}
+
+	status_t error = _WriteAllBlocks();
+	if (error != B_OK)
+		return error;
+
+	return fOutput->Flush();
+}
+
+
+/*!	Writes all blocks, followed by the index and the trailer. Nothing can be
+	written afterwards. If not called explicitly, the destructor does it.
+*/
+status_t
+BBlockCompressingOutputStream::Finish()
+{
+	status_t error = Flush();
+	if (error != B_OK || fFinished)
+		return error;
+
+	fFinished = true;
+
+	uint64 indexOffset = fOutputOffset;
+	for (int64 i = 0; i < fNextWrittenBlock; i++) {
+		block_compression_index_entry entry;
+		entry.offset = B_HOST_TO_LENDIAN_INT64(fIndex[i].offset);
+		entry.compressed_size
+			= B_HOST_TO_LENDIAN_INT32(fIndex[i].compressed_size);
+		entry.size = B_HOST_TO_LENDIAN_INT32(fIndex[i].size);
+
+		error = fOutput->WriteExactly(&entry, sizeof(entry));
+		if (error != B_OK)
+			return fError = error;
+	}
+
+	block_compression_trailer trailer;
+	memset(&trailer, 0, sizeof(trailer));
+	trailer.index_offset = B_HOST_TO_LENDIAN_INT64(indexOffset);
+	trailer.block_count = B_HOST_TO_LENDIAN_INT64(fNextWrittenBlock);
+	trailer.magic = B_HOST_TO_LENDIAN_INT32(kBlockCompressionMagic);
+
+	error = fOutput->WriteExactly(&trailer, sizeof(trailer));
+	if (error != B_OK)
+		return fError = error;
+
+	return fOutput->Flush();
+}
+
+
+/*static*/ status_t
+BBlockCompressingOutputStream::_WorkerEntry(void* data)
+{
+	((BBlockCompressingOutputStream*)data)->_Worker();
+	return B_OK;
+}
+
+
+void
+BBlockCompressingOutputStream::_Worker()
+{
+	while (true) {
+		status_t error;
+		do {
+			error = acquire_sem(fWorkSemaphore);
+		} while (error == B_INTERRUPTED);
+
+		if (error != B_OK || fTerminating)
+			return;
+
+		// the blocks are taken in the order they were submitted
+		int64 index = atomic_add64(&fNextCompressedBlock, 1);
+		Block& block = fBlocks[index % fBlockCount];
+		_CompressBlock(block);
+		release_sem(block.doneSemaphore);
+	}
+}
+
+
+void
+BBlockCompressingOutputStream::_CompressBlock(Block& block)
+{
+	// The output buffer is only as large as the input, so a block that
+	// doesn't get smaller overflows it, and is stored as is.
+	size_t compressedSize;
+	status_t error = fAlgorithm->CompressBuffer(block.data, block.size,
+		block.compressedData, block.size, compressedSize, fParameters);
+	if (error == B_BUFFER_OVERFLOW
+		|| (error == B_OK && compressedSize >= block.size)) {
+		compressedSize = block.size;
+		error = B_OK;
+	}
+
+	block.compressedSize = compressedSize;
+	block.status = error;
+}
+
+
+status_t
+BBlockCompressingOutputStream::_SubmitBlock()
+{
+	fNextBlock++;
+	return release_sem(fWorkSemaphore);
+}
+
+
+/*!	Waits for the oldest submitted block to be compressed, and writes it.
+*/
+status_t
+BBlockCompressingOutputStream::_WriteNextBlock()
+{
+	Block& block = fBlocks[fNextWrittenBlock % fBlockCount];
+
+	status_t error;
+	do {
+		error = acquire_sem(block.doneSemaphore);
+	} while (error == B_INTERRUPTED);
+
+	fNextWrittenBlock++;
+
+	if (error == B_OK)
+		error = block.status;
+
+	if (error == B_OK && fError == B_OK && fNextWrittenBlock > fIndexCapacity) {
+		int64 capacity = std::max(fIndexCapacity * 2, (int64)64);
+		IndexEntry* index = (IndexEntry*)realloc(fIndex,
+			capacity * sizeof(IndexEntry));
+		if (index != NULL) {
+			fIndex = index;
+			fIndexCapacity = capacity;
+		} else
+			error = B_NO_MEMORY;
+	}
+
+	if (error == B_OK && fError == B_OK) {
+		const uint8* data = block.compressedSize < block.size
+			? block.compressedData : block.data;
+		error = fOutput->WriteExactly(data, block.compressedSize);
+	}
+
+	if (error == B_OK && fError == B_OK) {
+		IndexEntry& entry = fIndex[fNextWrittenBlock - 1];
+		entry.offset = fOutputOffset;
+		entry.compressed_size = block.compressedSize;
+		entry.size = block.size;
+		fOutputOffset += block.compressedSize;
+	}
+
+	block.size = 0;
+
+	if (error != B_OK && fError == B_OK)
+		fError = error;
+	return fError;
+}
+
+
+status_t
+BBlockCompressingOutputStream::_WriteAllBlocks()
+{
+	// all blocks must be waited for, even after an error
+	status_t error = B_OK;
+	while (fNextWrittenBlock < fNextBlock) {
+		status_t blockError = _WriteNextBlock();
+		if (error == B_OK)
+			error = blockError;
+	}
+
+	return error;
+}
+
+
+void
+BBlockCompressingOutputStream::_StopWorkers()
+{
+	fTerminating = true;
+	if (fWorkSemaphore >= 0) {
+		delete_sem(fWorkSemaphore);
+		fWorkSemaphore = -1;
+	}
+
+	for (int32 i = 0; i < fThreadCount; i++) {
+		status_t result;
+		wait_for_thread(fThreads[i], &result);
+	}
+	fThreadCount = 0;
+}
+
+
+// #pragma mark - BBlockDecompressingInputStream
+
+
+struct BBlockDecompressingInputStream::Block {
+	off_t		position;
+	uint64		offset;
+	uint32		compressedSize;
+	uint32		size;
+};
+
+
+BBlockDecompressingInputStream::BBlockDecompressingInputStream(
+	BPositionIO* input, BCompressionAlgorithm* algorithm,
+	const BDecompressionParameters* parameters)
+	:
+	fInput(input),
+	fAlgorithm(algorithm),
+	fParameters(parameters),
+	fBlocks(NULL),
+	fBlockCount(0),
+	fBlockSize(0),
+	fSize(0),
+	fPosition(0),
+	fBuffer(NULL),
+	fCompressedBuffer(NULL),
+	fBufferedBlock(-1)
+{
+}
+
+
+BBlockDecompressingInputStream::~BBlockDecompressingInputStream()
+{
+	free(fBlocks);
+	free(fBuffer);
+	free(fCompressedBuffer);
+}
+
+
+/*!	Reads the index of the stream, which must span all of \a input.
+*/
+status_t
+BBlockDecompressingInputStream::Init()
+{
+	if (fInput == NULL || fAlgorithm == NULL || fBlocks != NULL)
+		return B_BAD_VALUE;
+
+	off_t inputSize;
+	status_t error = fInput->GetSize(&inputSize);
+	if (error != B_OK)
+		return error;
+
+	block_compression_header header;
+	block_compression_trailer trailer;
+	if (inputSize < (off_t)(sizeof(header) + sizeof(trailer)))
+		return B_BAD_DATA;
+
+	error = fInput->ReadAtExactly(0, &header, sizeof(header));
+	if (error == B_OK) {
+		error = fInput->ReadAtExactly(inputSize - sizeof(trailer), &trailer,
+			sizeof(trailer));
+	}
+	if (error != B_OK)
+		return error;
+
+	if (B_LENDIAN_TO_HOST_INT32(header.magic) != kBlockCompressionMagic
+		|| B_LENDIAN_TO_HOST_INT32(trailer.magic) != kBlockCompressionMagic) {
+		return B_BAD_DATA;
+	}
+	if (B_LENDIAN_TO_HOST_INT16(header.version) != kBlockCompressionVersion)
+		return B_NOT_SUPPORTED;
+
+	fBlockSize = B_LENDIAN_TO_HOST_INT32(header.block_size);
+	uint64 indexOffset = B_LENDIAN_TO_HOST_INT64(trailer.index_offset);
+	uint64 blockCount = B_LENDIAN_TO_HOST_INT64(trailer.block_count);
+	uint64 indexEnd = inputSize - sizeof(trailer);
+	if (fBlockSize == 0 || indexOffset < sizeof(header)
+		|| indexOffset > indexEnd
+		|| (indexEnd - indexOffset)
+			% sizeof(block_compression_index_entry) != 0
+		|| blockCount != (indexEnd - indexOffset)
+			/ sizeof(block_compression_index_entry)) {
+		return B_BAD_DATA;
+	}
+
+	// read the index
+	block_compression_index_entry* index
+		= (block_compression_index_entry*)malloc(
+			blockCount * sizeof(block_compression_index_entry));
+	fBlocks = (Block*)malloc(blockCount * sizeof(Block));
+	fBuffer = (uint8*)malloc(fBlockSize);
+	fCompressedBuffer = (uint8*)malloc(fBlockSize);
+	if ((blockCount > 0 && (index == NULL || fBlocks == NULL))
+		|| fBuffer == NULL || fCompressedBuffer == NULL) {
+		free(index);
+		return B_NO_MEMORY;
+	}
+
+	error = fInput->ReadAtExactly(indexOffset, index,
+		blockCount * sizeof(block_compression_index_entry));
+	if (error != B_OK) {
+		free(index);
+		return error;
+	}
+
+	off_t position = 0;
+	for (uint64 i = 0; i < blockCount; i++) {
+		Block& block = fBlocks[i];
+		block.position = position;
+		block.offset = B_LENDIAN_TO_HOST_INT64(index[i].offset);
+		block.compressedSize = B_LENDIAN_TO_HOST_INT32(
+			index[i].compressed_size);
+		block.size = B_LENDIAN_TO_HOST_INT32(index[i].size);
+
+		if (block.size == 0 || block.size > fBlockSize
+			|| block.compressedSize > block.size
+			|| block.offset < sizeof(header)
+			|| block.offset + block.compressedSize > indexOffset) {
+			free(index);
+			return B_BAD_DATA;
+		}
+
+		position += block.size;
+	}
+
+	free(index);
+
+	fBlockCount = blockCount;
+	fSize = position;
+	return B_OK;
+}
+
+
+ssize_t
+BBlockDecompressingInputStream::ReadAt(off_t position, void* buffer,
+	size_t size)
+{
+	if (fBuffer == NULL)
+		return B_NO_INIT;
+	if (position < 0)
+		return B_BAD_VALUE;
+
+	uint8* output = (uint8*)buffer;
+	size_t bytesRead = 0;
+
+	while (bytesRead < size && position < fSize) {
+		int64 index = _BlockAt(position);
+		status_t error = _LoadBlock(index);
+		if (error != B_OK)
+			return bytesRead > 0 ? (ssize_t)bytesRead : error;
+
+		const Block& block = fBlocks[index];
+		size_t offset = position - block.position;
+		size_t toCopy = std::min(size - bytesRead, block.size - offset);
+		memcpy(output + bytesRead, fBuffer + offset, toCopy);
+
+		bytesRead += toCopy;
+		position += toCopy;
+	}
+
+	return bytesRead;
+}
+
+
+ssize_t
+BBlockDecompressingInputStream::WriteAt(off_t position, const void* buffer,
+	size_t size)
+{
+	return B_NOT_SUPPORTED;
+}
+
+
+off_t
+BBlockDecompressingInputStream::Seek(off_t position, uint32 seekMode)
+{
+	switch (seekMode) {
+		case SEEK_SET:
+			break;
+		case SEEK_CUR:
+			position += fPosition;
+			break;
+		case SEEK_END:
+			position += fSize;
+			break;
+		default:
+			return B_BAD_VALUE;
+	}
+
+	if (position < 0)
+		return B_BAD_VALUE;
+
+	return fPosition = position;
+}
+
+
+off_t
+BBlockDecompressingInputStream::Position() const
+{
+	return fPosition;
+}
+
+
+status_t
+BBlockDecompressingInputStream::SetSize(off_t size)
+{
+	return B_NOT_SUPPORTED;
+}
+
+
+status_t
+BBlockDecompressingInputStream::GetSize(off_t* size) const
+{
+	*size = fSize;
+	return B_OK;
+}
+
+
+int64
+BBlockDecompressingInputStream::_BlockAt(off_t position) const
+{
+	// binary search
+	int64 lower = 0;
+	int64 upper = fBlockCount - 1;
+	while (lower < upper) {
+		int64 mid = (lower + upper + 1) / 2;
+		if (fBlocks[mid].position > position)
+			upper = mid - 1;
+		else
+			lower = mid;
+	}
+
+	return lower;
+}
+
+
+status_t
+BBlockDecompressingInputStream::_LoadBlock(int64 index)
+{
+	if (index == fBufferedBlock)
+		return B_OK;
+
+	fBufferedBlock = -1;
+
+	const Block& block = fBlocks[index];
+	if (block.compressedSize == block.size) {
+		// the block is stored as is
+		status_t error = fInput->ReadAtExactly(block.offset, fBuffer,
+			block.size);
+		if (error != B_OK)
+			return error;
+	} else {
+		status_t error = fInput->ReadAtExactly(block.offset,
+			fCompressedBuffer, block.compressedSize);
+		if (error != B_OK)
+			return error;
+
+		size_t size;
+		error = fAlgorithm->DecompressBuffer(fCompressedBuffer,
+			block.compressedSize, fBuffer, fBlockSize, size, fParameters);
+		if (error != B_OK)
+			return error;
+		if (size != block.size)
+			return B_BAD_DATA;
+	}
+
+	fBufferedBlock = index;
+	return B_OK;
+}
@@ -90,6 +90,22 @@ BFuncTranslator::OutputFormats(int32* _count) const
 }
 
 
+const translation_signature *
+BFuncTranslator::InputSignatures(int32* _count) const
+{
+	if (_count == NULL || fData.input_signatures == NULL)
+		return BTranslator::InputSignatures(_count);
+
+	int32 count = 0;
+	while (fData.input_signatures[count].length) {
+		count++;
+	}
+
+	*_count = count;
+	return fData.input_signatures;
+}
+
+
 status_t
 BFuncTranslator::Identify(BPositionIO* source, const translation_format* format,
 	BMessage* ioExtension, translator_info* info, uint32 type)
@@ -21,6 +21,7 @@ struct translator_data {
 	int32		version;
 	const translation_format* input_formats;
 	const translation_format* output_formats;
+	const translation_signature* input_signatures;
 
 	status_t	(*identify_hook)(BPositionIO* source, const translation_format* format,
 					BMessage* ioExtension, translator_info* outInfo, uint32 outType);
@@ -54,6 +55,8 @@ class BFuncTranslator : public BTranslator {
 		virtual status_t MakeConfigurationView(BMessage *ioExtension,
 			BView **outView, BRect *outExtent);
 		virtual status_t GetConfigurationMessage(BMessage *ioExtension);
+		virtual const translation_signature *InputSignatures(
+			int32 *_count) const;
 
 	protected:
 		virtual ~BFuncTranslator();
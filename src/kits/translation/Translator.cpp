@@ -12,6 +12,8 @@
 
 #include <Translator.h>
 
+#include <binary_compatibility/Global.h>
+
 
 BTranslator::BTranslator()
 	:
@@ -103,7 +105,36 @@ BTranslator::GetConfigurationMessage(BMessage* ioExtension)
 }
 
 
-status_t BTranslator::_Reserved_Translator_0(int32 n, void *p) { return B_ERROR; }
+/*!
+	Returns signatures, patterns at fixed positions in the data, of which
+	at least one is found in all data this translator could identify.
+	BTranslatorRoster only asks a translator to identify data that matches
+	one of its signatures, and thus does not need to call every translator
+	for each file. Signatures should lie within the first 4 KB of the
+	data; those that do not are assumed to match.
+	Translators that cannot tell their data apart that way return \c NULL
+	here, which is the default, and are always asked.
+*/
+const translation_signature*
+BTranslator::InputSignatures(int32* _count) const
+{
+	if (_count != NULL)
+		*_count = 0;
+	return NULL;
+}
+
+
+// The slot of the first reserved virtual is now used by InputSignatures();
+// translators that were built before that still refer to the old symbol.
+extern "C" const translation_signature*
+B_IF_GCC_2(_Reserved_Translator_0__11BTranslatorlPv,
+	_ZN11BTranslator22_Reserved_Translator_0EiPv)(const BTranslator* translator,
+	int32* _count)
+{
+	return translator->BTranslator::InputSignatures(_count);
+}
+
+
 status_t BTranslator::_Reserved_Translator_1(int32 n, void *p) { return B_ERROR; }
 status_t BTranslator::_Reserved_Translator_2(int32 n, void *p) { return B_ERROR; }
 status_t BTranslator::_Reserved_Translator_3(int32 n, void *p) { return B_ERROR; }
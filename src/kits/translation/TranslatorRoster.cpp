@@ -71,6 +71,9 @@ char B_TRANSLATOR_EXT_SOUND_MONO[]			= "nois/mono";
 char B_TRANSLATOR_EXT_SOUND_MARKER[]		= "nois/marker";
 char B_TRANSLATOR_EXT_SOUND_LOOP[]			= "nois/loop";
 
+// How much of the data is read up front to match the translators' signatures
+static const int32 kSignaturePeekSize = 4096;
+
 BTranslatorRoster* BTranslatorRoster::sDefaultRoster = NULL;
 
 
@@ -551,6 +554,8 @@ BTranslatorRoster::Private::GetTranslatorData(image_id image,
 		(void**)&data.make_config_hook);
 	get_image_symbol(image, "GetConfigMessage", B_SYMBOL_TYPE_TEXT,
 		(void**)&data.get_config_message_hook);
+	get_image_symbol(image, "inputSignatures", B_SYMBOL_TYPE_DATA,
+		(void**)&data.input_signatures);
 
 	return B_OK;
 }
@@ -729,8 +734,17 @@ BTranslatorRoster::Private::Identify(BPositionIO* source,
 
 	float bestWeight = 0.0f;
 
+	// Read the start of the data only once, so that translators which
+	// cannot handle it don't have to look at it at all
+	uint8 peek[kSignaturePeekSize];
+	ssize_t peekSize = source->ReadAt(0, peek, sizeof(peek));
+
 	while (iterator != fTranslators.end()) {
 		BTranslator& translator = *iterator->second.translator;
+		if (!_MatchesSignatures(translator, peek, peekSize)) {
+			iterator++;
+			continue;
+		}
 
 		off_t pos = source->Seek(0, SEEK_SET);
 		if (pos != 0)
@@ -784,8 +798,15 @@ BTranslatorRoster::Private::GetTranslators(BPositionIO* source,
 	TranslatorMap::const_iterator iterator = fTranslators.begin();
 	int32 count = 0;
 
+	uint8 peek[kSignaturePeekSize];
+	ssize_t peekSize = source->ReadAt(0, peek, sizeof(peek));
+
 	while (iterator != fTranslators.end()) {
 		BTranslator& translator = *iterator->second.translator;
+		if (!_MatchesSignatures(translator, peek, peekSize)) {
+			iterator++;
+			continue;
+		}
 
 		off_t pos = source->Seek(0, SEEK_SET);
 		if (pos != 0) {
@@ -956,6 +977,50 @@ BTranslatorRoster::Private::_CheckHints(const translation_format* formats,
 }
 
 
+/*!
+	Tests if the start of a source stream, of which \a size bytes could be
+	read into \a data, matches one of the signatures the translator declares.
+	Translators without signatures may identify anything. A negative \a size
+	means the data could not be read, and lets all translators through.
+*/
+/*static*/ bool
+BTranslatorRoster::Private::_MatchesSignatures(const BTranslator& translator,
+	const uint8* data, ssize_t size)
+{
+	int32 count = 0;
+	const translation_signature* signatures
+		= translator.InputSignatures(&count);
+	if (signatures == NULL || count <= 0 || size < 0)
+		return true;
+
+	for (int32 i = 0; i < count; i++) {
+		const translation_signature& signature = signatures[i];
+		if (signature.offset < 0 || signature.length <= 0
+			|| signature.offset + signature.length > kSignaturePeekSize) {
+			// we cannot check this one
+			return true;
+		}
+		if (signature.offset + signature.length > size)
+			continue;
+
+		const uint8* bytes = data + signature.offset;
+		const uint8* pattern = (const uint8*)signature.pattern;
+		const uint8* mask = (const uint8*)signature.mask;
+
+		int32 j = 0;
+		for (; j < signature.length; j++) {
+			uint8 byte = mask != NULL ? bytes[j] & mask[j] : bytes[j];
+			if (byte != pattern[j])
+				break;
+		}
+		if (j == signature.length)
+			return true;
+	}
+
+	return false;
+}
+
+
 const translator_item*
 BTranslatorRoster::Private::_FindTranslator(translator_id id) const
 {
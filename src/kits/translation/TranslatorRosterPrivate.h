@@ -82,6 +82,9 @@ public:
 
 private:
 	static	int					_CompareSupport(const void* _a, const void* _b);
+	static	bool				_MatchesSignatures(
+									const BTranslator& translator,
+									const uint8* data, ssize_t size);
 
 			void				_RescanChanged();
 
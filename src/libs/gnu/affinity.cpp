@@ -0,0 +1,91 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+#include <OS.h>
+
+#include <syscalls.h>
+#include <syscall_utils.h>
+
+
+/*	The kernel uses the layout of cpu_set_t for the CPU masks, but only looks
+	at as many CPUs as the system has. Threads are identified by their
+	thread_id; as on Linux, the pid of a process is the ID of its main thread.
+*/
+
+
+static status_t
+set_affinity(thread_id thread, size_t cpuSetSize, const cpu_set_t* mask)
+{
+	if (mask == NULL || cpuSetSize == 0)
+		return B_BAD_VALUE;
+
+	status_t status = _kern_set_thread_affinity(thread, mask,
+		cpuSetSize / sizeof(mask->__bits[0]) * sizeof(mask->__bits[0]));
+	if (status == B_BAD_THREAD_ID)
+		return ESRCH;
+	return status;
+}
+
+
+static status_t
+get_affinity(thread_id thread, size_t cpuSetSize, cpu_set_t* mask)
+{
+	if (mask == NULL)
+		return B_BAD_VALUE;
+
+	size_t size = cpuSetSize / sizeof(mask->__bits[0])
+		* sizeof(mask->__bits[0]);
+	if (size > sizeof(cpu_set_t))
+		size = sizeof(cpu_set_t);
+
+	memset(mask, 0, size);
+	status_t status = _kern_get_thread_affinity(thread, mask, size);
+	if (status == B_BAD_THREAD_ID)
+		return ESRCH;
+	return status;
+}
+
+
+int
+sched_setaffinity(pid_t thread, size_t cpuSetSize, const cpu_set_t* mask)
+{
+	RETURN_AND_SET_ERRNO(set_affinity(thread, cpuSetSize, mask));
+}
+
+
+int
+sched_getaffinity(pid_t thread, size_t cpuSetSize, cpu_set_t* mask)
+{
+	RETURN_AND_SET_ERRNO(get_affinity(thread, cpuSetSize, mask));
+}
+
+
+int
+pthread_setaffinity_np(pthread_t thread, size_t cpuSetSize,
+	const cpu_set_t* mask)
+{
+	thread_id id = get_pthread_thread_id(thread);
+	if (id < 0)
+		return ESRCH;
+
+	return set_affinity(id, cpuSetSize, mask);
+}
+
+
+int
+pthread_getaffinity_np(pthread_t thread, size_t cpuSetSize, cpu_set_t* mask)
+{
+	thread_id id = get_pthread_thread_id(thread);
+	if (id < 0)
+		return ESRCH;
+
+	return get_affinity(id, cpuSetSize, mask);
+}
@@ -44,6 +44,7 @@
 #include "DecorManager.h"
 #include "DesktopSettingsPrivate.h"
 #include "DrawingEngine.h"
+#include "FontCache.h"
 #include "FontManager.h"
 #include "HWInterface.h"
 #include "InputManager.h"
@@ -2659,6 +2660,10 @@ Desktop::_DispatchMessage(int32 code, BPrivate::LinkReceiver& link)
 			break;
 		}
 
+		case AS_DUMP_FONT_CACHE:
+			FontCache::Default()->Dump();
+			break;
+
 		case AS_EVENT_STREAM_CLOSED:
 			_LaunchInputServer();
 			break;
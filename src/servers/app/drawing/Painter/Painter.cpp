@@ -163,6 +163,8 @@ detect_simd()
 				cpuSIMD |= APPSERVER_SIMD_MMX;
 			if (edx & (1 << 25))
 				cpuSIMD |= APPSERVER_SIMD_SSE;
+			if (edx & (1 << 26))
+				cpuSIMD |= APPSERVER_SIMD_SSE2;
 		} else {
 			// no flags can be identified
 			cpuSIMD = 0;
@@ -170,7 +172,11 @@ detect_simd()
 		systemSIMD &= cpuSIMD;
 	}
 	return systemSIMD;
-#else	// !__i386__
+#elif __x86_64__
+	// SSE2 is part of the architecture. The MMX/SSE flags are not set, as
+	// they select assembly code that is only available on x86.
+	return APPSERVER_SIMD_SSE2;
+#else
 	return 0;
 #endif
 }
@@ -12,8 +12,10 @@
 
 #include "drawing_support.h"
 
+#include "Painter.h"
 #include "PatternHandler.h"
 #include "PixelFormat.h"
+#include "SpanBlendSSE2.h"
 
 class PatternHandler;
 
@@ -185,6 +187,24 @@ typedef PixelFormat::agg_buffer		agg_buffer;
 	BLEND_COMPOSITE_SUBPIX(d, r, g, b, _a1, _a2, _a3); \
 }
 
+extern uint32 gSIMDFlags;
+
+// use_sse2_spans
+//
+// Returns whether the SSE2 span blenders should be used for a span of the
+// given length.
+static inline
+bool
+use_sse2_spans(unsigned len)
+{
+#if PAINTER_SSE2_SPANS
+	// the setup is not worth it for very short spans
+	return len >= 4 && (gSIMDFlags & APPSERVER_SIMD_SSE2) != 0;
+#else
+	return false;
+#endif
+}
+
 static inline
 uint8
 brightness_for(uint8 red, uint8 green, uint8 blue)
@@ -53,6 +53,12 @@ blend_hline_alpha_pc_solid(int x, int y, unsigned len,
 		return;
 
 	if (alpha == 255 * 255) {
+#if PAINTER_SSE2_SPANS
+		if (use_sse2_spans(len)) {
+			fill_span32_sse2(p, len, color.r, color.g, color.b);
+			return;
+		}
+#endif
 		do {
 			ASSIGN_ALPHA_PC(p, color.r, color.g, color.b);
 			p += 4;
@@ -73,6 +79,14 @@ blend_solid_hspan_alpha_pc_solid(int x, int y, unsigned len,
 						   agg_buffer* buffer, const PatternHandler*)
 {
 	uint8* p = buffer->row_ptr(y) + (x << 2);
+#if PAINTER_SSE2_SPANS
+	// With an opaque color, the alpha is just the cover
+	if (color.a == 255 && use_sse2_spans(len)) {
+		blend_solid_span32_sse2(p, len, color.r, color.g, color.b, covers,
+			true);
+		return;
+	}
+#endif
 	do {
 		uint16 alpha = color.a * *covers;
 		if (alpha) {
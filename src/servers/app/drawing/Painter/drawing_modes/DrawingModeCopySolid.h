@@ -30,6 +30,17 @@ blend_hline_copy_solid(int x, int y, unsigned len,
 					   const color_type& c, uint8 cover,
 					   agg_buffer* buffer, const PatternHandler* pattern)
 {
+#if PAINTER_SSE2_SPANS
+	if (use_sse2_spans(len)) {
+		uint8* p = buffer->row_ptr(y) + (x << 2);
+		if (cover == 255)
+			fill_span32_sse2(p, len, c.r, c.g, c.b);
+		else
+			blend_hline32_sse2(p, len, c.r, c.g, c.b, cover);
+		return;
+	}
+#endif
+
 	if (cover == 255) {
 		uint32 v;
 		uint8* p8 = (uint8*)&v;
@@ -61,6 +72,12 @@ blend_solid_hspan_copy_solid(int x, int y, unsigned len,
 							 const PatternHandler* pattern)
 {
 	uint8* p = buffer->row_ptr(y) + (x << 2);
+#if PAINTER_SSE2_SPANS
+	if (use_sse2_spans(len)) {
+		blend_solid_span32_sse2(p, len, c.r, c.g, c.b, covers, false);
+		return;
+	}
+#endif
 	do {
 		if (*covers) {
 			if (*covers == 255) {
@@ -26,6 +26,13 @@ blend_solid_hspan_over_solid_subpix(int x, int y, unsigned len,
 	const int subpixelL = gSubpixelOrderingRGB ? 2 : 0;
 	const int subpixelM = 1;
 	const int subpixelR = gSubpixelOrderingRGB ? 0 : 2;
+#if PAINTER_SSE2_SPANS
+	if (use_sse2_spans(len / 3)) {
+		blend_subpix_span32_sse2(p, len / 3, c.r, c.g, c.b, covers,
+			subpixelL, subpixelR);
+		return;
+	}
+#endif
 	do {
 		BLEND_OVER_SUBPIX(p, c.r, c.g, c.b,
 			covers[subpixelL], covers[subpixelM], covers[subpixelR]);
@@ -0,0 +1,220 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * SSE2 versions of the span blending loops shared by the solid drawing modes
+ * on B_RGBA32.
+ *
+ */
+
+#include "SpanBlendSSE2.h"
+
+#if PAINTER_SSE2_SPANS
+
+#include <string.h>
+
+#include <emmintrin.h>
+
+#include "DrawingMode.h"
+
+
+#define SSE2_FUNCTION __attribute__((target("sse2")))
+
+
+// make_pixel
+static inline uint32
+make_pixel(uint8 r, uint8 g, uint8 b)
+{
+	pixel32 p;
+	p.data8[0] = b;
+	p.data8[1] = g;
+	p.data8[2] = r;
+	p.data8[3] = 255;
+	return p.data32;
+}
+
+
+// blend_pixels
+//
+// Blends the color into the four pixels of dst, with alphaLow and alphaHigh
+// holding the 16 bit alpha value for each channel of the first and the last
+// two pixels. BLEND() computes ((s - d) * a + (d << 8)) >> 8, which is the
+// same as (s * a + d * (256 - a)) >> 8. Both products and their sum stay
+// below 65536, so this can be done on unsigned 16 bit values without losing
+// anything.
+static inline SSE2_FUNCTION __m128i
+blend_pixels(__m128i dst, __m128i color, __m128i alphaLow, __m128i alphaHigh)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i full = _mm_set1_epi16(256);
+
+	__m128i low = _mm_unpacklo_epi8(dst, zero);
+	__m128i high = _mm_unpackhi_epi8(dst, zero);
+
+	low = _mm_add_epi16(_mm_mullo_epi16(color, alphaLow),
+		_mm_mullo_epi16(low, _mm_sub_epi16(full, alphaLow)));
+	high = _mm_add_epi16(_mm_mullo_epi16(color, alphaHigh),
+		_mm_mullo_epi16(high, _mm_sub_epi16(full, alphaHigh)));
+
+	__m128i result = _mm_packus_epi16(_mm_srli_epi16(low, 8),
+		_mm_srli_epi16(high, 8));
+
+	// BLEND() always sets the alpha channel to 255
+	return _mm_or_si128(result, _mm_set1_epi32(0xff000000));
+}
+
+
+// select_pixels
+static inline SSE2_FUNCTION __m128i
+select_pixels(__m128i mask, __m128i a, __m128i b)
+{
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+
+// #pragma mark -
+
+
+// fill_span32_sse2
+SSE2_FUNCTION void
+fill_span32_sse2(uint8* p, unsigned len, uint8 r, uint8 g, uint8 b)
+{
+	uint32 pixel = make_pixel(r, g, b);
+	__m128i pixels = _mm_set1_epi32(pixel);
+
+	while (len >= 4) {
+		_mm_storeu_si128((__m128i*)p, pixels);
+		p += 16;
+		len -= 4;
+	}
+
+	uint32* p32 = (uint32*)p;
+	while (len-- > 0)
+		*p32++ = pixel;
+}
+
+
+// blend_solid_span32_sse2
+SSE2_FUNCTION void
+blend_solid_span32_sse2(uint8* p, unsigned len, uint8 r, uint8 g, uint8 b,
+	const uint8* covers, bool composite)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i opaque = _mm_set1_epi32(0xff000000);
+	const __m128i fullCover = _mm_set1_epi32(255);
+	const __m128i color = _mm_setr_epi16(b, g, r, 0, b, g, r, 0);
+	const __m128i colorPixels = _mm_set1_epi32(make_pixel(r, g, b));
+
+	while (len >= 4) {
+		uint32 coverBits;
+		memcpy(&coverBits, covers, sizeof(coverBits));
+
+		if (coverBits != 0) {
+			__m128i dst = _mm_loadu_si128((const __m128i*)p);
+
+			// Composing over pixels that are not fully opaque needs a
+			// division, leave those to the scalar code
+			if (composite && _mm_movemask_epi8(_mm_cmpeq_epi32(
+					_mm_and_si128(dst, opaque), opaque)) != 0xffff) {
+				uint8* d = p;
+				for (int i = 0; i < 4; i++, d += 4) {
+					if (covers[i] == 255) {
+						*(uint32*)d = make_pixel(r, g, b);
+					} else if (covers[i] != 0) {
+						BLEND_COMPOSITE(d, r, g, b, covers[i]);
+					}
+				}
+			} else {
+				__m128i cover16 = _mm_unpacklo_epi8(
+					_mm_cvtsi32_si128(coverBits), zero);
+				__m128i cover32 = _mm_unpacklo_epi16(cover16, zero);
+				cover16 = _mm_unpacklo_epi16(cover16, cover16);
+
+				__m128i result = blend_pixels(dst, color,
+					_mm_unpacklo_epi32(cover16, cover16),
+					_mm_unpackhi_epi32(cover16, cover16));
+
+				result = select_pixels(_mm_cmpeq_epi32(cover32, fullCover),
+					colorPixels, result);
+				result = select_pixels(_mm_cmpeq_epi32(cover32, zero), dst,
+					result);
+
+				_mm_storeu_si128((__m128i*)p, result);
+			}
+		}
+
+		covers += 4;
+		p += 16;
+		len -= 4;
+	}
+
+	for (; len > 0; len--, covers++, p += 4) {
+		if (*covers == 255) {
+			*(uint32*)p = make_pixel(r, g, b);
+		} else if (*covers != 0) {
+			if (composite) {
+				BLEND_COMPOSITE(p, r, g, b, *covers);
+			} else {
+				BLEND(p, r, g, b, *covers);
+			}
+		}
+	}
+}
+
+
+// blend_hline32_sse2
+SSE2_FUNCTION void
+blend_hline32_sse2(uint8* p, unsigned len, uint8 r, uint8 g, uint8 b,
+	uint8 cover)
+{
+	const __m128i color = _mm_setr_epi16(b, g, r, 0, b, g, r, 0);
+	const __m128i alpha = _mm_set1_epi16(cover);
+
+	while (len >= 4) {
+		__m128i dst = _mm_loadu_si128((const __m128i*)p);
+		_mm_storeu_si128((__m128i*)p, blend_pixels(dst, color, alpha, alpha));
+		p += 16;
+		len -= 4;
+	}
+
+	for (; len > 0; len--, p += 4)
+		BLEND(p, r, g, b, cover);
+}
+
+
+// blend_subpix_span32_sse2
+SSE2_FUNCTION void
+blend_subpix_span32_sse2(uint8* p, unsigned len, uint8 r, uint8 g, uint8 b,
+	const uint8* covers, int subpixelL, int subpixelR)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i color = _mm_setr_epi16(b, g, r, 0, b, g, r, 0);
+
+	while (len >= 4) {
+		// rearrange the three covers of each pixel into channel order
+		uint8 alphas[16];
+		for (int i = 0; i < 4; i++) {
+			alphas[i * 4 + 0] = covers[subpixelL];
+			alphas[i * 4 + 1] = covers[1];
+			alphas[i * 4 + 2] = covers[subpixelR];
+			alphas[i * 4 + 3] = 0;
+			covers += 3;
+		}
+
+		__m128i alpha = _mm_loadu_si128((const __m128i*)alphas);
+		__m128i dst = _mm_loadu_si128((const __m128i*)p);
+		_mm_storeu_si128((__m128i*)p, blend_pixels(dst, color,
+			_mm_unpacklo_epi8(alpha, zero), _mm_unpackhi_epi8(alpha, zero)));
+
+		p += 16;
+		len -= 4;
+	}
+
+	for (; len > 0; len--, covers += 3, p += 4) {
+		BLEND_SUBPIX(p, r, g, b, covers[subpixelL], covers[1],
+			covers[subpixelR]);
+	}
+}
+
+
+#endif	// PAINTER_SSE2_SPANS
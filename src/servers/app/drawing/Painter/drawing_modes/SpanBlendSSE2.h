@@ -0,0 +1,46 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * SSE2 versions of the span blending loops shared by the solid drawing modes
+ * on B_RGBA32. They produce exactly the same results as the BLEND and
+ * BLEND_SUBPIX macros in DrawingMode.h.
+ *
+ */
+
+#ifndef SPAN_BLEND_SSE2_H
+#define SPAN_BLEND_SSE2_H
+
+#include <SupportDefs.h>
+
+
+#if (defined(__i386__) || defined(__x86_64__)) && __GNUC__ >= 5
+#	define PAINTER_SSE2_SPANS 1
+#endif
+
+
+#if PAINTER_SSE2_SPANS
+
+// Sets len pixels to the given color, with alpha set to 255.
+void fill_span32_sse2(uint8* p, unsigned len, uint8 r, uint8 g, uint8 b);
+
+// Blends the color into len pixels using one cover value per pixel. Pixels
+// with a cover of 0 are left untouched, a cover of 255 assigns the color.
+// If composite is true, pixels that are not fully opaque are composed like
+// BLEND_COMPOSITE does.
+void blend_solid_span32_sse2(uint8* p, unsigned len, uint8 r, uint8 g,
+	uint8 b, const uint8* covers, bool composite);
+
+// Blends the color into len pixels using the same cover for all of them.
+void blend_hline32_sse2(uint8* p, unsigned len, uint8 r, uint8 g, uint8 b,
+	uint8 cover);
+
+// Blends the color into len pixels using three cover values per pixel, one
+// for each sub-pixel, as BLEND_SUBPIX does.
+void blend_subpix_span32_sse2(uint8* p, unsigned len, uint8 r, uint8 g,
+	uint8 b, const uint8* covers, int subpixelL, int subpixelR);
+
+#endif	// PAINTER_SSE2_SPANS
+
+
+#endif	// SPAN_BLEND_SSE2_H
@@ -0,0 +1,237 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include "BatchCompression.h"
+
+#include "RemoteMessage.h"
+#include "StreamingRingBuffer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+static const size_t kHeaderSize = sizeof(uint16) + sizeof(uint32);
+static const size_t kBatchHeaderSize = sizeof(uint8) + sizeof(uint32);
+	// compression method and unpacked length
+
+
+BatchCompressor::BatchCompressor()
+	:
+	fParameters(B_ZSTD_COMPRESSION_FASTEST),
+	fBuffer(NULL),
+	fBytesIn(0),
+	fBytesOut(0)
+{
+	fBuffer = (uint8*)malloc(kHeaderSize + kBatchHeaderSize + kMaxBatchSize);
+}
+
+
+BatchCompressor::~BatchCompressor()
+{
+	free(fBuffer);
+}
+
+
+status_t
+BatchCompressor::InitCheck()
+{
+	return fBuffer != NULL ? B_OK : B_NO_MEMORY;
+}
+
+
+/*!	Packs up to kMaxBatchSize bytes of \a data into a batch message. The
+	returned batch stays valid until the next call. Data that doesn't
+	compress is stored as is, so the batch is never more than a few bytes
+	larger than the input.
+*/
+status_t
+BatchCompressor::Compress(const void* data, size_t length,
+	const void*& _batch, size_t& _batchLength)
+{
+	if (fBuffer == NULL)
+		return B_NO_INIT;
+	if (length == 0 || length > kMaxBatchSize)
+		return B_BAD_VALUE;
+
+	uint8* payload = fBuffer + kHeaderSize + kBatchHeaderSize;
+	uint8 method = RP_BATCH_ZSTD;
+	size_t payloadLength;
+	if (fAlgorithm.CompressBuffer(data, length, payload, length - 1,
+			payloadLength, &fParameters) != B_OK) {
+		// incompressible, or no zstd support in this build
+		method = RP_BATCH_STORED;
+		payloadLength = length;
+		memcpy(payload, data, length);
+	}
+
+	uint16 code = RP_COMPRESSED_BATCH;
+	uint32 messageLength = kHeaderSize + kBatchHeaderSize + payloadLength;
+	uint32 unpackedLength = length;
+
+	memcpy(fBuffer, &code, sizeof(code));
+	memcpy(fBuffer + sizeof(code), &messageLength, sizeof(messageLength));
+	fBuffer[kHeaderSize] = method;
+	memcpy(fBuffer + kHeaderSize + 1, &unpackedLength,
+		sizeof(unpackedLength));
+
+	fBytesIn += length;
+	fBytesOut += messageLength;
+
+	_batch = fBuffer;
+	_batchLength = messageLength;
+	return B_OK;
+}
+
+
+/*static*/ bool
+BatchCompressor::IsSupported()
+{
+	BZstdCompressionAlgorithm algorithm;
+	uint8 input[64] = { 0 };
+	uint8 output[128];
+	size_t outputLength;
+	return algorithm.CompressBuffer(input, sizeof(input), output,
+		sizeof(output), outputLength) == B_OK;
+}
+
+
+// #pragma mark -
+
+
+BatchDecompressor::BatchDecompressor(StreamingRingBuffer* target)
+	:
+	fTarget(target),
+	fHeaderLength(0),
+	fMessageLeft(0),
+	fInBatch(false),
+	fBatch(NULL),
+	fBatchLength(0),
+	fOutput(NULL)
+{
+	fBatch = (uint8*)malloc(kBatchHeaderSize + kMaxBatchSize);
+	fOutput = (uint8*)malloc(kMaxBatchSize);
+}
+
+
+BatchDecompressor::~BatchDecompressor()
+{
+	free(fBatch);
+	free(fOutput);
+}
+
+
+status_t
+BatchDecompressor::InitCheck()
+{
+	return fBatch != NULL && fOutput != NULL ? B_OK : B_NO_MEMORY;
+}
+
+
+status_t
+BatchDecompressor::Write(const void* _data, size_t length)
+{
+	const uint8* data = (const uint8*)_data;
+
+	while (length > 0) {
+		if (fMessageLeft == 0) {
+			// collect the header of the next message
+			size_t copyLength = min_c(length, kHeaderSize - fHeaderLength);
+			memcpy(fHeader + fHeaderLength, data, copyLength);
+			fHeaderLength += copyLength;
+			data += copyLength;
+			length -= copyLength;
+
+			if (fHeaderLength < kHeaderSize)
+				break;
+
+			fHeaderLength = 0;
+
+			uint16 code;
+			uint32 messageLength;
+			memcpy(&code, fHeader, sizeof(code));
+			memcpy(&messageLength, fHeader + sizeof(code),
+				sizeof(messageLength));
+			if (messageLength < kHeaderSize)
+				return B_BAD_DATA;
+
+			fMessageLeft = messageLength - kHeaderSize;
+			fInBatch = code == RP_COMPRESSED_BATCH;
+			if (fInBatch) {
+				if (fMessageLeft <= kBatchHeaderSize
+					|| fMessageLeft > kBatchHeaderSize + kMaxBatchSize) {
+					return B_BAD_DATA;
+				}
+
+				fBatchLength = 0;
+				continue;
+			}
+
+			status_t result = fTarget->Write(fHeader, kHeaderSize);
+			if (result != B_OK)
+				return result;
+
+			continue;
+		}
+
+		size_t copyLength = min_c(length, fMessageLeft);
+		if (fInBatch) {
+			memcpy(fBatch + fBatchLength, data, copyLength);
+			fBatchLength += copyLength;
+		} else {
+			status_t result = fTarget->Write(data, copyLength);
+			if (result != B_OK)
+				return result;
+		}
+
+		data += copyLength;
+		length -= copyLength;
+		fMessageLeft -= copyLength;
+
+		if (fInBatch && fMessageLeft == 0) {
+			status_t result = _Unpack();
+			if (result != B_OK)
+				return result;
+		}
+	}
+
+	return B_OK;
+}
+
+
+status_t
+BatchDecompressor::_Unpack()
+{
+	uint8 method = fBatch[0];
+	uint32 unpackedLength;
+	memcpy(&unpackedLength, fBatch + 1, sizeof(unpackedLength));
+	if (unpackedLength > kMaxBatchSize)
+		return B_BAD_DATA;
+
+	const uint8* payload = fBatch + kBatchHeaderSize;
+	size_t payloadLength = fBatchLength - kBatchHeaderSize;
+
+	switch (method) {
+		case RP_BATCH_STORED:
+			if (payloadLength != unpackedLength)
+				return B_BAD_DATA;
+
+			return fTarget->Write(payload, payloadLength);
+
+		case RP_BATCH_ZSTD:
+		{
+			size_t outputLength;
+			status_t result = fAlgorithm.DecompressBuffer(payload,
+				payloadLength, fOutput, kMaxBatchSize, outputLength);
+			if (result != B_OK)
+				return result;
+			if (outputLength != unpackedLength)
+				return B_BAD_DATA;
+
+			return fTarget->Write(fOutput, outputLength);
+		}
+	}
+
+	return B_BAD_DATA;
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef BATCH_COMPRESSION_H
+#define BATCH_COMPRESSION_H
+
+#include <SupportDefs.h>
+#include <ZstdCompressionAlgorithm.h>
+
+class StreamingRingBuffer;
+
+
+enum {
+	RP_BATCH_STORED = 0,
+	RP_BATCH_ZSTD
+};
+
+
+// the largest amount of message stream data put into one batch
+static const size_t kMaxBatchSize = 64 * 1024;
+
+
+/*!	Packs chunks of the message stream into RP_COMPRESSED_BATCH messages.
+	The chunks don't need to start or end at message boundaries, the
+	receiving side just appends the unpacked data to its stream.
+*/
+class BatchCompressor {
+public:
+								BatchCompressor();
+								~BatchCompressor();
+
+		status_t				InitCheck();
+
+		status_t				Compress(const void* data, size_t length,
+									const void*& _batch, size_t& _batchLength);
+
+		uint64					BytesIn() const { return fBytesIn; }
+		uint64					BytesOut() const { return fBytesOut; }
+
+static	bool					IsSupported();
+
+private:
+		BZstdCompressionAlgorithm fAlgorithm;
+		BZstdCompressionParameters fParameters;
+
+		uint8*					fBuffer;
+		uint64					fBytesIn;
+		uint64					fBytesOut;
+};
+
+
+/*!	Forwards a message stream to a ring buffer, unpacking any
+	RP_COMPRESSED_BATCH messages on the way.
+*/
+class BatchDecompressor {
+public:
+								BatchDecompressor(StreamingRingBuffer* target);
+								~BatchDecompressor();
+
+		status_t				InitCheck();
+
+		status_t				Write(const void* data, size_t length);
+
+private:
+		status_t				_Unpack();
+
+		StreamingRingBuffer*	fTarget;
+		BZstdCompressionAlgorithm fAlgorithm;
+
+		uint8					fHeader[sizeof(uint16) + sizeof(uint32)];
+		size_t					fHeaderLength;
+		uint32					fMessageLeft;
+
+		bool					fInBatch;
+		uint8*					fBatch;
+		size_t					fBatchLength;
+		uint8*					fOutput;
+};
+
+#endif // BATCH_COMPRESSION_H
@@ -9,10 +9,12 @@
 #include "NetReceiver.h"
 #include "RemoteMessage.h"
 
+#include "BatchCompression.h"
 #include "StreamingRingBuffer.h"
 
 #include <NetEndpoint.h>
 
+#include <new>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -22,16 +24,28 @@
 
 
 NetReceiver::NetReceiver(BNetEndpoint *listener, StreamingRingBuffer *target,
-	NewConnectionCallback newConnectionCallback, void *newConnectionCookie)
+	NewConnectionCallback newConnectionCallback, void *newConnectionCookie,
+	bool decompress)
 	:
 	fListener(listener),
 	fTarget(target),
+	fDecompressor(NULL),
 	fReceiverThread(-1),
 	fStopThread(false),
 	fNewConnectionCallback(newConnectionCallback),
 	fNewConnectionCookie(newConnectionCookie),
 	fEndpoint(newConnectionCallback == NULL ? listener : NULL)
 {
+	if (decompress) {
+		// the stream has to be followed from its very start, as the batches
+		// are only recognized at message boundaries
+		fDecompressor = new(std::nothrow) BatchDecompressor(fTarget);
+		if (fDecompressor != NULL && fDecompressor->InitCheck() != B_OK) {
+			delete fDecompressor;
+			fDecompressor = NULL;
+		}
+	}
+
 	fReceiverThread = spawn_thread(_NetworkReceiverEntry, "network receiver",
 		B_NORMAL_PRIORITY, this);
 	resume_thread(fReceiverThread);
@@ -45,6 +59,8 @@ NetReceiver::~NetReceiver()
 
 	suspend_thread(fReceiverThread);
 	resume_thread(fReceiverThread);
+
+	delete fDecompressor;
 }
 
 
@@ -124,7 +140,11 @@ NetReceiver::_Transfer()
 		}
 
 		errorCount = 0;
-		status_t result = fTarget->Write(buffer, readSize);
+		status_t result;
+		if (fDecompressor != NULL)
+			result = fDecompressor->Write(buffer, readSize);
+		else
+			result = fTarget->Write(buffer, readSize);
 		if (result != B_OK) {
 			TRACE_ERROR("writing to ring buffer failed: %s\n",
 				strerror(result));
@@ -11,6 +11,7 @@
 #include <OS.h>
 #include <SupportDefs.h>
 
+class BatchDecompressor;
 class BNetEndpoint;
 class StreamingRingBuffer;
 
@@ -22,10 +23,13 @@ public:
 								NetReceiver(BNetEndpoint *endpoint,
 									StreamingRingBuffer *target,
 									NewConnectionCallback callback = NULL,
-									void *newConnectionCookie = NULL);
+									void *newConnectionCookie = NULL,
+									bool decompress = false);
 								~NetReceiver();
 
 		BNetEndpoint *			Endpoint() { return fEndpoint; }
+		bool					IsDecompressing() const
+									{ return fDecompressor != NULL; }
 
 private:
 static	int32					_NetworkReceiverEntry(void *data);
@@ -34,6 +38,7 @@ static	int32					_NetworkReceiverEntry(void *data);
 
 		BNetEndpoint *			fListener;
 		StreamingRingBuffer *	fTarget;
+		BatchDecompressor *		fDecompressor;
 
 		thread_id				fReceiverThread;
 		bool					fStopThread;
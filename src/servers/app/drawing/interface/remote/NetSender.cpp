@@ -8,10 +8,13 @@
 
 #include "NetSender.h"
 
+#include "BatchCompression.h"
 #include "StreamingRingBuffer.h"
 
+#include <AutoDeleter.h>
 #include <NetEndpoint.h>
 
+#include <new>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -25,7 +28,11 @@ NetSender::NetSender(BNetEndpoint *endpoint, StreamingRingBuffer *source)
 	fEndpoint(endpoint),
 	fSource(source),
 	fSenderThread(-1),
-	fStopThread(false)
+	fStopThread(false),
+	fCompressionRequested(false),
+	fCompressing(false),
+	fHeaderLength(0),
+	fMessageLeft(0)
 {
 	fSenderThread = spawn_thread(_NetworkSenderEntry, "network sender",
 		B_NORMAL_PRIORITY, this);
@@ -42,6 +49,18 @@ NetSender::~NetSender()
 }
 
 
+/*!	Starts sending the stream as RP_COMPRESSED_BATCH messages. The switch
+	happens at the next message boundary, so that the receiver, which only
+	looks at the outer messages, never sees a batch start in the middle of
+	a plain message.
+*/
+void
+NetSender::EnableCompression()
+{
+	fCompressionRequested = true;
+}
+
+
 int32
 NetSender::_NetworkSenderEntry(void *data)
 {
@@ -52,25 +71,131 @@ NetSender::_NetworkSenderEntry(void *data)
 status_t
 NetSender::_NetworkSender()
 {
+	uint8 *buffer = (uint8 *)malloc(kMaxBatchSize);
+	if (buffer == NULL)
+		return B_NO_MEMORY;
+
+	MemoryDeleter bufferDeleter(buffer);
+	ObjectDeleter<BatchCompressor> compressor;
+
 	while (!fStopThread) {
-		uint8 buffer[4096];
-		int32 readSize = fSource->Read(buffer, sizeof(buffer), true);
+		int32 readSize = fSource->Read(buffer, kMaxBatchSize, true);
 		if (readSize < 0) {
 			TRACE_ERROR("read failed, stopping sender thread: %s\n",
 				strerror(readSize));
 			return readSize;
 		}
 
-		while (readSize > 0) {
-			int32 sendSize = fEndpoint->Send(buffer, readSize);
-			if (sendSize < 0) {
-				TRACE_ERROR("sending data failed: %s\n", strerror(sendSize));
-				return sendSize;
+		uint8 *data = buffer;
+		size_t length = readSize;
+
+		if (!fCompressing) {
+			size_t plainLength = _ScanMessages(data, length);
+			status_t result = _Send(data, plainLength);
+			if (result != B_OK)
+				return result;
+
+			data += plainLength;
+			length -= plainLength;
+
+			if (fCompressing && compressor.Get() == NULL) {
+				compressor.SetTo(new(std::nothrow) BatchCompressor());
+				if (compressor.Get() == NULL
+					|| compressor->InitCheck() != B_OK) {
+					// the stream is still valid without compression
+					TRACE_ERROR("failed to set up compression\n");
+					compressor.Unset();
+					fCompressing = false;
+					fCompressionRequested = false;
+					_ScanMessages(data, length);
+				}
+			}
+
+			if (!fCompressing) {
+				result = _Send(data, length);
+				if (result != B_OK)
+					return result;
+				continue;
 			}
+		}
+
+		if (length == 0)
+			continue;
+
+		const void *batch;
+		size_t batchLength;
+		status_t result = compressor->Compress(data, length, batch,
+			batchLength);
+		if (result == B_OK)
+			result = _Send(batch, batchLength);
+		if (result != B_OK) {
+			TRACE_ERROR("sending batch failed: %s\n", strerror(result));
+			return result;
+		}
+	}
+
+	return B_OK;
+}
 
-			readSize -= sendSize;
+
+/*!	Follows the message boundaries of the plain stream. Returns how much of
+	\a data can still be sent as is, which is all of it unless compression
+	was requested and a message ends within \a data.
+*/
+size_t
+NetSender::_ScanMessages(const uint8 *data, size_t length)
+{
+	static const size_t kHeaderSize = sizeof(fHeader);
+
+	size_t position = 0;
+	while (true) {
+		if (fMessageLeft == 0 && fHeaderLength == 0
+			&& fCompressionRequested) {
+			fCompressing = true;
+			return position;
+		}
+
+		if (position == length)
+			return position;
+
+		if (fMessageLeft > 0) {
+			size_t skipLength = min_c(fMessageLeft, length - position);
+			fMessageLeft -= skipLength;
+			position += skipLength;
+			continue;
+		}
+
+		size_t copyLength = min_c(kHeaderSize - fHeaderLength,
+			length - position);
+		memcpy(fHeader + fHeaderLength, data + position, copyLength);
+		fHeaderLength += copyLength;
+		position += copyLength;
+
+		if (fHeaderLength == kHeaderSize) {
+			uint32 messageLength;
+			memcpy(&messageLength, fHeader + sizeof(uint16),
+				sizeof(messageLength));
+			fMessageLeft = messageLength > kHeaderSize
+				? messageLength - kHeaderSize : 0;
+			fHeaderLength = 0;
 		}
 	}
+}
+
+
+status_t
+NetSender::_Send(const void *data, size_t length)
+{
+	while (length > 0) {
+		int32 sendSize = fEndpoint->Send(data, length);
+		if (sendSize < 0) {
+			TRACE_ERROR("sending data failed: %s\n", strerror(sendSize));
+			return sendSize;
+		}
+
+		data = (const uint8 *)data + sendSize;
+		length -= sendSize;
+	}
 
 	return B_OK;
 }
@@ -20,15 +20,27 @@ public:
 									StreamingRingBuffer *source);
 								~NetSender();
 
+		void					EnableCompression();
+
 private:
 static	int32					_NetworkSenderEntry(void *data);
 		status_t				_NetworkSender();
 
+		size_t					_ScanMessages(const uint8 *data,
+									size_t length);
+		status_t				_Send(const void *data, size_t length);
+
 		BNetEndpoint *			fEndpoint;
 		StreamingRingBuffer *	fSource;
 
 		thread_id				fSenderThread;
 		bool					fStopThread;
+
+		bool					fCompressionRequested;
+		bool					fCompressing;
+		uint8					fHeader[6];
+		size_t					fHeaderLength;
+		uint32					fMessageLeft;
 };
 
 #endif // NET_SENDER_H
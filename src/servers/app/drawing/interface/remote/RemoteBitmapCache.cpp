@@ -0,0 +1,216 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include "RemoteBitmapCache.h"
+
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+
+
+struct RemoteBitmapCache::EntryHashDefinition {
+	typedef remote_bitmap_key	KeyType;
+	typedef	cache_entry			ValueType;
+
+	size_t HashKey(const remote_bitmap_key& key) const
+	{
+		return (size_t)(key.hash ^ (key.hash >> 32));
+	}
+
+	size_t Hash(cache_entry* value) const
+	{
+		return HashKey(value->key);
+	}
+
+	bool Compare(const remote_bitmap_key& key, cache_entry* value) const
+	{
+		return value->key == key;
+	}
+
+	cache_entry*& GetLink(cache_entry* value) const
+	{
+		return value->hash_link;
+	}
+};
+
+
+static inline uint64
+mix(uint64 value)
+{
+	value ^= value >> 33;
+	value *= 0xff51afd7ed558ccdULL;
+	value ^= value >> 33;
+	value *= 0xc4ceb9fe1a85ec53ULL;
+	value ^= value >> 33;
+	return value;
+}
+
+
+RemoteBitmapCache::RemoteBitmapCache()
+	:
+	fLock("remote bitmap cache"),
+	fTable(NULL),
+	fFreeSlots(NULL),
+	fEvicted(NULL),
+	fFreeSlotCount(0),
+	fEvictedCount(0),
+	fMaxMemory(0),
+	fUsedMemory(0),
+	fHits(0),
+	fMisses(0),
+	fBytesSaved(0)
+{
+}
+
+
+RemoteBitmapCache::~RemoteBitmapCache()
+{
+	Unset();
+}
+
+
+/*!	Enables the cache with the limits the client agreed to. Any previous
+	contents are dropped, the client is expected to start out with an empty
+	cache as well.
+*/
+status_t
+RemoteBitmapCache::SetTo(size_t maxMemory, uint32 slotCount)
+{
+	Unset();
+
+	if (maxMemory == 0 || slotCount == 0)
+		return B_BAD_VALUE;
+
+	fTable = new(std::nothrow) EntryTable;
+	fFreeSlots = (uint32*)malloc(slotCount * sizeof(uint32));
+	fEvicted = (uint32*)malloc(slotCount * sizeof(uint32));
+	if (fTable == NULL || fFreeSlots == NULL || fEvicted == NULL
+		|| fTable->Init() != B_OK) {
+		Unset();
+		return B_NO_MEMORY;
+	}
+
+	// hand out the low slots first
+	for (uint32 i = 0; i < slotCount; i++)
+		fFreeSlots[i] = slotCount - i - 1;
+
+	fFreeSlotCount = slotCount;
+	fMaxMemory = maxMemory;
+	return B_OK;
+}
+
+
+void
+RemoteBitmapCache::Unset()
+{
+	if (fTable != NULL)
+		fTable->Clear();
+
+	while (cache_entry* entry = fEntries.RemoveHead())
+		delete entry;
+
+	delete fTable;
+	free(fFreeSlots);
+	free(fEvicted);
+
+	fTable = NULL;
+	fFreeSlots = NULL;
+	fEvicted = NULL;
+	fFreeSlotCount = 0;
+	fEvictedCount = 0;
+	fMaxMemory = 0;
+	fUsedMemory = 0;
+}
+
+
+/*!	Looks up the bitmap described by \a key. Returns \c false if the bitmap
+	can't be cached and has to be sent inline. Otherwise \a slot is set to
+	the slot holding the bitmap on the client, and \a store tells whether
+	the bitmap still needs to be sent to be put there. Slots that had to be
+	freed up to make room are available through EvictedAt() until the next
+	call, the client has to be told to drop them before the store.
+*/
+bool
+RemoteBitmapCache::Get(const remote_bitmap_key& key, uint32& slot,
+	bool& store)
+{
+	fEvictedCount = 0;
+
+	if (!IsEnabled() || key.length > fMaxMemory / 4)
+		return false;
+
+	cache_entry* entry = fTable->Lookup(key);
+	if (entry != NULL) {
+		fEntries.Remove(entry);
+		fEntries.Add(entry);
+
+		fHits++;
+		fBytesSaved += key.length;
+
+		slot = entry->slot;
+		store = false;
+		return true;
+	}
+
+	fMisses++;
+
+	entry = new(std::nothrow) cache_entry;
+	if (entry == NULL)
+		return false;
+
+	while (fFreeSlotCount == 0 || fUsedMemory + key.length > fMaxMemory) {
+		cache_entry* oldest = fEntries.Head();
+		if (oldest == NULL)
+			break;
+
+		fEvicted[fEvictedCount++] = oldest->slot;
+		_Evict(oldest);
+	}
+
+	entry->key = key;
+	entry->slot = fFreeSlots[--fFreeSlotCount];
+	fTable->Insert(entry);
+	fEntries.Add(entry);
+	fUsedMemory += key.length;
+
+	slot = entry->slot;
+	store = true;
+	return true;
+}
+
+
+/*!	Hashes the bitmap contents. This is not meant to be cryptographically
+	strong, together with the dimensions and the color space in the key it
+	only has to tell apart the bitmaps a session draws.
+*/
+/*static*/ uint64
+RemoteBitmapCache::HashBits(const void* bits, size_t length)
+{
+	const uint8* data = (const uint8*)bits;
+	uint64 hash = length * 0x9e3779b97f4a7c15ULL;
+
+	while (length >= sizeof(uint64)) {
+		uint64 value;
+		memcpy(&value, data, sizeof(value));
+		hash = (hash ^ mix(value)) * 0x9e3779b97f4a7c15ULL;
+		data += sizeof(uint64);
+		length -= sizeof(uint64);
+	}
+
+	uint64 value = 0;
+	memcpy(&value, data, length);
+	return mix(hash ^ value);
+}
+
+
+void
+RemoteBitmapCache::_Evict(cache_entry* entry)
+{
+	fTable->Remove(entry);
+	fEntries.Remove(entry);
+	fFreeSlots[fFreeSlotCount++] = entry->slot;
+	fUsedMemory -= entry->key.length;
+	delete entry;
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef REMOTE_BITMAP_CACHE_H
+#define REMOTE_BITMAP_CACHE_H
+
+#include <Locker.h>
+#include <SupportDefs.h>
+
+#include <util/DoublyLinkedList.h>
+#include <util/OpenHashTable.h>
+
+
+static const uint32 kRemoteBitmapNotCached = 0xffffffff;
+
+
+struct remote_bitmap_key {
+	uint64		hash;
+	int32		width;
+	int32		height;
+	int32		bytes_per_row;
+	uint32		color_space;
+	uint32		flags;
+	uint32		length;
+
+	bool operator==(const remote_bitmap_key& other) const
+	{
+		return hash == other.hash && width == other.width
+			&& height == other.height && bytes_per_row == other.bytes_per_row
+			&& color_space == other.color_space && flags == other.flags
+			&& length == other.length;
+	}
+};
+
+
+/*!	Mirrors the contents of the bitmap cache of a remote client.
+
+	The client stores bitmaps in numbered slots, the server decides which
+	bitmap goes into which slot and when it is dropped again. Since the
+	server only keeps the keys, it knows exactly which bitmaps the client
+	has without having to hold on to the bitmaps itself. The cache needs to
+	stay locked from looking up a bitmap until the message using the slot
+	has been written to the send buffer, so that the client sees stores,
+	evictions and uses in the same order as they were decided.
+*/
+class RemoteBitmapCache {
+public:
+								RemoteBitmapCache();
+								~RemoteBitmapCache();
+
+		bool					Lock() { return fLock.Lock(); }
+		void					Unlock() { fLock.Unlock(); }
+
+		status_t				SetTo(size_t maxMemory, uint32 slotCount);
+		void					Unset();
+		bool					IsEnabled() const
+									{ return fTable != NULL; }
+
+		bool					Get(const remote_bitmap_key& key,
+									uint32& slot, bool& store);
+		int32					CountEvicted() const
+									{ return fEvictedCount; }
+		uint32					EvictedAt(int32 index) const
+									{ return fEvicted[index]; }
+
+		uint64					Hits() const { return fHits; }
+		uint64					Misses() const { return fMisses; }
+		uint64					BytesSaved() const { return fBytesSaved; }
+
+static	uint64					HashBits(const void* bits, size_t length);
+
+private:
+		struct cache_entry : DoublyLinkedListLinkImpl<cache_entry> {
+			remote_bitmap_key	key;
+			uint32				slot;
+			cache_entry*		hash_link;
+		};
+
+		struct EntryHashDefinition;
+		typedef BOpenHashTable<EntryHashDefinition> EntryTable;
+		typedef DoublyLinkedList<cache_entry> EntryList;
+
+		void					_Evict(cache_entry* entry);
+
+		BLocker					fLock;
+
+		EntryTable*				fTable;
+		EntryList				fEntries;
+			// least recently used first
+		uint32*					fFreeSlots;
+		uint32*					fEvicted;
+		uint32					fFreeSlotCount;
+		int32					fEvictedCount;
+
+		size_t					fMaxMemory;
+		size_t					fUsedMemory;
+
+		uint64					fHits;
+		uint64					fMisses;
+		uint64					fBytesSaved;
+};
+
+#endif // REMOTE_BITMAP_CACHE_H
@@ -11,7 +11,9 @@
 
 #include "BitmapDrawingEngine.h"
 #include "DrawState.h"
+#include "RemoteBitmapCache.h"
 #include "ServerTokenSpace.h"
+#include "StreamingRingBuffer.h"
 
 #include <Bitmap.h>
 #include <utf8_functions.h>
@@ -34,7 +36,10 @@ RemoteDrawingEngine::RemoteDrawingEngine(RemoteHWInterface* interface)
 	fResultNotify(-1),
 	fStringWidthResult(0.0f),
 	fReadBitmapResult(NULL),
-	fBitmapDrawingEngine(NULL)
+	fBitmapDrawingEngine(NULL),
+	fLastFillValid(false),
+	fLastFillCode(0),
+	fLastFillWriteCount(0)
 {
 	RemoteMessage message(NULL, fHWInterface->SendBuffer());
 	message.Start(RP_CREATE_STATE);
@@ -364,8 +369,11 @@ RemoteDrawingEngine::DrawBitmap(ServerBitmap* bitmap, const BRect& _bitmapRect,
 			return;
 		}
 
+		RemoteBitmapCache* cache = _LockBitmapCache();
+
 		RemoteMessage message(NULL, fHWInterface->SendBuffer());
-		message.Start(RP_DRAW_BITMAP_RECTS);
+		message.Start(cache != NULL
+			? RP_DRAW_CACHED_BITMAP_RECTS : RP_DRAW_BITMAP_RECTS);
 		message.Add(fToken);
 		message.Add(options);
 		message.Add(bitmap->ColorSpace());
@@ -374,22 +382,36 @@ RemoteDrawingEngine::DrawBitmap(ServerBitmap* bitmap, const BRect& _bitmapRect,
 
 		for (int32 i = 0; i < rectCount; i++) {
 			message.Add(clippedRegion.RectAt(i));
-			message.AddBitmap(*bitmaps[i], true);
+			if (cache != NULL)
+				message.AddCachedBitmap(*bitmaps[i], *cache, true);
+			else
+				message.AddBitmap(*bitmaps[i], true);
 			delete bitmaps[i];
 		}
 
 		free(bitmaps);
+
+		if (cache != NULL) {
+			message.Flush();
+			cache->Unlock();
+		}
 		return;
 	}
 
-	// TODO: we may want to cache/checksum bitmaps
+	RemoteBitmapCache* cache = _LockBitmapCache();
+
 	RemoteMessage message(NULL, fHWInterface->SendBuffer());
-	message.Start(RP_DRAW_BITMAP);
+	message.Start(cache != NULL ? RP_DRAW_CACHED_BITMAP : RP_DRAW_BITMAP);
 	message.Add(fToken);
 	message.Add(bitmapRect);
 	message.Add(viewRect);
 	message.Add(options);
-	message.AddBitmap(*bitmap);
+	if (cache != NULL) {
+		message.AddCachedBitmap(*bitmap, *cache);
+		message.Flush();
+		cache->Unlock();
+	} else
+		message.AddBitmap(*bitmap);
 }
 
 
@@ -594,11 +616,18 @@ RemoteDrawingEngine::FillRect(BRect rect, const rgb_color& color)
 	if (!fClippingRegion.Intersects(rect))
 		return;
 
+	if (_IsRedundantFill(RP_FILL_RECT_COLOR, rect, color))
+		return;
+
+	int32 writeCount = fHWInterface->SendBuffer()->WriteCount();
+
 	RemoteMessage message(NULL, fHWInterface->SendBuffer());
 	message.Start(RP_FILL_RECT_COLOR);
 	message.Add(fToken);
 	message.Add(rect);
 	message.Add(color);
+	if (message.Flush() == B_OK)
+		_SetLastFill(RP_FILL_RECT_COLOR, rect, color, writeCount);
 }
 
 
@@ -637,10 +666,17 @@ RemoteDrawingEngine::FillRect(BRect rect)
 	if (!fClippingRegion.Intersects(rect))
 		return;
 
+	if (_IsRedundantFill(RP_FILL_RECT, rect, fState.HighColor()))
+		return;
+
+	int32 writeCount = fHWInterface->SendBuffer()->WriteCount();
+
 	RemoteMessage message(NULL, fHWInterface->SendBuffer());
 	message.Start(RP_FILL_RECT);
 	message.Add(fToken);
 	message.Add(rect);
+	if (message.Flush() == B_OK)
+		_SetLastFill(RP_FILL_RECT, rect, fState.HighColor(), writeCount);
 }
 
 
@@ -1056,6 +1092,81 @@ RemoteDrawingEngine::_DrawingEngineResult(void* cookie, RemoteMessage& message)
 }
 
 
+/*!	Returns the bitmap cache locked if the client has one, \c NULL
+	otherwise. The cache has to stay locked until the message using it has
+	been flushed.
+*/
+RemoteBitmapCache*
+RemoteDrawingEngine::_LockBitmapCache()
+{
+	RemoteBitmapCache* cache = fHWInterface->BitmapCache();
+	if (cache == NULL || !cache->Lock())
+		return NULL;
+
+	if (!cache->IsEnabled()) {
+		cache->Unlock();
+		return NULL;
+	}
+
+	return cache;
+}
+
+
+/*!	Tells whether filling \a rect would not change anything on the client,
+	because the last message that went out was an opaque fill of the same
+	kind and color covering it. Any other message, including state changes
+	and drawing of other engines, is going through the send buffer as well
+	and therefore ends the run.
+*/
+bool
+RemoteDrawingEngine::_IsRedundantFill(uint16 code, const BRect& rect,
+	const rgb_color& color)
+{
+	if (!fLastFillValid || fLastFillCode != code || fLastFillColor != color
+		|| fHWInterface->SendBuffer()->WriteCount() != fLastFillWriteCount
+		|| !fLastFillRect.Contains(rect)) {
+		return false;
+	}
+
+	return _IsOpaqueFill(code);
+}
+
+
+/*!	Remembers the fill just sent for _IsRedundantFill(). \a writeCount is
+	the write count of the send buffer from before the message was flushed,
+	only when exactly one write happened since then, it was ours.
+*/
+void
+RemoteDrawingEngine::_SetLastFill(uint16 code, const BRect& rect,
+	const rgb_color& color, int32 writeCount)
+{
+	fLastFillValid = _IsOpaqueFill(code);
+	fLastFillCode = code;
+	fLastFillRect = rect;
+	fLastFillColor = color;
+	fLastFillWriteCount = writeCount + 1;
+}
+
+
+bool
+RemoteDrawingEngine::_IsOpaqueFill(uint16 code) const
+{
+	// the client fills with its current drawing mode and, for RP_FILL_RECT,
+	// the current pattern, a second fill only is a no-op if it replaces the
+	// pixels with the same color
+	drawing_mode mode = fState.GetDrawingMode();
+	if (mode != B_OP_COPY && mode != B_OP_OVER)
+		return false;
+
+	if (code == RP_FILL_RECT
+		&& fState.GetPattern().GetPattern() != B_SOLID_HIGH) {
+		return false;
+	}
+
+	return fState.Transform().IsIdentity();
+}
+
+
 BRect
 RemoteDrawingEngine::_BuildBounds(BPoint* points, int32 pointCount)
 {
@@ -18,6 +18,7 @@ class BRect;
 class BRegion;
 
 class BitmapDrawingEngine;
+class RemoteBitmapCache;
 class ServerBitmap;
 
 class RemoteDrawingEngine : public DrawingEngine {
@@ -155,6 +156,14 @@ private:
 	static	bool				_DrawingEngineResult(void* cookie,
 									RemoteMessage& message);
 
+			RemoteBitmapCache*	_LockBitmapCache();
+
+			bool				_IsRedundantFill(uint16 code,
+									const BRect& rect, const rgb_color& color);
+			void				_SetLastFill(uint16 code, const BRect& rect,
+									const rgb_color& color, int32 writeCount);
+			bool				_IsOpaqueFill(uint16 code) const;
+
 			BRect				_BuildBounds(BPoint* points, int32 pointCount);
 			status_t			_ExtractBitmapRegions(ServerBitmap& bitmap,
 									uint32 options, const BRect& bitmapRect,
@@ -177,6 +186,12 @@ private:
 
 			BitmapDrawingEngine*
 								fBitmapDrawingEngine;
+
+			bool				fLastFillValid;
+			uint16				fLastFillCode;
+			BRect				fLastFillRect;
+			rgb_color			fLastFillColor;
+			int32				fLastFillWriteCount;
 };
 
 #endif // REMOTE_DRAWING_ENGINE_H
@@ -7,6 +7,8 @@
  */
 
 #include "RemoteHWInterface.h"
+#include "BatchCompression.h"
+#include "RemoteBitmapCache.h"
 #include "RemoteDrawingEngine.h"
 #include "RemoteEventStream.h"
 #include "RemoteMessage.h"
@@ -29,6 +31,10 @@
 #define TRACE_ERROR(x...)		debug_printf("RemoteHWInterface: " x)
 
 
+static const uint32 kMaxBitmapCacheMemory = 32 * 1024 * 1024;
+static const uint32 kMaxBitmapCacheSlots = 4096;
+
+
 struct callback_info {
 	uint32				token;
 	RemoteHWInterface::CallbackFunction	callback;
@@ -49,6 +55,7 @@ RemoteHWInterface::RemoteHWInterface(const char* target)
 	fReceiveBuffer(NULL),
 	fSender(NULL),
 	fReceiver(NULL),
+	fBitmapCache(NULL),
 	fEventThread(-1),
 	fEventStream(NULL),
 	fCallbackLocker("callback locker")
@@ -96,6 +103,12 @@ RemoteHWInterface::RemoteHWInterface(const char* target)
 	if (fInitStatus != B_OK)
 		return;
 
+	fBitmapCache = new(std::nothrow) RemoteBitmapCache();
+	if (fBitmapCache == NULL) {
+		fInitStatus = B_NO_MEMORY;
+		return;
+	}
+
 	fReceiver = new(std::nothrow) NetReceiver(fListenEndpoint, fReceiveBuffer,
 		_NewConnectionCallback, this);
 	if (fReceiver == NULL) {
@@ -131,6 +144,7 @@ RemoteHWInterface::~RemoteHWInterface()
 	delete fListenEndpoint;
 
 	delete fEventStream;
+	delete fBitmapCache;
 }
 
 
@@ -251,14 +265,8 @@ RemoteHWInterface::_EventThread()
 
 		switch (code) {
 			case RP_INIT_CONNECTION:
-			{
-				RemoteMessage reply(NULL, fSendBuffer);
-				reply.Start(RP_INIT_CONNECTION);
-				status_t result = reply.Flush();
-				(void)result;
-				TRACE("init connection result: %s\n", strerror(result));
+				_InitConnection(message);
 				break;
-			}
 
 			case RP_UPDATE_DISPLAY_MODE:
 			{
@@ -332,6 +340,13 @@ RemoteHWInterface::_NewConnection(BNetEndpoint &endpoint)
 
 	fSendBuffer->MakeEmpty();
 
+	// the new client starts out with an empty cache, it will tell us what
+	// it supports with its RP_INIT_CONNECTION
+	if (fBitmapCache->Lock()) {
+		fBitmapCache->Unset();
+		fBitmapCache->Unlock();
+	}
+
 	BNetEndpoint *sendEndpoint = new(std::nothrow) BNetEndpoint(endpoint);
 	if (sendEndpoint == NULL)
 		return B_NO_MEMORY;
@@ -346,6 +361,62 @@ RemoteHWInterface::_NewConnection(BNetEndpoint &endpoint)
 }
 
 
+void
+RemoteHWInterface::_InitConnection(RemoteMessage& message)
+{
+	// Older clients send an empty message and only get the plain protocol
+	uint32 features = 0;
+	uint32 cacheMemory = 0;
+	uint32 cacheSlots = 0;
+	if (message.DataLeft() > 0) {
+		message.Read(features);
+		message.Read(cacheMemory);
+		if (message.Read(cacheSlots) != B_OK)
+			features = 0;
+	}
+
+	if ((features & RP_FEATURE_COMPRESSION) != 0
+		&& !BatchCompressor::IsSupported()) {
+		features &= ~RP_FEATURE_COMPRESSION;
+	}
+
+	// Keep the cache locked until the reply is out, so that no bitmap that
+	// uses it can make it to the client before it knows about the cache
+	if (!fBitmapCache->Lock())
+		return;
+
+	if ((features & RP_FEATURE_BITMAP_CACHE) != 0) {
+		cacheMemory = min_c(cacheMemory, kMaxBitmapCacheMemory);
+		cacheSlots = min_c(cacheSlots, kMaxBitmapCacheSlots);
+
+		status_t result = fBitmapCache->SetTo(cacheMemory, cacheSlots);
+		if (result != B_OK) {
+			TRACE_ERROR("failed to set up the bitmap cache: %s\n",
+				strerror(result));
+			features &= ~RP_FEATURE_BITMAP_CACHE;
+		}
+	}
+
+	features &= RP_FEATURE_BITMAP_CACHE | RP_FEATURE_COMPRESSION;
+
+	RemoteMessage reply(NULL, fSendBuffer);
+	reply.Start(RP_INIT_CONNECTION);
+	reply.Add(features);
+	reply.Add(cacheMemory);
+	reply.Add(cacheSlots);
+	status_t result = reply.Flush();
+	fBitmapCache->Unlock();
+
+	TRACE("init connection result: %s, features %#" B_PRIx32 "\n",
+		strerror(result), features);
+
+	if (result == B_OK && (features & RP_FEATURE_COMPRESSION) != 0
+		&& fSender != NULL) {
+		fSender->EnableCompression();
+	}
+}
+
+
 void
 RemoteHWInterface::_Disconnect()
 {
@@ -17,6 +17,7 @@ class BNetEndpoint;
 class StreamingRingBuffer;
 class NetSender;
 class NetReceiver;
+class RemoteBitmapCache;
 class RemoteEventStream;
 class RemoteMessage;
 
@@ -82,6 +83,7 @@ virtual	status_t					CopyBackToFront(const BRect& frame);
 		// drawing engine interface
 		StreamingRingBuffer*		ReceiveBuffer() { return fReceiveBuffer; }
 		StreamingRingBuffer*		SendBuffer() { return fSendBuffer; }
+		RemoteBitmapCache*			BitmapCache() { return fBitmapCache; }
 
 typedef bool (*CallbackFunction)(void* cookie, RemoteMessage& message);
 
@@ -103,6 +105,7 @@ static	status_t					_NewConnectionCallback(void *cookie,
 		status_t					_NewConnection(BNetEndpoint &endpoint);
 
 		void						_Disconnect();
+		void						_InitConnection(RemoteMessage& message);
 
 		void						_FillDisplayModeTiming(display_mode &mode);
 
@@ -123,6 +126,8 @@ static	status_t					_NewConnectionCallback(void *cookie,
 		NetSender*					fSender;
 		NetReceiver*				fReceiver;
 
+		RemoteBitmapCache*			fBitmapCache;
+
 		thread_id					fEventThread;
 		RemoteEventStream*			fEventStream;
 
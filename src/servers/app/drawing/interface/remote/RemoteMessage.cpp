@@ -8,6 +8,8 @@
 
 #include "RemoteMessage.h"
 
+#include "RemoteBitmapCache.h"
+
 #ifndef CLIENT_COMPILE
 #include "DrawState.h"
 #include "ServerBitmap.h"
@@ -111,6 +113,19 @@ RemoteMessage::AddBitmap(const ServerBitmap& bitmap, bool minimal)
 }
 
 
+/*!	Adds the bitmap through the client side bitmap cache. The cache needs to
+	be locked by the caller until the message has been flushed.
+*/
+void
+RemoteMessage::AddCachedBitmap(const ServerBitmap& bitmap,
+	RemoteBitmapCache& cache, bool minimal)
+{
+	_AddCachedBitmap(cache, bitmap.Width(), bitmap.Height(),
+		bitmap.BytesPerRow(), bitmap.ColorSpace(), bitmap.Flags(),
+		bitmap.Bits(), bitmap.BitsLength(), minimal);
+}
+
+
 void
 RemoteMessage::AddFont(const ServerFont& font)
 {
@@ -189,6 +204,17 @@ RemoteMessage::AddBitmap(const BBitmap& bitmap)
 	fWriteIndex += bitsLength;
 	fAvailable -= bitsLength;
 }
+
+
+void
+RemoteMessage::AddCachedBitmap(const BBitmap& bitmap, RemoteBitmapCache& cache,
+	bool minimal)
+{
+	BRect bounds = bitmap.Bounds();
+	_AddCachedBitmap(cache, bounds.IntegerWidth() + 1,
+		bounds.IntegerHeight() + 1, bitmap.BytesPerRow(), bitmap.ColorSpace(),
+		bitmap.Flags(), bitmap.Bits(), bitmap.BitsLength(), minimal);
+}
 #endif // !CLIENT_COMPILE
 
 
@@ -586,3 +612,57 @@ RemoteMessage::ReadArrayLine(BPoint& startPoint, BPoint& endPoint,
 	Read(endPoint);
 	return Read(color);
 }
+
+
+void
+RemoteMessage::_AddCachedBitmap(RemoteBitmapCache& cache, int32 width,
+	int32 height, int32 bytesPerRow, color_space colorSpace, uint32 flags,
+	const void* bits, uint32 bitsLength, bool minimal)
+{
+	remote_bitmap_key key;
+	key.hash = RemoteBitmapCache::HashBits(bits, bitsLength);
+	key.width = width;
+	key.height = height;
+	key.bytes_per_row = bytesPerRow;
+	key.color_space = colorSpace;
+	key.flags = flags;
+	key.length = bitsLength;
+
+	uint32 slot;
+	bool store;
+	if (!cache.Get(key, slot, store)) {
+		slot = kRemoteBitmapNotCached;
+		store = false;
+	}
+
+	// the slots that had to make room for this bitmap, to be dropped by the
+	// client before anything else
+	int32 evictedCount = cache.CountEvicted();
+	Add(evictedCount);
+	for (int32 i = 0; i < evictedCount; i++)
+		Add(cache.EvictedAt(i));
+
+	Add(slot);
+	Add(store);
+
+	if (slot != kRemoteBitmapNotCached && !store)
+		return;
+
+	Add(width);
+	Add(height);
+	Add(bytesPerRow);
+
+	if (!minimal) {
+		Add(colorSpace);
+		Add(flags);
+	}
+
+	Add(bitsLength);
+
+	if (!_MakeSpace(bitsLength))
+		return;
+
+	memcpy(fBuffer + fWriteIndex, bits, bitsLength);
+	fWriteIndex += bitsLength;
+	fAvailable -= bitsLength;
+}
@@ -29,6 +29,7 @@ class BGradient;
 class BView;
 class DrawState;
 class Pattern;
+class RemoteBitmapCache;
 class RemotePainter;
 class ServerBitmap;
 class ServerCursor;
@@ -41,6 +42,7 @@ enum {
 	RP_CLOSE_CONNECTION,
 	RP_GET_SYSTEM_PALETTE,
 	RP_GET_SYSTEM_PALETTE_RESULT,
+	RP_COMPRESSED_BATCH,
 
 	RP_CREATE_STATE = 20,
 	RP_DELETE_STATE,
@@ -65,6 +67,8 @@ enum {
 	RP_INVERT_RECT,
 	RP_DRAW_BITMAP,
 	RP_DRAW_BITMAP_RECTS,
+	RP_DRAW_CACHED_BITMAP,
+	RP_DRAW_CACHED_BITMAP_RECTS,
 
 	RP_STROKE_ARC = 80,
 	RP_STROKE_BEZIER,
@@ -129,6 +133,13 @@ enum {
 };
 
 
+// optional protocol features, negotiated by RP_INIT_CONNECTION
+enum {
+	RP_FEATURE_BITMAP_CACHE		= 0x01,
+	RP_FEATURE_COMPRESSION		= 0x02
+};
+
+
 class RemoteMessage {
 public:
 								RemoteMessage(StreamingRingBuffer* source,
@@ -154,6 +165,9 @@ public:
 #ifndef CLIENT_COMPILE
 		void					AddBitmap(const ServerBitmap& bitmap,
 									bool minimal = false);
+		void					AddCachedBitmap(const ServerBitmap& bitmap,
+									RemoteBitmapCache& cache,
+									bool minimal = false);
 		void					AddFont(const ServerFont& font);
 		void					AddPattern(const Pattern& pattern);
 		void					AddDrawState(const DrawState& drawState);
@@ -161,6 +175,9 @@ public:
 		void					AddCursor(const ServerCursor& cursor);
 #else
 		void					AddBitmap(const BBitmap& bitmap);
+		void					AddCachedBitmap(const BBitmap& bitmap,
+									RemoteBitmapCache& cache,
+									bool minimal = false);
 #endif
 
 		template<typename T>
@@ -190,6 +207,11 @@ public:
 
 private:
 		bool					_MakeSpace(size_t size);
+		void					_AddCachedBitmap(RemoteBitmapCache& cache,
+									int32 width, int32 height,
+									int32 bytesPerRow, color_space colorSpace,
+									uint32 flags, const void* bits,
+									uint32 bitsLength, bool minimal);
 
 		StreamingRingBuffer*	fSource;
 		StreamingRingBuffer*	fTarget;
@@ -40,7 +40,8 @@ StreamingRingBuffer::StreamingRingBuffer(size_t bufferSize)
 	fBufferSize(bufferSize),
 	fReadable(0),
 	fReadPosition(0),
-	fWritePosition(0)
+	fWritePosition(0),
+	fWriteCount(0)
 {
 	fReaderNotifier = create_sem(0, "StreamingRingBuffer read notify");
 	fWriterNotifier = create_sem(0, "StreamingRingBuffer write notify");
@@ -199,6 +200,7 @@ StreamingRingBuffer::Write(const void *buffer, size_t length)
 		}
 	}
 
+	atomic_add(&fWriteCount, 1);
 	return B_OK;
 }
 
@@ -26,6 +26,11 @@ public:
 
 		void					MakeEmpty();
 
+		// number of completed writes, to tell whether anything else was
+		// written since a given point
+		int32					WriteCount() const
+									{ return atomic_get((int32*)&fWriteCount); }
+
 private:
 		bool					fReaderWaiting;
 		bool					fWriterWaiting;
@@ -43,6 +48,7 @@ private:
 		size_t					fReadable;
 		int32					fReadPosition;
 		int32					fWritePosition;
+		int32					fWriteCount;
 };
 
 #endif // STREAMING_RING_BUFFER_H
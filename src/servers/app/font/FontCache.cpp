@@ -24,12 +24,17 @@ using std::nothrow;
 FontCache
 FontCache::sDefaultInstance;
 
+static const int32 kMaxEntryCount = 30;
+static const size_t kMaxMemoryUsage = 8 * 1024 * 1024;
+static const bigtime_t kMinPruneInterval = 100000;
+
 // #pragma mark -
 
 // constructor
 FontCache::FontCache()
 	: MultiLocker("FontCache lock")
 	, fFontCacheEntries()
+	, fLastPruneTime(0)
 {
 }
 
@@ -83,8 +88,10 @@ FontCache::FontCacheEntryFor(const ServerFont& font, bool forceVector)
 	entry = fFontCacheEntries.Get(signature);
 
 	if (!entry) {
-		// remove old entries, keep entries below certain count
+		// remove old entries, keep entries below certain count and memory
+		// usage
 		_ConstrainEntryCount();
+		_ConstrainMemoryUsage();
 		entry = new (nothrow) FontCacheEntry();
 		if (!entry || !entry->Init(font, forceVector)
 			|| fFontCacheEntries.Put(signature, entry) < B_OK) {
@@ -109,9 +116,61 @@ FontCache::Recycle(FontCacheEntry* entry)
 		return;
 	entry->UpdateUsage();
 	entry->ReleaseReference();
+
+	// The memory usage is an atomic counter, so it can be checked without
+	// locking. Pruning needs the write lock, which would serialize all glyph
+	// lookups, so it is only done every once in a while, by a single thread.
+	if (FontCacheEntry::TotalMemoryUsage() <= kMaxMemoryUsage)
+		return;
+
+	bigtime_t now = system_time();
+	bigtime_t lastPruneTime = atomic_get64(&fLastPruneTime);
+	if (now - lastPruneTime < kMinPruneInterval
+		|| atomic_test_and_set64(&fLastPruneTime, now, lastPruneTime)
+			!= lastPruneTime) {
+		return;
+	}
+
+	AutoWriteLocker locker(this);
+	if (locker.IsLocked())
+		_ConstrainMemoryUsage();
 }
 
-static const int32 kMaxEntryCount = 30;
+// Dump
+void
+FontCache::Dump()
+{
+	AutoReadLocker locker(this);
+	if (!locker.IsLocked())
+		return;
+
+	debug_printf("Font cache: %" B_PRId32 " entries, %" B_PRIuSIZE
+		" bytes (limit %" B_PRIuSIZE ")\n", fFontCacheEntries.Size(),
+		FontCacheEntry::TotalMemoryUsage(), kMaxMemoryUsage);
+
+	uint64 totalHits = 0;
+	uint64 totalMisses = 0;
+
+	FontMap::Iterator iterator = fFontCacheEntries.GetIterator();
+	while (iterator.HasNext()) {
+		FontMap::Entry mapEntry = iterator.Next();
+		FontCacheEntry* entry = mapEntry.value;
+
+		uint64 hits = entry->Hits();
+		uint64 misses = entry->Misses();
+		totalHits += hits;
+		totalMisses += misses;
+
+		debug_printf("  %s: %" B_PRId32 " glyphs, %" B_PRIuSIZE " bytes, "
+			"%" B_PRIu64 " hits, %" B_PRIu64 " misses\n",
+			mapEntry.key.GetString(), entry->GlyphCount(),
+			entry->MemoryUsage(), hits, misses);
+	}
+
+	uint64 lookups = totalHits + totalMisses;
+	debug_printf("  hit rate: %.1f%%\n",
+		lookups > 0 ? 100.0 * totalHits / lookups : 0.0);
+}
 
 static inline double
 usage_index(uint64 useCount, bigtime_t age)
@@ -128,29 +187,51 @@ FontCache::_ConstrainEntryCount()
 		return;
 //printf("FontCache::_ConstrainEntryCount()\n");
 
-	FontMap::Iterator iterator = fFontCacheEntries.GetIterator();
+	_RemoveLeastUsedEntry(false);
+}
+
+// _ConstrainMemoryUsage
+void
+FontCache::_ConstrainMemoryUsage()
+{
+	// this function is only ever called with the WriteLock held
 
-	// NOTE: if kMaxEntryCount has a sane value, there has got to be
-	// some entries, so using the iterator like that should be ok
-	FontCacheEntry* leastUsedEntry = iterator.Next().value;
+	// Only entries nobody else holds a reference to are evicted, as the
+	// others would not free their memory before they are recycled anyway.
+	while (FontCacheEntry::TotalMemoryUsage() > kMaxMemoryUsage) {
+		if (!_RemoveLeastUsedEntry(true))
+			break;
+	}
+}
+
+// _RemoveLeastUsedEntry
+bool
+FontCache::_RemoveLeastUsedEntry(bool unreferencedOnly)
+{
+	// this function is only ever called with the WriteLock held
+	FontCacheEntry* leastUsedEntry = NULL;
+	double leastUsageIndex = 0.0;
 	bigtime_t now = system_time();
-	bigtime_t age = now - leastUsedEntry->LastUsed();
-	uint64 useCount = leastUsedEntry->UsedCount();
-	double leastUsageIndex = usage_index(useCount, age);
-//printf("  leastUsageIndex: %f\n", leastUsageIndex);
 
+	FontMap::Iterator iterator = fFontCacheEntries.GetIterator();
 	while (iterator.HasNext()) {
 		FontCacheEntry* entry = iterator.Next().value;
-		age = now - entry->LastUsed();
-		useCount = entry->UsedCount();
+		if (unreferencedOnly && entry->CountReferences() > 1)
+			continue;
+
+		bigtime_t age = now - entry->LastUsed();
+		uint64 useCount = entry->UsedCount();
 		double usageIndex = usage_index(useCount, age);
 //printf("  usageIndex: %f\n", usageIndex);
-		if (usageIndex < leastUsageIndex) {
+		if (leastUsedEntry == NULL || usageIndex < leastUsageIndex) {
 			leastUsedEntry = entry;
 			leastUsageIndex = usageIndex;
 		}
 	}
 
+	if (leastUsedEntry == NULL)
+		return false;
+
 	iterator = fFontCacheEntries.GetIterator();
 	while (iterator.HasNext()) {
 		if (iterator.Next().value == leastUsedEntry) {
@@ -159,4 +240,5 @@ FontCache::_ConstrainEntryCount()
 			break;
 		}
 	}
+	return true;
 }
@@ -28,14 +28,20 @@ class FontCache : public MultiLocker {
 									bool forceVector);
 			void				Recycle(FontCacheEntry* entry);
 
+			void				Dump();
+
  private:
 			void				_ConstrainEntryCount();
+			void				_ConstrainMemoryUsage();
+			bool				_RemoveLeastUsedEntry(
+									bool unreferencedOnly);
 
 	static	FontCache			sDefaultInstance;
 
 	typedef HashMap<HashString, FontCacheEntry*> FontMap;
 
 			FontMap				fFontCacheEntries;
+			bigtime_t			fLastPruneTime;
 };
 
 #endif // FONT_CACHE_H
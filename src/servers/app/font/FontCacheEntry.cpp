@@ -40,6 +40,14 @@
 
 
 BLocker FontCacheEntry::sUsageUpdateLock("FontCacheEntry usage lock");
+int64 FontCacheEntry::sTotalMemoryUsage = 0;
+
+
+// Glyphs and their rendered data are packed into pages of this size. Glyphs
+// that don't fit into a quarter of a page get a page of their own, so that
+// the pages don't fill up with padding.
+static const size_t kGlyphPageSize = 16 * 1024;
+static const size_t kGlyphAlignment = 8;
 
 
 class FontCacheEntry::GlyphCachePool {
@@ -69,19 +77,37 @@ class FontCacheEntry::GlyphCachePool {
 			return value->hash_link;
 		}
 	};
+	struct GlyphPage {
+		GlyphPage*	next;
+		size_t		size;
+		size_t		used;
+
+		uint8* Data()
+		{
+			return (uint8*)this + _Align(sizeof(GlyphPage));
+		}
+	};
+
 public:
 	GlyphCachePool()
+		:
+		fPages(NULL),
+		fMemoryUsage(0)
 	{
 	}
 
 	~GlyphCachePool()
 	{
-		GlyphCache* glyph = fGlyphTable.Clear(true);
-		while (glyph != NULL) {
-			GlyphCache* next = glyph->hash_link;
-			delete glyph;
-			glyph = next;
+		// The glyphs live in the pages, there is nothing else to free
+		fGlyphTable.Clear(true);
+
+		while (fPages != NULL) {
+			GlyphPage* next = fPages->next;
+			free(fPages);
+			fPages = next;
 		}
+
+		atomic_add64(&sTotalMemoryUsage, -(int64)fMemoryUsage);
 	}
 
 	status_t Init()
@@ -103,26 +129,84 @@ public:
 		if (glyph != NULL)
 			return NULL;
 
-		glyph = new(std::nothrow) GlyphCache(glyphIndex, dataSize, dataType,
-			bounds, advanceX, advanceY, preciseAdvanceX, preciseAdvanceY,
-			insetLeft, insetRight);
-		if (glyph == NULL || glyph->data == NULL) {
-			delete glyph;
+		// Place the glyph and its data next to each other
+		size_t glyphSize = _Align(sizeof(GlyphCache));
+		uint8* buffer = _Allocate(glyphSize + dataSize);
+		if (buffer == NULL)
 			return NULL;
-		}
 
-		// TODO: The HashTable grows without bounds. We should cleanup
-		// older entries from time to time.
+		glyph = new(buffer) GlyphCache(glyphIndex, buffer + glyphSize,
+			dataSize, dataType, bounds, advanceX, advanceY, preciseAdvanceX,
+			preciseAdvanceY, insetLeft, insetRight);
+
+		// The FontCache limits the overall memory used by evicting whole
+		// entries, so the table does not need to be trimmed here.
 
 		fGlyphTable.Insert(glyph);
 
 		return glyph;
 	}
 
+	int32 CountGlyphs() const
+	{
+		return fGlyphTable.CountElements();
+	}
+
+	size_t MemoryUsage() const
+	{
+		return fMemoryUsage;
+	}
+
+private:
+	static size_t _Align(size_t size)
+	{
+		return (size + kGlyphAlignment - 1) & ~(kGlyphAlignment - 1);
+	}
+
+	uint8* _Allocate(size_t size)
+	{
+		size = _Align(size);
+
+		if (fPages != NULL && fPages->size - fPages->used >= size) {
+			uint8* buffer = fPages->Data() + fPages->used;
+			fPages->used += size;
+			return buffer;
+		}
+
+		size_t pageSize = kGlyphPageSize;
+		bool dedicated = size > pageSize / 4;
+		if (dedicated)
+			pageSize = size;
+
+		size_t headerSize = _Align(sizeof(GlyphPage));
+		GlyphPage* page = (GlyphPage*)malloc(headerSize + pageSize);
+		if (page == NULL)
+			return NULL;
+
+		page->size = pageSize;
+		page->used = size;
+
+		if (dedicated && fPages != NULL) {
+			// keep filling the current page
+			page->next = fPages->next;
+			fPages->next = page;
+		} else {
+			page->next = fPages;
+			fPages = page;
+		}
+
+		fMemoryUsage += headerSize + pageSize;
+		atomic_add64(&sTotalMemoryUsage, headerSize + pageSize);
+
+		return page->Data();
+	}
+
 private:
 	typedef BOpenHashTable<GlyphHashTableDefinition> GlyphTable;
 
 	GlyphTable	fGlyphTable;
+	GlyphPage*	fPages;
+	size_t		fMemoryUsage;
 };
 
 
@@ -135,7 +219,9 @@ FontCacheEntry::FontCacheEntry()
 	fGlyphCache(new(std::nothrow) GlyphCachePool()),
 	fEngine(),
 	fLastUsedTime(LONGLONG_MIN),
-	fUseCounter(0)
+	fUseCounter(0),
+	fHits(0),
+	fMisses(0)
 {
 }
 
@@ -262,7 +348,9 @@ const GlyphCache*
 FontCacheEntry::CachedGlyph(uint32 glyphCode)
 {
 	// Only requires a read lock.
-	return fGlyphCache->FindGlyph(glyphCode);
+	const GlyphCache* glyph = fGlyphCache->FindGlyph(glyphCode);
+	atomic_add64(glyph != NULL ? &fHits : &fMisses, 1);
+	return glyph;
 }
 
 
@@ -391,6 +479,27 @@ FontCacheEntry::GenerateSignature(char* signature, size_t signatureSize,
 }
 
 
+int32
+FontCacheEntry::GlyphCount() const
+{
+	return fGlyphCache->CountGlyphs();
+}
+
+
+size_t
+FontCacheEntry::MemoryUsage() const
+{
+	return fGlyphCache->MemoryUsage();
+}
+
+
+/*static*/ size_t
+FontCacheEntry::TotalMemoryUsage()
+{
+	return atomic_get64(&sTotalMemoryUsage);
+}
+
+
 void
 FontCacheEntry::UpdateUsage()
 {
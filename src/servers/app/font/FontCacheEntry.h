@@ -41,13 +41,13 @@
 
 
 struct GlyphCache {
-	GlyphCache(uint32 glyphIndex, uint32 dataSize, glyph_data_type dataType,
-			const agg::rect_i& bounds, float advanceX, float advanceY,
-			float preciseAdvanceX, float preciseAdvanceY,
-			float insetLeft, float insetRight)
+	GlyphCache(uint32 glyphIndex, uint8* data, uint32 dataSize,
+			glyph_data_type dataType, const agg::rect_i& bounds,
+			float advanceX, float advanceY, float preciseAdvanceX,
+			float preciseAdvanceY, float insetLeft, float insetRight)
 		:
 		glyph_index(glyphIndex),
-		data((uint8*)malloc(dataSize)),
+		data(data),
 		data_size(dataSize),
 		data_type(dataType),
 		bounds(bounds),
@@ -61,11 +61,6 @@ struct GlyphCache {
 	{
 	}
 
-	~GlyphCache()
-	{
-		free(data);
-	}
-
 	uint32			glyph_index;
 	uint8*			data;
 	uint32			data_size;
@@ -128,6 +123,15 @@ class FontCacheEntry : public MultiLocker, public BReferenceable {
 									size_t signatureSize,
 									const ServerFont& font, bool forceVector);
 
+	// statistics
+			int32				GlyphCount() const;
+			size_t				MemoryUsage() const;
+			uint64				Hits() const
+									{ return fHits; }
+			uint64				Misses() const
+									{ return fMisses; }
+	static	size_t				TotalMemoryUsage();
+
 	// private to FontCache class:
 			void				UpdateUsage();
 			bigtime_t			LastUsed() const
@@ -150,6 +154,10 @@ class FontCacheEntry : public MultiLocker, public BReferenceable {
 	static	BLocker				sUsageUpdateLock;
 			bigtime_t			fLastUsedTime;
 			uint64				fUseCounter;
+
+	static	int64				sTotalMemoryUsage;
+			int64				fHits;
+			int64				fMisses;
 };
 
 #endif // FONT_CACHE_ENTRY_H
@@ -8,9 +8,12 @@
 
 #include "CatchUpManager.h"
 
-#include <vector>
+#include <algorithm>
+#include <new>
 
+#include <Autolock.h>
 #include <Debug.h>
+#include <Entry.h>
 #include <Query.h>
 
 #include "IndexServer.h"
@@ -21,20 +24,118 @@ const uint32 kCatchUpDone = '&CUD';
 
 const bigtime_t kSecond = 1000000;
 
+const int32 kMaxWorkers = 8;
+//! The workers take that many entries from the list at once.
+const size_t kChunkSize = 64;
+//! A worker commits its analysers and the sync position is written after
+//! that many entries, so that a catch up can be resumed after a crash.
+const size_t kCheckpointInterval = 1000;
+
+
+/*! Each worker has its own set of analysers, since they are not thread safe.
+\c firstPending is the first entry the worker has taken but not yet
+committed, or the number of entries if there is none. */
+struct CatchUpAnalyser::worker {
+			CatchUpAnalyser*	catchUpAnalyser;
+			FileAnalyserList*	analysers;
+			int32				index;
+			thread_id			thread;
+			size_t				processed;
+			size_t				firstPending;
+};
+
+
+static bool
+compare_modified(const catch_up_entry& a, const catch_up_entry& b)
+{
+	return a.modified < b.modified;
+}
+
+
+CatchUpStatus::CatchUpStatus()
+	:
+	fRunCount(0),
+	fRunsDone(0),
+	fStartTime(0),
+	fActiveCount(0)
+{
+
+}
+
+
+void
+CatchUpStatus::Start(int64 runCount)
+{
+	if (atomic_add(&fActiveCount, 1) == 0) {
+		atomic_set64(&fRunCount, 0);
+		atomic_set64(&fRunsDone, 0);
+		atomic_set64(&fStartTime, system_time());
+	}
+	atomic_add64(&fRunCount, runCount);
+}
+
+
+void
+CatchUpStatus::RunsDone(int64 count)
+{
+	atomic_add64(&fRunsDone, count);
+}
+
+
+void
+CatchUpStatus::Finish(int64 runsLeft)
+{
+	// runs that were skipped because the catch up has been stopped don't
+	// count as backlog anymore
+	atomic_add64(&fRunCount, -runsLeft);
+	atomic_add(&fActiveCount, -1);
+}
+
+
+void
+CatchUpStatus::GetStatus(BMessage& message)
+{
+	int64 runCount = atomic_get64(&fRunCount);
+	int64 runsDone = atomic_get64(&fRunsDone);
+	bigtime_t elapsed = system_time() - atomic_get64(&fStartTime);
+
+	float runsPerSecond = 0;
+	if (runsDone > 0 && elapsed > 0)
+		runsPerSecond = runsDone * (float)kSecond / elapsed;
+
+	message.AddBool("catch up active", atomic_get(&fActiveCount) > 0);
+	message.AddInt64("catch up runs", runCount);
+	message.AddInt64("catch up runs done", runsDone);
+	message.AddInt64("catch up backlog", max_c(runCount - runsDone, 0));
+	message.AddFloat("catch up runs per second", runsPerSecond);
+}
+
 
 CatchUpAnalyser::CatchUpAnalyser(const BVolume& volume, time_t start,
-	time_t end, BHandler* manager)
+	time_t end, BHandler* manager, CatchUpStatus* status)
 	:
 	AnalyserDispatcher("CatchUpAnalyser"),
 	fVolume(volume),
 	fStart(start),
 	fEnd(end),
-	fCatchUpManager(manager)
+	fCatchUpManager(manager),
+	fStatus(status),
+	fWorkerAnalysers(kMaxWorkers, true),
+	fWorkLock("catch up work"),
+	fNextEntry(0),
+	fWorkers(NULL),
+	fWorkerCount(0)
 {
 	
 }
 
 
+CatchUpAnalyser::~CatchUpAnalyser()
+{
+	_DeleteWorkers();
+}
+
+
 void
 CatchUpAnalyser::MessageReceived(BMessage *message)
 {
@@ -62,14 +163,38 @@ CatchUpAnalyser::AnalyseEntry(const entry_ref& ref)
 {
 	for (int i = 0; i < fFileAnalyserList.CountItems(); i++) {
 		FileAnalyser* analyser = fFileAnalyserList.ItemAt(i);
-		const analyser_settings& settings = analyser->CachedSettings();
-		if (settings.syncPosition / kSecond >= fStart
-			&& settings.watchingStart / kSecond <= fEnd)
+		if (_IsInRange(analyser))
 			analyser->AnalyseEntry(ref);
 	}
 }
 
 
+bool
+CatchUpAnalyser::AddWorker(FileAnalyserList* analysers)
+{
+	BAutolock _(this);
+	if (fWorkerAnalysers.CountItems() >= kMaxWorkers - 1)
+		return false;
+	return fWorkerAnalysers.AddItem(analysers);
+}
+
+
+bool
+CatchUpAnalyser::RemoveAnalyser(const BString& name)
+{
+	BAutolock _(this);
+	for (int32 i = 0; i < fWorkerAnalysers.CountItems(); i++) {
+		FileAnalyserList* analysers = fWorkerAnalysers.ItemAt(i);
+		for (int32 j = analysers->CountItems() - 1; j >= 0; j--) {
+			if (analysers->ItemAt(j)->Name() == name)
+				delete analysers->RemoveItemAt(j);
+		}
+	}
+
+	return AnalyserDispatcher::RemoveAnalyser(name);
+}
+
+
 void
 CatchUpAnalyser::_CatchUp()
 {
@@ -89,24 +214,78 @@ CatchUpAnalyser::_CatchUp()
 
 	query.Fetch();
 
-	std::vector<entry_ref> entryList;
+	fEntries.clear();
 	entry_ref ref;
-	while (query.GetNextRef(&ref) == B_OK)
-		entryList.push_back(ref);
+	while (query.GetNextRef(&ref) == B_OK) {
+		catch_up_entry entry;
+		entry.ref = ref;
+		if (BEntry(&ref).GetModificationTime(&entry.modified) != B_OK)
+			entry.modified = fStart;
+		fEntries.push_back(entry);
+	}
 
-	printf("CatchUpAnalyser:: entryList.size() %i\n", (int)entryList.size());
+	// Going through the entries in the order they were modified allows to
+	// use the modification time of the last analysed entry as checkpoint.
+	std::stable_sort(fEntries.begin(), fEntries.end(), compare_modified);
 
-	if (entryList.size() == 0)
+	printf("CatchUpAnalyser:: entryList.size() %i\n", (int)fEntries.size());
+
+	if (fEntries.size() == 0) {
+		_DeleteWorkers();
 		return;
+	}
+
+	// Every worker takes the next chunk of entries when it is done with the
+	// last one, and runs all analysers on it. The first worker uses our own
+	// analysers, the others the copies the manager gave us. We are locked
+	// meanwhile, so RemoveAnalyser() can't change them under the workers.
+	int32 analyserCount = fFileAnalyserList.CountItems();
+	int32 workerCount = min_c(fWorkerAnalysers.CountItems() + 1,
+		(int32)((fEntries.size() + kChunkSize - 1) / kChunkSize));
+
+	worker workers[kMaxWorkers];
+	fWorkers = workers;
+	fWorkerCount = workerCount;
+	fNextEntry = 0;
+
+	fStatus->Start((int64)fEntries.size() * analyserCount);
+
+	for (int32 i = 0; i < workerCount; i++) {
+		workers[i].catchUpAnalyser = this;
+		workers[i].analysers = i == 0
+			? &fFileAnalyserList : fWorkerAnalysers.ItemAt(i - 1);
+		workers[i].index = i;
+		workers[i].processed = 0;
+		workers[i].firstPending = fEntries.size();
+		workers[i].thread = -1;
+	}
 
-	for (uint32 i = 0; i < entryList.size(); i++) {
-		if (Stopped())
-			return;
-		if (i % 100 == 0)
-			printf("Catch up: %i/%i\n", (int)i,(int)entryList.size());
-		AnalyseEntry(entryList[i]);
+	for (int32 i = 0; i < workerCount; i++) {
+		workers[i].thread = spawn_thread(_WorkerEntry, "catch up worker",
+			B_LOW_PRIORITY, &workers[i]);
+		if (workers[i].thread < 0)
+			_Work(&workers[i]);
+		else
+			resume_thread(workers[i].thread);
 	}
-	LastEntry();
+
+	size_t processed = 0;
+	for (int32 i = 0; i < workerCount; i++) {
+		if (workers[i].thread >= 0) {
+			status_t result;
+			wait_for_thread(workers[i].thread, &result);
+		}
+		processed += workers[i].processed;
+	}
+
+	fStatus->Finish((int64)(fEntries.size() - processed) * analyserCount);
+	fEntries.clear();
+	fWorkers = NULL;
+	fWorkerCount = 0;
+	_DeleteWorkers();
+
+	if (Stopped())
+		return;
 
 	_WriteSyncSatus(fEnd * kSecond);
 	printf("Catched up.\n");
@@ -118,6 +297,126 @@ CatchUpAnalyser::_CatchUp()
 }
 
 
+status_t
+CatchUpAnalyser::_WorkerEntry(void* data)
+{
+	worker* self = (worker*)data;
+	self->catchUpAnalyser->_Work(self);
+	return B_OK;
+}
+
+
+void
+CatchUpAnalyser::_Work(worker* worker)
+{
+	FileAnalyserList& analysers = *worker->analysers;
+	int32 analyserCount = analysers.CountItems();
+
+	size_t sinceCheckpoint = 0;
+	size_t start;
+	size_t end;
+	while (!Stopped() && _NextChunk(worker, start, end)) {
+		if (worker->index == 0)
+			printf("Catch up: %i/%i\n", (int)start, (int)fEntries.size());
+
+		for (size_t i = start; i < end; i++) {
+			if (Stopped()) {
+				// let the next catch up continue from here
+				_Checkpoint(worker, i);
+				return;
+			}
+
+			for (int32 j = 0; j < analyserCount; j++) {
+				FileAnalyser* analyser = analysers.ItemAt(j);
+				if (_IsInRange(analyser))
+					analyser->AnalyseEntry(fEntries[i].ref);
+			}
+			fStatus->RunsDone(analyserCount);
+			worker->processed++;
+		}
+
+		sinceCheckpoint += end - start;
+		if (sinceCheckpoint >= kCheckpointInterval) {
+			_Checkpoint(worker, fEntries.size());
+			sinceCheckpoint = 0;
+		}
+	}
+
+	_Checkpoint(worker, fEntries.size());
+}
+
+
+/*! Takes the next \c kChunkSize entries for \a worker. Returns \c false
+when there are none left. */
+bool
+CatchUpAnalyser::_NextChunk(worker* worker, size_t& start, size_t& end)
+{
+	BAutolock _(fWorkLock);
+	if (fNextEntry >= fEntries.size())
+		return false;
+
+	start = fNextEntry;
+	end = min_c(start + kChunkSize, fEntries.size());
+	fNextEntry = end;
+
+	if (worker->firstPending > start)
+		worker->firstPending = start;
+	return true;
+}
+
+
+bool
+CatchUpAnalyser::_IsInRange(FileAnalyser* analyser)
+{
+	const analyser_settings& settings = analyser->CachedSettings();
+	return settings.syncPosition / kSecond >= fStart
+		&& settings.watchingStart / kSecond <= fEnd;
+}
+
+
+/*! Commits what the analysers of \a worker have done so far; everything
+before \a firstPending has been analysed by it. The sync position is then
+moved up to the last entry before the first one any worker has not
+committed yet. Entries modified at exactly that time may not all have been
+analysed yet, but since the next catch up starts at the sync position they
+are analysed again. */
+void
+CatchUpAnalyser::_Checkpoint(worker* worker, size_t firstPending)
+{
+	FileAnalyserList& analysers = *worker->analysers;
+	for (int32 i = 0; i < analysers.CountItems(); i++) {
+		FileAnalyser* analyser = analysers.ItemAt(i);
+		if (_IsInRange(analyser))
+			analyser->LastEntry();
+	}
+
+	BAutolock _(fWorkLock);
+	worker->firstPending = firstPending;
+
+	size_t committed = fNextEntry;
+	for (int32 i = 0; i < fWorkerCount; i++)
+		committed = min_c(committed, fWorkers[i].firstPending);
+	if (committed == 0)
+		return;
+
+	// the analysers of all workers share their settings
+	bigtime_t position = fEntries[committed - 1].modified * kSecond;
+	for (int32 i = 0; i < analysers.CountItems(); i++) {
+		FileAnalyser* analyser = analysers.ItemAt(i);
+		if (!_IsInRange(analyser))
+			continue;
+
+		AnalyserSettings* settings = analyser->Settings();
+		ASSERT(settings);
+		if (settings->SyncPosition() >= position)
+			continue;
+
+		settings->SetSyncPosition(position);
+		settings->WriteSettings();
+	}
+}
+
+
 void
 CatchUpAnalyser::_WriteSyncSatus(bigtime_t syncTime)
 {
@@ -131,9 +430,22 @@ CatchUpAnalyser::_WriteSyncSatus(bigtime_t syncTime)
 }
 
 
+void
+CatchUpAnalyser::_DeleteWorkers()
+{
+	for (int32 i = 0; i < fWorkerAnalysers.CountItems(); i++) {
+		FileAnalyserList* analysers = fWorkerAnalysers.ItemAt(i);
+		for (int32 j = 0; j < analysers->CountItems(); j++)
+			delete analysers->ItemAt(j);
+	}
+	fWorkerAnalysers.MakeEmpty();
+}
+
+
 CatchUpManager::CatchUpManager(const BVolume& volume)
 	:
-	fVolume(volume)
+	fVolume(volume),
+	fStatus(new CatchUpStatus, true)
 {
 
 }
@@ -154,9 +466,11 @@ CatchUpManager::MessageReceived(BMessage *message)
 	CatchUpAnalyser* analyser;
 	switch (message->what) {
 		case kCatchUpDone:
-			message->AddPointer("Analyser", &analyser);
-			fCatchUpAnalyserList.RemoveItem(analyser);
-			analyser->PostMessage(B_QUIT_REQUESTED);
+			if (message->FindPointer("Analyser", (void**)&analyser) != B_OK)
+				break;
+			// Stop() might have already sent it away
+			if (fCatchUpAnalyserList.RemoveItem(analyser))
+				analyser->PostMessage(B_QUIT_REQUESTED);
 		break;
 
 		default:
@@ -218,7 +532,7 @@ CatchUpManager::CatchUp()
 	}
 
 	CatchUpAnalyser* catchUpAnalyser = new CatchUpAnalyser(fVolume,
-		startBig / kSecond, endBig / kSecond, this);
+		startBig / kSecond, endBig / kSecond, this, fStatus);
 	if (!catchUpAnalyser)
 		return false;
 	if (!fCatchUpAnalyserList.AddItem(catchUpAnalyser)) {
@@ -226,6 +540,39 @@ CatchUpManager::CatchUp()
 		return false;
 	}
 
+	// An analyser is not thread safe, so every worker but the first gets its
+	// own copies. A worker that misses one of them is left out.
+	IndexServer* server = (IndexServer*)be_app;
+	system_info info;
+	get_system_info(&info);
+	int32 workerCount = min_c((int32)info.cpu_count, kMaxWorkers);
+	for (int32 i = 1; i < workerCount; i++) {
+		FileAnalyserList* analysers = new(std::nothrow) FileAnalyserList;
+		if (analysers == NULL)
+			break;
+
+		for (int j = 0; j < fFileAnalyserQueue.CountItems(); j++) {
+			FileAnalyser* original = fFileAnalyserQueue.ItemAt(j);
+			FileAnalyser* analyser = server->CreateFileAnalyser(
+				original->Name(), fVolume);
+			if (analyser == NULL)
+				break;
+			analyser->SetSettings(original->Settings());
+			if (!analysers->AddItem(analyser)) {
+				delete analyser;
+				break;
+			}
+		}
+
+		if (analysers->CountItems() != fFileAnalyserQueue.CountItems()
+			|| !catchUpAnalyser->AddWorker(analysers)) {
+			for (int j = 0; j < analysers->CountItems(); j++)
+				delete analysers->ItemAt(j);
+			delete analysers;
+			break;
+		}
+	}
+
 	for (int i = 0; i < fFileAnalyserQueue.CountItems(); i++) {
 		FileAnalyser* analyser = fFileAnalyserQueue.ItemAt(i);
 		// if AddAnalyser fails at least don't leak
@@ -250,3 +597,11 @@ CatchUpManager::Stop()
 	}
 	fCatchUpAnalyserList.MakeEmpty();
 }
+
+
+void
+CatchUpManager::GetStatus(BMessage& message)
+{
+	message.AddInt32("volume", fVolume.Device());
+	fStatus->GetStatus(message);
+}
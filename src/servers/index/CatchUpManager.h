@@ -9,6 +9,12 @@
 #define CATCH_UP_MANAGER_H
 
 
+#include <vector>
+
+#include <Locker.h>
+#include <Message.h>
+#include <Referenceable.h>
+
 #include "AnalyserDispatcher.h"
 
 
@@ -21,28 +27,84 @@
 #endif
 
 
+/*! Progress of the catch up of a volume, shared between the manager and its
+analysers. The workers update it without locking, so the index server can
+report it at any time. Work is counted in analyser runs, one for every
+entry and analyser. */
+class CatchUpStatus : public BReferenceable {
+public:
+								CatchUpStatus();
+
+			void				Start(int64 runCount);
+			void				RunsDone(int64 count);
+			void				Finish(int64 runsLeft);
+
+			void				GetStatus(BMessage& message);
+
+private:
+			int64				fRunCount;
+			int64				fRunsDone;
+			int64				fStartTime;
+			int32				fActiveCount;
+};
+
+
+struct catch_up_entry {
+			entry_ref			ref;
+			time_t				modified;
+};
+
+typedef std::vector<catch_up_entry> CatchUpEntryVector;
+
+
 class CatchUpAnalyser : public AnalyserDispatcher {
 public:
 								CatchUpAnalyser(const BVolume& volume,
 									time_t start, time_t end,
-									BHandler* manager);
+									BHandler* manager,
+									CatchUpStatus* status);
+								~CatchUpAnalyser();
 
 			void				MessageReceived(BMessage *message);
 			void				StartAnalysing();
 
 			void				AnalyseEntry(const entry_ref& ref);
 
+			//! Adds a copy of all analysers for another worker, the catch up
+			//! analyser takes ownership of it and the analysers in it.
+			bool				AddWorker(FileAnalyserList* analysers);
+			bool				RemoveAnalyser(const BString& name);
+
 			const BVolume&		Volume() { return fVolume; }
 
 private:
+			struct worker;
+
 			void				_CatchUp();
+	static	status_t			_WorkerEntry(void* data);
+			void				_Work(worker* worker);
+			bool				_NextChunk(worker* worker, size_t& start,
+									size_t& end);
+			bool				_IsInRange(FileAnalyser* analyser);
+			void				_Checkpoint(worker* worker,
+									size_t firstPending);
 			void				_WriteSyncSatus(bigtime_t syncTime);
+			void				_DeleteWorkers();
 
 			BVolume				fVolume;
 			time_t				fStart;
 			time_t				fEnd;
 
 			BHandler*			fCatchUpManager;
+			BReference<CatchUpStatus>	fStatus;
+
+			BObjectList<FileAnalyserList>	fWorkerAnalysers;
+
+			CatchUpEntryVector	fEntries;
+			BLocker				fWorkLock;
+			size_t				fNextEntry;
+			worker*				fWorkers;
+			int32				fWorkerCount;
 };
 
 
@@ -67,8 +129,12 @@ public:
 			//! queue.
 			void				Stop();
 
+			//! thread safe
+			void				GetStatus(BMessage& message);
+
 private:
 			BVolume				fVolume;
+			BReference<CatchUpStatus>	fStatus;
 
 			FileAnalyserList	fFileAnalyserQueue;
 			CatchUpAnalyserList	fCatchUpAnalyserList;
@@ -13,6 +13,8 @@
 #include <Path.h>
 #include <String.h>
 
+#include "IndexServerPrivate.h"
+
 
 VolumeObserverHandler::VolumeObserverHandler(IndexServer* indexServer)
 	:
@@ -116,7 +118,22 @@ IndexServer::ReadyToRun()
 void
 IndexServer::MessageReceived(BMessage *message)
 {
-	BApplication::MessageReceived(message);
+	switch (message->what) {
+		case kGetCatchUpStatus:
+		{
+			BMessage reply(B_REPLY);
+			for (int i = 0; i < fVolumeWatcherList.CountItems(); i++) {
+				BMessage status;
+				fVolumeWatcherList.ItemAt(i)->GetCatchUpStatus(status);
+				reply.AddMessage("status", &status);
+			}
+			message->SendReply(&reply);
+			break;
+		}
+
+		default:
+			BApplication::MessageReceived(message);
+	}
 }
 
 
@@ -430,6 +430,7 @@ VolumeWatcher::VolumeWatcher(const BVolume& volume)
 	fCatchUpManager(volume)
 {
 	AddHandler(&fWatchNameHandler);
+	AddHandler(&fCatchUpManager);
 
 	fVolumeWorker = new VolumeWorker(this);
 	fVolumeWorker->Run();
@@ -536,6 +537,13 @@ VolumeWatcher::FindEntryRef(ino_t node, dev_t device, entry_ref& entry)
 }
 
 
+void
+VolumeWatcher::GetCatchUpStatus(BMessage& message)
+{
+	fCatchUpManager.GetStatus(message);
+}
+
+
 void
 VolumeWatcher::_NewEntriesArrived()
 {
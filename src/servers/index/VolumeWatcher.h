@@ -140,6 +140,9 @@ public:
 			bool				FindEntryRef(ino_t node, dev_t device,
 									entry_ref& entry);
 
+			//! thread safe
+			void				GetCatchUpStatus(BMessage& message);
+
 private:
 	friend class WatchNameHandler;
 
@@ -33,7 +33,8 @@
 // This is the kernel-side implementation of the system profiling support.
 // A userland team can register as system profiler, providing an area as buffer
 // for events. Those events are team, thread, and image changes (added/removed),
-// periodic sampling of the return address stack for each CPU, as well as
+// periodic sampling of the return address stack for each CPU, the stacks of
+// threads when they start waiting (for off-CPU profiling), as well as
 // scheduling and I/O scheduling events.
 
 
@@ -286,7 +287,8 @@ SystemProfiler::SystemProfiler(team_id team, const area_info& userAreaInfo,
 	memset(fReentered, 0, sizeof(fReentered));
 
 	// compute the number wait objects we want to cache
-	if ((fFlags & B_SYSTEM_PROFILER_SCHEDULING_EVENTS) != 0) {
+	if ((fFlags & (B_SYSTEM_PROFILER_SCHEDULING_EVENTS
+			| B_SYSTEM_PROFILER_WAIT_EVENTS)) != 0) {
 		fWaitObjectCount = parameters.locking_lookup_size
 			/ (sizeof(WaitObject) + (sizeof(void*) * 3 / 2));
 		if (fWaitObjectCount < MIN_WAIT_OBJECT_COUNT)
@@ -504,7 +506,8 @@ SystemProfiler::Init()
 	fProfilingActive = true;
 
 	// start scheduler and wait object listening
-	if ((fFlags & B_SYSTEM_PROFILER_SCHEDULING_EVENTS) != 0) {
+	if ((fFlags & (B_SYSTEM_PROFILER_SCHEDULING_EVENTS
+			| B_SYSTEM_PROFILER_WAIT_EVENTS)) != 0) {
 		scheduler_add_listener(this);
 		fSchedulerNotificationsRequested = true;
 
@@ -512,7 +515,9 @@ SystemProfiler::Init()
 		add_wait_object_listener(this);
 		fWaitObjectNotificationsRequested = true;
 		waitObjectLocker.Unlock();
+	}
 
+	if ((fFlags & B_SYSTEM_PROFILER_SCHEDULING_EVENTS) != 0) {
 		// fake schedule events for the initially running threads
 		int32 cpuCount = smp_get_num_cpus();
 		for (int32 i = 0; i < cpuCount; i++) {
@@ -742,6 +747,8 @@ SystemProfiler::EventOccurred(NotificationService& service,
 void
 SystemProfiler::ThreadEnqueuedInRunQueue(Thread* thread)
 {
+	// This event is also needed for wait events, since it marks the end of
+	// the wait.
 	int cpu = smp_get_current_cpu();
 
 	InterruptsSpinLocker locker(fLock, false, !fReentered[cpu]);
@@ -773,6 +780,9 @@ SystemProfiler::ThreadEnqueuedInRunQueue(Thread* thread)
 void
 SystemProfiler::ThreadRemovedFromRunQueue(Thread* thread)
 {
+	if ((fFlags & B_SYSTEM_PROFILER_SCHEDULING_EVENTS) == 0)
+		return;
+
 	int cpu = smp_get_current_cpu();
 
 	InterruptsSpinLocker locker(fLock, false, !fReentered[cpu]);
@@ -801,13 +811,45 @@ SystemProfiler::ThreadScheduled(Thread* oldThread, Thread* newThread)
 {
 	int cpu = smp_get_current_cpu();
 
+	// We are still running on the old thread's stack, so if it starts
+	// waiting, this is the time to get its stack trace.
+	bool waiting = oldThread->state == B_THREAD_WAITING;
+	int32 stackDepth = 0;
+	if (waiting && (fFlags & B_SYSTEM_PROFILER_WAIT_EVENTS) != 0
+		&& oldThread != newThread && oldThread->team->id != fTeam) {
+		stackDepth = arch_debug_get_stack_trace(fCPUData[cpu].buffer,
+			fStackDepth, 0, 0, STACK_TRACE_KERNEL | STACK_TRACE_USER);
+	}
+
 	InterruptsSpinLocker locker(fLock, false, !fReentered[cpu]);
 		// When re-entering, we already hold the lock.
 
 	// If the old thread starts waiting, handle the wait object.
-	if (oldThread->state == B_THREAD_WAITING)
+	if (waiting)
 		_WaitObjectUsed((addr_t)oldThread->wait.object, oldThread->wait.type);
 
+	if (stackDepth > 0) {
+		system_profiler_thread_waiting* event
+			= (system_profiler_thread_waiting*)_AllocateBuffer(
+				sizeof(system_profiler_thread_waiting)
+					+ stackDepth * sizeof(addr_t),
+				B_SYSTEM_PROFILER_THREAD_WAITING, cpu, 0);
+		if (event != NULL) {
+			event->time = system_time_nsecs();
+			event->thread = oldThread->id;
+			event->wait_object_type = oldThread->wait.type;
+			event->wait_object = (addr_t)oldThread->wait.object;
+			memcpy(event->samples, fCPUData[cpu].buffer,
+				stackDepth * sizeof(addr_t));
+		}
+	}
+
+	if ((fFlags & B_SYSTEM_PROFILER_SCHEDULING_EVENTS) == 0) {
+		fHeader->size = fBufferSize;
+		_MaybeNotifyProfilerThreadLocked();
+		return;
+	}
+
 	system_profiler_thread_scheduled* event
 		= (system_profiler_thread_scheduled*)
 			_AllocateBuffer(sizeof(system_profiler_thread_scheduled),
@@ -1565,7 +1607,8 @@ _user_system_profiler_start(struct system_profiler_parameters* userParameters)
 	if (areaInfo.team != team)
 		return B_BAD_VALUE;
 
-	if ((parameters.flags & B_SYSTEM_PROFILER_SAMPLING_EVENTS) != 0) {
+	if ((parameters.flags & (B_SYSTEM_PROFILER_SAMPLING_EVENTS
+			| B_SYSTEM_PROFILER_WAIT_EVENTS)) != 0) {
 		if (parameters.stack_depth < 1)
 			return B_BAD_VALUE;
 
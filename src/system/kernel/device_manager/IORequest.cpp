@@ -1084,6 +1084,23 @@ IORequest::SetUnfinished()
 }
 
 
+/*!	Lets the request fail with \a status, unless it has already failed or
+	finished. The request is still finished as usual, once its pending
+	operations are done; it must not get any new ones.
+*/
+void
+IORequest::Abort(status_t status)
+{
+	MutexLocker _(fLock);
+
+	if (fStatus != 1)
+		return;
+
+	fStatus = status;
+	fPartialTransfer = true;
+}
+
+
 void
 IORequest::SetTransferredBytes(bool partialTransfer,
 	generic_size_t transferredBytes)
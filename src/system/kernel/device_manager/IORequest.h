@@ -263,6 +263,7 @@ struct IORequest : IORequestChunk, DoublyLinkedListLinkImpl<IORequest> {
 									status_t status, bool partialTransfer,
 									generic_size_t transferEndOffset);
 			void				SetUnfinished();
+			void				Abort(status_t status);
 
 			generic_size_t		RemainingBytes() const
 									{ return fRemainingBytes; }
@@ -0,0 +1,706 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "IOSchedulerMultiQueue.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <smp.h>
+#include <util/AutoLock.h>
+
+#include "IOSchedulerRoster.h"
+
+
+//#define TRACE_IO_SCHEDULER
+#ifdef TRACE_IO_SCHEDULER
+#	define TRACE(x...) dprintf(x)
+#else
+#	define TRACE(x...) ;
+#endif
+
+
+static const uint32 kOperationsPerQueue = 32;
+	// used when there is no DMA resource
+
+
+struct IOSchedulerMultiQueue::CompletionDPC : DPCCallback {
+	Queue*				queue;
+
+	virtual	void		DoDPC(DPCQueue* dpcQueue);
+};
+
+
+/*!	The request owner part keeps the requests of this queue: "requests" are
+	still being translated, "completed_requests" have been translated
+	completely but still have operations in flight, and "operations" are
+	unfinished operations that have to be passed to the driver again.
+	"aborted_requests" are done, but have not been notified yet, and
+	"deferred_requests" are done and have callbacks, so that they are left
+	to the DPC thread to notify.
+	These, as well as "unused_operations", are protected by "lock".
+	The completion members are protected by "completion_lock", as they are
+	also accessed in interrupt context.
+*/
+struct IOSchedulerMultiQueue::Queue : IORequestOwner {
+	IOSchedulerMultiQueue*	scheduler;
+	uint32					index;
+
+	mutex					lock;
+	IORequestList			aborted_requests;
+	IORequestList			deferred_requests;
+	IOOperationList			unused_operations;
+	IOOperation**			allocated_operations;
+	uint32					operation_count;
+	int32					stalled;
+
+	spinlock				completion_lock;
+	IOOperationList			completed_operations;
+	int32					workers;
+	bool					dpc_scheduled;
+
+	CompletionDPC			completion_dpc;
+	DPCQueue				dpc_queue;
+};
+
+
+void
+IOSchedulerMultiQueue::CompletionDPC::DoDPC(DPCQueue* dpcQueue)
+{
+	{
+		InterruptsSpinLocker locker(queue->completion_lock);
+		queue->dpc_scheduled = false;
+	}
+
+	queue->scheduler->_Run(queue, RUN_SUBMIT | RUN_CALLBACKS);
+}
+
+
+// #pragma mark -
+
+
+IOSchedulerMultiQueue::IOSchedulerMultiQueue(DMAResource* resource,
+	uint32 queueCount)
+	:
+	IOScheduler(resource),
+	fQueueCount(queueCount > 0 ? queueCount : 1),
+	fQueues(NULL),
+	fQueueCallback(NULL),
+	fQueueCallbackData(NULL),
+	fStalledQueueCount(0),
+	fRecycleCount(0)
+{
+}
+
+
+IOSchedulerMultiQueue::~IOSchedulerMultiQueue()
+{
+	if (fQueues == NULL)
+		return;
+
+	for (uint32 i = 0; i < fQueueCount; i++) {
+		Queue& queue = fQueues[i];
+		queue.dpc_queue.Close(false);
+
+		mutex_lock(&queue.lock);
+		mutex_destroy(&queue.lock);
+
+		if (queue.allocated_operations != NULL) {
+			for (uint32 j = 0; j < queue.operation_count; j++)
+				delete queue.allocated_operations[j];
+			delete[] queue.allocated_operations;
+		}
+	}
+
+	delete[] fQueues;
+}
+
+
+status_t
+IOSchedulerMultiQueue::Init(const char* name)
+{
+	status_t error = IOScheduler::Init(name);
+	if (error != B_OK)
+		return error;
+
+	fQueues = new(std::nothrow) Queue[fQueueCount];
+	if (fQueues == NULL)
+		return B_NO_MEMORY;
+
+	// Every queue may use all of the DMA buffers; the DMA resource decides
+	// who gets them.
+	uint32 operationCount = fDMAResource != NULL
+		? fDMAResource->BufferCount() : kOperationsPerQueue;
+
+	for (uint32 i = 0; i < fQueueCount; i++) {
+		Queue& queue = fQueues[i];
+		queue.team = -1;
+		queue.thread = -1;
+		queue.priority = B_IDLE_PRIORITY;
+		queue.hash_link = NULL;
+		queue.scheduler = this;
+		queue.index = i;
+		mutex_init(&queue.lock, "I/O queue");
+		queue.operation_count = 0;
+		queue.stalled = 0;
+		B_INITIALIZE_SPINLOCK(&queue.completion_lock);
+		queue.workers = 0;
+		queue.dpc_scheduled = false;
+		queue.completion_dpc.queue = &queue;
+		queue.allocated_operations = NULL;
+	}
+
+	for (uint32 i = 0; i < fQueueCount; i++) {
+		Queue& queue = fQueues[i];
+		queue.allocated_operations
+			= new(std::nothrow) IOOperation*[operationCount];
+		if (queue.allocated_operations == NULL)
+			return B_NO_MEMORY;
+
+		for (; queue.operation_count < operationCount;
+				queue.operation_count++) {
+			IOOperation* operation = new(std::nothrow) IOOperation;
+			if (operation == NULL)
+				return B_NO_MEMORY;
+
+			queue.allocated_operations[queue.operation_count] = operation;
+			queue.unused_operations.Add(operation);
+		}
+
+		char buffer[B_OS_NAME_LENGTH];
+		snprintf(buffer, sizeof(buffer), "%s completion %" B_PRId32 "/%"
+			B_PRIu32, name, fID, i);
+		error = queue.dpc_queue.Init(buffer, B_NORMAL_PRIORITY + 2, 0);
+		if (error != B_OK)
+			return error;
+	}
+
+	return B_OK;
+}
+
+
+/*!	Sets a callback that is told which of the device's queues an operation
+	has to be submitted to. It replaces any callback set via SetCallback().
+*/
+void
+IOSchedulerMultiQueue::SetQueueCallback(io_queue_callback callback,
+	void* data)
+{
+	fQueueCallback = callback;
+	fQueueCallbackData = data;
+}
+
+
+status_t
+IOSchedulerMultiQueue::ScheduleRequest(IORequest* request)
+{
+	TRACE("%p->IOSchedulerMultiQueue::ScheduleRequest(%p)\n", this, request);
+
+	IOBuffer* buffer = request->Buffer();
+	if (buffer->IsVirtual()) {
+		status_t status = buffer->LockMemory(request->TeamID(),
+			request->IsWrite());
+		if (status != B_OK) {
+			request->SetStatusAndNotify(status);
+			return status;
+		}
+	}
+
+	// It does not matter if we are moved to another CPU from here on; the
+	// queue is only a hint to spread the load.
+	Queue* queue = &fQueues[smp_get_current_cpu() % fQueueCount];
+
+	MutexLocker locker(queue->lock);
+	request->SetOwner(queue);
+	queue->requests.Add(request);
+	locker.Unlock();
+
+	IOSchedulerRoster::Default()->Notify(IO_SCHEDULER_REQUEST_SCHEDULED, this,
+		request);
+
+	_Run(queue, RUN_SUBMIT);
+	return B_OK;
+}
+
+
+/*!	Lets \a request fail with \a status. Operations that have not been
+	passed to the driver yet are finished right away; the request is
+	finished as soon as those the driver already has are done.
+*/
+void
+IOSchedulerMultiQueue::AbortRequest(IORequest* request, status_t status)
+{
+	Queue* queue = _QueueFor(request);
+	if (queue == NULL)
+		return;
+
+	MutexLocker locker(queue->lock);
+	if (request->Owner() != queue)
+		return;
+
+	_AbortRequest(queue, request, status);
+	locker.Unlock();
+
+	_NotifyAborted(queue, 0);
+}
+
+
+void
+IOSchedulerMultiQueue::OperationCompleted(IOOperation* operation,
+	status_t status, generic_size_t transferredBytes)
+{
+	Queue* queue = static_cast<Queue*>(operation->Parent()->Owner());
+	bool threadContext = are_interrupts_enabled();
+
+	InterruptsSpinLocker locker(queue->completion_lock);
+
+	// finish operation only once
+	if (operation->Status() <= 0)
+		return;
+
+	operation->SetStatus(status);
+
+	// set the bytes transferred (of the net data)
+	generic_size_t partialBegin
+		= operation->OriginalOffset() - operation->Offset();
+	operation->SetTransferredBytes(
+		transferredBytes > partialBegin ? transferredBytes - partialBegin : 0);
+
+	queue->completed_operations.Add(operation);
+
+	// If a thread is working on this queue, it will pick up the operation
+	// before it leaves.
+	if (queue->workers > 0)
+		return;
+
+	if (!threadContext) {
+		_ScheduleDPC(queue);
+		return;
+	}
+
+	// We are called by a thread of the driver, and may finish the operation
+	// right here. We don't pass new operations to the driver from here,
+	// though, as it might hold locks it would need for them.
+	locker.Unlock();
+	_Run(queue, 0);
+}
+
+
+void
+IOSchedulerMultiQueue::Dump() const
+{
+	kprintf("IOSchedulerMultiQueue at %p\n", this);
+	kprintf("  DMA resource:   %p\n", fDMAResource);
+	kprintf("  queues:         %" B_PRIu32 "\n", fQueueCount);
+	kprintf("  stalled queues: %" B_PRId32 "\n", fStalledQueueCount);
+
+	for (uint32 i = 0; i < fQueueCount; i++) {
+		const Queue& queue = fQueues[i];
+		kprintf("  queue %" B_PRIu32 ": owner %p, workers %" B_PRId32
+			", stalled %" B_PRId32 ", DPC %s\n", i, &queue, queue.workers,
+			queue.stalled, queue.dpc_scheduled ? "scheduled" : "idle");
+	}
+}
+
+
+/*!	Collects operations for all requests of the queue, as far as there are
+	unused operations and DMA buffers left.
+	Must be called with the queue's lock held.
+	Returns \c false, if some requests could not be translated completely.
+*/
+bool
+IOSchedulerMultiQueue::_PrepareOperations(Queue* queue,
+	IOOperationList& operations)
+{
+	// unfinished operations go first
+	operations.MoveFrom(&queue->operations);
+
+	while (IORequest* request = queue->requests.Head()) {
+		if (!_PrepareRequestOperations(queue, request, operations))
+			return false;
+
+		// the request has been translated completely, so we don't need to
+		// look at it again; if it has been aborted, it is gone already
+		if (queue->requests.Head() == request) {
+			queue->requests.Remove(request);
+			queue->completed_requests.Add(request);
+		}
+	}
+
+	return true;
+}
+
+
+bool
+IOSchedulerMultiQueue::_PrepareRequestOperations(Queue* queue,
+	IORequest* request, IOOperationList& operations)
+{
+	if (fDMAResource == NULL) {
+		// the request may be looked at again while its operation is pending
+		if (request->RemainingBytes() == 0 || request->Status() <= 0)
+			return true;
+
+		// TODO: If the device has block size restrictions, we might need to
+		// use a bounce buffer.
+		IOOperation* operation = queue->unused_operations.RemoveHead();
+		if (operation == NULL)
+			return false;
+
+		status_t status = operation->Prepare(request);
+		if (status != B_OK) {
+			operation->SetParent(NULL);
+			queue->unused_operations.Add(operation);
+			_AbortRequest(queue, request, status);
+			return true;
+		}
+
+		operation->SetOriginalRange(request->Offset(), request->Length());
+		request->Advance(request->Length());
+
+		operations.Add(operation);
+		return true;
+	}
+
+	while (request->RemainingBytes() > 0 && request->Status() > 0) {
+		IOOperation* operation = queue->unused_operations.RemoveHead();
+		if (operation == NULL)
+			return false;
+
+		int32 recycleCount = atomic_get(&fRecycleCount);
+
+		status_t status = fDMAResource->TranslateNext(request, operation, 0);
+		if (status != B_OK) {
+			operation->SetParent(NULL);
+			queue->unused_operations.Add(operation);
+
+			if (status != B_BUSY) {
+				_AbortRequest(queue, request, status);
+				return true;
+			}
+
+			// The DMA buffers are in use, maybe by another queue. If none
+			// has been returned since we looked, wait until one is.
+			if (atomic_get(&fRecycleCount) != recycleCount)
+				continue;
+
+			if (atomic_get_and_set(&queue->stalled, 1) == 0)
+				atomic_add(&fStalledQueueCount, 1);
+			return false;
+		}
+
+		operations.Add(operation);
+	}
+
+	return true;
+}
+
+
+/*!	Returns the queue that owns \a request, or \c NULL, if it doesn't
+	belong to any of our queues.
+*/
+IOSchedulerMultiQueue::Queue*
+IOSchedulerMultiQueue::_QueueFor(IORequest* request) const
+{
+	IORequestOwner* owner = request->Owner();
+	for (uint32 i = 0; i < fQueueCount; i++) {
+		if (owner == &fQueues[i])
+			return &fQueues[i];
+	}
+
+	return NULL;
+}
+
+
+/*!	Must be called with the queue's lock held. The request is notified by
+	_NotifyAborted(), if it doesn't have any operations left.
+*/
+void
+IOSchedulerMultiQueue::_AbortRequest(Queue* queue, IORequest* request,
+	status_t status)
+{
+	TRACE("IOSchedulerMultiQueue::_AbortRequest(%p, %s)\n", request,
+		strerror(status));
+
+	request->Abort(status);
+
+	// operations that wait for their next phase don't get it anymore
+	IOOperationList abortedOperations;
+	IOOperationList::Iterator iterator = queue->operations.GetIterator();
+	while (IOOperation* operation = iterator.Next()) {
+		if (operation->Parent() != request)
+			continue;
+
+		iterator.Remove();
+		operation->SetStatus(status);
+		operation->SetTransferredBytes(0);
+		abortedOperations.Add(operation);
+	}
+
+	// don't translate the rest of it
+	if (queue->requests.Contains(request)) {
+		queue->requests.Remove(request);
+		queue->completed_requests.Add(request);
+	}
+
+	if (!abortedOperations.IsEmpty()) {
+		InterruptsSpinLocker completionLocker(queue->completion_lock);
+		queue->completed_operations.MoveFrom(&abortedOperations);
+		if (queue->workers == 0)
+			_ScheduleDPC(queue);
+		return;
+	}
+
+	if (!request->IsFinished())
+		return;
+
+	queue->completed_requests.Remove(request);
+	request->SetOwner(NULL);
+	queue->aborted_requests.Add(request);
+}
+
+
+/*!	Notifies the requests that have been finished by _AbortRequest().
+	Must be called without the queue's lock held.
+*/
+void
+IOSchedulerMultiQueue::_NotifyAborted(Queue* queue, uint32 flags)
+{
+	IORequestList requests;
+	{
+		MutexLocker locker(queue->lock);
+		requests.MoveFrom(&queue->aborted_requests);
+	}
+
+	while (IORequest* request = requests.RemoveHead())
+		_NotifyFinished(queue, request, flags);
+}
+
+
+/*!	Notifies a finished request, unless it has callbacks and \a flags don't
+	allow calling them. Those may issue new I/O, so they are left to the
+	DPC thread, which doesn't hold any locks of the driver, and isn't in
+	the middle of passing operations to it.
+	Must be called without the queue's lock held.
+*/
+void
+IOSchedulerMultiQueue::_NotifyFinished(Queue* queue, IORequest* request,
+	uint32 flags)
+{
+	if ((flags & RUN_CALLBACKS) == 0 && request->HasCallbacks()) {
+		MutexLocker locker(queue->lock);
+		queue->deferred_requests.Add(request);
+		locker.Unlock();
+
+		InterruptsSpinLocker completionLocker(queue->completion_lock);
+		_ScheduleDPC(queue);
+		return;
+	}
+
+	IOSchedulerRoster::Default()->Notify(IO_SCHEDULER_REQUEST_FINISHED,
+		this, request);
+	request->NotifyFinished();
+}
+
+
+/*!	Notifies the requests with callbacks that other threads have left to
+	the DPC thread.
+*/
+void
+IOSchedulerMultiQueue::_NotifyDeferred(Queue* queue)
+{
+	IORequestList requests;
+	{
+		MutexLocker locker(queue->lock);
+		requests.MoveFrom(&queue->deferred_requests);
+	}
+
+	while (IORequest* request = requests.RemoveHead())
+		_NotifyFinished(queue, request, RUN_CALLBACKS);
+}
+
+
+/*!	Finishes the completed operations of the queue.
+	Returns whether or not there were any.
+*/
+bool
+IOSchedulerMultiQueue::_Finish(Queue* queue, uint32 flags)
+{
+	bool finishedAny = false;
+	bool recycledBuffers = false;
+
+	while (true) {
+		InterruptsSpinLocker completionLocker(queue->completion_lock);
+		IOOperation* operation = queue->completed_operations.RemoveHead();
+		if (operation == NULL)
+			break;
+
+		completionLocker.Unlock();
+		finishedAny = true;
+
+		TRACE("IOSchedulerMultiQueue::_Finish(): operation: %p\n", operation);
+
+		if (!operation->Finish()) {
+			// the operation has another phase, pass it to the driver again
+			TRACE("  operation: %p not finished yet\n", operation);
+			MutexLocker _(queue->lock);
+			operation->SetTransferredBytes(0);
+			queue->operations.Add(operation);
+			continue;
+		}
+
+		// All bookkeeping of the request happens with the queue locked, so
+		// that only one thread can see it finished.
+		MutexLocker locker(queue->lock);
+
+		IORequest* request = operation->Parent();
+		generic_size_t operationOffset
+			= operation->OriginalOffset() - request->Offset();
+		request->OperationFinished(operation, operation->Status(),
+			operation->TransferredBytes() < operation->OriginalLength(),
+			operation->Status() == B_OK
+				? operationOffset + operation->OriginalLength()
+				: operationOffset);
+
+		// recycle the operation
+		if (fDMAResource != NULL) {
+			fDMAResource->RecycleBuffer(operation->Buffer());
+			atomic_add(&fRecycleCount, 1);
+			recycledBuffers = true;
+		}
+		queue->unused_operations.Add(operation);
+
+		if (!request->IsFinished())
+			continue;
+
+		if (request->Status() == B_OK && request->RemainingBytes() > 0) {
+			// The request has been processed OK so far, but it isn't really
+			// finished yet.
+			request->SetUnfinished();
+			continue;
+		}
+
+		queue->requests.MoveFrom(&queue->completed_requests);
+		queue->requests.Remove(request);
+		request->SetOwner(NULL);
+
+		locker.Unlock();
+
+		_NotifyFinished(queue, request, flags);
+	}
+
+	if (recycledBuffers)
+		_WakeStalledQueues();
+
+	return finishedAny;
+}
+
+
+/*!	Passes all pending operations of the queue to the driver, and finishes
+	those that have been completed, until there is nothing left to do.
+	This is done by the thread that scheduled a request, as well as by the
+	queue's DPC thread. A driver thread that completes an operation only
+	finishes operations, and leaves the rest to the DPC thread. Only the
+	DPC thread notifies requests with callbacks.
+*/
+void
+IOSchedulerMultiQueue::_Run(Queue* queue, uint32 flags)
+{
+	bool submit = (flags & RUN_SUBMIT) != 0;
+
+	InterruptsSpinLocker completionLocker(queue->completion_lock);
+	queue->workers++;
+	completionLocker.Unlock();
+
+	while (true) {
+		IOOperationList operations;
+		if (submit) {
+			MutexLocker locker(queue->lock);
+			if (_PrepareOperations(queue, operations)
+				&& atomic_get_and_set(&queue->stalled, 0) != 0) {
+				atomic_add(&fStalledQueueCount, -1);
+			}
+			bool aborted = !queue->aborted_requests.IsEmpty();
+			bool deferred = (flags & RUN_CALLBACKS) != 0
+				&& !queue->deferred_requests.IsEmpty();
+			locker.Unlock();
+
+			if (aborted)
+				_NotifyAborted(queue, flags);
+			if (deferred)
+				_NotifyDeferred(queue);
+		}
+
+		while (IOOperation* operation = operations.RemoveHead()) {
+			TRACE("IOSchedulerMultiQueue::_Run(): queue %" B_PRIu32
+				", operation %p\n", queue->index, operation);
+
+			if (fQueueCallback != NULL)
+				fQueueCallback(fQueueCallbackData, operation, queue->index);
+			else
+				fIOCallback(fIOCallbackData, operation);
+		}
+
+		if (_Finish(queue, flags))
+			continue;
+
+		completionLocker.Lock();
+		if (queue->completed_operations.IsEmpty()) {
+			queue->workers--;
+			break;
+		}
+		completionLocker.Unlock();
+	}
+
+	if (submit)
+		return;
+
+	completionLocker.Unlock();
+
+	// Operations that have another phase, and requests that waited for
+	// unused operations still have to be passed to the driver.
+	MutexLocker locker(queue->lock);
+	bool pending = !queue->operations.IsEmpty()
+		|| !queue->requests.IsEmpty();
+	locker.Unlock();
+
+	if (pending) {
+		completionLocker.Lock();
+		_ScheduleDPC(queue);
+	}
+}
+
+
+/*!	Must be called with the queue's completion lock held. */
+void
+IOSchedulerMultiQueue::_ScheduleDPC(Queue* queue)
+{
+	if (queue->dpc_scheduled)
+		return;
+
+	queue->dpc_scheduled = true;
+	queue->dpc_queue.Add(&queue->completion_dpc);
+}
+
+
+/*!	Lets the queues that ran out of DMA buffers try again. */
+void
+IOSchedulerMultiQueue::_WakeStalledQueues()
+{
+	if (atomic_get(&fStalledQueueCount) == 0)
+		return;
+
+	for (uint32 i = 0; i < fQueueCount; i++) {
+		Queue* queue = &fQueues[i];
+		if (atomic_get_and_set(&queue->stalled, 0) == 0)
+			continue;
+
+		atomic_add(&fStalledQueueCount, -1);
+
+		InterruptsSpinLocker locker(queue->completion_lock);
+		_ScheduleDPC(queue);
+	}
+}
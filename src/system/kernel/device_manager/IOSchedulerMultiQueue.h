@@ -0,0 +1,97 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef IO_SCHEDULER_MULTI_QUEUE_H
+#define IO_SCHEDULER_MULTI_QUEUE_H
+
+
+#include <KernelExport.h>
+
+#include <DPC.h>
+#include <lock.h>
+
+#include "dma_resources.h"
+#include "IOScheduler.h"
+
+
+typedef status_t (*io_queue_callback)(void* data, io_operation* operation,
+	uint32 queue);
+
+
+/*!	An I/O scheduler for devices with several hardware submission queues,
+	like NVMe or multi-queue virtio-blk.
+
+	There is no scheduler thread: requests are translated and passed to the
+	driver on the CPU that issued them, using the queue that belongs to that
+	CPU. Operations that the driver completes right away are finished by
+	the issuing thread as well. Operations the driver completes in a thread
+	of its own are finished by that thread. Only those completed in
+	interrupt context are finished by the queue's DPC thread, since
+	finishing them may copy from bounce buffers, and takes the request's
+	mutex. Requests with callbacks are always notified by the DPC thread,
+	as the callbacks may issue new I/O. The queues share nothing but the
+	DMAResource.
+*/
+class IOSchedulerMultiQueue : public IOScheduler {
+public:
+								IOSchedulerMultiQueue(DMAResource* resource,
+									uint32 queueCount);
+	virtual						~IOSchedulerMultiQueue();
+
+	virtual	status_t			Init(const char* name);
+
+			uint32				CountQueues() const	{ return fQueueCount; }
+			void				SetQueueCallback(io_queue_callback callback,
+									void* data);
+
+	virtual	status_t			ScheduleRequest(IORequest* request);
+
+	virtual	void				AbortRequest(IORequest* request,
+									status_t status = B_CANCELED);
+	virtual	void				OperationCompleted(IOOperation* operation,
+									status_t status,
+									generic_size_t transferredBytes);
+									// may be called in interrupt context
+
+	virtual	void				Dump() const;
+
+private:
+			struct Queue;
+			struct CompletionDPC;
+
+			enum {
+				RUN_SUBMIT		= 0x01,
+					// pass pending operations to the driver
+				RUN_CALLBACKS	= 0x02
+					// notify requests with callbacks directly
+			};
+
+			bool				_PrepareOperations(Queue* queue,
+									IOOperationList& operations);
+			bool				_PrepareRequestOperations(Queue* queue,
+									IORequest* request,
+									IOOperationList& operations);
+			Queue*				_QueueFor(IORequest* request) const;
+			void				_AbortRequest(Queue* queue,
+									IORequest* request, status_t status);
+			void				_NotifyAborted(Queue* queue, uint32 flags);
+			void				_NotifyFinished(Queue* queue,
+									IORequest* request, uint32 flags);
+			void				_NotifyDeferred(Queue* queue);
+			bool				_Finish(Queue* queue, uint32 flags);
+			void				_Run(Queue* queue, uint32 flags);
+			void				_ScheduleDPC(Queue* queue);
+			void				_WakeStalledQueues();
+
+private:
+			uint32				fQueueCount;
+			Queue*				fQueues;
+			io_queue_callback	fQueueCallback;
+			void*				fQueueCallbackData;
+			int32				fStalledQueueCount;
+			int32				fRecycleCount;
+};
+
+
+#endif	// IO_SCHEDULER_MULTI_QUEUE_H
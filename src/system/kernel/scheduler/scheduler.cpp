@@ -217,6 +217,68 @@ scheduler_set_thread_priority(Thread *thread, int32 priority)
 }
 
 
+void
+scheduler_set_thread_cpu_mask(Thread* thread, const CPUSet& mask)
+{
+	ASSERT(are_interrupts_enabled());
+
+	InterruptsSpinLocker _(thread->scheduler_lock);
+	SchedulerModeLocker modeLocker;
+
+	SCHEDULER_ENTER_FUNCTION();
+
+	ThreadData* threadData = thread->scheduler_data;
+	threadData->SetCPUMask(mask);
+
+	if (thread->state == B_THREAD_RUNNING) {
+		ASSERT(thread->cpu != NULL);
+		int32 cpu = thread->cpu->cpu_num;
+		if (threadData->IsCPUAllowed(cpu))
+			return;
+
+		if (cpu == smp_get_current_cpu())
+			gCPU[cpu].invoke_scheduler = true;
+		else {
+			smp_send_ici(cpu, SMP_MSG_RESCHEDULE, 0, 0, 0, NULL,
+				SMP_MSG_FLAG_ASYNC);
+		}
+		return;
+	}
+
+	if (thread->state != B_THREAD_READY)
+		return;
+
+	// The thread is in the run queue. Move it to the one of a CPU it may
+	// run on.
+
+	T(RemoveThread(thread));
+
+	// notify listeners
+	NotifySchedulerListeners(&SchedulerListener::ThreadRemovedFromRunQueue,
+		thread);
+
+	if (threadData->Dequeue())
+		enqueue(thread, false);
+}
+
+
+void
+scheduler_get_thread_cpu_mask(Thread* thread, CPUSet& mask)
+{
+	InterruptsSpinLocker _(thread->scheduler_lock);
+
+	ThreadData* threadData = thread->scheduler_data;
+	if (threadData->HasCPUMask())
+		mask = threadData->GetCPUMask();
+	else {
+		mask.ClearAll();
+		int32 cpuCount = smp_get_num_cpus();
+		for (int32 i = 0; i < cpuCount; i++)
+			mask.SetBit(i);
+	}
+}
+
+
 void
 scheduler_reschedule_ici()
 {
@@ -374,6 +436,12 @@ reschedule(int32 nextState)
 
 	oldThread->has_yielded = false;
 
+	// If the CPU mask of the old thread has changed, so that it may no longer
+	// run here, it has to move to another CPU.
+	bool oldThreadAllowed = oldThreadData->IsCPUAllowed(thisCPU);
+	if (enqueueOldThread && !oldThreadAllowed)
+		putOldThreadAtBack = true;
+
 	// select thread with the biggest priority and enqueue back the old thread
 	ThreadData* nextThreadData;
 	if (gCPU[thisCPU].disabled) {
@@ -387,9 +455,9 @@ reschedule(int32 nextState)
 		} else
 			nextThreadData = oldThreadData;
 	} else {
-		nextThreadData
-			= cpu->ChooseNextThread(enqueueOldThread ? oldThreadData : NULL,
-				putOldThreadAtBack);
+		nextThreadData = cpu->ChooseNextThread(
+			enqueueOldThread && oldThreadAllowed ? oldThreadData : NULL,
+			putOldThreadAtBack);
 
 		// update CPU heap
 		CoreCPUHeapLocker cpuLocker(core);
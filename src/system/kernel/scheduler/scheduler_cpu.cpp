@@ -232,8 +232,10 @@ CPUEntry::ChooseNextThread(ThreadData* oldThread, bool putAtBack)
 
 	CoreRunQueueLocker coreLocker(fCore);
 
-	ThreadData* sharedThread = fCore->PeekThread();
-	ASSERT(sharedThread != NULL || pinnedThread != NULL || oldThread != NULL);
+	ASSERT(fCore->PeekThread() != NULL || pinnedThread != NULL
+		|| oldThread != NULL);
+
+	ThreadData* sharedThread = fCore->PeekThread(fCPUNumber);
 
 	int32 sharedPriority = -1;
 	if (sharedThread != NULL)
@@ -444,6 +446,34 @@ CoreEntry::PushBack(ThreadData* thread, int32 priority)
 }
 
 
+/*!	Returns the thread with the highest priority in the core's run queue
+	that may run on \a cpu. A thread whose CPU mask covers only some of the
+	CPUs of this core is left to the CPUs it may run on, as long as one of
+	them is enabled, so that threads behind it are not held up.
+	The run queue must be locked.
+*/
+ThreadData*
+CoreEntry::PeekThread(int32 cpu) const
+{
+	SCHEDULER_ENTER_FUNCTION();
+
+	ThreadData* thread = fRunQueue.PeekMaximum();
+	if (thread == NULL || thread->IsCPUAllowed(cpu)
+		|| !thread->IsCoreAllowed(this)) {
+		return thread;
+	}
+
+	ThreadRunQueue::ConstIterator iterator = fRunQueue.GetConstIterator();
+	while (iterator.HasNext()) {
+		thread = iterator.Next();
+		if (thread->IsCPUAllowed(cpu) || !thread->IsCoreAllowed(this))
+			return thread;
+	}
+
+	return NULL;
+}
+
+
 void
 CoreEntry::Remove(ThreadData* thread)
 {
@@ -477,6 +507,7 @@ CoreEntry::AddCPU(CPUEntry* cpu)
 	}
 
 	fCPUHeap.Insert(cpu, B_IDLE_PRIORITY);
+	fCPUSet.SetBit(cpu->ID());
 }
 
 
@@ -487,6 +518,7 @@ CoreEntry::RemoveCPU(CPUEntry* cpu, ThreadProcessing& threadPostProcessing)
 	ASSERT(fIdleCPUCount > 0);
 
 	fIdleCPUCount--;
+	fCPUSet.ClearBit(cpu->ID());
 	if (--fCPUCount == 0) {
 		// unassign threads
 		thread_map(CoreEntry::_UnassignThread, this);
@@ -131,6 +131,8 @@ public:
 	inline				PackageEntry*	Package() const	{ return fPackage; }
 	inline				int32			CPUCount() const
 											{ return fCPUCount; }
+	inline				const CPUSet&	CPUMask() const
+											{ return fCPUSet; }
 
 	inline				void			LockCPUHeap();
 	inline				void			UnlockCPUHeap();
@@ -148,6 +150,7 @@ public:
 											int32 priority);
 						void			Remove(ThreadData* thread);
 	inline				ThreadData*		PeekThread() const;
+						ThreadData*		PeekThread(int32 cpu) const;
 
 	inline				bigtime_t		GetActiveTime() const;
 	inline				void			IncreaseActiveTime(
@@ -182,6 +185,7 @@ private:
 						PackageEntry*	fPackage;
 
 						int32			fCPUCount;
+						CPUSet			fCPUSet;
 						int32			fIdleCPUCount;
 						CPUPriorityHeap	fCPUHeap;
 						spinlock		fCPULock;
@@ -5,6 +5,8 @@
 
 #include "scheduler_thread.h"
 
+#include <team.h>
+
 
 using namespace Scheduler;
 
@@ -39,6 +41,9 @@ ThreadData::_InitBase()
 	fMeasureAvailableActiveTime = 0;
 	fLastMeasureAvailableTime = 0;
 	fMeasureAvailableTime = 0;
+
+	fCPUMask.ClearAll();
+	fHasCPUMask = false;
 }
 
 
@@ -48,7 +53,12 @@ ThreadData::_ChooseCore() const
 	SCHEDULER_ENTER_FUNCTION();
 
 	ASSERT(!gSingleCore);
-	return gCurrentMode->choose_core(this);
+	CoreEntry* core = gCurrentMode->choose_core(this);
+	if (IsCoreAllowed(core))
+		return core;
+
+	CoreEntry* allowedCore = _ChooseAllowedCore();
+	return allowedCore != NULL ? allowedCore : core;
 }
 
 
@@ -59,7 +69,8 @@ ThreadData::_ChooseCPU(CoreEntry* core, bool& rescheduleNeeded) const
 
 	int32 threadPriority = GetEffectivePriority();
 
-	if (fThread->previous_cpu != NULL) {
+	if (fThread->previous_cpu != NULL
+		&& IsCPUAllowed(fThread->previous_cpu->cpu_num)) {
 		CPUEntry* previousCPU
 			= CPUEntry::GetCPU(fThread->previous_cpu->cpu_num);
 		if (previousCPU->Core() == core && !fThread->previous_cpu->disabled) {
@@ -76,6 +87,24 @@ ThreadData::_ChooseCPU(CoreEntry* core, bool& rescheduleNeeded) const
 	CPUEntry* cpu = core->CPUHeap()->PeekRoot();
 	ASSERT(cpu != NULL);
 
+	if (!IsCPUAllowed(cpu->ID()) && IsCoreAllowed(core)) {
+		// find the least busy of the CPUs the thread may run on
+		CPUEntry* allowedCPU = NULL;
+		int32 cpuCount = smp_get_num_cpus();
+		for (int32 i = 0; i < cpuCount; i++) {
+			if (!IsCPUAllowed(i) || !core->CPUMask().GetBit(i))
+				continue;
+
+			CPUEntry* other = CPUEntry::GetCPU(i);
+			if (allowedCPU == NULL || CPUPriorityHeap::GetKey(other)
+					< CPUPriorityHeap::GetKey(allowedCPU)) {
+				allowedCPU = other;
+			}
+		}
+		ASSERT(allowedCPU != NULL);
+		cpu = allowedCPU;
+	}
+
 	if (CPUPriorityHeap::GetKey(cpu) < threadPriority) {
 		cpu->UpdatePriority(threadPriority);
 		rescheduleNeeded = true;
@@ -86,6 +115,28 @@ ThreadData::_ChooseCPU(CoreEntry* core, bool& rescheduleNeeded) const
 }
 
 
+/*!	Returns the least loaded of the enabled cores the thread may run on, or
+	\c NULL if none of the CPUs in its mask is enabled.
+*/
+CoreEntry*
+ThreadData::_ChooseAllowedCore() const
+{
+	SCHEDULER_ENTER_FUNCTION();
+
+	CoreEntry* chosen = NULL;
+	for (int32 i = 0; i < gCoreCount; i++) {
+		CoreEntry* core = &gCoreEntries[i];
+		if (core->CPUCount() == 0 || !IsCoreAllowed(core))
+			continue;
+
+		if (chosen == NULL || core->GetLoad() < chosen->GetLoad())
+			chosen = core;
+	}
+
+	return chosen;
+}
+
+
 ThreadData::ThreadData(Thread* thread)
 	:
 	fThread(thread)
@@ -103,6 +154,13 @@ ThreadData::Init()
 	ThreadData* currentThreadData = currentThread->scheduler_data;
 	fNeededLoad = currentThreadData->fNeededLoad;
 
+	// New threads inherit the CPU mask of their creator, unless they belong
+	// to the kernel.
+	if (fThread->team != team_get_kernel_team()) {
+		fCPUMask = currentThreadData->fCPUMask;
+		fHasCPUMask = currentThreadData->fHasCPUMask;
+	}
+
 	if (!IsRealTime()) {
 		fPriorityPenalty = std::min(currentThreadData->fPriorityPenalty,
 				std::max(GetPriority() - _GetMinimalPriority(), int32(0)));
@@ -144,11 +202,42 @@ ThreadData::Dump() const
 	kprintf("\twent_sleep_active:\t%" B_PRId64 "\n", fWentSleepActive);
 	kprintf("\tcore:\t\t\t%" B_PRId32 "\n",
 		fCore != NULL ? fCore->ID() : -1);
+	if (fHasCPUMask) {
+		kprintf("\tcpu_mask:\t\t");
+		int32 cpuCount = smp_get_num_cpus();
+		for (int32 i = 0; i < cpuCount; i++) {
+			if (fCPUMask.GetBit(i))
+				kprintf(" %" B_PRId32, i);
+		}
+		kprintf("\n");
+	}
 	if (fCore != NULL && HasCacheExpired())
 		kprintf("\tcache affinity has expired\n");
 }
 
 
+/*!	Restricts the thread to the CPUs in \a mask. A mask that contains all
+	CPUs, or none, removes the restriction.
+*/
+void
+ThreadData::SetCPUMask(const CPUSet& mask)
+{
+	fCPUMask = mask;
+	fHasCPUMask = false;
+
+	if (mask.IsEmpty())
+		return;
+
+	int32 cpuCount = smp_get_num_cpus();
+	for (int32 i = 0; i < cpuCount; i++) {
+		if (!mask.GetBit(i)) {
+			fHasCPUMask = true;
+			break;
+		}
+	}
+}
+
+
 bool
 ThreadData::ChooseCoreAndCPU(CoreEntry*& targetCore, CPUEntry*& targetCPU)
 {
@@ -28,6 +28,7 @@ private:
 	inline	CoreEntry*	_ChooseCore() const;
 	inline	CPUEntry*	_ChooseCPU(CoreEntry* core,
 							bool& rescheduleNeeded) const;
+			CoreEntry*	_ChooseAllowedCore() const;
 
 public:
 						ThreadData(Thread* thread);
@@ -46,6 +47,12 @@ public:
 	inline	bool		HasCacheExpired() const;
 	inline	CoreEntry*	Rebalance() const;
 
+			void		SetCPUMask(const CPUSet& mask);
+	inline	const CPUSet&	GetCPUMask() const	{ return fCPUMask; }
+	inline	bool		HasCPUMask() const	{ return fHasCPUMask; }
+	inline	bool		IsCPUAllowed(int32 cpu) const;
+	inline	bool		IsCoreAllowed(const CoreEntry* core) const;
+
 	inline	int32		GetEffectivePriority() const;
 
 	inline	void		StartCPUTime();
@@ -129,6 +136,9 @@ private:
 			uint32		fLoadMeasurementEpoch;
 
 			CoreEntry*	fCore;
+
+			CPUSet		fCPUMask;
+			bool		fHasCPUMask;
 };
 
 class ThreadProcessing {
@@ -182,7 +192,33 @@ ThreadData::Rebalance() const
 	SCHEDULER_ENTER_FUNCTION();
 
 	ASSERT(!gSingleCore);
-	return gCurrentMode->rebalance(this);
+	CoreEntry* core = gCurrentMode->rebalance(this);
+	if (IsCoreAllowed(core))
+		return core;
+	if (fCore != NULL && IsCoreAllowed(fCore))
+		return fCore;
+
+	CoreEntry* allowedCore = _ChooseAllowedCore();
+	return allowedCore != NULL ? allowedCore : core;
+}
+
+
+/*!	Returns whether the thread's CPU mask allows it to run on \a cpu.
+*/
+inline bool
+ThreadData::IsCPUAllowed(int32 cpu) const
+{
+	return !fHasCPUMask || fCPUMask.GetBit(cpu);
+}
+
+
+/*!	Returns whether the thread may run on one of the enabled CPUs of
+	\a core.
+*/
+inline bool
+ThreadData::IsCoreAllowed(const CoreEntry* core) const
+{
+	return !fHasCPUMask || fCPUMask.Matches(core->CPUMask());
 }
 
 
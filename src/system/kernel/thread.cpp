@@ -3299,6 +3299,29 @@ set_thread_priority(thread_id id, int32 priority)
 }
 
 
+static status_t
+thread_set_thread_cpu_mask(thread_id id, const CPUSet& mask, bool kernel)
+{
+	Thread* thread = Thread::GetAndLock(id);
+	if (thread == NULL)
+		return B_BAD_THREAD_ID;
+	BReference<Thread> threadReference(thread, true);
+	ThreadLocker threadLocker(thread, true);
+
+	// check whether the change is allowed
+	if (thread_is_idle_thread(thread) || !thread_check_permissions(
+			thread_get_current_thread(), thread, kernel))
+		return B_NOT_ALLOWED;
+
+	scheduler_set_thread_cpu_mask(thread, mask);
+	threadLocker.Unlock();
+
+	// if the current thread may no longer run on this CPU, move it now
+	scheduler_reschedule_if_necessary();
+	return B_OK;
+}
+
+
 status_t
 snooze_etc(bigtime_t timeout, int timebase, uint32 flags)
 {
@@ -3480,6 +3503,79 @@ _user_set_thread_priority(thread_id thread, int32 newPriority)
 }
 
 
+/*!	Restricts the thread to the CPUs in the bitmap \a userMask, which holds
+	the bit for CPU \c n in bit \c n % 32 of its \c n / 32 'th \c uint32.
+	CPUs the system doesn't have are ignored, but at least one existing CPU
+	must be given.
+*/
+status_t
+_user_set_thread_affinity(thread_id thread, const void* userMask, size_t size)
+{
+	uint32 bits[ROUNDUP(SMP_MAX_CPUS, 32) / 32];
+	if (size == 0 || size % sizeof(uint32) != 0)
+		return B_BAD_VALUE;
+	if (userMask == NULL || !IS_USER_ADDRESS(userMask))
+		return B_BAD_ADDRESS;
+
+	memset(bits, 0, sizeof(bits));
+	if (user_memcpy(bits, userMask, std::min(size, sizeof(bits))) != B_OK)
+		return B_BAD_ADDRESS;
+
+	CPUSet mask;
+	int32 cpuCount = smp_get_num_cpus();
+	for (int32 i = 0; i < cpuCount; i++) {
+		if ((bits[i / 32] & (1u << (i % 32))) != 0)
+			mask.SetBit(i);
+	}
+	if (mask.IsEmpty())
+		return B_BAD_VALUE;
+
+	if (thread == 0)
+		thread = thread_get_current_thread_id();
+
+	return thread_set_thread_cpu_mask(thread, mask, false);
+}
+
+
+/*!	Returns the CPUs the thread may run on, in the format of
+	_user_set_thread_affinity(). \a size must leave room for all CPUs of
+	the system.
+*/
+status_t
+_user_get_thread_affinity(thread_id id, void* userMask, size_t size)
+{
+	uint32 bits[ROUNDUP(SMP_MAX_CPUS, 32) / 32];
+	int32 cpuCount = smp_get_num_cpus();
+	if (size % sizeof(uint32) != 0
+		|| size < ROUNDUP(cpuCount, 32) / 32 * sizeof(uint32)) {
+		return B_BAD_VALUE;
+	}
+	if (userMask == NULL || !IS_USER_ADDRESS(userMask))
+		return B_BAD_ADDRESS;
+
+	if (id == 0)
+		id = thread_get_current_thread_id();
+
+	Thread* thread = Thread::Get(id);
+	if (thread == NULL)
+		return B_BAD_THREAD_ID;
+	BReference<Thread> threadReference(thread, true);
+
+	CPUSet mask;
+	scheduler_get_thread_cpu_mask(thread, mask);
+
+	memset(bits, 0, sizeof(bits));
+	for (int32 i = 0; i < cpuCount; i++) {
+		if (mask.GetBit(i))
+			bits[i / 32] |= 1u << (i % 32);
+	}
+
+	if (user_memcpy(userMask, bits, std::min(size, sizeof(bits))) != B_OK)
+		return B_BAD_ADDRESS;
+	return B_OK;
+}
+
+
 thread_id
 _user_spawn_thread(thread_creation_attributes* userAttributes)
 {
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	This file is compiled with -mavx2, and must only be used on CPUs that
+	support it.
+*/
+
+
+#include "string_simd.h"
+
+#include <immintrin.h>
+
+
+namespace {
+
+
+struct AVX2 {
+	typedef __m256i Type;
+
+	static const size_t kSize = 32;
+	static const uint32_t kFullMask = 0xffffffff;
+
+	static inline Type Load(const void* address)
+	{
+		return _mm256_load_si256(static_cast<const __m256i*>(address));
+	}
+
+	static inline Type LoadUnaligned(const void* address)
+	{
+		return _mm256_loadu_si256(static_cast<const __m256i*>(address));
+	}
+
+	static inline Type Broadcast(uint8_t value)
+	{
+		return _mm256_set1_epi8(value);
+	}
+
+	static inline uint32_t EqualMask(Type a, Type b)
+	{
+		return _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b));
+	}
+};
+
+
+}	// namespace
+
+
+const string_functions gStringFunctionsAVX2 = {
+	&StringFunctions<AVX2>::MemChr,
+	&StringFunctions<AVX2>::MemCmp,
+	&StringFunctions<AVX2>::StrChr,
+	&StringFunctions<AVX2>::StrCmp,
+	&StringFunctions<AVX2>::StrLen,
+	&StringFunctions<AVX2>::StrNLen,
+	&StringFunctions<AVX2>::StrRChr
+};
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Entry points of the string functions that have SSE2 and AVX2
+	implementations. SSE2 is always available on x86_64; the AVX2 versions
+	are chosen once, when the first of these functions is called, if both the
+	CPU and the kernel support them.
+*/
+
+
+#include <cpuid.h>
+#include <string.h>
+#include <strings.h>
+
+#include "string_simd.h"
+
+
+static const string_functions* sStringFunctions = NULL;
+
+
+static bool
+has_avx2()
+{
+	unsigned int eax, ebx, ecx, edx;
+	if (__get_cpuid_max(0, NULL) < 7)
+		return false;
+
+	__cpuid(1, eax, ebx, ecx, edx);
+	if ((ecx & bit_OSXSAVE) == 0 || (ecx & bit_AVX) == 0)
+		return false;
+
+	// the kernel must save the upper halves of the YMM registers as well
+	unsigned int xcr0Low, xcr0High;
+	__asm__ __volatile__("xgetbv" : "=a" (xcr0Low), "=d" (xcr0High) : "c" (0));
+	if ((xcr0Low & 0x6) != 0x6)
+		return false;
+
+	__cpuid_count(7, 0, eax, ebx, ecx, edx);
+	return (ebx & bit_AVX2) != 0;
+}
+
+
+static const string_functions*
+select_string_functions()
+{
+	// Threads racing here all come to the same result, so there is no need
+	// for any locking.
+	const string_functions* functions = has_avx2()
+		? &gStringFunctionsAVX2 : &gStringFunctionsSSE2;
+	sStringFunctions = functions;
+	return functions;
+}
+
+
+static inline const string_functions*
+get_string_functions()
+{
+	const string_functions* functions = sStringFunctions;
+	if (__builtin_expect(functions == NULL, 0))
+		return select_string_functions();
+	return functions;
+}
+
+
+extern "C" void*
+memchr(const void* source, int value, size_t length)
+{
+	return get_string_functions()->memchr(source, value, length);
+}
+
+
+extern "C" int
+memcmp(const void* a, const void* b, size_t length)
+{
+	return get_string_functions()->memcmp(a, b, length);
+}
+
+
+extern "C" char*
+strchr(const char* string, int character)
+{
+	return get_string_functions()->strchr(string, character);
+}
+
+
+extern "C" char*
+index(const char* string, int character)
+{
+	return get_string_functions()->strchr(string, character);
+}
+
+
+extern "C" int
+strcmp(const char* a, const char* b)
+{
+	return get_string_functions()->strcmp(a, b);
+}
+
+
+extern "C" size_t
+strlen(const char* string)
+{
+	return get_string_functions()->strlen(string);
+}
+
+
+extern "C" size_t
+strnlen(const char* string, size_t count)
+{
+	return get_string_functions()->strnlen(string, count);
+}
+
+
+extern "C" char*
+strrchr(const char* string, int character)
+{
+	return get_string_functions()->strrchr(string, character);
+}
+
+
+extern "C" char*
+rindex(const char* string, int character)
+{
+	return get_string_functions()->strrchr(string, character);
+}
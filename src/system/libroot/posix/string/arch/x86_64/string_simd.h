@@ -0,0 +1,325 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef STRING_SIMD_H
+#define STRING_SIMD_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+
+struct string_functions {
+	void*	(*memchr)(const void* source, int value, size_t length);
+	int		(*memcmp)(const void* a, const void* b, size_t length);
+	char*	(*strchr)(const char* string, int character);
+	int		(*strcmp)(const char* a, const char* b);
+	size_t	(*strlen)(const char* string);
+	size_t	(*strnlen)(const char* string, size_t count);
+	char*	(*strrchr)(const char* string, int character);
+};
+
+
+extern const string_functions gStringFunctionsSSE2;
+extern const string_functions gStringFunctionsAVX2;
+
+
+/*	The functions below are instantiated once per vector extension. A Vector
+	class provides:
+		Type			the vector type
+		kSize			the vector size in bytes (at most 32)
+		kFullMask		a mask with one bit set for each byte of a vector
+		Load()			loads an aligned vector
+		LoadUnaligned()	loads a vector from any address
+		Broadcast()		creates a vector with all bytes set to a value
+		EqualMask()		compares two vectors bytewise, and returns a mask with
+						the bits set for the bytes that are equal
+
+	Aligned loads never cross a page boundary, so the string functions may
+	read a few bytes before the start and after the end of the string.
+*/
+
+
+namespace {
+
+
+static const size_t kPageSize = 4096;
+
+
+template<typename Vector>
+static inline size_t
+simd_strlen(const char* string)
+{
+	const size_t offset = (uintptr_t)string & (Vector::kSize - 1);
+	const char* block = string - offset;
+	const typename Vector::Type zero = Vector::Broadcast(0);
+
+	uint32_t mask = Vector::EqualMask(Vector::Load(block), zero) >> offset;
+	if (mask != 0)
+		return __builtin_ctz(mask);
+
+	while (true) {
+		block += Vector::kSize;
+		mask = Vector::EqualMask(Vector::Load(block), zero);
+		if (mask != 0)
+			return block - string + __builtin_ctz(mask);
+	}
+}
+
+
+template<typename Vector>
+static inline size_t
+simd_strnlen(const char* string, size_t count)
+{
+	if (count == 0)
+		return 0;
+
+	const size_t offset = (uintptr_t)string & (Vector::kSize - 1);
+	const char* block = string - offset;
+	const typename Vector::Type zero = Vector::Broadcast(0);
+
+	uint32_t mask = Vector::EqualMask(Vector::Load(block), zero) >> offset;
+	size_t length;
+	if (mask != 0)
+		length = __builtin_ctz(mask);
+	else {
+		length = Vector::kSize - offset;
+		while (length < count) {
+			block += Vector::kSize;
+			mask = Vector::EqualMask(Vector::Load(block), zero);
+			if (mask != 0) {
+				length = block - string + __builtin_ctz(mask);
+				break;
+			}
+			length += Vector::kSize;
+		}
+	}
+
+	return length < count ? length : count;
+}
+
+
+template<typename Vector>
+static inline void*
+simd_memchr(const void* source, int value, size_t length)
+{
+	if (length == 0)
+		return NULL;
+
+	const uint8_t* start = (const uint8_t*)source;
+	const size_t offset = (uintptr_t)start & (Vector::kSize - 1);
+	const uint8_t* block = start - offset;
+	const typename Vector::Type needle = Vector::Broadcast((uint8_t)value);
+
+	uint32_t mask = Vector::EqualMask(Vector::Load(block), needle) >> offset;
+	if (mask != 0) {
+		size_t index = __builtin_ctz(mask);
+		return index < length ? (void*)(start + index) : NULL;
+	}
+
+	if (length <= Vector::kSize - offset)
+		return NULL;
+	length -= Vector::kSize - offset;
+	block += Vector::kSize;
+
+	while (length >= Vector::kSize) {
+		mask = Vector::EqualMask(Vector::Load(block), needle);
+		if (mask != 0)
+			return (void*)(block + __builtin_ctz(mask));
+
+		block += Vector::kSize;
+		length -= Vector::kSize;
+	}
+
+	if (length == 0)
+		return NULL;
+
+	mask = Vector::EqualMask(Vector::Load(block), needle)
+		& ((1u << length) - 1);
+	return mask != 0 ? (void*)(block + __builtin_ctz(mask)) : NULL;
+}
+
+
+template<typename Vector>
+static inline char*
+simd_strchr(const char* string, int character)
+{
+	const size_t offset = (uintptr_t)string & (Vector::kSize - 1);
+	const char* block = string - offset;
+	const typename Vector::Type zero = Vector::Broadcast(0);
+	const typename Vector::Type needle = Vector::Broadcast((uint8_t)character);
+
+	typename Vector::Type data = Vector::Load(block);
+	uint32_t mask = (Vector::EqualMask(data, zero)
+		| Vector::EqualMask(data, needle)) >> offset;
+	if (mask != 0)
+		block = string;
+	else {
+		while (true) {
+			block += Vector::kSize;
+			data = Vector::Load(block);
+			mask = Vector::EqualMask(data, zero)
+				| Vector::EqualMask(data, needle);
+			if (mask != 0)
+				break;
+		}
+	}
+
+	const char* found = block + __builtin_ctz(mask);
+	return *found == (char)character ? (char*)found : NULL;
+}
+
+
+template<typename Vector>
+static inline char*
+simd_strrchr(const char* string, int character)
+{
+	const size_t offset = (uintptr_t)string & (Vector::kSize - 1);
+	const char* block = string - offset;
+	const typename Vector::Type zero = Vector::Broadcast(0);
+	const typename Vector::Type needle = Vector::Broadcast((uint8_t)character);
+	const char* last = NULL;
+
+	typename Vector::Type data = Vector::Load(block);
+	uint32_t zeroMask = Vector::EqualMask(data, zero) >> offset;
+	uint32_t mask = Vector::EqualMask(data, needle) >> offset;
+	const char* start = string;
+
+	while (true) {
+		if (zeroMask != 0) {
+			// ignore everything after the terminating null
+			mask &= zeroMask ^ (zeroMask - 1);
+			if (mask != 0)
+				last = start + 31 - __builtin_clz(mask);
+			return (char*)last;
+		}
+		if (mask != 0)
+			last = start + 31 - __builtin_clz(mask);
+
+		block += Vector::kSize;
+		start = block;
+		data = Vector::Load(block);
+		zeroMask = Vector::EqualMask(data, zero);
+		mask = Vector::EqualMask(data, needle);
+	}
+}
+
+
+template<typename Vector>
+static inline int
+simd_strcmp(const char* a, const char* b)
+{
+	const typename Vector::Type zero = Vector::Broadcast(0);
+
+	while (true) {
+		// unaligned loads must not cross into a page that might not exist
+		if (((uintptr_t)a & (kPageSize - 1)) > kPageSize - Vector::kSize
+			|| ((uintptr_t)b & (kPageSize - 1)) > kPageSize - Vector::kSize) {
+			int cmp = (unsigned char)*a - (unsigned char)*b;
+			if (cmp != 0 || *a == '\0')
+				return cmp;
+			a++;
+			b++;
+			continue;
+		}
+
+		typename Vector::Type dataA = Vector::LoadUnaligned(a);
+		typename Vector::Type dataB = Vector::LoadUnaligned(b);
+		uint32_t mask = (~Vector::EqualMask(dataA, dataB) & Vector::kFullMask)
+			| Vector::EqualMask(dataA, zero);
+		if (mask != 0) {
+			size_t index = __builtin_ctz(mask);
+			return (unsigned char)a[index] - (unsigned char)b[index];
+		}
+
+		a += Vector::kSize;
+		b += Vector::kSize;
+	}
+}
+
+
+static inline int
+compare_words(uint64_t a, uint64_t b)
+{
+	// the first differing byte is the lowest one on little endian
+	int shift = __builtin_ctzll(a ^ b) & ~7;
+	return (int)((a >> shift) & 0xff) - (int)((b >> shift) & 0xff);
+}
+
+
+template<typename Vector>
+static inline int
+simd_memcmp(const void* _a, const void* _b, size_t length)
+{
+	const uint8_t* a = (const uint8_t*)_a;
+	const uint8_t* b = (const uint8_t*)_b;
+
+	if (length < Vector::kSize) {
+		while (length >= 8) {
+			uint64_t wordA, wordB;
+			memcpy(&wordA, a, 8);
+			memcpy(&wordB, b, 8);
+			if (wordA != wordB)
+				return compare_words(wordA, wordB);
+			a += 8;
+			b += 8;
+			length -= 8;
+		}
+		while (length-- > 0) {
+			int cmp = *a++ - *b++;
+			if (cmp != 0)
+				return cmp;
+		}
+		return 0;
+	}
+
+	const uint8_t* lastA = a + length - Vector::kSize;
+	const uint8_t* lastB = b + length - Vector::kSize;
+	while (true) {
+		if (a > lastA) {
+			// compare the last vector, overlapping the previous one
+			a = lastA;
+			b = lastB;
+		}
+
+		uint32_t mask = ~Vector::EqualMask(Vector::LoadUnaligned(a),
+			Vector::LoadUnaligned(b)) & Vector::kFullMask;
+		if (mask != 0) {
+			size_t index = __builtin_ctz(mask);
+			return a[index] - b[index];
+		}
+
+		if (a == lastA)
+			return 0;
+
+		a += Vector::kSize;
+		b += Vector::kSize;
+	}
+}
+
+
+template<typename Vector>
+struct StringFunctions {
+	static void* MemChr(const void* source, int value, size_t length)
+		{ return simd_memchr<Vector>(source, value, length); }
+	static int MemCmp(const void* a, const void* b, size_t length)
+		{ return simd_memcmp<Vector>(a, b, length); }
+	static char* StrChr(const char* string, int character)
+		{ return simd_strchr<Vector>(string, character); }
+	static int StrCmp(const char* a, const char* b)
+		{ return simd_strcmp<Vector>(a, b); }
+	static size_t StrLen(const char* string)
+		{ return simd_strlen<Vector>(string); }
+	static size_t StrNLen(const char* string, size_t count)
+		{ return simd_strnlen<Vector>(string, count); }
+	static char* StrRChr(const char* string, int character)
+		{ return simd_strrchr<Vector>(string, character); }
+};
+
+
+}	// namespace
+
+
+#endif	// STRING_SIMD_H
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "string_simd.h"
+
+#include <emmintrin.h>
+
+
+namespace {
+
+
+struct SSE2 {
+	typedef __m128i Type;
+
+	static const size_t kSize = 16;
+	static const uint32_t kFullMask = 0xffff;
+
+	static inline Type Load(const void* address)
+	{
+		return _mm_load_si128(static_cast<const __m128i*>(address));
+	}
+
+	static inline Type LoadUnaligned(const void* address)
+	{
+		return _mm_loadu_si128(static_cast<const __m128i*>(address));
+	}
+
+	static inline Type Broadcast(uint8_t value)
+	{
+		return _mm_set1_epi8(value);
+	}
+
+	static inline uint32_t EqualMask(Type a, Type b)
+	{
+		return _mm_movemask_epi8(_mm_cmpeq_epi8(a, b));
+	}
+};
+
+
+}	// namespace
+
+
+const string_functions gStringFunctionsSSE2 = {
+	&StringFunctions<SSE2>::MemChr,
+	&StringFunctions<SSE2>::MemCmp,
+	&StringFunctions<SSE2>::StrChr,
+	&StringFunctions<SSE2>::StrCmp,
+	&StringFunctions<SSE2>::StrLen,
+	&StringFunctions<SSE2>::StrNLen,
+	&StringFunctions<SSE2>::StrRChr
+};
@@ -0,0 +1,402 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * This file may be used under the terms of the MIT License.
+ */
+
+/*!	Tests BFS delayed allocation. The directory given must be on a scratch
+	BFS volume mounted with the "delalloc" option, as the test fills it up
+	completely.
+*/
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <fs_info.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <SupportDefs.h>
+
+
+static const size_t kChunkSize = 4096;
+static const int32 kFileCount = 4;
+static const int32 kMaxExtents = 2;
+	// the allocation group boundary might split a file
+
+static const int32 kInodeMagic = 0x3bbe0ad9;
+static const int32 kDirectRuns = 12;
+
+// the parts of the on-disk inode needed to count the block runs (see bfs.h)
+struct block_run {
+	int32		allocation_group;
+	uint16		start;
+	uint16		length;
+} _PACKED;
+
+struct bfs_inode_start {
+	int32		magic1;
+	block_run	inode_num;
+	int32		uid;
+	int32		gid;
+	int32		mode;
+	int32		flags;
+	int64		create_time;
+	int64		last_modified_time;
+	block_run	parent;
+	block_run	attributes;
+	uint32		type;
+	int32		inode_size;
+	uint32		etc;
+
+	block_run	direct[kDirectRuns];
+	int64		max_direct_range;
+	block_run	indirect;
+	int64		max_indirect_range;
+} _PACKED;
+
+bool gVerbose;
+
+
+static void
+fill_chunk(uint8* chunk, int32 file, off_t offset)
+{
+	for (size_t i = 0; i < kChunkSize; i++)
+		chunk[i] = (uint8)(file * 61 + (offset + i) / 7);
+}
+
+
+static void
+make_path(char* path, size_t size, const char* directory, const char* name,
+	int32 index)
+{
+	snprintf(path, size, "%s/delalloc_%s_%" B_PRId32, directory, name, index);
+}
+
+
+/*!	Reads back the file at \a path, and exits if its contents don't match
+	what fill_chunk() wrote, or if not all of it got its blocks.
+*/
+static void
+verify_file(const char* path, int32 file, off_t expectedSize)
+{
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		printf("could not open %s: %s\n", path, strerror(errno));
+		exit(1);
+	}
+
+	struct stat stat;
+	if (fstat(fd, &stat) != 0 || stat.st_size != expectedSize) {
+		printf("%s has size %" B_PRIdOFF ", expected %" B_PRIdOFF "\n", path,
+			stat.st_size, expectedSize);
+		exit(1);
+	}
+	if (stat.st_blocks * 512 < stat.st_size) {
+		printf("%s: only %" B_PRIdOFF " of %" B_PRIdOFF " bytes have blocks\n",
+			path, (off_t)stat.st_blocks * 512, stat.st_size);
+		exit(1);
+	}
+
+	uint8 expected[kChunkSize];
+	uint8 buffer[kChunkSize];
+	for (off_t offset = 0; offset < expectedSize; offset += kChunkSize) {
+		ssize_t bytesRead = read(fd, buffer, kChunkSize);
+		fill_chunk(expected, file, offset);
+		if (bytesRead != (ssize_t)min_c(kChunkSize, expectedSize - offset)
+			|| memcmp(buffer, expected, bytesRead) != 0) {
+			printf("%s: wrong data at %" B_PRIdOFF "\n", path, offset);
+			exit(1);
+		}
+	}
+
+	close(fd);
+}
+
+
+/*!	Returns the number of block runs the data of the file at \a path is
+	stored in, as found in its inode on the device; the ID of a BFS inode is
+	its block number. If the indirect block is used, the number of direct
+	block runs plus one is returned.
+*/
+static int32
+count_extents(const char* path)
+{
+	struct stat stat;
+	fs_info info;
+	if (::stat(path, &stat) != 0 || fs_stat_dev(stat.st_dev, &info) != 0) {
+		printf("could not stat %s: %s\n", path, strerror(errno));
+		exit(1);
+	}
+
+	// make sure the inode is on disk
+	sync();
+
+	int device = open(info.device_name, O_RDONLY);
+	if (device < 0) {
+		printf("could not open %s: %s\n", info.device_name, strerror(errno));
+		exit(1);
+	}
+
+	bfs_inode_start inode;
+	if (pread(device, &inode, sizeof(inode),
+			(off_t)stat.st_ino * info.block_size) != (ssize_t)sizeof(inode)
+		|| inode.magic1 != kInodeMagic) {
+		printf("could not read the inode of %s\n", path);
+		exit(1);
+	}
+	close(device);
+
+	if (inode.max_indirect_range != 0)
+		return kDirectRuns + 1;
+
+	int32 count = 0;
+	while (count < kDirectRuns && inode.direct[count].length != 0)
+		count++;
+
+	return count;
+}
+
+
+/*!	Writes to a file in small pieces, and is killed before it can close it.
+	The blocks still have to be placed when the team's descriptors are
+	closed.
+*/
+static void
+test_killed_writer(const char* directory)
+{
+	puts("--------- Killed Writer ----------");
+
+	char path[PATH_MAX];
+	make_path(path, sizeof(path), directory, "killed", 0);
+	unlink(path);
+
+	static const off_t kSize = 1024 * 1024;
+
+	pid_t child = fork();
+	if (child == 0) {
+		int fd = open(path, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+		if (fd < 0)
+			exit(1);
+
+		uint8 chunk[kChunkSize];
+		for (off_t offset = 0; offset < kSize; offset += kChunkSize) {
+			fill_chunk(chunk, 0, offset);
+			if (write(fd, chunk, kChunkSize) != (ssize_t)kChunkSize)
+				exit(1);
+		}
+
+		kill(getpid(), SIGKILL);
+	}
+
+	int childStatus;
+	if (child < 0 || waitpid(child, &childStatus, 0) != child
+		|| !WIFSIGNALED(childStatus)) {
+		printf("writer didn't run through\n");
+		exit(1);
+	}
+
+	verify_file(path, 0, kSize);
+	unlink(path);
+}
+
+
+/*!	Checks that fsync() places the blocks of a file that is still open. */
+static void
+test_fsync(const char* directory)
+{
+	puts("--------- fsync ----------");
+
+	char path[PATH_MAX];
+	make_path(path, sizeof(path), directory, "fsync", 0);
+
+	int fd = open(path, O_CREAT | O_TRUNC | O_RDWR, 0644);
+	if (fd < 0) {
+		printf("could not create %s: %s\n", path, strerror(errno));
+		exit(1);
+	}
+
+	static const off_t kSize = 256 * 1024;
+
+	uint8 chunk[kChunkSize];
+	for (off_t offset = 0; offset < kSize; offset += kChunkSize) {
+		fill_chunk(chunk, 1, offset);
+		if (write(fd, chunk, kChunkSize) != (ssize_t)kChunkSize) {
+			printf("write failed: %s\n", strerror(errno));
+			exit(1);
+		}
+	}
+
+	if (fsync(fd) != 0) {
+		printf("fsync failed: %s\n", strerror(errno));
+		exit(1);
+	}
+
+	verify_file(path, 1, kSize);
+	close(fd);
+	unlink(path);
+}
+
+
+/*!	Writes several files in small pieces at the same time. Since their blocks
+	are placed only when they are closed, the files must not interleave on
+	disk.
+*/
+static void
+test_extents(const char* directory)
+{
+	puts("--------- Extents ----------");
+
+	static const off_t kSize = 1024 * 1024;
+
+	int fds[kFileCount];
+	char path[PATH_MAX];
+
+	for (int32 i = 0; i < kFileCount; i++) {
+		make_path(path, sizeof(path), directory, "extents", i);
+		fds[i] = open(path, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+		if (fds[i] < 0) {
+			printf("could not create %s: %s\n", path, strerror(errno));
+			exit(1);
+		}
+	}
+
+	uint8 chunk[kChunkSize];
+	for (off_t offset = 0; offset < kSize; offset += kChunkSize) {
+		for (int32 i = 0; i < kFileCount; i++) {
+			fill_chunk(chunk, i, offset);
+			if (write(fds[i], chunk, kChunkSize) != (ssize_t)kChunkSize) {
+				printf("write failed: %s\n", strerror(errno));
+				exit(1);
+			}
+		}
+	}
+
+	for (int32 i = 0; i < kFileCount; i++)
+		close(fds[i]);
+
+	for (int32 i = 0; i < kFileCount; i++) {
+		make_path(path, sizeof(path), directory, "extents", i);
+		verify_file(path, i, kSize);
+
+		int32 extents = count_extents(path);
+		if (gVerbose)
+			printf("  file %" B_PRId32 ": %" B_PRId32 " extents\n", i, extents);
+		if (extents > kMaxExtents) {
+			printf("%s is stored in %" B_PRId32 " extents, expected at most %"
+				B_PRId32 "\n", path, extents, kMaxExtents);
+			exit(1);
+		}
+
+		unlink(path);
+	}
+}
+
+
+/*!	Fills the volume with several files written at the same time. Running
+	out of space must be reported by write(), as the blocks are reserved;
+	placing them when the files are synced and closed must not fail anymore.
+*/
+static void
+test_device_full(const char* directory)
+{
+	puts("--------- Device Full ----------");
+
+	struct statvfs info;
+	if (statvfs(directory, &info) != 0) {
+		printf("statvfs failed: %s\n", strerror(errno));
+		exit(1);
+	}
+	fsblkcnt_t freeBlocks = info.f_bfree;
+
+	int fds[kFileCount];
+	off_t sizes[kFileCount];
+	char path[PATH_MAX];
+
+	for (int32 i = 0; i < kFileCount; i++) {
+		make_path(path, sizeof(path), directory, "full", i);
+		fds[i] = open(path, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+		if (fds[i] < 0) {
+			printf("could not create %s: %s\n", path, strerror(errno));
+			exit(1);
+		}
+		sizes[i] = 0;
+	}
+
+	uint8 chunk[kChunkSize];
+	bool full = false;
+	while (!full) {
+		for (int32 i = 0; i < kFileCount; i++) {
+			fill_chunk(chunk, i, sizes[i]);
+			ssize_t bytesWritten = write(fds[i], chunk, kChunkSize);
+			if (bytesWritten < 0) {
+				if (errno != ENOSPC) {
+					printf("write failed: %s\n", strerror(errno));
+					exit(1);
+				}
+				full = true;
+				break;
+			}
+			sizes[i] += bytesWritten;
+		}
+	}
+
+	if (gVerbose) {
+		printf("  wrote %" B_PRIdOFF ", %" B_PRIdOFF ", %" B_PRIdOFF ", %"
+			B_PRIdOFF " bytes\n", sizes[0], sizes[1], sizes[2], sizes[3]);
+	}
+
+	for (int32 i = 0; i < kFileCount; i++) {
+		if (fsync(fds[i]) != 0 || close(fds[i]) != 0) {
+			printf("could not place the blocks of file %" B_PRId32 ": %s\n",
+				i, strerror(errno));
+			exit(1);
+		}
+	}
+
+	for (int32 i = 0; i < kFileCount; i++) {
+		make_path(path, sizeof(path), directory, "full", i);
+		verify_file(path, i, sizes[i]);
+		unlink(path);
+	}
+
+	// all reservations must be gone again (the directory may have grown)
+	if (statvfs(directory, &info) != 0 || info.f_bfree + 64 < freeBlocks) {
+		printf("%" B_PRIu64 " blocks are lost\n",
+			(uint64)(freeBlocks - info.f_bfree));
+		exit(1);
+	}
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int argIndex = 1;
+	if (argc > argIndex && !strcmp(argv[argIndex], "-v")) {
+		gVerbose = true;
+		argIndex++;
+	}
+
+	if (argc != argIndex + 1) {
+		fprintf(stderr, "usage: %s [-v] <directory>\n"
+			"The directory must be on a scratch BFS volume mounted with the "
+			"\"delalloc\" option.\n", argv[0]);
+		return 1;
+	}
+
+	const char* directory = argv[argIndex];
+
+	test_fsync(directory);
+	test_killed_writer(directory);
+	test_extents(directory);
+	test_device_full(directory);
+
+	puts("All tests passed.");
+	return 0;
+}
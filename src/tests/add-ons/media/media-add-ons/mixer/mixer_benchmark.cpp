@@ -0,0 +1,239 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Measures the time the mixer needs per output buffer, as the share of the
+	time it has until the buffer is due. It replays what MixerInput and
+	MixerCore do with every buffer: it resamples a number of stereo 16 bit
+	inputs from 44.1 kHz into the planar mix buffers, mixes them, and
+	converts the result to an interleaved 16 bit output buffer at 48 kHz.
+
+	For comparison, the same is done with the interleaved layout and the
+	scalar loop the mixer used before.
+
+	MixerCore itself is not driven: it needs a running AudioMixer node with
+	a time source and a buffer group. The benchmark calls the same
+	resamplers and kernels in the same order instead, so it measures the
+	computation only, not the scheduling of the mixer thread.
+
+	Usage: mixerBenchmark [<inputs> [<algorithm> [<frames>]]]
+	with algorithm 0 (drop/repeat samples), 2 (linear interpolation), or
+	3 (windowed sinc).
+*/
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <MediaDefs.h>
+#include <OS.h>
+
+#include <Interpolate.h>
+#include <MixerKernels.h>
+#include <Resampler.h>
+#include <SincResampler.h>
+
+
+static const int32 kChannels = 2;
+static const int32 kInputRate = 44100;
+static const int32 kOutputRate = 48000;
+static const int32 kRuns = 200;
+
+
+static Resampler*
+create_resampler(int32 algorithm, uint32 sourceFormat, uint32 destFormat)
+{
+	switch (algorithm) {
+		case 2:
+			return new Interpolate(sourceFormat, destFormat);
+		case 3:
+			return new SincResampler(sourceFormat, destFormat);
+		default:
+			return new Resampler(sourceFormat, destFormat);
+	}
+}
+
+
+class Benchmark {
+public:
+	Benchmark(int32 inputCount, int32 algorithm, int32 frames)
+		:
+		fInputCount(inputCount),
+		fFrames(frames),
+		fInputFrames((int64)frames * kInputRate / kOutputRate)
+	{
+		fInputData = new int16[fInputCount * fInputFrames * kChannels];
+		for (int32 input = 0; input < fInputCount; input++) {
+			int16* data = fInputData + input * fInputFrames * kChannels;
+			double frequency = 220.0 * (input + 1);
+			for (int32 i = 0; i < fInputFrames; i++) {
+				int16 value = (int16)(8000 * sin(2 * M_PI * frequency * i
+					/ kInputRate));
+				data[i * kChannels] = value;
+				data[i * kChannels + 1] = -value;
+			}
+		}
+
+		fInputBuffers = new float[fInputCount * kChannels * fFrames];
+		fMixBuffer = new float[kChannels * fFrames];
+		fOutput = new int16[kChannels * fFrames];
+
+		fInputResamplers = new Resampler*[fInputCount * kChannels];
+		for (int32 i = 0; i < fInputCount * kChannels; i++) {
+			fInputResamplers[i] = create_resampler(algorithm,
+				media_raw_audio_format::B_AUDIO_SHORT,
+				media_raw_audio_format::B_AUDIO_FLOAT);
+			fInputResamplers[i]->SetFrameRates(kInputRate, kOutputRate);
+		}
+		for (int32 i = 0; i < kChannels; i++) {
+			fOutputResamplers[i] = create_resampler(algorithm,
+				media_raw_audio_format::B_AUDIO_FLOAT,
+				media_raw_audio_format::B_AUDIO_SHORT);
+			fOutputResamplers[i]->SetFrameRates(kOutputRate, kOutputRate);
+		}
+	}
+
+	~Benchmark()
+	{
+		for (int32 i = 0; i < fInputCount * kChannels; i++)
+			delete fInputResamplers[i];
+		for (int32 i = 0; i < kChannels; i++)
+			delete fOutputResamplers[i];
+		delete[] fInputResamplers;
+		delete[] fInputData;
+		delete[] fInputBuffers;
+		delete[] fMixBuffer;
+		delete[] fOutput;
+	}
+
+	bigtime_t Run(bool planar)
+	{
+		bigtime_t bestTime = B_INFINITE_TIMEOUT;
+		for (int32 run = 0; run < kRuns; run++) {
+			bigtime_t startTime = system_time();
+			if (planar)
+				_MixPlanar();
+			else
+				_MixInterleaved();
+			bigtime_t time = system_time() - startTime;
+			if (time < bestTime)
+				bestTime = time;
+		}
+		return bestTime;
+	}
+
+	bigtime_t BufferDuration() const
+	{
+		return (bigtime_t)fFrames * 1000000 / kOutputRate;
+	}
+
+private:
+	void _MixPlanar()
+	{
+		// MixerInput::BufferReceived()
+		for (int32 input = 0; input < fInputCount; input++) {
+			for (int32 channel = 0; channel < kChannels; channel++) {
+				fInputResamplers[input * kChannels + channel]->Resample(
+					fInputData + (input * fInputFrames * kChannels) + channel,
+					kChannels * sizeof(int16), fInputFrames,
+					fInputBuffers + (input * kChannels + channel) * fFrames,
+					sizeof(float), fFrames, 1.0f);
+			}
+		}
+
+		// MixerCore::_MixThread()
+		const mixer_kernels& kernels = get_mixer_kernels();
+		memset(fMixBuffer, 0, sizeof(float) * kChannels * fFrames);
+		for (int32 channel = 0; channel < kChannels; channel++) {
+			for (int32 input = 0; input < fInputCount; input++) {
+				kernels.mix_add(fMixBuffer + channel * fFrames,
+					fInputBuffers + (input * kChannels + channel) * fFrames,
+					fFrames, 1.0f / fInputCount);
+			}
+		}
+		for (int32 channel = 0; channel < kChannels; channel++) {
+			fOutputResamplers[channel]->Resample(
+				fMixBuffer + channel * fFrames, sizeof(float), fFrames,
+				fOutput + channel, kChannels * sizeof(int16), fFrames, 1.0f);
+		}
+	}
+
+	void _MixInterleaved()
+	{
+		for (int32 input = 0; input < fInputCount; input++) {
+			float* buffer = fInputBuffers + input * kChannels * fFrames;
+			for (int32 channel = 0; channel < kChannels; channel++) {
+				fInputResamplers[input * kChannels + channel]->Resample(
+					fInputData + (input * fInputFrames * kChannels) + channel,
+					kChannels * sizeof(int16), fInputFrames, buffer + channel,
+					kChannels * sizeof(float), fFrames, 1.0f);
+			}
+		}
+
+		memset(fMixBuffer, 0, sizeof(float) * kChannels * fFrames);
+		for (int32 channel = 0; channel < kChannels; channel++) {
+			for (int32 input = 0; input < fInputCount; input++) {
+				const float* source = fInputBuffers
+					+ input * kChannels * fFrames + channel;
+				float* dest = fMixBuffer + channel;
+				float gain = 1.0f / fInputCount;
+				for (int32 i = 0; i < fFrames; i++) {
+					*dest += *source * gain;
+					dest += kChannels;
+					source += kChannels;
+				}
+			}
+		}
+		for (int32 channel = 0; channel < kChannels; channel++) {
+			fOutputResamplers[channel]->Resample(fMixBuffer + channel,
+				kChannels * sizeof(float), fFrames, fOutput + channel,
+				kChannels * sizeof(int16), fFrames, 1.0f);
+		}
+	}
+
+private:
+	int32		fInputCount;
+	int32		fFrames;
+	int32		fInputFrames;
+	int16*		fInputData;
+	float*		fInputBuffers;
+	float*		fMixBuffer;
+	int16*		fOutput;
+	Resampler**	fInputResamplers;
+	Resampler*	fOutputResamplers[kChannels];
+};
+
+
+int
+main(int argc, const char** argv)
+{
+	int32 inputCount = argc > 1 ? atol(argv[1]) : 8;
+	int32 algorithm = argc > 2 ? atol(argv[2]) : 2;
+	int32 frames = argc > 3 ? atol(argv[3]) : 1024;
+	if (inputCount < 1 || frames < 16) {
+		fprintf(stderr, "usage: %s [<inputs> [<algorithm> [<frames>]]]\n",
+			argv[0]);
+		return 1;
+	}
+
+	printf("%" B_PRId32 " stereo inputs, algorithm %" B_PRId32 ", %" B_PRId32
+		" frames per buffer, %s kernels\n", inputCount, algorithm, frames,
+		get_mixer_kernels().name);
+
+	Benchmark benchmark(inputCount, algorithm, frames);
+	bigtime_t duration = benchmark.BufferDuration();
+
+	bigtime_t time = benchmark.Run(false);
+	printf("interleaved: %6" B_PRIdBIGTIME " us per buffer, %5.1f%% of %"
+		B_PRIdBIGTIME " us\n", time, 100.0 * time / duration, duration);
+
+	time = benchmark.Run(true);
+	printf("planar:      %6" B_PRIdBIGTIME " us per buffer, %5.1f%% of %"
+		B_PRIdBIGTIME " us\n", time, 100.0 * time / duration, duration);
+
+	return 0;
+}
@@ -0,0 +1,199 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Measures building, flattening, unflattening and searching messages of
+	different sizes, with and without reserving their size up front.
+*/
+
+
+#include <Message.h>
+#include <OS.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+static const int32 kFieldCounts[] = { 4, 32, 256, 1024 };
+static const int32 kTotalFields = 1024 * 1024;
+
+
+typedef void (*benchmark_function)(int32 fieldCount, int32 iterations);
+
+
+static void
+field_name(int32 index, char* name, size_t size)
+{
+	snprintf(name, size, "field %" B_PRId32, index);
+}
+
+
+static void
+build_message(BMessage& message, int32 fieldCount, bool reserve)
+{
+	if (reserve) {
+		// the names, the values, and the size of each string
+		message.Reserve(fieldCount, fieldCount * (16 + 32 + 4));
+	}
+
+	char name[32];
+	for (int32 i = 0; i < fieldCount; i++) {
+		field_name(i, name, sizeof(name));
+		if (i % 2 == 0)
+			message.AddInt32(name, i);
+		else
+			message.AddString(name, "a string value of some length");
+	}
+}
+
+
+static void
+benchmark_build(int32 fieldCount, int32 iterations)
+{
+	for (int32 i = 0; i < iterations; i++) {
+		BMessage message('test');
+		build_message(message, fieldCount, false);
+	}
+}
+
+
+static void
+benchmark_build_reserved(int32 fieldCount, int32 iterations)
+{
+	for (int32 i = 0; i < iterations; i++) {
+		BMessage message('test');
+		build_message(message, fieldCount, true);
+	}
+}
+
+
+static void
+benchmark_build_new(int32 fieldCount, int32 iterations)
+{
+	// allocating the messages themselves, as when posting them
+	for (int32 i = 0; i < iterations; i++) {
+		BMessage* message = new BMessage('test');
+		build_message(*message, fieldCount, false);
+		delete message;
+	}
+}
+
+
+static void
+benchmark_flatten(int32 fieldCount, int32 iterations)
+{
+	BMessage message('test');
+	build_message(message, fieldCount, false);
+
+	ssize_t size = message.FlattenedSize();
+	char* buffer = (char*)malloc(size);
+	if (buffer == NULL)
+		return;
+
+	for (int32 i = 0; i < iterations; i++)
+		message.Flatten(buffer, size);
+
+	free(buffer);
+}
+
+
+static void
+benchmark_unflatten(int32 fieldCount, int32 iterations)
+{
+	BMessage message('test');
+	build_message(message, fieldCount, false);
+
+	ssize_t size = message.FlattenedSize();
+	char* buffer = (char*)malloc(size);
+	if (buffer == NULL)
+		return;
+
+	message.Flatten(buffer, size);
+
+	for (int32 i = 0; i < iterations; i++) {
+		BMessage unflattened;
+		unflattened.Unflatten(buffer);
+	}
+
+	free(buffer);
+}
+
+
+static void
+benchmark_find(int32 fieldCount, int32 iterations)
+{
+	BMessage message('test');
+	build_message(message, fieldCount, false);
+
+	char name[32];
+	for (int32 i = 0; i < iterations; i++) {
+		for (int32 j = 0; j < fieldCount; j++) {
+			field_name(j, name, sizeof(name));
+
+			const void* data;
+			ssize_t size;
+			if (message.FindData(name, B_ANY_TYPE, &data, &size) != B_OK) {
+				fprintf(stderr, "could not find \"%s\"\n", name);
+				exit(1);
+			}
+		}
+	}
+}
+
+
+static void
+run_benchmark(const char* name, benchmark_function function)
+{
+	printf("%s:\n", name);
+
+	for (size_t i = 0; i < sizeof(kFieldCounts) / sizeof(kFieldCounts[0]);
+			i++) {
+		int32 fieldCount = kFieldCounts[i];
+		int32 iterations = kTotalFields / fieldCount;
+
+		// warm up the caches
+		function(fieldCount, iterations / 10 + 1);
+
+		bigtime_t startTime = system_time();
+		function(fieldCount, iterations);
+		bigtime_t time = system_time() - startTime;
+
+		printf("  %5" B_PRId32 " fields: %8.3f us per message, %6.3f us per"
+			" field\n", fieldCount, (double)time / iterations,
+			(double)time / iterations / fieldCount);
+	}
+}
+
+
+int
+main()
+{
+	// check that the messages survive the round trip
+	BMessage message('test');
+	build_message(message, 256, true);
+
+	BMessage copy(message);
+	ssize_t size = message.FlattenedSize();
+	char* buffer = (char*)malloc(size);
+	BMessage unflattened;
+	if (buffer == NULL || message.Flatten(buffer, size) != B_OK
+		|| unflattened.Unflatten(buffer) != B_OK
+		|| !unflattened.HasSameData(message)
+		|| !copy.HasSameData(message)) {
+		fprintf(stderr, "messages don't match\n");
+		return 1;
+	}
+	free(buffer);
+
+	run_benchmark("build", &benchmark_build);
+	run_benchmark("build reserved", &benchmark_build_reserved);
+	run_benchmark("build allocated", &benchmark_build_new);
+	run_benchmark("flatten", &benchmark_flatten);
+	run_benchmark("unflatten", &benchmark_unflatten);
+	run_benchmark("find", &benchmark_find);
+
+	return 0;
+}
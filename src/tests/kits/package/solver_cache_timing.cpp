@@ -0,0 +1,143 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Measures how long the solver takes to set up a synthetic repository,
+	first converting its packages, and then using the cache it wrote.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <FindDirectory.h>
+#include <ObjectList.h>
+#include <OS.h>
+#include <Path.h>
+#include <String.h>
+
+#include <package/PackageInfo.h>
+#include <package/SolverRepositoryCacheKey.h>
+#include <package/solver/Solver.h>
+#include <package/solver/SolverPackage.h>
+#include <package/solver/SolverRepository.h>
+
+
+using namespace BPackageKit;
+
+
+static const char* const kRepositoryName = "solver-cache-timing";
+
+
+static status_t
+add_packages(BSolverRepository& repository, int count)
+{
+	// the same scheme as make_repo uses
+	for (int i = 0; i < count; i++) {
+		BString name = BString("pkg") << i + 1;
+		BString majorVersion = BString() << 1 + i % 5;
+		BString minorVersion = BString() << i % 10;
+		BString microVersion = BString() << i % 100;
+
+		BPackageInfo info;
+		info.SetName(name);
+		info.SetSummary(BString("Synthetic package ") << name);
+		info.SetArchitecture(B_PACKAGE_ARCHITECTURE_ANY);
+		info.SetVersion(BPackageVersion(majorVersion, minorVersion,
+			microVersion, "", 1));
+
+		info.AddProvides(BPackageResolvable(name,
+			BPackageVersion(majorVersion, minorVersion, microVersion, "", 1)));
+		if (i % 2 == 1)
+			info.AddProvides(BPackageResolvable(BString("lib") << name));
+		if (i % 3 != 1)
+			info.AddProvides(BPackageResolvable(BString("cmd:") << name));
+
+		if (i > 1) {
+			int requiresCount = rand() % 10 % i;
+			for (int r = 0; r < requiresCount; r++) {
+				info.AddRequires(BPackageResolvableExpression(
+					BString("pkg") << rand() % i + 1));
+			}
+		}
+
+		status_t error = repository.AddPackage(info);
+		if (error != B_OK)
+			return error;
+	}
+
+	return B_OK;
+}
+
+
+static bigtime_t
+time_solver_setup(BSolverRepository& repository)
+{
+	BSolver* solver;
+	status_t error = BSolver::Create(solver);
+	if (error == B_OK)
+		error = solver->Init();
+	if (error == B_OK)
+		error = solver->AddRepository(&repository);
+	if (error != B_OK) {
+		fprintf(stderr, "failed to set up the solver: %s\n", strerror(error));
+		exit(1);
+	}
+
+	// the pool is only created when it's needed first
+	bigtime_t start = system_time();
+	BObjectList<BSolverPackage> packages;
+	error = solver->FindPackages("pkg1", BSolver::B_FIND_IN_NAME, packages);
+	bigtime_t time = system_time() - start;
+
+	if (error != B_OK || packages.IsEmpty()) {
+		fprintf(stderr, "failed to find packages: %s\n", strerror(error));
+		exit(1);
+	}
+
+	delete solver;
+	return time;
+}
+
+
+int
+main(int argc, const char** argv)
+{
+	int count = argc > 1 ? atoi(argv[1]) : 50000;
+	if (count <= 0) {
+		fprintf(stderr, "usage: %s [<pkg-count>]\n", argv[0]);
+		return 1;
+	}
+
+	BSolverRepository repository(BString(kRepositoryName));
+	status_t error = add_packages(repository, count);
+	if (error != B_OK) {
+		fprintf(stderr, "failed to add packages: %s\n", strerror(error));
+		return 1;
+	}
+
+	// Only repositories read from a repository cache are cached
+	BPackageKit::BPrivate::set_solver_repository_cache_key(&repository,
+		BString("synthetic ") << count);
+
+	BPath cachePath;
+	if (find_directory(B_USER_CACHE_DIRECTORY, &cachePath) == B_OK) {
+		cachePath.Append("package-solver");
+		cachePath.Append(BString(kRepositoryName) << ".solv");
+		unlink(cachePath.Path());
+	}
+
+	bigtime_t uncached = time_solver_setup(repository);
+	bigtime_t cached = time_solver_setup(repository);
+
+	printf("%d packages: %" B_PRIdBIGTIME " ms converted, %" B_PRIdBIGTIME
+		" ms from cache (%.1fx)\n", count, uncached / 1000, cached / 1000,
+		cached > 0 ? (double)uncached / cached : 0.0);
+
+	unlink(cachePath.Path());
+	return 0;
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Measures how fast BJson parses a document, either the given file, or a
+	generated one resembling the package catalogue HaikuDepot loads.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <DataIO.h>
+#include <File.h>
+#include <OS.h>
+#include <String.h>
+
+#include <Json.h>
+#include <JsonEventListener.h>
+
+
+using namespace BPrivate;
+
+
+class CountingListener : public BJsonEventListener {
+public:
+	CountingListener()
+		:
+		fEventCount(0),
+		fContentLength(0),
+		fError(B_OK)
+	{
+	}
+
+	virtual bool Handle(const BJsonEvent& event)
+	{
+		fEventCount++;
+		if (event.Content() != NULL)
+			fContentLength += strlen(event.Content());
+		return true;
+	}
+
+	virtual void HandleError(status_t status, int32 line, const char* message)
+	{
+		fprintf(stderr, "parse error at line %" B_PRId32 ": %s\n", line,
+			message);
+		fError = status;
+	}
+
+	virtual void Complete()
+	{
+	}
+
+	uint64 EventCount() const
+	{
+		return fEventCount;
+	}
+
+	status_t Error() const
+	{
+		return fError;
+	}
+
+private:
+	uint64		fEventCount;
+	uint64		fContentLength;
+	status_t	fError;
+};
+
+
+static void
+generate_catalogue(BString& json, int32 packageCount)
+{
+	json = "{\"items\":[";
+	for (int32 i = 0; i < packageCount; i++) {
+		if (i > 0)
+			json << ",";
+		json << "{\"name\":\"package" << i << "\",\"active\":true,"
+			"\"prominenceOrdering\":" << i % 1000 << ","
+			"\"derivedRating\":" << (i % 50) / 10.0 << ","
+			"\"pkgVersions\":[{\"major\":\"" << i % 10 << "\",\"minor\":\""
+			<< i % 7 << "\",\"revision\":" << i % 3 << ","
+			"\"summary\":\"A package with the number " << i << "\","
+			"\"description\":\"This is a rather long description of the "
+			"package, as some of the real ones are. It even contains an "
+			"escaped \\\"quote\\\" and a\\nnew line every now and then.\","
+			"\"payloadLength\":" << i * 4096 + 17 << ","
+			"\"isLatest\":true}],"
+			"\"pkgCategoryCodes\":[\"development\",\"utilities\"]}";
+	}
+	json << "]}";
+}
+
+
+int
+main(int argc, const char** argv)
+{
+	BString json;
+	if (argc > 1) {
+		BFile file(argv[1], B_READ_ONLY);
+		off_t size;
+		status_t error = file.InitCheck();
+		if (error == B_OK)
+			error = file.GetSize(&size);
+		if (error != B_OK) {
+			fprintf(stderr, "could not open %s: %s\n", argv[1],
+				strerror(error));
+			return 1;
+		}
+
+		char* buffer = json.LockBuffer(size);
+		ssize_t bytesRead = file.Read(buffer, size);
+		json.UnlockBuffer(bytesRead > 0 ? bytesRead : 0);
+		if (bytesRead != size) {
+			fprintf(stderr, "could not read %s\n", argv[1]);
+			return 1;
+		}
+	} else
+		generate_catalogue(json, 20000);
+
+	const int32 kRuns = 5;
+	bigtime_t bestTime = B_INFINITE_TIMEOUT;
+	uint64 eventCount = 0;
+
+	for (int32 run = 0; run < kRuns; run++) {
+		BMemoryIO input(json.String(), json.Length());
+		CountingListener listener;
+
+		bigtime_t startTime = system_time();
+		BJson::Parse(&input, &listener);
+		bigtime_t time = system_time() - startTime;
+
+		if (listener.Error() != B_OK)
+			return 1;
+
+		eventCount = listener.EventCount();
+		if (time < bestTime)
+			bestTime = time;
+	}
+
+	printf("%" B_PRId32 " bytes, %" B_PRIu64 " events: %" B_PRIdBIGTIME
+		" ms, %.1f MB/s\n", json.Length(), eventCount, bestTime / 1000,
+		bestTime > 0 ? (double)json.Length() / bestTime : 0.0);
+
+	return 0;
+}
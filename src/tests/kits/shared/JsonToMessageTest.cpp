@@ -4,7 +4,10 @@
  */
 #include "JsonToMessageTest.h"
 
+#include <string.h>
+
 #include <Json.h>
+#include <JsonMessageWriter.h>
 
 #include <cppunit/TestCaller.h>
 #include <cppunit/TestSuite.h>
@@ -246,6 +249,35 @@ void JsonToMessageTest::TestHaikuDepotFetchBatch()
 }
 
 
+void
+JsonToMessageTest::TestTrailingDataNotConsumed()
+{
+	const char* input = "{\"a\":1} [2]";
+	BMemoryIO inputData(input, strlen(input));
+	BMessage message;
+	BJsonMessageWriter writer(message);
+
+	// ----------------------
+	BJson::Parse(&inputData, &writer);
+	// ----------------------
+
+	CPPUNIT_ASSERT_EQUAL(B_OK, writer.ErrorStatus());
+	CPPUNIT_ASSERT_EQUAL((off_t)7, inputData.Position());
+
+		// the next value can be parsed from where the first one ended
+
+	BMessage nextMessage;
+	BJsonMessageWriter nextWriter(nextMessage);
+
+	// ----------------------
+	BJson::Parse(&inputData, &nextWriter);
+	// ----------------------
+
+	CPPUNIT_ASSERT_EQUAL(B_OK, nextWriter.ErrorStatus());
+	CPPUNIT_ASSERT_EQUAL((off_t)strlen(input), inputData.Position());
+}
+
+
 /*static*/ void
 JsonToMessageTest::AddTests(BTestSuite& parent)
 {
@@ -284,6 +316,10 @@ JsonToMessageTest::AddTests(BTestSuite& parent)
 		"JsonToMessageTest::TestHaikuDepotFetchBatch",
 		&JsonToMessageTest::TestHaikuDepotFetchBatch));
 
+	suite.addTest(new CppUnit::TestCaller<JsonToMessageTest>(
+		"JsonToMessageTest::TestTrailingDataNotConsumed",
+		&JsonToMessageTest::TestTrailingDataNotConsumed));
+
 //	suite.addTest(new CppUnit::TestCaller<JsonToMessageTest>(
 //		"JsonToMessageTest::TestObjectAForPerformance",
 //		&JsonToMessageTest::TestObjectAForPerformance));
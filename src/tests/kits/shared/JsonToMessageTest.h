@@ -28,6 +28,7 @@ public:
 			void				TestUnterminatedObject();
 			void				TestUnterminatedArray();
 			void				TestHaikuDepotFetchBatch();
+			void				TestTrailingDataNotConsumed();
 
 	static	void				AddTests(BTestSuite& suite);
 private:
@@ -5,6 +5,7 @@
 #include <cppunit/Test.h>
 #include <cppunit/TestSuite.h>
 #include <cppunit/TestCaller.h>
+#include <sniffer/Matcher.h>
 #include <sniffer/Rule.h>
 #include <sniffer/Parser.h>
 #include <DataIO.h>
@@ -15,6 +16,7 @@
 #include <stdio.h>
 
 #include <iostream>
+#include <vector>
 using std::cout;
 using std::endl;
 
@@ -1383,6 +1385,22 @@ std::string("\000\034	000 034", 10),	// Otherwise, it thinks the NULL is the end
 				CHK(match == test.result[j]);			
 			} 
 		}
+
+		// All rules compiled together must yield the same results
+		NextSubTest();
+		Rule compiledRules[ruleCount];
+		std::vector<const Rule*> ruleList;
+		for (int j = 0; j < ruleCount; j++) {
+			CHK(parse(rules[j], &compiledRules[j], NULL) == B_OK);
+			ruleList.push_back(&compiledRules[j]);
+		}
+		Matcher matcher;
+		CHK(matcher.SetTo(ruleList) == B_OK);
+		CHK(matcher.CountRules() == ruleCount);
+		std::vector<bool> matches;
+		matcher.Match(test.data.data(), test.data.length(), matches);
+		for (int j = 0; j < ruleCount; j++)
+			CHK(matches[j] == test.result[j]);
 	}
 #endif // !TEST_R5
 }
@@ -0,0 +1,373 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "BlockCompressionTest.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include <BlockCompression.h>
+#include <ByteOrder.h>
+#include <DataIO.h>
+#include <ZlibCompressionAlgorithm.h>
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestSuite.h>
+
+
+static const size_t kBlockSize = 4096;
+
+// sizes of the on-disk structures of the stream format
+static const size_t kHeaderSize = 16;
+static const size_t kIndexEntrySize = 16;
+static const size_t kTrailerSize = 24;
+
+// field offsets within an index entry, and within the trailer
+static const size_t kEntryOffsetField = 0;
+static const size_t kEntryCompressedSizeField = 8;
+static const size_t kEntrySizeField = 12;
+static const size_t kTrailerIndexOffsetField = 0;
+static const size_t kTrailerBlockCountField = 8;
+static const size_t kTrailerMagicField = 20;
+
+
+class BlockCompressionTest : public BTestCase {
+	public:
+		BlockCompressionTest(std::string name = "");
+
+		void RoundTripTest();
+		void IncompressibleTest();
+		void FlushTest();
+		void CorruptTest();
+
+	private:
+		void _Compress(BMallocIO& output, const uint8* data, size_t size,
+			const size_t* flushOffsets = NULL, int32 flushCount = 0);
+		void _Verify(BMallocIO& compressed, const uint8* data, size_t size,
+			int64 expectedBlockCount);
+		status_t _InitCorrupted(const uint8* buffer, size_t size);
+
+	private:
+		BZlibCompressionAlgorithm fAlgorithm;
+};
+
+
+static void
+fill_compressible(uint8* data, size_t size)
+{
+	// Repeats often enough to compress well, but still differs from block
+	// to block, so that a read from the wrong block is noticed.
+	for (size_t i = 0; i < size; i++)
+		data[i] = (uint8)(i * 7 / 5 + i / kBlockSize);
+}
+
+
+static void
+fill_random(uint8* data, size_t size)
+{
+	srand(42);
+	for (size_t i = 0; i < size; i++)
+		data[i] = (uint8)rand();
+}
+
+
+static uint64
+read_uint64(const uint8* buffer, size_t offset)
+{
+	uint64 value;
+	memcpy(&value, buffer + offset, sizeof(value));
+	return B_LENDIAN_TO_HOST_INT64(value);
+}
+
+
+static void
+write_uint64(uint8* buffer, size_t offset, uint64 value)
+{
+	value = B_HOST_TO_LENDIAN_INT64(value);
+	memcpy(buffer + offset, &value, sizeof(value));
+}
+
+
+static void
+write_uint32(uint8* buffer, size_t offset, uint32 value)
+{
+	value = B_HOST_TO_LENDIAN_INT32(value);
+	memcpy(buffer + offset, &value, sizeof(value));
+}
+
+
+BlockCompressionTest::BlockCompressionTest(std::string name)
+	:
+	BTestCase(name)
+{
+}
+
+
+void
+BlockCompressionTest::_Compress(BMallocIO& output, const uint8* data,
+	size_t size, const size_t* flushOffsets, int32 flushCount)
+{
+	BBlockCompressingOutputStream stream(&output, &fAlgorithm);
+	CPPUNIT_ASSERT_EQUAL(B_OK, stream.Init(kBlockSize, 2));
+
+	// write in odd sized chunks, so that they don't line up with the blocks
+	size_t offset = 0;
+	int32 flushIndex = 0;
+	while (offset < size) {
+		size_t end = std::min(offset + 1000, size);
+		if (flushIndex < flushCount && flushOffsets[flushIndex] <= end)
+			end = flushOffsets[flushIndex];
+
+		if (end > offset) {
+			CPPUNIT_ASSERT_EQUAL((ssize_t)(end - offset),
+				stream.Write(data + offset, end - offset));
+			offset = end;
+		}
+
+		if (flushIndex < flushCount && flushOffsets[flushIndex] == offset) {
+			CPPUNIT_ASSERT_EQUAL(B_OK, stream.Flush());
+			flushIndex++;
+		}
+	}
+
+	CPPUNIT_ASSERT_EQUAL(B_OK, stream.Finish());
+	CPPUNIT_ASSERT(stream.Write(data, 1) < 0);
+}
+
+
+void
+BlockCompressionTest::_Verify(BMallocIO& compressed, const uint8* data,
+	size_t size, int64 expectedBlockCount)
+{
+	BBlockDecompressingInputStream stream(&compressed, &fAlgorithm);
+	CPPUNIT_ASSERT_EQUAL(B_OK, stream.Init());
+	CPPUNIT_ASSERT_EQUAL(expectedBlockCount, stream.CountBlocks());
+
+	off_t streamSize;
+	CPPUNIT_ASSERT_EQUAL(B_OK, stream.GetSize(&streamSize));
+	CPPUNIT_ASSERT_EQUAL((off_t)size, streamSize);
+
+	uint8* buffer = (uint8*)malloc(size + kBlockSize);
+	CPPUNIT_ASSERT(buffer != NULL);
+
+	// read everything sequentially
+	size_t offset = 0;
+	while (offset < size) {
+		ssize_t bytesRead = stream.Read(buffer + offset, 777);
+		CPPUNIT_ASSERT(bytesRead > 0);
+		offset += bytesRead;
+	}
+	CPPUNIT_ASSERT_EQUAL(size, offset);
+	CPPUNIT_ASSERT(memcmp(buffer, data, size) == 0);
+	CPPUNIT_ASSERT_EQUAL((ssize_t)0, stream.Read(buffer, 1));
+
+	// random reads, many of them spanning block boundaries
+	srand(17);
+	for (int32 i = 0; i < 500; i++) {
+		off_t position = rand() % size;
+		size_t length = rand() % (3 * kBlockSize) + 1;
+		size_t expected = std::min(length, size - (size_t)position);
+
+		memset(buffer, 0, length);
+		CPPUNIT_ASSERT_EQUAL((ssize_t)expected,
+			stream.ReadAt(position, buffer, length));
+		CPPUNIT_ASSERT(memcmp(buffer, data + position, expected) == 0);
+	}
+
+	// reads at and beyond the end
+	CPPUNIT_ASSERT_EQUAL((ssize_t)0, stream.ReadAt(size, buffer, 1));
+	CPPUNIT_ASSERT_EQUAL((ssize_t)0, stream.ReadAt(size + 10, buffer, 1));
+
+	free(buffer);
+}
+
+
+status_t
+BlockCompressionTest::_InitCorrupted(const uint8* buffer, size_t size)
+{
+	BMemoryIO input(buffer, size);
+	BBlockDecompressingInputStream stream(&input, &fAlgorithm);
+	return stream.Init();
+}
+
+
+void
+BlockCompressionTest::RoundTripTest()
+{
+	const size_t size = 10 * kBlockSize + kBlockSize / 2;
+	uint8* data = (uint8*)malloc(size);
+	CPPUNIT_ASSERT(data != NULL);
+	fill_compressible(data, size);
+
+	BMallocIO compressed;
+	_Compress(compressed, data, size);
+	CPPUNIT_ASSERT(compressed.BufferLength() < size / 2);
+
+	_Verify(compressed, data, size, 11);
+	free(data);
+}
+
+
+void
+BlockCompressionTest::IncompressibleTest()
+{
+	const size_t size = 3 * kBlockSize + 100;
+	uint8* data = (uint8*)malloc(size);
+	CPPUNIT_ASSERT(data != NULL);
+	fill_random(data, size);
+
+	BMallocIO compressed;
+	_Compress(compressed, data, size);
+
+	// all blocks must have been stored as they are
+	CPPUNIT_ASSERT_EQUAL(
+		kHeaderSize + size + 4 * kIndexEntrySize + kTrailerSize,
+		compressed.BufferLength());
+
+	_Verify(compressed, data, size, 4);
+	free(data);
+}
+
+
+void
+BlockCompressionTest::FlushTest()
+{
+	const size_t size = 3 * kBlockSize;
+	uint8* data = (uint8*)malloc(size);
+	CPPUNIT_ASSERT(data != NULL);
+	fill_compressible(data, size);
+
+	// The second flush at the same offset must not produce an empty block,
+	// so the blocks end up being 4096, 904, 4096, 904, and 2288 bytes.
+	static const size_t kFlushOffsets[] = { 5000, 10000, 10000 };
+
+	BMallocIO compressed;
+	_Compress(compressed, data, size, kFlushOffsets, 3);
+	_Verify(compressed, data, size, 5);
+
+	// read across both short blocks at once
+	BBlockDecompressingInputStream stream(&compressed, &fAlgorithm);
+	CPPUNIT_ASSERT_EQUAL(B_OK, stream.Init());
+
+	uint8 buffer[7000];
+	CPPUNIT_ASSERT_EQUAL((ssize_t)sizeof(buffer),
+		stream.ReadAt(4000, buffer, sizeof(buffer)));
+	CPPUNIT_ASSERT(memcmp(buffer, data + 4000, sizeof(buffer)) == 0);
+
+	free(data);
+}
+
+
+void
+BlockCompressionTest::CorruptTest()
+{
+	const size_t size = 3 * kBlockSize;
+	uint8* data = (uint8*)malloc(size);
+	CPPUNIT_ASSERT(data != NULL);
+	fill_compressible(data, size);
+
+	BMallocIO compressed;
+	_Compress(compressed, data, size);
+	free(data);
+
+	const size_t length = compressed.BufferLength();
+	uint8* original = (uint8*)malloc(length);
+	uint8* buffer = (uint8*)malloc(length);
+	CPPUNIT_ASSERT(original != NULL && buffer != NULL);
+	memcpy(original, compressed.Buffer(), length);
+
+	const size_t trailer = length - kTrailerSize;
+	const uint64 indexOffset = read_uint64(original,
+		trailer + kTrailerIndexOffsetField);
+	CPPUNIT_ASSERT_EQUAL((uint64)(trailer - 3 * kIndexEntrySize),
+		indexOffset);
+	const size_t lastEntry = indexOffset + 2 * kIndexEntrySize;
+
+	CPPUNIT_ASSERT_EQUAL(B_OK, _InitCorrupted(original, length));
+
+	// truncated streams
+	CPPUNIT_ASSERT_EQUAL(B_BAD_DATA, _InitCorrupted(original, 0));
+	CPPUNIT_ASSERT_EQUAL(B_BAD_DATA,
+		_InitCorrupted(original, kHeaderSize + kTrailerSize - 1));
+	CPPUNIT_ASSERT_EQUAL(B_BAD_DATA, _InitCorrupted(original, trailer));
+	CPPUNIT_ASSERT_EQUAL(B_BAD_DATA, _InitCorrupted(original, length - 1));
+
+	// bad trailer magic
+	memcpy(buffer, original, length);
+	buffer[trailer + kTrailerMagicField] ^= 0xff;
+	CPPUNIT_ASSERT_EQUAL(B_BAD_DATA, _InitCorrupted(buffer, length));
+
+	// index beyond the trailer
+	memcpy(buffer, original, length);
+	write_uint64(buffer, trailer + kTrailerIndexOffsetField, length);
+	CPPUNIT_ASSERT_EQUAL(B_BAD_DATA, _InitCorrupted(buffer, length));
+
+	// index overlapping the header
+	memcpy(buffer, original, length);
+	write_uint64(buffer, trailer + kTrailerIndexOffsetField, 0);
+	CPPUNIT_ASSERT_EQUAL(B_BAD_DATA, _InitCorrupted(buffer, length));
+
+	// index that isn't a multiple of the entry size
+	memcpy(buffer, original, length);
+	write_uint64(buffer, trailer + kTrailerIndexOffsetField,
+		indexOffset - kIndexEntrySize / 2);
+	CPPUNIT_ASSERT_EQUAL(B_BAD_DATA, _InitCorrupted(buffer, length));
+
+	// block count not matching the index size
+	memcpy(buffer, original, length);
+	write_uint64(buffer, trailer + kTrailerBlockCountField, 4);
+	CPPUNIT_ASSERT_EQUAL(B_BAD_DATA, _InitCorrupted(buffer, length));
+
+	// empty block
+	memcpy(buffer, original, length);
+	write_uint32(buffer, lastEntry + kEntrySizeField, 0);
+	CPPUNIT_ASSERT_EQUAL(B_BAD_DATA, _InitCorrupted(buffer, length));
+
+	// block larger than the block size
+	memcpy(buffer, original, length);
+	write_uint32(buffer, lastEntry + kEntrySizeField, kBlockSize + 1);
+	CPPUNIT_ASSERT_EQUAL(B_BAD_DATA, _InitCorrupted(buffer, length));
+
+	// compressed data larger than the block
+	memcpy(buffer, original, length);
+	write_uint32(buffer, lastEntry + kEntryCompressedSizeField,
+		kBlockSize + 1);
+	CPPUNIT_ASSERT_EQUAL(B_BAD_DATA, _InitCorrupted(buffer, length));
+
+	// compressed data reaching into the index
+	memcpy(buffer, original, length);
+	write_uint64(buffer, lastEntry + kEntryOffsetField, indexOffset - 1);
+	CPPUNIT_ASSERT_EQUAL(B_BAD_DATA, _InitCorrupted(buffer, length));
+
+	// compressed data overlapping the header
+	memcpy(buffer, original, length);
+	write_uint64(buffer, lastEntry + kEntryOffsetField, kHeaderSize - 1);
+	CPPUNIT_ASSERT_EQUAL(B_BAD_DATA, _InitCorrupted(buffer, length));
+
+	free(original);
+	free(buffer);
+}
+
+
+CppUnit::Test*
+BlockCompressionTestSuite()
+{
+	CppUnit::TestSuite* testSuite = new CppUnit::TestSuite();
+
+	testSuite->addTest(new CppUnit::TestCaller<BlockCompressionTest>(
+		"BBlockCompression::RoundTrip", &BlockCompressionTest::RoundTripTest));
+	testSuite->addTest(new CppUnit::TestCaller<BlockCompressionTest>(
+		"BBlockCompression::Incompressible",
+		&BlockCompressionTest::IncompressibleTest));
+	testSuite->addTest(new CppUnit::TestCaller<BlockCompressionTest>(
+		"BBlockCompression::Flush", &BlockCompressionTest::FlushTest));
+	testSuite->addTest(new CppUnit::TestCaller<BlockCompressionTest>(
+		"BBlockCompression::Corrupt", &BlockCompressionTest::CorruptTest));
+
+	return testSuite;
+}
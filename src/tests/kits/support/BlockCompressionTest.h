@@ -0,0 +1,15 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _BLOCK_COMPRESSION_TEST_H_
+#define _BLOCK_COMPRESSION_TEST_H_
+
+
+#include "TestCase.h"
+
+
+CppUnit::Test *BlockCompressionTestSuite();
+
+
+#endif	// _BLOCK_COMPRESSION_TEST_H_
@@ -9,6 +9,7 @@
 #include "bmemoryio/MallocIOTest.h"
 #include "bstring/StringTest.h"
 #include "bblockcache/BlockCacheTest.h"
+#include "BlockCompressionTest.h"
 #include "ByteOrderTest.h"
 #include "DateTimeTest.h"
 
@@ -21,6 +22,7 @@ getTestSuite()
 	// ##### Add test suites here #####
 	suite->addTest("BArchivable", ArchivableTestSuite());
 	suite->addTest("BAutolock", AutolockTestSuite());
+	suite->addTest("BBlockCompression", BlockCompressionTestSuite());
 	suite->addTest("BDateTime", DateTimeTestSuite());
 	suite->addTest("BLocker", LockerTestSuite());
 	suite->addTest("BMemoryIO", MemoryIOTestSuite());
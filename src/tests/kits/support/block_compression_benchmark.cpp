@@ -0,0 +1,307 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Compares the throughput of the compression streams with the block
+	compressing stream, and checks that the data survives the round trip.
+	Compresses the given file, or generated data.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include <DataIO.h>
+#include <File.h>
+#include <OS.h>
+
+#include <BlockCompression.h>
+#include <ZlibCompressionAlgorithm.h>
+#include <ZstdCompressionAlgorithm.h>
+
+
+static const size_t kChunkSize = 64 * 1024;
+static const int32 kRandomReads = 2000;
+static const size_t kRandomReadSize = 4096;
+
+
+static void
+generate_data(BMallocIO& data, size_t size)
+{
+	// text like data, that compresses reasonably well
+	static const char* const kWords[] = {
+		"package", "haiku", "compression", "block", "stream", "the", "a",
+		"of", "data", "index", "thread", "buffer", "random", "access", "\n"
+	};
+	const int32 kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+
+	uint32 seed = 1;
+	while ((size_t)data.Position() < size) {
+		seed = seed * 1103515245 + 12345;
+		const char* word = kWords[(seed >> 16) % kWordCount];
+		data.Write(word, strlen(word));
+		data.Write(" ", 1);
+	}
+	data.SetSize(size);
+}
+
+
+static void
+print_result(const char* name, size_t size, bigtime_t time,
+	size_t compressedSize = 0)
+{
+	printf("  %-28s %8.1f MB/s", name,
+		time > 0 ? (double)size / time : 0.0);
+	if (compressedSize > 0)
+		printf("  %5.1f%%", 100.0 * compressedSize / size);
+	printf("\n");
+}
+
+
+static bool
+check_data(const BMallocIO& data, const void* buffer, off_t offset,
+	size_t size)
+{
+	if (memcmp((const uint8*)data.Buffer() + offset, buffer, size) == 0)
+		return true;
+
+	fprintf(stderr, "data mismatch at %" B_PRIdOFF "\n", offset);
+	return false;
+}
+
+
+static bool
+benchmark_stream(const char* name, BCompressionAlgorithm* algorithm,
+	const BCompressionParameters* compressionParameters,
+	const BDecompressionParameters* decompressionParameters,
+	const BMallocIO& data)
+{
+	const uint8* input = (const uint8*)data.Buffer();
+	size_t size = data.BufferLength();
+
+	BMallocIO compressed;
+	BDataIO* stream;
+	status_t error = algorithm->CreateCompressingOutputStream(&compressed,
+		compressionParameters, stream);
+	if (error != B_OK) {
+		printf("  %s: %s\n", name, strerror(error));
+		return error == B_NOT_SUPPORTED;
+	}
+
+	bigtime_t startTime = system_time();
+	for (size_t offset = 0; offset < size; offset += kChunkSize) {
+		error = stream->WriteExactly(input + offset,
+			std::min(kChunkSize, size - offset));
+		if (error != B_OK)
+			break;
+	}
+	if (error == B_OK)
+		error = stream->Flush();
+	bigtime_t time = system_time() - startTime;
+	delete stream;
+
+	if (error != B_OK) {
+		fprintf(stderr, "%s: compressing failed: %s\n", name, strerror(error));
+		return false;
+	}
+	print_result("stream compress", size, time, compressed.BufferLength());
+
+	BMemoryIO compressedInput(compressed.Buffer(), compressed.BufferLength());
+	error = algorithm->CreateDecompressingInputStream(&compressedInput,
+		decompressionParameters, stream);
+	if (error != B_OK) {
+		fprintf(stderr, "%s: %s\n", name, strerror(error));
+		return false;
+	}
+
+	uint8* buffer = new uint8[kChunkSize];
+	bool ok = true;
+	startTime = system_time();
+	for (size_t offset = 0; ok && offset < size; offset += kChunkSize) {
+		size_t toRead = std::min(kChunkSize, size - offset);
+		ok = stream->ReadExactly(buffer, toRead) == B_OK
+			&& check_data(data, buffer, offset, toRead);
+	}
+	time = system_time() - startTime;
+	delete stream;
+	delete[] buffer;
+
+	if (ok)
+		print_result("stream decompress", size, time);
+	return ok;
+}
+
+
+static bool
+benchmark_blocks(const char* name, BCompressionAlgorithm* algorithm,
+	const BCompressionParameters* compressionParameters,
+	const BDecompressionParameters* decompressionParameters,
+	const BMallocIO& data, int32 threadCount)
+{
+	const uint8* input = (const uint8*)data.Buffer();
+	size_t size = data.BufferLength();
+
+	BMallocIO compressed;
+	bigtime_t startTime = system_time();
+	{
+		BBlockCompressingOutputStream stream(&compressed, algorithm,
+			compressionParameters);
+		status_t error = stream.Init(B_BLOCK_COMPRESSION_DEFAULT_BLOCK_SIZE,
+			threadCount);
+		for (size_t offset = 0; error == B_OK && offset < size;
+				offset += kChunkSize) {
+			error = stream.WriteExactly(input + offset,
+				std::min(kChunkSize, size - offset));
+		}
+		if (error == B_OK)
+			error = stream.Finish();
+		if (error != B_OK) {
+			fprintf(stderr, "%s: block compressing failed: %s\n", name,
+				strerror(error));
+			return false;
+		}
+	}
+	bigtime_t time = system_time() - startTime;
+
+	char resultName[64];
+	snprintf(resultName, sizeof(resultName), "blocks compress, %" B_PRId32
+		" thread%s", threadCount, threadCount == 1 ? "" : "s");
+	print_result(resultName, size, time, compressed.BufferLength());
+
+	BMemoryIO compressedInput(compressed.Buffer(), compressed.BufferLength());
+	BBlockDecompressingInputStream stream(&compressedInput, algorithm,
+		decompressionParameters);
+	status_t error = stream.Init();
+	off_t uncompressedSize;
+	if (error == B_OK)
+		error = stream.GetSize(&uncompressedSize);
+	if (error != B_OK || uncompressedSize != (off_t)size) {
+		fprintf(stderr, "%s: opening blocks failed: %s\n", name,
+			strerror(error));
+		return false;
+	}
+
+	// only check the decompression once
+	if (threadCount != 1)
+		return true;
+
+	uint8* buffer = new uint8[kChunkSize];
+	bool ok = true;
+	startTime = system_time();
+	for (size_t offset = 0; ok && offset < size; offset += kChunkSize) {
+		size_t toRead = std::min(kChunkSize, size - offset);
+		ok = stream.ReadExactly(buffer, toRead) == B_OK
+			&& check_data(data, buffer, offset, toRead);
+	}
+	time = system_time() - startTime;
+	if (ok)
+		print_result("blocks decompress", size, time);
+
+	// read small pieces from all over the data
+	uint32 seed = 1;
+	startTime = system_time();
+	for (int32 i = 0; ok && i < kRandomReads; i++) {
+		seed = seed * 1103515245 + 12345;
+		off_t offset = (off_t)seed % (size - kRandomReadSize);
+		ok = stream.ReadAtExactly(offset, buffer, kRandomReadSize) == B_OK
+			&& check_data(data, buffer, offset, kRandomReadSize);
+	}
+	time = system_time() - startTime;
+	delete[] buffer;
+
+	if (ok) {
+		printf("  %-28s %8" B_PRIdBIGTIME " us per read\n",
+			"blocks random 4 KB reads", time / kRandomReads);
+	}
+	return ok;
+}
+
+
+static bool
+benchmark(const char* name, BCompressionAlgorithm* algorithm,
+	const BCompressionParameters* compressionParameters,
+	const BDecompressionParameters* decompressionParameters,
+	const BMallocIO& data)
+{
+	printf("%s:\n", name);
+
+	// skip algorithms that weren't built in
+	size_t compressedSize;
+	if (algorithm->CompressBuffer(data.Buffer(), 16, NULL, 0, compressedSize,
+			compressionParameters) == B_NOT_SUPPORTED) {
+		printf("  not supported\n");
+		return true;
+	}
+
+	if (!benchmark_stream(name, algorithm, compressionParameters,
+			decompressionParameters, data)) {
+		return false;
+	}
+
+	system_info info;
+	int32 cpuCount = get_system_info(&info) == B_OK ? info.cpu_count : 1;
+	for (int32 threadCount = 1; threadCount <= cpuCount; threadCount *= 2) {
+		if (!benchmark_blocks(name, algorithm, compressionParameters,
+				decompressionParameters, data, threadCount)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+int
+main(int argc, const char** argv)
+{
+	BMallocIO data;
+	if (argc > 1) {
+		BFile file(argv[1], B_READ_ONLY);
+		status_t error = file.InitCheck();
+		uint8 buffer[kChunkSize];
+		while (error == B_OK) {
+			ssize_t bytesRead = file.Read(buffer, sizeof(buffer));
+			if (bytesRead <= 0) {
+				error = bytesRead;
+				break;
+			}
+			error = data.WriteExactly(buffer, bytesRead);
+		}
+		if (error != B_OK) {
+			fprintf(stderr, "could not read %s: %s\n", argv[1],
+				strerror(error));
+			return 1;
+		}
+	} else
+		generate_data(data, 64 * 1024 * 1024);
+
+	if (data.BufferLength() <= kRandomReadSize) {
+		fprintf(stderr, "the input is too small\n");
+		return 1;
+	}
+
+	printf("%" B_PRIuSIZE " bytes\n", data.BufferLength());
+
+	BZlibCompressionAlgorithm zlib;
+	BZlibCompressionParameters zlibCompressionParameters;
+	BZlibDecompressionParameters zlibDecompressionParameters;
+	if (!benchmark("zlib", &zlib, &zlibCompressionParameters,
+			&zlibDecompressionParameters, data)) {
+		return 1;
+	}
+
+	BZstdCompressionAlgorithm zstd;
+	BZstdCompressionParameters zstdCompressionParameters;
+	BZstdDecompressionParameters zstdDecompressionParameters;
+	if (!benchmark("zstd", &zstd, &zstdCompressionParameters,
+			&zstdDecompressionParameters, data)) {
+		return 1;
+	}
+
+	return 0;
+}
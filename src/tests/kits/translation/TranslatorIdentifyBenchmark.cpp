@@ -0,0 +1,105 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Measures how long the default translator roster takes to identify the
+	files in a directory, as Tracker does when it creates thumbnails. Run it
+	on a directory with a mix of images.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Directory.h>
+#include <Entry.h>
+#include <File.h>
+#include <OS.h>
+#include <TranslatorRoster.h>
+
+
+static const int32 kRuns = 5;
+
+
+int
+main(int argc, const char** argv)
+{
+	const char* path = argc > 1 ? argv[1] : "/boot/system/data/artwork";
+
+	BDirectory directory(path);
+	status_t status = directory.InitCheck();
+	if (status != B_OK) {
+		fprintf(stderr, "could not open %s: %s\n", path, strerror(status));
+		return 1;
+	}
+
+	BTranslatorRoster* roster = BTranslatorRoster::Default();
+
+	// The first run also loads the translators, and is therefore not counted
+	bigtime_t bestIdentifyTime = B_INFINITE_TIMEOUT;
+	bigtime_t bestGetTranslatorsTime = B_INFINITE_TIMEOUT;
+	int32 fileCount = 0;
+	int32 identifiedCount = 0;
+
+	for (int32 run = 0; run <= kRuns; run++) {
+		bigtime_t identifyTime = 0;
+		bigtime_t getTranslatorsTime = 0;
+		fileCount = 0;
+		identifiedCount = 0;
+
+		directory.Rewind();
+		BEntry entry;
+		while (directory.GetNextEntry(&entry) == B_OK) {
+			BFile file(&entry, B_READ_ONLY);
+			if (file.InitCheck() != B_OK)
+				continue;
+
+			fileCount++;
+
+			translator_info info;
+			bigtime_t startTime = system_time();
+			if (roster->Identify(&file, NULL, &info) == B_OK)
+				identifiedCount++;
+			identifyTime += system_time() - startTime;
+
+			translator_info* infos;
+			int32 infoCount;
+			startTime = system_time();
+			if (roster->GetTranslators(&file, NULL, &infos, &infoCount)
+					== B_OK) {
+				delete[] infos;
+			}
+			getTranslatorsTime += system_time() - startTime;
+		}
+
+		if (run == 0)
+			continue;
+		if (identifyTime < bestIdentifyTime)
+			bestIdentifyTime = identifyTime;
+		if (getTranslatorsTime < bestGetTranslatorsTime)
+			bestGetTranslatorsTime = getTranslatorsTime;
+	}
+
+	if (fileCount == 0) {
+		fprintf(stderr, "no files found in %s\n", path);
+		return 1;
+	}
+
+	translator_id* translators;
+	int32 translatorCount = 0;
+	if (roster->GetAllTranslators(&translators, &translatorCount) == B_OK)
+		delete[] translators;
+
+	printf("%" B_PRId32 " files, %" B_PRId32 " identified, %" B_PRId32
+		" translators\n", fileCount, identifiedCount, translatorCount);
+	printf("Identify():       %8" B_PRIdBIGTIME " us, %6" B_PRIdBIGTIME
+		" us per file\n", bestIdentifyTime, bestIdentifyTime / fileCount);
+	printf("GetTranslators(): %8" B_PRIdBIGTIME " us, %6" B_PRIdBIGTIME
+		" us per file\n", bestGetTranslatorsTime,
+		bestGetTranslatorsTime / fileCount);
+
+	return 0;
+}
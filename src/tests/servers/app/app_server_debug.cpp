@@ -40,7 +40,7 @@ send_debug_message(team_id team, int32 code)
 void
 usage()
 {
-	fprintf(stderr, "usage: %s -[ab] <team-id> [...]\n", __progname);
+	fprintf(stderr, "usage: %s -[abf] <team-id> [...]\n", __progname);
 	exit(1);
 }
 
@@ -53,15 +53,18 @@ main(int argc, char** argv)
 
 	bool dumpAllocator = false;
 	bool dumpBitmaps = false;
+	bool dumpFontCache = false;
 
 	int32 i = 1;
-	while (argv[i][0] == '-') {
+	while (i < argc && argv[i][0] == '-') {
 		const char* arg = &argv[i][1];
 		while (arg[0]) {
 			if (arg[0] == 'a')
 				dumpAllocator = true;
 			else if (arg[0] == 'b')
 				dumpBitmaps = true;
+			else if (arg[0] == 'f')
+				dumpFontCache = true;
 			else
 				usage();
 
@@ -81,5 +84,9 @@ main(int argc, char** argv)
 			send_debug_message(team, AS_DUMP_BITMAPS);
 	}
 
+	// the font cache is shared by all applications
+	if (dumpFontCache)
+		send_debug_message(-1, AS_DUMP_FONT_CACHE);
+
 	return 0;
 }
@@ -0,0 +1,369 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Replays a synthetic remote desktop session through the remote protocol
+	encoder and reports how many bytes per frame go over the wire, without
+	and with the bitmap cache and batch compression.
+
+	The session is a deterministic mix of what a desktop typically redraws:
+	window backgrounds, labels, a pool of icons that keep coming back and now
+	and then a larger picture that hasn't been seen before.
+*/
+
+
+#include <Bitmap.h>
+
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "BatchCompression.h"
+#include "RemoteBitmapCache.h"
+#include "RemoteMessage.h"
+#include "StreamingRingBuffer.h"
+
+
+static const int32 kFrameCount = 500;
+static const int32 kIconCount = 24;
+static const int32 kIconSize = 32;
+static const int32 kPictureSize = 256;
+static const int32 kPictureInterval = 25;
+static const uint32 kToken = 1;
+
+static const size_t kCacheMemory = 32 * 1024 * 1024;
+static const uint32 kCacheSlots = 4096;
+
+static const char* kLabels[] = {
+	"Tracker", "Deskbar", "Terminal", "StyledEdit", "WebPositive",
+	"Preferences", "home", "config", "settings", "Desktop", "Trash",
+	"Applications", "Demos", "develop", "Documents", "Music"
+};
+static const int32 kLabelCount = sizeof(kLabels) / sizeof(kLabels[0]);
+
+
+enum encoding {
+	ENCODE_PLAIN = 0,
+	ENCODE_CACHED,
+	ENCODE_CACHED_COMPRESSED,
+	ENCODE_COUNT
+};
+
+static const char* kEncodingNames[] = {
+	"plain",
+	"bitmap cache",
+	"bitmap cache + zstd"
+};
+
+
+static uint32
+next_random(uint32& seed)
+{
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 16) & 0x7fff;
+}
+
+
+static BBitmap*
+create_bitmap(int32 size, uint32 seed, bool noisy)
+{
+	BBitmap* bitmap = new(std::nothrow) BBitmap(BRect(0, 0, size - 1,
+		size - 1), B_BITMAP_NO_SERVER_LINK, B_RGBA32);
+	if (bitmap == NULL || bitmap->InitCheck() != B_OK) {
+		delete bitmap;
+		return NULL;
+	}
+
+	uint8 red = next_random(seed);
+	uint8 green = next_random(seed);
+	uint8 blue = next_random(seed);
+
+	for (int32 y = 0; y < size; y++) {
+		uint8* row = (uint8*)bitmap->Bits() + y * bitmap->BytesPerRow();
+		for (int32 x = 0; x < size; x++) {
+			// icons are smooth shapes with a transparent border, pictures
+			// have some noise that doesn't compress well
+			int32 noise = noisy ? next_random(seed) & 0x1f : 0;
+			int32 distance = abs(x - size / 2) + abs(y - size / 2);
+			row[x * 4 + 0] = blue + x * 2 + noise;
+			row[x * 4 + 1] = green + y * 2 + noise;
+			row[x * 4 + 2] = red + (x + y) + noise;
+			row[x * 4 + 3] = noisy || distance < size * 3 / 4 ? 255 : 0;
+		}
+	}
+
+	return bitmap;
+}
+
+
+class Session {
+public:
+								Session();
+								~Session();
+
+			status_t			Init();
+
+			status_t			SetEncoding(encoding encoding);
+			size_t				EncodeFrame(int32 frame);
+
+			RemoteBitmapCache&	Cache() { return fCache; }
+
+private:
+			void				_DrawBitmap(const BBitmap& bitmap,
+									BPoint where);
+			status_t			_FlushMessage();
+
+			StreamingRingBuffer	fBuffer;
+			RemoteMessage		fMessage;
+			RemoteBitmapCache	fCache;
+			BatchCompressor		fCompressor;
+			encoding			fEncoding;
+
+			BBitmap*			fIcons[kIconCount];
+
+			uint8*				fFrame;
+			size_t				fFrameLength;
+			size_t				fFrameSize;
+};
+
+
+Session::Session()
+	:
+	fBuffer(4 * 1024 * 1024),
+	fMessage(NULL, &fBuffer),
+	fEncoding(ENCODE_PLAIN),
+	fFrame(NULL),
+	fFrameLength(0),
+	fFrameSize(0)
+{
+	memset(fIcons, 0, sizeof(fIcons));
+}
+
+
+Session::~Session()
+{
+	for (int32 i = 0; i < kIconCount; i++)
+		delete fIcons[i];
+
+	free(fFrame);
+}
+
+
+status_t
+Session::Init()
+{
+	status_t result = fBuffer.InitCheck();
+	if (result != B_OK)
+		return result;
+
+	result = fCompressor.InitCheck();
+	if (result != B_OK)
+		return result;
+
+	for (int32 i = 0; i < kIconCount; i++) {
+		fIcons[i] = create_bitmap(kIconSize, i + 1, false);
+		if (fIcons[i] == NULL)
+			return B_NO_MEMORY;
+	}
+
+	return B_OK;
+}
+
+
+status_t
+Session::SetEncoding(encoding encoding)
+{
+	fEncoding = encoding;
+	if (encoding == ENCODE_PLAIN) {
+		fCache.Unset();
+		return B_OK;
+	}
+
+	return fCache.SetTo(kCacheMemory, kCacheSlots);
+}
+
+
+/*!	Encodes one frame and returns the number of bytes it takes on the wire.
+	The frame content only depends on \a frame, so that all encodings see the
+	same session.
+*/
+size_t
+Session::EncodeFrame(int32 frame)
+{
+	uint32 seed = frame * 7919 + 1;
+	fFrameLength = 0;
+
+	int32 windowCount = 1 + next_random(seed) % 3;
+	for (int32 i = 0; i < windowCount; i++) {
+		BRect rect(next_random(seed) % 800, next_random(seed) % 600, 0, 0);
+		rect.right = rect.left + 100 + next_random(seed) % 400;
+		rect.bottom = rect.top + 100 + next_random(seed) % 300;
+
+		rgb_color color = { 216, 216, 216, 255 };
+		color.red -= next_random(seed) % 32;
+
+		fMessage.Start(RP_SET_HIGH_COLOR);
+		fMessage.Add(kToken);
+		fMessage.Add(color);
+		_FlushMessage();
+
+		fMessage.Start(RP_FILL_RECT);
+		fMessage.Add(kToken);
+		fMessage.Add(rect);
+		_FlushMessage();
+
+		int32 itemCount = 4 + next_random(seed) % 12;
+		for (int32 j = 0; j < itemCount; j++) {
+			BPoint where(rect.left + next_random(seed) % 100,
+				rect.top + j * (kIconSize + 8));
+
+			_DrawBitmap(*fIcons[next_random(seed) % kIconCount], where);
+
+			const char* label = kLabels[next_random(seed) % kLabelCount];
+			fMessage.Start(RP_DRAW_STRING);
+			fMessage.Add(kToken);
+			fMessage.Add(where + BPoint(kIconSize + 4, kIconSize / 2));
+			fMessage.AddString(label, strlen(label));
+			fMessage.Add(false);
+			_FlushMessage();
+		}
+	}
+
+	if (frame % kPictureInterval == 0) {
+		// each picture is seen twice, like an image viewer being redrawn
+		BBitmap* picture = create_bitmap(kPictureSize,
+			(frame / (kPictureInterval * 2)) + 1000, true);
+		if (picture != NULL) {
+			_DrawBitmap(*picture, BPoint(200, 100));
+			delete picture;
+		}
+	}
+
+	if (fEncoding != ENCODE_CACHED_COMPRESSED)
+		return fFrameLength;
+
+	size_t compressedLength = 0;
+	for (size_t offset = 0; offset < fFrameLength; offset += kMaxBatchSize) {
+		const void* batch;
+		size_t batchLength;
+		if (fCompressor.Compress(fFrame + offset,
+				min_c(kMaxBatchSize, fFrameLength - offset), batch,
+				batchLength) != B_OK) {
+			return fFrameLength;
+		}
+
+		compressedLength += batchLength;
+	}
+
+	return compressedLength;
+}
+
+
+void
+Session::_DrawBitmap(const BBitmap& bitmap, BPoint where)
+{
+	bool cached = fEncoding != ENCODE_PLAIN;
+	BRect bounds = bitmap.Bounds();
+
+	fMessage.Start(cached ? RP_DRAW_CACHED_BITMAP : RP_DRAW_BITMAP);
+	fMessage.Add(kToken);
+	fMessage.Add(bounds);
+	fMessage.Add(bounds.OffsetToCopy(where));
+	fMessage.Add((uint32)0);
+	if (cached)
+		fMessage.AddCachedBitmap(bitmap, fCache);
+	else
+		fMessage.AddBitmap(bitmap);
+
+	_FlushMessage();
+}
+
+
+/*!	Writes the current message to the ring buffer and moves it from there to
+	the frame, so that the buffer never fills up.
+*/
+status_t
+Session::_FlushMessage()
+{
+	status_t result = fMessage.Flush();
+	if (result != B_OK)
+		return result;
+
+	uint8 header[sizeof(uint16) + sizeof(uint32)];
+	if (fBuffer.Read(header, sizeof(header)) != (int32)sizeof(header))
+		return B_ERROR;
+
+	uint32 length;
+	memcpy(&length, header + sizeof(uint16), sizeof(length));
+
+	if (fFrameLength + length > fFrameSize) {
+		size_t newSize = max_c(fFrameSize * 2, fFrameLength + length);
+		uint8* newFrame = (uint8*)realloc(fFrame, newSize);
+		if (newFrame == NULL)
+			return B_NO_MEMORY;
+
+		fFrame = newFrame;
+		fFrameSize = newSize;
+	}
+
+	memcpy(fFrame + fFrameLength, header, sizeof(header));
+	int32 bodyLength = length - sizeof(header);
+	if (bodyLength > 0 && fBuffer.Read(fFrame + fFrameLength + sizeof(header),
+			bodyLength) != bodyLength) {
+		return B_ERROR;
+	}
+
+	fFrameLength += length;
+	return B_OK;
+}
+
+
+// #pragma mark -
+
+
+int
+main(int argc, char** argv)
+{
+	Session session;
+	status_t result = session.Init();
+	if (result != B_OK) {
+		fprintf(stderr, "failed to set up the session: %s\n",
+			strerror(result));
+		return 1;
+	}
+
+	if (!BatchCompressor::IsSupported())
+		printf("zstd is not available, batches will be stored uncompressed\n");
+
+	printf("%" B_PRId32 " frames\n\n", kFrameCount);
+	printf("%-22s %12s %12s %12s\n", "encoding", "total", "per frame",
+		"max frame");
+
+	for (int32 i = 0; i < ENCODE_COUNT; i++) {
+		result = session.SetEncoding((encoding)i);
+		if (result != B_OK) {
+			fprintf(stderr, "failed to set up encoding %s: %s\n",
+				kEncodingNames[i], strerror(result));
+			return 1;
+		}
+
+		uint64 total = 0;
+		size_t maxFrame = 0;
+		for (int32 frame = 0; frame < kFrameCount; frame++) {
+			size_t length = session.EncodeFrame(frame);
+			total += length;
+			maxFrame = max_c(maxFrame, length);
+		}
+
+		printf("%-22s %12" B_PRIu64 " %12" B_PRIu64 " %12" B_PRIuSIZE "\n",
+			kEncodingNames[i], total, total / kFrameCount, maxFrame);
+	}
+
+	RemoteBitmapCache& cache = session.Cache();
+	printf("\nbitmap cache: %" B_PRIu64 " hits, %" B_PRIu64 " misses, %"
+		B_PRIu64 " bytes saved over the cached runs\n", cache.Hits(),
+		cache.Misses(), cache.BytesSaved());
+	return 0;
+}
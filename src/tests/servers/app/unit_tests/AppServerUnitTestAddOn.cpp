@@ -7,6 +7,7 @@
 #include <TestSuiteAddon.h>
 
 #include "SimpleTransformTest.h"
+#include "SpanBlendTest.h"
 
 
 BTestSuite*
@@ -15,6 +16,7 @@ getTestSuite()
 	BTestSuite* suite = new BTestSuite("AppServerUnitTests");
 
 	SimpleTransformTest::AddTests(*suite);
+	SpanBlendTest::AddTests(*suite);
 
 	return suite;
 }
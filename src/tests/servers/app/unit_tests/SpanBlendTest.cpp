@@ -0,0 +1,249 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include "SpanBlendTest.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestSuite.h>
+
+#include "DrawingMode.h"
+#include "SpanBlendSSE2.h"
+
+
+// The SSE2 span blenders have to produce exactly what the scalar macros
+// produce, so every test runs both on the same random data and compares
+// the results byte by byte. The span lengths are chosen to cover the
+// vectorized part as well as the scalar tail.
+
+
+static const unsigned kMaxLength = 67;
+static const int kRounds = 200;
+
+
+static void
+fill_random(uint8* buffer, size_t size)
+{
+	for (size_t i = 0; i < size; i++)
+		buffer[i] = rand() & 0xff;
+}
+
+
+// Makes sure the special cover values 0 and 255 show up often enough.
+static void
+fill_random_covers(uint8* covers, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		switch (rand() % 4) {
+			case 0:
+				covers[i] = 0;
+				break;
+			case 1:
+				covers[i] = 255;
+				break;
+			default:
+				covers[i] = rand() & 0xff;
+				break;
+		}
+	}
+}
+
+
+// Leaves about every fourth pixel not fully opaque.
+static void
+fill_random_alpha(uint8* pixels, unsigned length)
+{
+	for (unsigned i = 0; i < length; i++) {
+		switch (rand() % 8) {
+			case 0:
+				pixels[i * 4 + 3] = 0;
+				break;
+			case 1:
+				pixels[i * 4 + 3] = rand() & 0xff;
+				break;
+			default:
+				pixels[i * 4 + 3] = 255;
+				break;
+		}
+	}
+}
+
+
+void
+SpanBlendTest::FillSpan()
+{
+#if PAINTER_SSE2_SPANS
+	uint8 expected[kMaxLength * 4];
+	uint8 result[kMaxLength * 4];
+
+	for (unsigned length = 0; length <= kMaxLength; length++) {
+		uint8 r = rand(), g = rand(), b = rand();
+		fill_random(expected, sizeof(expected));
+		memcpy(result, expected, sizeof(result));
+
+		for (unsigned i = 0; i < length; i++) {
+			expected[i * 4 + 0] = b;
+			expected[i * 4 + 1] = g;
+			expected[i * 4 + 2] = r;
+			expected[i * 4 + 3] = 255;
+		}
+		fill_span32_sse2(result, length, r, g, b);
+
+		CPPUNIT_ASSERT(memcmp(expected, result, sizeof(result)) == 0);
+	}
+#endif
+}
+
+
+void
+SpanBlendTest::BlendHLine()
+{
+#if PAINTER_SSE2_SPANS
+	uint8 expected[kMaxLength * 4];
+	uint8 result[kMaxLength * 4];
+
+	for (int round = 0; round < kRounds; round++) {
+		unsigned length = rand() % (kMaxLength + 1);
+		uint8 r = rand(), g = rand(), b = rand();
+		uint8 cover = rand();
+		fill_random(expected, sizeof(expected));
+		memcpy(result, expected, sizeof(result));
+
+		uint8* p = expected;
+		for (unsigned i = 0; i < length; i++, p += 4)
+			BLEND(p, r, g, b, cover);
+		blend_hline32_sse2(result, length, r, g, b, cover);
+
+		CPPUNIT_ASSERT(memcmp(expected, result, sizeof(result)) == 0);
+	}
+#endif
+}
+
+
+void
+SpanBlendTest::BlendSolidSpan()
+{
+#if PAINTER_SSE2_SPANS
+	uint8 expected[kMaxLength * 4];
+	uint8 result[kMaxLength * 4];
+	uint8 covers[kMaxLength];
+
+	for (int round = 0; round < kRounds; round++) {
+		unsigned length = rand() % (kMaxLength + 1);
+		uint8 r = rand(), g = rand(), b = rand();
+		fill_random(expected, sizeof(expected));
+		fill_random_covers(covers, length);
+		memcpy(result, expected, sizeof(result));
+
+		uint8* p = expected;
+		for (unsigned i = 0; i < length; i++, p += 4) {
+			if (covers[i] == 255) {
+				p[0] = b;
+				p[1] = g;
+				p[2] = r;
+				p[3] = 255;
+			} else if (covers[i] != 0)
+				BLEND(p, r, g, b, covers[i]);
+		}
+		blend_solid_span32_sse2(result, length, r, g, b, covers, false);
+
+		CPPUNIT_ASSERT(memcmp(expected, result, sizeof(result)) == 0);
+	}
+#endif
+}
+
+
+void
+SpanBlendTest::BlendSolidSpanComposite()
+{
+#if PAINTER_SSE2_SPANS
+	uint8 expected[kMaxLength * 4];
+	uint8 result[kMaxLength * 4];
+	uint8 covers[kMaxLength];
+
+	for (int round = 0; round < kRounds; round++) {
+		unsigned length = rand() % (kMaxLength + 1);
+		uint8 r = rand(), g = rand(), b = rand();
+		fill_random(expected, sizeof(expected));
+		fill_random_alpha(expected, kMaxLength);
+		fill_random_covers(covers, length);
+		memcpy(result, expected, sizeof(result));
+
+		uint8* p = expected;
+		for (unsigned i = 0; i < length; i++, p += 4) {
+			if (covers[i] == 255) {
+				p[0] = b;
+				p[1] = g;
+				p[2] = r;
+				p[3] = 255;
+			} else if (covers[i] != 0)
+				BLEND_COMPOSITE(p, r, g, b, covers[i]);
+		}
+		blend_solid_span32_sse2(result, length, r, g, b, covers, true);
+
+		CPPUNIT_ASSERT(memcmp(expected, result, sizeof(result)) == 0);
+	}
+#endif
+}
+
+
+void
+SpanBlendTest::BlendSubpixSpan()
+{
+#if PAINTER_SSE2_SPANS
+	uint8 expected[kMaxLength * 4];
+	uint8 result[kMaxLength * 4];
+	uint8 covers[kMaxLength * 3];
+
+	for (int round = 0; round < kRounds; round++) {
+		unsigned length = rand() % (kMaxLength + 1);
+		uint8 r = rand(), g = rand(), b = rand();
+		// covers[0] or covers[2] go to the red channel depending on the
+		// subpixel ordering
+		int subpixelL = (round & 1) != 0 ? 2 : 0;
+		int subpixelR = 2 - subpixelL;
+		fill_random(expected, sizeof(expected));
+		fill_random_covers(covers, length * 3);
+		memcpy(result, expected, sizeof(result));
+
+		uint8* p = expected;
+		const uint8* c = covers;
+		for (unsigned i = 0; i < length; i++, p += 4, c += 3)
+			BLEND_SUBPIX(p, r, g, b, c[subpixelL], c[1], c[subpixelR]);
+		blend_subpix_span32_sse2(result, length, r, g, b, covers, subpixelL,
+			subpixelR);
+
+		CPPUNIT_ASSERT(memcmp(expected, result, sizeof(result)) == 0);
+	}
+#endif
+}
+
+
+/* static */ void
+SpanBlendTest::AddTests(BTestSuite& parent)
+{
+	CppUnit::TestSuite* const suite = new CppUnit::TestSuite(
+		"SpanBlendTest");
+
+	suite->addTest(new CppUnit::TestCaller<SpanBlendTest>(
+		"SpanBlendTest::FillSpan",
+		&SpanBlendTest::FillSpan));
+	suite->addTest(new CppUnit::TestCaller<SpanBlendTest>(
+		"SpanBlendTest::BlendHLine",
+		&SpanBlendTest::BlendHLine));
+	suite->addTest(new CppUnit::TestCaller<SpanBlendTest>(
+		"SpanBlendTest::BlendSolidSpan",
+		&SpanBlendTest::BlendSolidSpan));
+	suite->addTest(new CppUnit::TestCaller<SpanBlendTest>(
+		"SpanBlendTest::BlendSolidSpanComposite",
+		&SpanBlendTest::BlendSolidSpanComposite));
+	suite->addTest(new CppUnit::TestCaller<SpanBlendTest>(
+		"SpanBlendTest::BlendSubpixSpan",
+		&SpanBlendTest::BlendSubpixSpan));
+
+	parent.addTest("SpanBlendTest", suite);
+}
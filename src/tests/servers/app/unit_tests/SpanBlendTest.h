@@ -0,0 +1,24 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef SPAN_BLEND_TEST_H
+#define SPAN_BLEND_TEST_H
+
+#include <TestCase.h>
+#include <TestSuite.h>
+
+
+class SpanBlendTest : public BTestCase {
+public:
+	static	void			AddTests(BTestSuite& parent);
+
+			void			FillSpan();
+			void			BlendHLine();
+			void			BlendSolidSpan();
+			void			BlendSolidSpanComposite();
+			void			BlendSubpixSpan();
+};
+
+
+#endif // SPAN_BLEND_TEST_H
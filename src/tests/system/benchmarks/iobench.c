@@ -0,0 +1,291 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*
+ * Measures random I/O operations per second and latencies of a block device.
+ * Every thread has one request in flight, so the thread count is the queue
+ * depth.
+ *
+ * To compare the emulated NVMe and virtio-blk devices of QEMU, attach the
+ * same image to both, and run the test against each of them:
+ *
+ *	qemu-system-x86_64 ... -smp 4 \
+ *		-drive file=test.img,if=none,id=nvm,format=raw,cache=none \
+ *		-device nvme,serial=iobench,drive=nvm \
+ *		-drive file=test.img,if=none,id=vblk,format=raw,cache=none,snapshot=on \
+ *		-device virtio-blk-pci,drive=vblk,num-queues=4
+ *
+ *	iobench -t 16 /dev/disk/nvme/0/raw
+ *	iobench -t 16 /dev/disk/virtual/virtio_block/0/raw
+ *
+ * Running the virtio-blk test with num-queues=1 shows what the per-CPU
+ * queues gain.
+ */
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <Drivers.h>
+#include <OS.h>
+
+
+#define MAX_THREADS			256
+#define LATENCY_BUCKETS		10000
+	// one bucket per microsecond, the last one gets everything slower
+
+
+typedef struct {
+	int			fd;
+	thread_id	thread;
+	uint32		seed;
+	void*		buffer;
+	uint64		count;
+	uint64		errors;
+	bigtime_t	total_latency;
+	bigtime_t	max_latency;
+	uint32		latencies[LATENCY_BUCKETS];
+} thread_data;
+
+
+static off_t sBlockCount;
+static size_t sBlockSize = 4096;
+static bool sWrite = false;
+static bool sSequential = false;
+static volatile bool sQuit = false;
+static int32 sNextBlock = 0;
+
+
+static void
+usage(int status)
+{
+	fprintf(stderr,
+		"Usage: iobench [options] <device>\n"
+		"Measures random I/O operations per second, and latencies.\n\n"
+		"  -b <size>\tblock size in bytes (default 4096)\n"
+		"  -d <seconds>\tduration of the test (default 10)\n"
+		"  -t <count>\tnumber of threads, ie. queue depth (default 1)\n"
+		"  -s\t\tsequential instead of random access\n"
+		"  -w\t\twrite instead of read; this destroys the data on the "
+			"device!\n");
+	exit(status);
+}
+
+
+static off_t
+next_block(thread_data* data)
+{
+	if (sSequential)
+		return (off_t)(uint32)atomic_add(&sNextBlock, 1) % sBlockCount;
+
+	// xorshift, as rand() would serialize the threads
+	data->seed ^= data->seed << 13;
+	data->seed ^= data->seed >> 17;
+	data->seed ^= data->seed << 5;
+
+	return (((off_t)data->seed << 16) ^ (data->seed >> 3)) % sBlockCount;
+}
+
+
+static status_t
+io_thread(void* _data)
+{
+	thread_data* data = (thread_data*)_data;
+
+	while (!sQuit) {
+		off_t offset = next_block(data) * sBlockSize;
+		bigtime_t start = system_time();
+
+		ssize_t bytes;
+		if (sWrite)
+			bytes = pwrite(data->fd, data->buffer, sBlockSize, offset);
+		else
+			bytes = pread(data->fd, data->buffer, sBlockSize, offset);
+
+		bigtime_t latency = system_time() - start;
+
+		if (bytes != (ssize_t)sBlockSize) {
+			data->errors++;
+			continue;
+		}
+
+		data->count++;
+		data->total_latency += latency;
+		data->latencies[latency < LATENCY_BUCKETS
+			? latency : LATENCY_BUCKETS - 1]++;
+		if (latency > data->max_latency)
+			data->max_latency = latency;
+	}
+
+	return B_OK;
+}
+
+
+static bigtime_t
+percentile(const uint64* latencies, uint64 count, int perMille)
+{
+	uint64 wanted = (count * perMille + 999) / 1000;
+	uint64 seen = 0;
+
+	for (int32 i = 0; i < LATENCY_BUCKETS; i++) {
+		seen += latencies[i];
+		if (seen >= wanted)
+			return i;
+	}
+
+	return LATENCY_BUCKETS - 1;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int threadCount = 1;
+	int duration = 10;
+
+	int option;
+	while ((option = getopt(argc, argv, "b:d:t:swh")) != -1) {
+		switch (option) {
+			case 'b':
+				sBlockSize = strtoul(optarg, NULL, 0);
+				break;
+			case 'd':
+				duration = atoi(optarg);
+				break;
+			case 't':
+				threadCount = atoi(optarg);
+				break;
+			case 's':
+				sSequential = true;
+				break;
+			case 'w':
+				sWrite = true;
+				break;
+			case 'h':
+				usage(0);
+				break;
+			default:
+				usage(1);
+				break;
+		}
+	}
+
+	if (optind + 1 != argc || sBlockSize == 0 || duration <= 0
+		|| threadCount <= 0 || threadCount > MAX_THREADS)
+		usage(1);
+
+	const char* device = argv[optind];
+	int fd = open(device, sWrite ? O_RDWR : O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "iobench: could not open %s: %s\n", device,
+			strerror(errno));
+		return 1;
+	}
+
+	device_geometry geometry;
+	off_t size;
+	if (ioctl(fd, B_GET_GEOMETRY, &geometry, sizeof(geometry)) == 0) {
+		size = (off_t)geometry.bytes_per_sector * geometry.sectors_per_track
+			* geometry.cylinder_count * geometry.head_count;
+	} else
+		size = lseek(fd, 0, SEEK_END);
+
+	sBlockCount = size / sBlockSize;
+	if (sBlockCount <= 0) {
+		fprintf(stderr, "iobench: %s is too small.\n", device);
+		return 1;
+	}
+
+	thread_data* threads = (thread_data*)calloc(threadCount,
+		sizeof(thread_data));
+	if (threads == NULL) {
+		fprintf(stderr, "iobench: out of memory\n");
+		return 1;
+	}
+
+	for (int i = 0; i < threadCount; i++) {
+		thread_data* data = &threads[i];
+		data->fd = fd;
+		data->seed = (uint32)(system_time() + i * 7919) | 1;
+		if (posix_memalign(&data->buffer, B_PAGE_SIZE, sBlockSize) != 0) {
+			fprintf(stderr, "iobench: out of memory\n");
+			return 1;
+		}
+		memset(data->buffer, 0x55, sBlockSize);
+
+		data->thread = spawn_thread(io_thread, "iobench", B_NORMAL_PRIORITY,
+			data);
+		if (data->thread < 0) {
+			fprintf(stderr, "iobench: could not spawn thread: %s\n",
+				strerror(data->thread));
+			return 1;
+		}
+	}
+
+	printf("%s: %s %s, %zu bytes, %d thread%s, %d seconds\n", device,
+		sSequential ? "sequential" : "random", sWrite ? "writes" : "reads",
+		sBlockSize, threadCount, threadCount == 1 ? "" : "s", duration);
+
+	bigtime_t start = system_time();
+	for (int i = 0; i < threadCount; i++)
+		resume_thread(threads[i].thread);
+
+	snooze((bigtime_t)duration * 1000000);
+	sQuit = true;
+
+	for (int i = 0; i < threadCount; i++) {
+		status_t result;
+		wait_for_thread(threads[i].thread, &result);
+	}
+	bigtime_t elapsed = system_time() - start;
+
+	// merge the results of all threads
+
+	static uint64 latencies[LATENCY_BUCKETS];
+	uint64 count = 0;
+	uint64 errors = 0;
+	bigtime_t total = 0;
+	bigtime_t maxLatency = 0;
+
+	for (int i = 0; i < threadCount; i++) {
+		thread_data* data = &threads[i];
+		count += data->count;
+		total += data->total_latency;
+		errors += data->errors;
+		if (data->max_latency > maxLatency)
+			maxLatency = data->max_latency;
+
+		for (int32 j = 0; j < LATENCY_BUCKETS; j++)
+			latencies[j] += data->latencies[j];
+	}
+
+	if (count == 0) {
+		fprintf(stderr, "iobench: all %" B_PRIu64 " operations failed\n",
+			errors);
+		return 1;
+	}
+
+	double iops = count * 1000000.0 / elapsed;
+	printf("  %.0f IOPS, %.1f MB/s", iops,
+		iops * sBlockSize / (1024 * 1024));
+	if (errors != 0)
+		printf(", %" B_PRIu64 " errors", errors);
+	printf("\n");
+
+	printf("  latency (usecs): avg %" B_PRIdBIGTIME ", 50%% %" B_PRIdBIGTIME
+		", 90%% %" B_PRIdBIGTIME ", 99%% %" B_PRIdBIGTIME ", 99.9%% %"
+		B_PRIdBIGTIME ", max %" B_PRIdBIGTIME "\n", total / (bigtime_t)count,
+		percentile(latencies, count, 500), percentile(latencies, count, 900),
+		percentile(latencies, count, 990), percentile(latencies, count, 999),
+		maxLatency);
+
+	close(fd);
+	return 0;
+}
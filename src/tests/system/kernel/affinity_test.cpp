@@ -0,0 +1,135 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Checks that the CPU mask of a thread can be set and read back, that it is
+	inherited by new threads and forked teams, and that invalid masks are
+	refused.
+*/
+
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <OS.h>
+#include <syscalls.h>
+
+
+static const int32 kMaskWords = 32;
+
+
+static bool
+get_mask(thread_id thread, uint32* mask)
+{
+	memset(mask, 0, kMaskWords * sizeof(uint32));
+	status_t status = _kern_get_thread_affinity(thread, mask,
+		kMaskWords * sizeof(uint32));
+	if (status != B_OK) {
+		fprintf(stderr, "getting the mask of %" B_PRId32 " failed: %s\n",
+			thread, strerror(status));
+		return false;
+	}
+	return true;
+}
+
+
+static bool
+check_mask(thread_id thread, const uint32* expected, const char* what)
+{
+	uint32 mask[kMaskWords];
+	if (!get_mask(thread, mask))
+		return false;
+
+	if (memcmp(mask, expected, sizeof(mask)) != 0) {
+		fprintf(stderr, "%s: mask is %#" B_PRIx32 ", expected %#" B_PRIx32
+			"\n", what, mask[0], expected[0]);
+		return false;
+	}
+	return true;
+}
+
+
+static status_t
+spin(void*)
+{
+	bigtime_t end = system_time() + 100000;
+	while (system_time() < end)
+		;
+	return B_OK;
+}
+
+
+int
+main()
+{
+	system_info info;
+	get_system_info(&info);
+	int32 cpuCount = info.cpu_count;
+
+	uint32 all[kMaskWords];
+	memset(all, 0, sizeof(all));
+	for (int32 i = 0; i < cpuCount; i++)
+		all[i / 32] |= 1u << (i % 32);
+
+	if (!check_mask(0, all, "initial mask"))
+		return 1;
+
+	// an empty mask, and one with only non-existing CPUs, are refused
+	uint32 mask[kMaskWords];
+	memset(mask, 0, sizeof(mask));
+	if (_kern_set_thread_affinity(0, mask, sizeof(mask)) != B_BAD_VALUE) {
+		fprintf(stderr, "empty mask was accepted\n");
+		return 1;
+	}
+	if (cpuCount < kMaskWords * 32) {
+		mask[kMaskWords - 1] = 1u << 31;
+		if (_kern_set_thread_affinity(0, mask, sizeof(mask)) != B_BAD_VALUE) {
+			fprintf(stderr, "mask without existing CPUs was accepted\n");
+			return 1;
+		}
+	}
+
+	// restrict ourselves to the last CPU, and keep running there
+	memset(mask, 0, sizeof(mask));
+	mask[(cpuCount - 1) / 32] = 1u << ((cpuCount - 1) % 32);
+	status_t status = _kern_set_thread_affinity(0, mask, sizeof(mask));
+	if (status != B_OK) {
+		fprintf(stderr, "setting the mask failed: %s\n", strerror(status));
+		return 1;
+	}
+	if (!check_mask(find_thread(NULL), mask, "own mask"))
+		return 1;
+	spin(NULL);
+
+	// new threads inherit the mask
+	thread_id thread = spawn_thread(spin, "spinner", B_NORMAL_PRIORITY, NULL);
+	if (!check_mask(thread, mask, "spawned thread"))
+		return 1;
+	resume_thread(thread);
+	wait_for_thread(thread, &status);
+
+	// and so do forked teams
+	pid_t child = fork();
+	if (child == 0)
+		return check_mask(0, mask, "forked team") ? 0 : 1;
+
+	int childStatus;
+	if (child < 0 || waitpid(child, &childStatus, 0) != child
+		|| !WIFEXITED(childStatus) || WEXITSTATUS(childStatus) != 0) {
+		fprintf(stderr, "forked team failed\n");
+		return 1;
+	}
+
+	// setting all CPUs removes the restriction again
+	if (_kern_set_thread_affinity(0, all, sizeof(all)) != B_OK
+		|| !check_mask(0, all, "reset mask")) {
+		return 1;
+	}
+
+	printf("all tests passed\n");
+	return 0;
+}
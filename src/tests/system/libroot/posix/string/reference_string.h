@@ -0,0 +1,135 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef REFERENCE_STRING_H
+#define REFERENCE_STRING_H
+
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+// The generic C implementations of the string functions that are vectorized
+// on some architectures.
+
+
+#define LACKS_ZERO_BYTE(value) \
+	(((value - 0x01010101) & ~value & 0x80808080) == 0)
+
+
+static void*
+reference_memchr(const void* source, int value, size_t length)
+{
+	const unsigned char* bytes = (const unsigned char*)source;
+	for (size_t i = 0; i < length; i++) {
+		if (bytes[i] == (unsigned char)value)
+			return (void*)(bytes + i);
+	}
+	return NULL;
+}
+
+
+static int
+reference_memcmp(const void* _a, const void* _b, size_t length)
+{
+	const unsigned char* a = (const unsigned char*)_a;
+	const unsigned char* b = (const unsigned char*)_b;
+	while (length-- > 0) {
+		int cmp = *a++ - *b++;
+		if (cmp != 0)
+			return cmp;
+	}
+	return 0;
+}
+
+
+static char*
+reference_strchr(const char* string, int character)
+{
+	for (; *string != (char)character; string++) {
+		if (*string == '\0')
+			return NULL;
+	}
+	return (char*)string;
+}
+
+
+static int
+reference_strcmp(const char* a, const char* b)
+{
+	while (true) {
+		int cmp = (unsigned char)*a - (unsigned char)*b++;
+		if (cmp != 0 || *a++ == '\0')
+			return cmp;
+	}
+}
+
+
+static size_t
+reference_strlen(const char* string)
+{
+	size_t length = 0;
+
+	/* Align access for four byte reads */
+	for (; (((uintptr_t)string + length) & 3) != 0; length++) {
+		if (string[length] == '\0')
+			return length;
+	}
+
+	/* Check four bytes for zero char */
+	uint32_t* valuePointer = (uint32_t*)(string + length);
+	for (; LACKS_ZERO_BYTE(*valuePointer); valuePointer++)
+		;
+
+	/* Find the exact length */
+	for (length = ((char*)valuePointer) - string; string[length] != '\0';
+		length++)
+		;
+
+	return length;
+}
+
+
+static size_t
+reference_strnlen(const char* string, size_t count)
+{
+	size_t length = 0;
+
+	/* Align access for four byte reads */
+	for (; (((uintptr_t)string + length) & 3) != 0; length++) {
+		if (length == count || string[length] == '\0')
+			return length;
+	}
+
+	/* Check four bytes for zero char */
+	const uint32_t* kMaxScanPosition = (uint32_t*)(string + count - 4);
+	uint32_t* valuePointer = (uint32_t*)(string + length);
+	for (; valuePointer <= kMaxScanPosition && LACKS_ZERO_BYTE(*valuePointer);
+		valuePointer++)
+		;
+
+	/* Find the exact length */
+	for (length = ((char*)valuePointer) - string; length < count
+		&& string[length] != '\0'; length++)
+		;
+
+	return length;
+}
+
+
+static char*
+reference_strrchr(const char* string, int character)
+{
+	const char* last = NULL;
+	for (;; string++) {
+		if (*string == (char)character)
+			last = string;
+		if (*string == '\0')
+			break;
+	}
+	return (char*)last;
+}
+
+
+#endif	// REFERENCE_STRING_H
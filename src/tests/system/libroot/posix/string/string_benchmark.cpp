@@ -0,0 +1,135 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Measures the throughput of the string functions of libroot, and of plain
+	C versions of them, for a few string lengths.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <OS.h>
+
+#include "reference_string.h"
+
+
+static const size_t kLengths[] = { 8, 32, 128, 1024, 16384, 262144 };
+static const size_t kBytesPerRun = 64 * 1024 * 1024;
+
+static char* sString;
+static char* sOtherString;
+static size_t sLength;
+
+
+struct Benchmark {
+	const char*	name;
+	size_t		(*function)();
+	size_t		(*reference)();
+};
+
+
+// The functions are called through pointers, so that the compiler can't
+// replace them with its builtins.
+static void* (* volatile sMemchr)(const void*, int, size_t) = memchr;
+static int (* volatile sMemcmp)(const void*, const void*, size_t) = memcmp;
+static char* (* volatile sStrchr)(const char*, int) = strchr;
+static int (* volatile sStrcmp)(const char*, const char*) = strcmp;
+static size_t (* volatile sStrlen)(const char*) = strlen;
+static size_t (* volatile sStrnlen)(const char*, size_t) = strnlen;
+static char* (* volatile sStrrchr)(const char*, int) = strrchr;
+
+
+#define BENCHMARK(name, call, referenceCall) \
+	static size_t name() { return (size_t)(call); } \
+	static size_t name##_reference() { return (size_t)(referenceCall); }
+
+BENCHMARK(bench_memchr, sMemchr(sString, 'x', sLength),
+	reference_memchr(sString, 'x', sLength))
+BENCHMARK(bench_memcmp, sMemcmp(sString, sOtherString, sLength),
+	reference_memcmp(sString, sOtherString, sLength))
+BENCHMARK(bench_strchr, sStrchr(sString, 'x'), reference_strchr(sString, 'x'))
+BENCHMARK(bench_strcmp, sStrcmp(sString, sOtherString),
+	reference_strcmp(sString, sOtherString))
+BENCHMARK(bench_strlen, sStrlen(sString), reference_strlen(sString))
+BENCHMARK(bench_strnlen, sStrnlen(sString, sLength + 1),
+	reference_strnlen(sString, sLength + 1))
+BENCHMARK(bench_strrchr, sStrrchr(sString, 'x'),
+	reference_strrchr(sString, 'x'))
+
+static const Benchmark kBenchmarks[] = {
+	{ "memchr", bench_memchr, bench_memchr_reference },
+	{ "memcmp", bench_memcmp, bench_memcmp_reference },
+	{ "strchr", bench_strchr, bench_strchr_reference },
+	{ "strcmp", bench_strcmp, bench_strcmp_reference },
+	{ "strlen", bench_strlen, bench_strlen_reference },
+	{ "strnlen", bench_strnlen, bench_strnlen_reference },
+	{ "strrchr", bench_strrchr, bench_strrchr_reference },
+};
+
+
+static double
+measure(size_t (*function)(), size_t length)
+{
+	// calling through a volatile pointer keeps the compiler from moving the
+	// call out of the loop
+	size_t (* volatile call)() = function;
+	size_t runs = kBytesPerRun / length;
+	volatile size_t sink = 0;
+
+	bigtime_t start = system_time();
+	for (size_t i = 0; i < runs; i++)
+		sink += call();
+	bigtime_t time = system_time() - start;
+
+	(void)sink;
+	return time > 0 ? (double)runs * length / time : 0;
+		// bytes per microsecond, ie. MB/s
+}
+
+
+int
+main(int argc, char** argv)
+{
+	size_t maxLength = kLengths[sizeof(kLengths) / sizeof(kLengths[0]) - 1];
+
+	// neither string contains the character searched for, so the whole
+	// string is always scanned
+	sString = (char*)malloc(maxLength + 1);
+	sOtherString = (char*)malloc(maxLength + 1);
+	if (sString == NULL || sOtherString == NULL) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	for (size_t i = 0; i < maxLength; i++)
+		sString[i] = 'a' + i % 23;
+
+	printf("%-8s %8s %12s %12s %8s\n", "function", "length", "libroot MB/s",
+		"C MB/s", "speedup");
+
+	for (size_t i = 0; i < sizeof(kBenchmarks) / sizeof(kBenchmarks[0]); i++) {
+		const Benchmark& benchmark = kBenchmarks[i];
+		if (argc > 1 && strcmp(argv[1], benchmark.name) != 0)
+			continue;
+
+		for (size_t j = 0; j < sizeof(kLengths) / sizeof(kLengths[0]); j++) {
+			sLength = kLengths[j];
+			sString[sLength] = '\0';
+			memcpy(sOtherString, sString, sLength + 1);
+
+			double speed = measure(benchmark.function, sLength);
+			double referenceSpeed = measure(benchmark.reference, sLength);
+			printf("%-8s %8zu %12.0f %12.0f %7.1fx\n", benchmark.name, sLength,
+				speed, referenceSpeed,
+				referenceSpeed > 0 ? speed / referenceSpeed : 0.0);
+
+			sString[sLength] = 'a' + sLength % 23;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Compares the string functions of libroot against plain C versions, on
+	random data of random lengths and alignments. The data is placed right
+	in front of an inaccessible page, so that reading past the end of a
+	string is caught as well.
+*/
+
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "reference_string.h"
+
+
+static const size_t kMaxLength = 512;
+
+// The functions are called through pointers, so that the compiler can't
+// replace them with its builtins.
+static void* (* volatile sMemchr)(const void*, int, size_t) = memchr;
+static int (* volatile sMemcmp)(const void*, const void*, size_t) = memcmp;
+static char* (* volatile sStrchr)(const char*, int) = strchr;
+static int (* volatile sStrcmp)(const char*, const char*) = strcmp;
+static size_t (* volatile sStrlen)(const char*) = strlen;
+static size_t (* volatile sStrnlen)(const char*, size_t) = strnlen;
+static char* (* volatile sStrrchr)(const char*, int) = strrchr;
+
+static int sFailures = 0;
+
+
+static int
+sign(int value)
+{
+	return value < 0 ? -1 : value > 0 ? 1 : 0;
+}
+
+
+static void
+fail(const char* function, const char* string, size_t length, size_t iteration)
+{
+	fprintf(stderr, "%s() failed in iteration %zu: length %zu, alignment %zu\n",
+		function, iteration, length, (size_t)((uintptr_t)string % 64));
+	if (++sFailures > 20)
+		exit(1);
+}
+
+
+/*!	Returns a buffer of \a size bytes that ends right in front of a page
+	that can't be accessed.
+*/
+static char*
+allocate_guarded_buffer(size_t size)
+{
+	size_t pageSize = sysconf(_SC_PAGESIZE);
+	size_t areaSize = (size + pageSize - 1) / pageSize * pageSize + pageSize;
+
+	void* area = mmap(NULL, areaSize, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (area == MAP_FAILED) {
+		perror("mmap");
+		exit(1);
+	}
+
+	char* guard = (char*)area + areaSize - pageSize;
+	if (mprotect(guard, pageSize, PROT_NONE) != 0) {
+		perror("mprotect");
+		exit(1);
+	}
+
+	return guard - size;
+}
+
+
+static void
+fill_random(char* buffer, size_t length)
+{
+	// Use a small alphabet most of the time, to get a lot of matches, and
+	// bytes with the highest bit set, as those compare differently when
+	// treated as signed.
+	for (size_t i = 0; i < length; i++) {
+		if (rand() % 4 == 0)
+			buffer[i] = (char)(rand() % 255 + 1);
+		else
+			buffer[i] = "aAb\x80\xff"[rand() % 5];
+	}
+}
+
+
+static void
+test_iteration(char* bufferEnd, char* otherBufferEnd, size_t iteration)
+{
+	size_t length = rand() % kMaxLength;
+	size_t slack = rand() % 3 == 0 ? 0 : rand() % 64;
+
+	// the string (including its null) ends slack bytes before the guard page
+	char* string = bufferEnd - slack - length - 1;
+	fill_random(string, length);
+	string[length] = '\0';
+
+	char character = rand() % 8 == 0 ? '\0' : string[rand() % (length + 1)];
+	if (rand() % 4 == 0)
+		character = (char)rand();
+
+	if (sStrlen(string) != reference_strlen(string))
+		fail("strlen", string, length, iteration);
+
+	size_t count = rand() % (length + 64);
+	if (count > length + 1 + slack)
+		count = length + 1 + slack;
+	if (sStrnlen(string, count) != reference_strnlen(string, count))
+		fail("strnlen", string, length, iteration);
+
+	if (sStrchr(string, character) != reference_strchr(string, character))
+		fail("strchr", string, length, iteration);
+
+	if (sStrrchr(string, character) != reference_strrchr(string, character))
+		fail("strrchr", string, length, iteration);
+
+	size_t memoryLength = rand() % (length + slack + 2);
+	if (sMemchr(string, character, memoryLength)
+			!= reference_memchr(string, character, memoryLength)) {
+		fail("memchr", string, length, iteration);
+	}
+
+	// the other string is a copy, differing in one position at most
+	size_t otherSlack = rand() % 64;
+	char* other = otherBufferEnd - otherSlack - length - 1;
+	memcpy(other, string, length + 1);
+	if (rand() % 2 == 0 && length > 0) {
+		size_t position = rand() % length;
+		other[position] = (char)(rand() % 255 + 1);
+	}
+	if (rand() % 8 == 0)
+		other[rand() % (length + 1)] = '\0';
+
+	if (sign(sStrcmp(string, other)) != sign(reference_strcmp(string, other)))
+		fail("strcmp", string, length, iteration);
+	if (sign(sStrcmp(other, string)) != sign(reference_strcmp(other, string)))
+		fail("strcmp", other, length, iteration);
+
+	if (sign(sMemcmp(string, other, length))
+			!= sign(reference_memcmp(string, other, length))) {
+		fail("memcmp", string, length, iteration);
+	}
+}
+
+
+int
+main(int argc, char** argv)
+{
+	size_t iterations = argc > 1 ? strtoul(argv[1], NULL, 0) : 1000000;
+	unsigned seed = argc > 2 ? strtoul(argv[2], NULL, 0) : time(NULL);
+	srand(seed);
+
+	printf("Testing %zu iterations with seed %u...\n", iterations, seed);
+
+	char* buffer = allocate_guarded_buffer(kMaxLength + 128);
+	char* otherBuffer = allocate_guarded_buffer(kMaxLength + 128);
+	char* bufferEnd = buffer + kMaxLength + 128;
+	char* otherBufferEnd = otherBuffer + kMaxLength + 128;
+
+	for (size_t i = 0; i < iterations; i++)
+		test_iteration(bufferEnd, otherBufferEnd, i);
+
+	if (sFailures != 0) {
+		printf("%d failures\n", sFailures);
+		return 1;
+	}
+
+	printf("All tests passed.\n");
+	return 0;
+}
@@ -16,6 +16,7 @@
 #include "DoublyLinkedList.h"
 #include "fssh_kernel_export.h"
 #include "fssh_lock.h"
+#include "fssh_os.h"
 #include "fssh_stdio.h"
 #include "fssh_string.h"
 #include "fssh_uio.h"
@@ -38,15 +39,22 @@ using std::nothrow;
 // This is a hacked version of the kernel file cache implementation. The main
 // part of the implementation didn't change that much -- some code not needed
 // in userland has been removed, most notably everything on the page level.
-// On the downside, the cache now never caches anything, but will always
+// On the downside, the cache now almost never caches anything, but will
 // directly work on the underlying device. Since that is usually cached by the
 // host operating system, it shouldn't hurt much, though.
+// The only exception is a single range of written data per file, which is
+// kept until it is synced, or another part of the file is accessed. Like the
+// modified pages in the kernel, this gives the file system the chance to
+// place the blocks of a file when it knows how large it is going to be.
 
 // maximum number of iovecs per request
 #define MAX_IO_VECS			64	// 256 kB
 #define MAX_FILE_IO_VECS	32
 #define MAX_TEMP_IO_VECS	8
 
+// maximum size of the modified range that is kept per file
+#define MAX_DIRTY_SIZE		(16 * 1024 * 1024)
+
 #define user_memcpy(a, b, c) fssh_memcpy(a, b, c)
 
 #define PAGE_ALIGN(x) (((x) + (FSSH_B_PAGE_SIZE - 1)) & ~(FSSH_B_PAGE_SIZE - 1))
@@ -66,6 +74,11 @@ struct file_cache_ref {
 	fssh_vnode_id				nodeID;
 	struct vnode*				node;
 	fssh_off_t					virtual_size;
+
+	uint8_t*					dirty_buffer;
+	fssh_size_t					dirty_buffer_size;
+	fssh_off_t					dirty_offset;
+	fssh_size_t					dirty_size;
 };
 
 
@@ -117,6 +130,68 @@ write_to_file(file_cache_ref *ref, void *cookie, fssh_off_t offset,
 }
 
 
+/*!	Writes the modified range of the file back, if there is one.
+	The cache ref must be locked; it is unlocked while writing.
+*/
+static fssh_status_t
+flush_dirty_range(file_cache_ref *ref)
+{
+	while (ref->dirty_size > 0) {
+		// take the data out of the cache, as it might change while unlocked
+		uint8_t *buffer = ref->dirty_buffer;
+		fssh_size_t bufferSize = ref->dirty_buffer_size;
+		fssh_off_t offset = ref->dirty_offset;
+		fssh_size_t size = ref->dirty_size;
+
+		ref->dirty_buffer = NULL;
+		ref->dirty_buffer_size = 0;
+		ref->dirty_size = 0;
+
+		fssh_status_t status = write_to_file(ref, NULL, offset, 0,
+			(fssh_addr_t)buffer, size);
+		if (status == FSSH_B_BUSY && ref->dirty_size == 0) {
+			// the file system can't write the data yet, just like the page
+			// writer in the kernel, we'll retry a bit later
+			ref->dirty_buffer = buffer;
+			ref->dirty_buffer_size = bufferSize;
+			ref->dirty_offset = offset;
+			ref->dirty_size = size;
+
+			fssh_mutex_unlock(&ref->lock);
+			fssh_snooze(10000);
+			fssh_mutex_lock(&ref->lock);
+			continue;
+		}
+
+		// keep the buffer around for the next writes
+		if (ref->dirty_buffer == NULL) {
+			ref->dirty_buffer = buffer;
+			ref->dirty_buffer_size = bufferSize;
+		} else
+			free(buffer);
+
+		if (status != FSSH_B_OK)
+			return status;
+	}
+
+	return FSSH_B_OK;
+}
+
+
+/*!	Returns whether the modified range of the file intersects with the range
+	from \a offset to \a offset + \a size.
+	The cache ref must be locked.
+*/
+static bool
+intersects_dirty_range(file_cache_ref *ref, fssh_off_t offset,
+	fssh_size_t size)
+{
+	return ref->dirty_size > 0
+		&& offset < ref->dirty_offset + (fssh_off_t)ref->dirty_size
+		&& offset + (fssh_off_t)size > ref->dirty_offset;
+}
+
+
 static inline fssh_status_t
 satisfy_cache_io(file_cache_ref *ref, void *cookie, cache_func function,
 	fssh_off_t offset, fssh_addr_t buffer, int32_t &pageOffset,
@@ -222,6 +297,75 @@ cache_io(void *_cacheRef, void *cookie, fssh_off_t offset, fssh_addr_t buffer,
 }
 
 
+/*!	Adds the data to the modified range of the file, after having written
+	the range back if the data doesn't extend it. Larger requests are
+	written to the file directly.
+*/
+static fssh_status_t
+write_to_dirty_range(file_cache_ref *ref, void *cookie, fssh_off_t offset,
+	fssh_addr_t buffer, fssh_size_t *_size)
+{
+	MutexLocker locker(ref->lock);
+
+	// out of bounds access?
+	if (offset >= ref->virtual_size || offset < 0) {
+		*_size = 0;
+		return FSSH_B_OK;
+	}
+
+	fssh_size_t size = fssh_min_c(*_size,
+		fssh_size_t(ref->virtual_size - offset));
+	*_size = size;
+	if (size == 0)
+		return FSSH_B_OK;
+
+	if (ref->dirty_size > 0
+		&& (offset < ref->dirty_offset
+			|| offset > ref->dirty_offset + (fssh_off_t)ref->dirty_size
+			|| offset + size - ref->dirty_offset > MAX_DIRTY_SIZE)) {
+		fssh_status_t status = flush_dirty_range(ref);
+		if (status != FSSH_B_OK)
+			return status;
+	}
+
+	if (ref->dirty_size == 0) {
+		if (size > MAX_DIRTY_SIZE) {
+			locker.Unlock();
+			return cache_io(ref, cookie, offset, buffer, _size, true);
+		}
+		ref->dirty_offset = offset;
+	}
+
+	fssh_size_t end = offset + size - ref->dirty_offset;
+	if (end > ref->dirty_buffer_size) {
+		fssh_size_t bufferSize = fssh_max_c(end,
+			fssh_min_c(2 * ref->dirty_buffer_size, MAX_DIRTY_SIZE));
+		uint8_t *dirtyBuffer = (uint8_t *)realloc(ref->dirty_buffer,
+			bufferSize);
+		if (dirtyBuffer == NULL) {
+			fssh_status_t status = flush_dirty_range(ref);
+			if (status != FSSH_B_OK)
+				return status;
+
+			locker.Unlock();
+			return cache_io(ref, cookie, offset, buffer, _size, true);
+		}
+
+		ref->dirty_buffer = dirtyBuffer;
+		ref->dirty_buffer_size = bufferSize;
+	}
+
+	uint8_t *target = ref->dirty_buffer + (offset - ref->dirty_offset);
+	if (buffer != 0)
+		fssh_memcpy(target, (void *)buffer, size);
+	else
+		fssh_memset(target, 0, size);
+
+	ref->dirty_size = fssh_max_c(ref->dirty_size, end);
+	return FSSH_B_OK;
+}
+
+
 }	// namespace FSShell
 
 
@@ -245,6 +389,10 @@ fssh_file_cache_create(fssh_mount_id mountID, fssh_vnode_id vnodeID,
 	ref->mountID = mountID;
 	ref->nodeID = vnodeID;
 	ref->virtual_size = size;
+	ref->dirty_buffer = NULL;
+	ref->dirty_buffer_size = 0;
+	ref->dirty_offset = 0;
+	ref->dirty_size = 0;
 
 	// get vnode
 	fssh_status_t error = vfs_lookup_vnode(mountID, vnodeID, &ref->node);
@@ -275,9 +423,13 @@ fssh_file_cache_delete(void *_cacheRef)
 
 	TRACE(("file_cache_delete(ref = %p)\n", ref));
 
+	// Like in the kernel, any modified data is discarded; the VFS syncs the
+	// file before it is put, and the data of a removed file isn't needed
+	// anymore.
 	fssh_mutex_lock(&ref->lock);
 	fssh_mutex_destroy(&ref->lock);
 
+	free(ref->dirty_buffer);
 	delete ref;
 }
 
@@ -316,6 +468,13 @@ fssh_file_cache_set_size(void *_cacheRef, fssh_off_t size)
 
 	fssh_mutex_lock(&ref->lock);
 	ref->virtual_size = size;
+
+	// forget about modified data beyond the end of the file
+	if (ref->dirty_offset >= size)
+		ref->dirty_size = 0;
+	else if (ref->dirty_offset + (fssh_off_t)ref->dirty_size > size)
+		ref->dirty_size = size - ref->dirty_offset;
+
 	fssh_mutex_unlock(&ref->lock);
 
 	return FSSH_B_OK;
@@ -329,7 +488,8 @@ fssh_file_cache_sync(void *_cacheRef)
 	if (ref == NULL)
 		return FSSH_B_BAD_VALUE;
 
-	return FSSH_B_OK;
+	MutexLocker locker(ref->lock);
+	return flush_dirty_range(ref);
 }
 
 
@@ -342,6 +502,14 @@ fssh_file_cache_read(void *_cacheRef, void *cookie, fssh_off_t offset,
 	TRACE(("file_cache_read(ref = %p, offset = %Ld, buffer = %p, size = %u)\n",
 		ref, offset, bufferBase, *_size));
 
+	MutexLocker locker(ref->lock);
+	if (intersects_dirty_range(ref, offset, *_size)) {
+		fssh_status_t status = flush_dirty_range(ref);
+		if (status != FSSH_B_OK)
+			return status;
+	}
+	locker.Unlock();
+
 	return cache_io(ref, cookie, offset, (fssh_addr_t)bufferBase, _size, false);
 }
 
@@ -352,8 +520,8 @@ fssh_file_cache_write(void *_cacheRef, void *cookie, fssh_off_t offset,
 {
 	file_cache_ref *ref = (file_cache_ref *)_cacheRef;
 
-	fssh_status_t status = cache_io(ref, cookie, offset,
-		(fssh_addr_t)const_cast<void *>(buffer), _size, true);
+	fssh_status_t status = write_to_dirty_range(ref, cookie, offset,
+		(fssh_addr_t)const_cast<void *>(buffer), _size);
 	TRACE(("file_cache_write(ref = %p, offset = %Ld, buffer = %p, size = %u) = %d\n",
 		ref, offset, buffer, *_size, status));
 
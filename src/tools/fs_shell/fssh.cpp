@@ -1513,10 +1513,13 @@ input_loop(bool interactive)
 
 
 static int
-standard_session(const char* device, const char* fsName, bool interactive)
+standard_session(const char* device, const char* fsName,
+	const char* mountParameters, bool interactive)
 {
 	// mount FS
-	fssh_dev_t fsDev = _kern_mount(kMountPoint, device, fsName, 0, NULL, 0);
+	fssh_dev_t fsDev = _kern_mount(kMountPoint, device, fsName, 0,
+		mountParameters,
+		mountParameters != NULL ? strlen(mountParameters) : 0);
 	if (fsDev < 0) {
 		fprintf(stderr, "Error: Mounting FS failed: %s\n",
 			fssh_strerror(fsDev));
@@ -1564,7 +1567,8 @@ print_usage(bool error)
 {
 	fprintf((error ? stderr : stdout),
 		"Usage: %s [ --start-offset <startOffset>]\n"
-		"          [ --end-offset <endOffset>] [-n] <device>\n"
+		"          [ --end-offset <endOffset>]\n"
+		"          [ --mount-parameters <mount parameters>] [-n] <device>\n"
 		"       %s [ --start-offset <startOffset>]\n"
 		"          [ --end-offset <endOffset>]\n"
 		"          --initialize [-n] <device> <volume name> "
@@ -1600,6 +1604,7 @@ main(int argc, const char* const* argv)
 	const char* device = NULL;
 	const char* volumeName = NULL;
 	const char* initParameters = NULL;
+	const char* mountParameters = NULL;
 	fssh_off_t startOffset = 0;
 	fssh_off_t endOffset = -1;
 
@@ -1621,6 +1626,10 @@ main(int argc, const char* const* argv)
 			if (argi >= argc)
 				print_usage_and_exit(true);
 			endOffset = atoll(argv[argi++]);
+		} else if (strcmp(arg, "--mount-parameters") == 0) {
+			if (argi >= argc)
+				print_usage_and_exit(true);
+			mountParameters = argv[argi++];
 		} else {
 			print_usage_and_exit(true);
 		}
@@ -1674,7 +1683,8 @@ main(int argc, const char* const* argv)
 		result = initialization_session(device, fsName, volumeName,
 			initParameters);
 	} else
-		result = standard_session(device, fsName, interactive);
+		result = standard_session(device, fsName, mountParameters,
+			interactive);
 
 	return result;
 }
@@ -172,6 +172,24 @@ fssh_mutex_lock(fssh_mutex *mutex)
 }
 
 
+extern "C" fssh_status_t
+fssh_mutex_trylock(fssh_mutex *mutex)
+{
+	fssh_thread_id me = fssh_find_thread(NULL);
+
+	if (me == mutex->holder)
+		return FSSH_B_WOULD_BLOCK;
+
+	fssh_status_t status = fssh_acquire_sem_etc(mutex->sem, 1,
+		FSSH_B_RELATIVE_TIMEOUT, 0);
+	if (status < FSSH_B_OK)
+		return status;
+
+	mutex->holder = me;
+	return FSSH_B_OK;
+}
+
+
 extern "C" void
 fssh_mutex_unlock(fssh_mutex *mutex)
 {